@@ -0,0 +1,187 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Benchmark.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <iostream>
+#include <algorithm>
+//
+#include "Timer.h"
+
+/**
+ * A microbenchmark of one primitive, parameterized by the number of features
+ * and the number of active features of the sparse vectors. setUp(..)
+ * allocates and fills the data from a fixed seed, so the runs are
+ * reproducible; step() is the operation that is timed.
+ */
+class Microbenchmark
+{
+  public:
+    virtual ~Microbenchmark()
+    {
+    }
+    virtual std::string name() const =0;
+    // False when the primitive does not depend on the number of active features
+    virtual bool sparse() const
+    {
+      return true;
+    }
+    virtual void setUp(const int& nbFeatures, const int& nbActive) =0;
+    virtual void step() =0;
+    virtual void tearDown() =0;
+};
+
+/**
+ * Runs the microbenchmarks on a sweep of feature counts and active counts.
+ * Each configuration is calibrated until a repetition lasts minTimeInMilliSec,
+ * then repeated nbRepetitions times; the median is reported in ns per step.
+ * The results print as a table, and as JSON to track the regressions.
+ */
+class BenchmarkRunner
+{
+  public:
+    struct Result
+    {
+        std::string name;
+        int nbFeatures;
+        int nbActive;
+        long nbIterations;
+        double median, min, max; // in ns per step
+    };
+
+    // Defeats the elimination of the results of the steps
+    static volatile double& sink()
+    {
+      static volatile double value = 0;
+      return value;
+    }
+
+  protected:
+    double minTimeInMilliSec;
+    int nbRepetitions;
+    std::string filter;
+    std::vector<Result> results;
+
+  public:
+    BenchmarkRunner(const double& minTimeInMilliSec, const int& nbRepetitions,
+        const std::string& filter) :
+        minTimeInMilliSec(minTimeInMilliSec), nbRepetitions(std::max(nbRepetitions, 1)), //
+        filter(filter)
+    {
+    }
+
+    void run(Microbenchmark* benchmark, const std::vector<int>& nbFeatures,
+        const std::vector<int>& nbActive)
+    {
+      if (!filter.empty() && benchmark->name().find(filter) == std::string::npos)
+        return;
+      for (size_t i = 0; i < nbFeatures.size(); i++)
+      {
+        if (!benchmark->sparse())
+        {
+          run(benchmark, nbFeatures[i], nbFeatures[i]);
+          continue;
+        }
+        for (size_t j = 0; j < nbActive.size(); j++)
+          if (nbActive[j] * 2 <= nbFeatures[i])
+            run(benchmark, nbFeatures[i], nbActive[j]);
+      }
+    }
+
+    const std::vector<Result>& getResults() const
+    {
+      return results;
+    }
+
+    void printHeader(std::ostream& out) const
+    {
+      char line[256];
+      std::snprintf(line, sizeof(line), "%-36s %9s %7s %12s %12s %12s", "benchmark", "features",
+          "active", "median(ns)", "min(ns)", "iterations");
+      out << line << std::endl;
+    }
+
+    void writeJson(std::ostream& out, const std::string& label, const std::string& scalar) const
+    {
+      out << "{\n  \"library\": \"RLLib\",\n  \"label\": \"" << label << "\",\n";
+      out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+      out << "  \"scalar\": \"" << scalar << "\",\n";
+      out << "  \"minTimeInMilliSec\": " << minTimeInMilliSec << ",\n";
+      out << "  \"repetitions\": " << nbRepetitions << ",\n";
+      out << "  \"benchmarks\": [";
+      for (size_t i = 0; i < results.size(); i++)
+      {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"features\": "
+            << r.nbFeatures << ", \"active\": " << r.nbActive << ", \"iterations\": "
+            << r.nbIterations << ", \"ns_median\": " << r.median << ", \"ns_min\": " << r.min
+            << ", \"ns_max\": " << r.max << "}";
+      }
+      out << "\n  ]\n}" << std::endl;
+    }
+
+  protected:
+    void run(Microbenchmark* benchmark, const int& nbFeatures, const int& nbActive)
+    {
+      benchmark->setUp(nbFeatures, nbActive);
+      // Calibrates the number of iterations of a repetition, which also warms up
+      long nbIterations = 1;
+      while (time(benchmark, nbIterations) < minTimeInMilliSec * 1e6 && nbIterations < (1L << 40))
+        nbIterations *= 2;
+      std::vector<double> times;
+      for (int r = 0; r < nbRepetitions; r++)
+        times.push_back(time(benchmark, nbIterations) / nbIterations);
+      benchmark->tearDown();
+
+      std::sort(times.begin(), times.end());
+      Result result;
+      result.name = benchmark->name();
+      result.nbFeatures = nbFeatures;
+      result.nbActive = nbActive;
+      result.nbIterations = nbIterations;
+      result.median = times[times.size() / 2];
+      result.min = times.front();
+      result.max = times.back();
+      results.push_back(result);
+
+      char line[256];
+      std::snprintf(line, sizeof(line), "%-36s %9d %7d %12.1f %12.1f %12ld", result.name.c_str(),
+          nbFeatures, nbActive, result.median, result.min, nbIterations);
+      std::cout << line << std::endl;
+    }
+
+    // In ns
+    static double time(Microbenchmark* benchmark, const long& nbIterations)
+    {
+      RLLib::Timer timer;
+      timer.start();
+      for (long i = 0; i < nbIterations; i++)
+        benchmark->step();
+      timer.stop();
+      return timer.getElapsedTimeInMicroSec() * 1e3;
+    }
+};
+
+#endif /* BENCHMARK_H_ */
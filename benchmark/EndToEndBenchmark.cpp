@@ -0,0 +1,719 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * EndToEndBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <map>
+#include <cassert>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+//
+#include "RL.h"
+#include "Trace.h"
+#include "Policy.h"
+#include "Hashing.h"
+#include "Projector.h"
+#include "ControlAlgorithm.h"
+#include "StateToStateAction.h"
+
+// The problems use the names of std and RLLib unqualified
+using namespace std;
+using namespace RLLib;
+
+#include "Acrobot.h"
+#include "CartPole.h"
+#include "Helicopter.h"
+#include "MountainCar.h"
+#include "RandlovBike.h"
+#include "MountainCar3D.h"
+#include "SwingPendulum.h"
+#include "UnderwaterVehicle.h"
+#include "ContinuousGridworld.h"
+#include "NonMarkovPoleBalancing.h"
+//
+#include "Statistics.h"
+
+/**
+ * The end-to-end learning throughput of every bundled problem: each
+ * problem/algorithm pair learns for a fixed number of episodes from a fixed
+ * seed per repetition, and reports
+ *   - the agent steps/s, i.e., the time in RLAgent::initialize(..) and
+ *     RLAgent::getAtp1(..),
+ *   - the simulator steps/s, i.e., the rest of the episode loop: the problem
+ *     and RLRunner,
+ *   - the peak RSS,
+ *   - the number of episodes until the mean return of the last ten episodes
+ *     reaches the threshold of the pair.
+ * Each repetition runs in a child process, so that the peak RSS belongs to
+ * one pair, and the child releases its objects when it exits.
+ *
+ * The results are stored as a baseline file; --compare runs Welch's t-test
+ * between the repetitions of a baseline and the current ones, and flags the
+ * metrics that are significantly worse.
+ */
+namespace
+{
+  double nowInNanoSec()
+  {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+  }
+
+  // Times the decisions of the agent it decorates
+  class TimedAgent: public RLAgent<double>
+  {
+    protected:
+      RLAgent<double>* agent;
+
+    public:
+      double timeInNanoSec;
+
+      TimedAgent(RLAgent<double>* agent) :
+          RLAgent<double>(agent->getRLAgent()), agent(agent), timeInNanoSec(0)
+      {
+      }
+
+      const Action<double>* initialize(const TRStep<double>* step)
+      {
+        const double start = nowInNanoSec();
+        const Action<double>* a_tp1 = agent->initialize(step);
+        timeInNanoSec += nowInNanoSec() - start;
+        return a_tp1;
+      }
+
+      const Action<double>* getAtp1(const TRStep<double>* step)
+      {
+        const double start = nowInNanoSec();
+        const Action<double>* a_tp1 = agent->getAtp1(step);
+        timeInNanoSec += nowInNanoSec() - start;
+        return a_tp1;
+      }
+
+      void reset()
+      {
+        agent->reset();
+      }
+
+      void flush()
+      {
+        agent->flush();
+      }
+  };
+
+  // The result of one repetition, sent by the child process through a pipe
+  struct RunResult
+  {
+      double agentTimeInNanoSec;
+      double totalTimeInNanoSec;
+      long nbSteps;
+      long peakRSSInKB;
+      int episodesToThreshold; // nbEpisodes + 1 when it is not reached
+  };
+
+  // Counts the steps, and the episodes until the mean return of the last WINDOW reaches threshold
+  class EpisodeCounter: public RLRunner<double>::Event
+  {
+    public:
+      enum
+      {
+        WINDOW = 10
+      };
+
+      RunResult* result;
+      std::vector<double>* returns;
+      double threshold;
+
+      EpisodeCounter(RunResult* result, std::vector<double>* returns, const double& threshold) :
+          result(result), returns(returns), threshold(threshold)
+      {
+      }
+
+      void update() const
+      {
+        result->nbSteps += nbTotalTimeSteps;
+        returns->push_back(episodeR);
+        if (returns->size() < WINDOW || nbEpisodeDone >= result->episodesToThreshold)
+          return;
+        double sum = 0;
+        for (size_t i = returns->size() - WINDOW; i < returns->size(); i++)
+          sum += returns->at(i);
+        if (sum / WINDOW >= threshold)
+          result->episodesToThreshold = nbEpisodeDone;
+      }
+  };
+
+  /**
+   * A problem/algorithm pair. setUp(..) builds the problem and the control
+   * from random; the objects live until the child process exits.
+   */
+  class Workload
+  {
+    public:
+      typedef RLProblem<double>* (*ProblemFactory)(Random<double>* random);
+
+      std::string problemName, algorithmName;
+      int maxEpisodeTimeSteps, nbEpisodes;
+      double threshold; // on the mean return of the last episodes
+
+    protected:
+      ProblemFactory newProblem;
+      RLProblem<double>* problem;
+
+    public:
+      Workload(const std::string& problemName, const std::string& algorithmName,
+          ProblemFactory newProblem, const int& maxEpisodeTimeSteps, const int& nbEpisodes,
+          const double& threshold) :
+          problemName(problemName), algorithmName(algorithmName), //
+          maxEpisodeTimeSteps(maxEpisodeTimeSteps), nbEpisodes(nbEpisodes), //
+          threshold(threshold), newProblem(newProblem), problem(0)
+      {
+      }
+
+      virtual ~Workload()
+      {
+      }
+
+      std::string name() const
+      {
+        return problemName + "/" + algorithmName;
+      }
+
+      RLProblem<double>* getProblem() const
+      {
+        return problem;
+      }
+
+      virtual Control<double>* setUp(Random<double>* random) =0;
+  };
+
+  // Sarsa(lambda) with replacing traces, epsilon-greedy, on hashed tile coding
+  class SarsaWorkload: public Workload
+  {
+    public:
+      SarsaWorkload(const std::string& problemName, ProblemFactory newProblem,
+          const int& maxEpisodeTimeSteps, const int& nbEpisodes, const double& threshold) :
+          Workload(problemName, "Sarsa", newProblem, maxEpisodeTimeSteps, nbEpisodes, threshold)
+      {
+      }
+
+      Control<double>* setUp(Random<double>* random)
+      {
+        problem = newProblem(random);
+        Hashing<double>* hashing = new MurmurHashing<double>(random, 100000);
+        Projector<double>* projector = new TileCoderHashing<double>(hashing,
+            problem->dimension(), 10, 10, true);
+        StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+            problem->getDiscreteActions());
+        Trace<double>* e = new ATrace<double>(projector->dimension());
+        Sarsa<double>* sarsa = new SarsaTrue<double>(0.1 / projector->vectorNorm(), 0.99, 0.9,
+            e);
+        Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(),
+            sarsa, 0.01);
+        return new SarsaControl<double>(acting, toStateAction, sarsa);
+      }
+  };
+
+  // Greedy-GQ(lambda) off-policy control from a random behavior policy
+  class GreedyGQWorkload: public Workload
+  {
+    protected:
+      bool continuousActions;
+
+    public:
+      GreedyGQWorkload(const std::string& problemName, ProblemFactory newProblem,
+          const int& maxEpisodeTimeSteps, const int& nbEpisodes, const double& threshold,
+          const bool& continuousActions = false) :
+          Workload(problemName, "GreedyGQ", newProblem, maxEpisodeTimeSteps, nbEpisodes,
+              threshold), continuousActions(continuousActions)
+      {
+      }
+
+      Control<double>* setUp(Random<double>* random)
+      {
+        problem = newProblem(random);
+        // The problems without discrete actions have one continuous action, e.g., the
+        // hovering Helicopter; Greedy-GQ then evaluates it
+        Actions<double>* actions =
+            continuousActions ? problem->getContinuousActions() : problem->getDiscreteActions();
+        Hashing<double>* hashing = new MurmurHashing<double>(random, 100000);
+        Projector<double>* projector = new TileCoderHashing<double>(hashing,
+            problem->dimension(), 10, 10, true);
+        StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+            actions);
+        Trace<double>* e = new ATrace<double>(projector->dimension());
+        GQ<double>* gq = new GQ<double>(0.1 / projector->vectorNorm(),
+            0.0001 / projector->vectorNorm(), 0.99, 0.4, e);
+        Policy<double>* behavior = new RandomPolicy<double>(random, actions);
+        Policy<double>* target = new Greedy<double>(actions, gq);
+        return new GreedyGQ<double>(target, behavior, actions, toStateAction, gq);
+      }
+  };
+
+  // Off-policy actor-critic with a GTD(lambda) critic and a Boltzmann target policy
+  class OffPACWorkload: public Workload
+  {
+    public:
+      OffPACWorkload(const std::string& problemName, ProblemFactory newProblem,
+          const int& maxEpisodeTimeSteps, const int& nbEpisodes, const double& threshold) :
+          Workload(problemName, "OffPAC", newProblem, maxEpisodeTimeSteps, nbEpisodes, threshold)
+      {
+      }
+
+      Control<double>* setUp(Random<double>* random)
+      {
+        problem = newProblem(random);
+        Hashing<double>* hashing = new MurmurHashing<double>(random, 100000);
+        Projector<double>* projector = new TileCoderHashing<double>(hashing,
+            problem->dimension(), 10, 10, true);
+        StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+            problem->getDiscreteActions());
+        Trace<double>* critice = new ATrace<double>(projector->dimension());
+        GTDLambda<double>* critic = new GTDLambda<double>(0.1 / projector->vectorNorm(),
+            0.0001 / projector->vectorNorm(), 0.99, 0.4, critice);
+        PolicyDistribution<double>* target = new BoltzmannDistribution<double>(random,
+            problem->getDiscreteActions(), projector->dimension());
+        Traces<double>* actoreTraces = new Traces<double>();
+        actoreTraces->push_back(new ATrace<double>(projector->dimension()));
+        ActorOffPolicy<double>* actor = new ActorLambdaOffPolicy<double>(
+            0.5 / projector->vectorNorm(), 0.99, 0.4, target, actoreTraces);
+        Policy<double>* behavior = new RandomPolicy<double>(random,
+            problem->getDiscreteActions());
+        return new OffPAC<double>(behavior, critic, actor, toStateAction, projector);
+      }
+  };
+
+  // Average reward actor-critic with a Normal policy on one continuous action
+  class ActorCriticWorkload: public Workload
+  {
+    public:
+      ActorCriticWorkload(const std::string& problemName, ProblemFactory newProblem,
+          const int& maxEpisodeTimeSteps, const int& nbEpisodes, const double& threshold) :
+          Workload(problemName, "ActorCritic", newProblem, maxEpisodeTimeSteps, nbEpisodes,
+              threshold)
+      {
+      }
+
+      Control<double>* setUp(Random<double>* random)
+      {
+        problem = newProblem(random);
+        Hashing<double>* hashing = new MurmurHashing<double>(random, 1000);
+        Projector<double>* projector = new TileCoderHashing<double>(hashing,
+            problem->dimension(), 10, 10, false);
+        StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+            problem->getContinuousActions());
+        Trace<double>* critice = new ATrace<double>(projector->dimension());
+        TDLambda<double>* critic = new TDLambda<double>(0.1 / projector->vectorNorm(), 1.0, 0.5,
+            critice);
+        PolicyDistribution<double>* policyDistribution = new NormalDistributionScaled<double>(
+            random, problem->getContinuousActions(), 0, 1.0, projector->dimension());
+        Range<double>* policyRange = new Range<double>(-2.0, 2.0);
+        Range<double>* problemRange = new Range<double>(-2.0, 2.0);
+        PolicyDistribution<double>* acting = new ScaledPolicyDistribution<double>(
+            problem->getContinuousActions(), policyDistribution, policyRange, problemRange);
+        Traces<double>* actoreTraces = new Traces<double>();
+        actoreTraces->push_back(new ATrace<double>(projector->dimension()));
+        actoreTraces->push_back(new ATrace<double>(projector->dimension()));
+        ActorOnPolicy<double>* actor = new ActorLambda<double>(0.001 / projector->vectorNorm(),
+            1.0, 0.5, acting, actoreTraces);
+        return new AverageRewardActorCritic<double>(critic, actor, projector, toStateAction,
+            0.0001);
+      }
+  };
+
+  RLProblem<double>* newMountainCar(Random<double>* random)
+  {
+    return new MountainCar<double>(random);
+  }
+
+  RLProblem<double>* newMountainCar3D(Random<double>* random)
+  {
+    return new MountainCar3D<double>(random);
+  }
+
+  RLProblem<double>* newAcrobot(Random<double>* random)
+  {
+    return new Acrobot(random);
+  }
+
+  RLProblem<double>* newCartPole(Random<double>* random)
+  {
+    return new CartPole(random);
+  }
+
+  RLProblem<double>* newNonMarkovPoleBalancing(Random<double>* random)
+  {
+    return new NonMarkovPoleBalancing<double>(random);
+  }
+
+  RLProblem<double>* newRandlovBike(Random<double>* random)
+  {
+    return new RandlovBike<double>(random, false);
+  }
+
+  RLProblem<double>* newUnderwaterVehicle(Random<double>* random)
+  {
+    return new UnderwaterVehicle(random);
+  }
+
+  RLProblem<double>* newContinuousGridworld(Random<double>* random)
+  {
+    return new ContinuousGridworld<double>(random);
+  }
+
+  RLProblem<double>* newSwingPendulum(Random<double>* random)
+  {
+    return new SwingPendulum<double>(random);
+  }
+
+  RLProblem<double>* newHelicopter(Random<double>* random)
+  {
+    return new Helicopter<double>(random);
+  }
+
+  void newWorkloads(std::vector<Workload*>& workloads)
+  {
+    workloads.push_back(new SarsaWorkload("MountainCar", newMountainCar, 5000, 100, -150));
+    workloads.push_back(new SarsaWorkload("MountainCar3D", newMountainCar3D, 5000, 20, -2500));
+    workloads.push_back(new SarsaWorkload("Acrobot", newAcrobot, 1000, 50, -250));
+    workloads.push_back(new SarsaWorkload("CartPole", newCartPole, 1000, 200, -60));
+    workloads.push_back(
+        new SarsaWorkload("NonMarkovPoleBalancing", newNonMarkovPoleBalancing, 1000, 200, 50));
+    workloads.push_back(new SarsaWorkload("RandlovBike", newRandlovBike, 10000, 50, 0));
+    workloads.push_back(
+        new SarsaWorkload("UnderwaterVehicle", newUnderwaterVehicle, 1000, 30, -1));
+    workloads.push_back(
+        new GreedyGQWorkload("ContinuousGridworld", newContinuousGridworld, 5000, 50, -10000));
+    // Greedy-GQ only evaluates the hovering action, which crashes in a few steps
+    workloads.push_back(new GreedyGQWorkload("Helicopter", newHelicopter, 1000, 2000, 0, true));
+    workloads.push_back(new OffPACWorkload("SwingPendulum", newSwingPendulum, 5000, 20, -4500));
+    workloads.push_back(
+        new ActorCriticWorkload("SwingPendulum", newSwingPendulum, 5000, 20, -500));
+  }
+
+  // Runs one repetition in this process
+  RunResult runOnce(Workload* workload, const uint32_t& seed, const int& nbEpisodes)
+  {
+    RunResult result;
+    result.agentTimeInNanoSec = result.totalTimeInNanoSec = 0;
+    result.nbSteps = 0;
+    result.peakRSSInKB = 0;
+    result.episodesToThreshold = nbEpisodes + 1;
+
+    Random<double>* random = new Random<double>;
+    random->reseed(seed);
+    Control<double>* control = workload->setUp(random);
+    RLAgent<double>* learner = new LearnerAgent<double>(control);
+    TimedAgent* agent = new TimedAgent(learner);
+    RLRunner<double>* runner = new RLRunner<double>(agent, workload->getProblem(),
+        workload->maxEpisodeTimeSteps, nbEpisodes, 1);
+    runner->setVerbose(false);
+    std::vector<double> returns;
+    returns.reserve(nbEpisodes);
+    EpisodeCounter counter(&result, &returns, workload->threshold);
+    runner->onEpisodeEnd.push_back(&counter);
+
+    const double start = nowInNanoSec();
+    runner->run();
+    result.totalTimeInNanoSec = nowInNanoSec() - start;
+    result.agentTimeInNanoSec = agent->timeInNanoSec;
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRSSInKB = usage.ru_maxrss;
+    return result;
+  }
+
+  /**
+   * Runs one repetition of workloads[index] in a new image of this program,
+   * see main(..); false when the child fails. The child starts from a fresh
+   * address space, so its peak RSS does not depend on the parent.
+   */
+  bool runInChild(const size_t& index, const uint32_t& seed, const int& nbEpisodes,
+      RunResult& result)
+  {
+    int fds[2];
+    if (pipe(fds) != 0)
+      return false;
+    std::cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+      close(fds[0]);
+      close(fds[1]);
+      return false;
+    }
+    if (pid == 0)
+    {
+      close(fds[0]);
+      char arguments[4][16];
+      std::snprintf(arguments[0], sizeof(arguments[0]), "%d", int(index));
+      std::snprintf(arguments[1], sizeof(arguments[1]), "%u", seed);
+      std::snprintf(arguments[2], sizeof(arguments[2]), "%d", nbEpisodes);
+      std::snprintf(arguments[3], sizeof(arguments[3]), "%d", fds[1]);
+      execl("/proc/self/exe", "RLLibEndToEnd", "--run", arguments[0], arguments[1],
+          arguments[2], arguments[3], (char*) 0);
+      _exit(127);
+    }
+    close(fds[1]);
+    const bool read = ::read(fds[0], &result, sizeof(result)) == ssize_t(sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return read && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+
+  // The child of runInChild(..): --run index seed nbEpisodes fd
+  int runChild(char** argv)
+  {
+    std::vector<Workload*> workloads;
+    newWorkloads(workloads);
+    const size_t index = std::atoi(argv[0]);
+    if (index >= workloads.size())
+      return 1;
+    const RunResult result = runOnce(workloads[index], std::atoi(argv[1]), std::atoi(argv[2]));
+    const int fd = std::atoi(argv[3]);
+    const bool written = write(fd, &result, sizeof(result)) == ssize_t(sizeof(result));
+    close(fd);
+    return written ? 0 : 1;
+  }
+
+  /**
+   * The metrics of the repetitions of the pairs, keyed by "problem algorithm
+   * metric". A baseline file has one line per key: the key, the number of
+   * repetitions and their values; the lines that start with # are comments.
+   */
+  typedef std::map<std::string, std::vector<double> > Metrics;
+
+  const char* metricNames[] = { "agentStepsPerSec", "simulatorStepsPerSec", "stepsPerSec",
+      "peakRSSInKB", "episodesToThreshold" };
+  // The throughputs are better when higher, the others when lower
+  const bool higherIsBetter[] = { true, true, true, false, false };
+  const int nbMetrics = 5;
+
+  void addResult(Metrics& metrics, Workload* workload, const RunResult& r)
+  {
+    const double agent = r.agentTimeInNanoSec * 1e-9, total = r.totalTimeInNanoSec * 1e-9;
+    const double values[] = { r.nbSteps / agent, r.nbSteps / (total - agent), r.nbSteps / total,
+        double(r.peakRSSInKB), double(r.episodesToThreshold) };
+    for (int m = 0; m < nbMetrics; m++)
+      metrics[workload->problemName + " " + workload->algorithmName + " " + metricNames[m]] //
+      .push_back(values[m]);
+  }
+
+  const std::vector<double>& get(const Metrics& metrics, Workload* workload, const int& m)
+  {
+    static const std::vector<double> empty;
+    const Metrics::const_iterator iter = metrics.find(
+        workload->problemName + " " + workload->algorithmName + " " + metricNames[m]);
+    return iter == metrics.end() ? empty : iter->second;
+  }
+
+  bool writeBaseline(const std::string& file, const std::string& label, const Metrics& metrics)
+  {
+    std::ofstream out(file.c_str());
+    if (!out)
+    {
+      std::cerr << "ERROR! (persist) file=" << file << std::endl;
+      return false;
+    }
+    out << "# RLLibEndToEnd baseline label=" << label << " compiler=" << __VERSION__ << std::endl;
+    out.precision(10);
+    for (Metrics::const_iterator iter = metrics.begin(); iter != metrics.end(); ++iter)
+    {
+      out << iter->first << " " << iter->second.size();
+      for (size_t i = 0; i < iter->second.size(); i++)
+        out << " " << iter->second[i];
+      out << std::endl;
+    }
+    return true;
+  }
+
+  bool readBaseline(const std::string& file, Metrics& metrics)
+  {
+    std::ifstream in(file.c_str());
+    if (!in)
+    {
+      std::cerr << "ERROR! (resurrect) file=" << file << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+      std::istringstream tokens(line);
+      std::string problem, algorithm, metric;
+      size_t n = 0;
+      tokens >> problem >> algorithm >> metric >> n;
+      std::vector<double>& values = metrics[problem + " " + algorithm + " " + metric];
+      double value;
+      while (values.size() < n && tokens >> value)
+        values.push_back(value);
+      if (values.size() != n)
+      {
+        std::cerr << "ERROR! (resurrect) malformed line=" << line << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Flags the metrics that are worse than the baseline with a p-value of
+   * Welch's t-test below alpha, by more than minChange of the baseline mean;
+   * returns the number of flagged metrics.
+   */
+  int compare(const std::vector<Workload*>& workloads, const Metrics& baseline,
+      const Metrics& current, const double& alpha, const double& minChange)
+  {
+    std::printf("\n%-34s %-21s %14s %14s %8s %8s\n", "pair", "metric", "baseline", "current",
+        "change", "p");
+    int nbRegressions = 0;
+    for (size_t w = 0; w < workloads.size(); w++)
+      for (int m = 0; m < nbMetrics; m++)
+      {
+        const std::vector<double>& b = get(baseline, workloads[w], m);
+        const std::vector<double>& c = get(current, workloads[w], m);
+        if (c.empty())
+          continue;
+        if (b.empty())
+        {
+          std::printf("%-34s %-21s %14s %14.1f\n", workloads[w]->name().c_str(), metricNames[m],
+              "-", Statistics::mean(c));
+          continue;
+        }
+        const double mb = Statistics::mean(b), mc = Statistics::mean(c);
+        const double change = mb != 0 ? (mc - mb) / std::fabs(mb) : 0;
+        const double worse = higherIsBetter[m] ? -change : change;
+        bool flagged = false;
+        double p = 1;
+        if (b.size() > 1 && c.size() > 1)
+        {
+          p = higherIsBetter[m] ? Statistics::welchLess(c, b) : Statistics::welchLess(b, c);
+          flagged = p < alpha && worse > minChange;
+        }
+        nbRegressions += flagged;
+        std::printf("%-34s %-21s %14.1f %14.1f %+7.1f%% %8.4f%s\n", workloads[w]->name().c_str(),
+            metricNames[m], mb, mc, 100 * change, p, flagged ? "  << WORSE" : "");
+      }
+    return nbRegressions;
+  }
+
+  void usage()
+  {
+    std::cout << "usage: RLLibEndToEnd [--baseline file] [--compare file] [--filter name]"
+        << " [--repetitions n] [--alpha p] [--min-change fraction] [--label text] [--quick]"
+        << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc == 6 && std::string(argv[1]) == "--run")
+    return runChild(argv + 2);
+
+  std::string baselineFile, compareFile, filter, label("HEAD");
+  int nbRepetitions = 5;
+  double alpha = 0.01, minChange = 0.03;
+  bool quick = false;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg(argv[i]);
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--baseline" && hasValue)
+      baselineFile = argv[++i];
+    else if (arg == "--compare" && hasValue)
+      compareFile = argv[++i];
+    else if (arg == "--filter" && hasValue)
+      filter = argv[++i];
+    else if (arg == "--repetitions" && hasValue)
+      nbRepetitions = std::max(std::atoi(argv[++i]), 1);
+    else if (arg == "--alpha" && hasValue)
+      alpha = std::atof(argv[++i]);
+    else if (arg == "--min-change" && hasValue)
+      minChange = std::atof(argv[++i]);
+    else if (arg == "--label" && hasValue)
+      label = argv[++i];
+    else if (arg == "--quick")
+      quick = true;
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+
+  Metrics baseline;
+  if (!compareFile.empty() && !readBaseline(compareFile, baseline))
+    return 1;
+
+  std::vector<Workload*> workloads, selected;
+  newWorkloads(workloads);
+  std::printf("%-34s %7s %8s %12s %12s %12s %10s %8s\n", "pair", "seeds", "steps", "agent/s",
+      "simulator/s", "steps/s", "rss(KB)", "episodes");
+  Metrics current;
+  for (size_t w = 0; w < workloads.size(); w++)
+  {
+    Workload* workload = workloads[w];
+    if (!filter.empty() && workload->name().find(filter) == std::string::npos)
+      continue;
+    selected.push_back(workload);
+    // --quick shortens the runs, which changes the episodes to threshold
+    const int nbEpisodes = quick ? std::max(workload->nbEpisodes / 5, 1) : workload->nbEpisodes;
+    long nbSteps = 0;
+    for (int seed = 0; seed < nbRepetitions; seed++)
+    {
+      RunResult result;
+      if (!runInChild(w, seed, nbEpisodes, result))
+      {
+        std::cerr << "ERROR! " << workload->name() << " seed=" << seed << " failed" << std::endl;
+        return 1;
+      }
+      nbSteps += result.nbSteps;
+      addResult(current, workload, result);
+    }
+    std::printf("%-34s %7d %8ld %12.0f %12.0f %12.0f %10.0f %8.1f\n", workload->name().c_str(),
+        nbRepetitions, nbSteps / nbRepetitions, Statistics::mean(get(current, workload, 0)),
+        Statistics::mean(get(current, workload, 1)),
+        Statistics::mean(get(current, workload, 2)),
+        Statistics::mean(get(current, workload, 3)),
+        Statistics::mean(get(current, workload, 4)));
+  }
+
+  int nbRegressions = 0;
+  if (!compareFile.empty())
+  {
+    nbRegressions = compare(selected, baseline, current, alpha, minChange);
+    std::cout << "\n" << nbRegressions << " metric(s) significantly worse than " << compareFile
+        << std::endl;
+  }
+  if (!baselineFile.empty() && !writeBaseline(baselineFile, label, current))
+    return 1;
+
+  for (size_t w = 0; w < workloads.size(); w++)
+    delete workloads[w];
+  return nbRegressions ? 2 : 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * GatherBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+//
+#include "Vector.h"
+#include "Mathema.h"
+#include "AllocationPolicy.h"
+#include "Benchmark.h"
+
+using namespace RLLib;
+
+/**
+ * The throughput of random gathers over a large weight table, as the dot
+ * product of a hashed tile coder over its weights, for each allocation
+ * policy of the table: the default new T[], a cache line alignment,
+ * transparent and explicit huge pages, and the NUMA binding and
+ * interleaving. Each step gathers nbActive weights at uniform random
+ * indexes, which come from a precomputed stream.
+ */
+namespace
+{
+  class Gather: public Microbenchmark
+  {
+    protected:
+      std::string prefix;
+      AllocationPolicy* policy;
+      PVector<double>* weights;
+      std::vector<int> indexes;
+      int nbActive;
+      size_t cursor;
+      bool reported;
+
+    public:
+      // policy 0 is the default allocation
+      Gather(const std::string& prefix, AllocationPolicy* policy) :
+          prefix(prefix), policy(policy), weights(0), nbActive(0), cursor(0), //
+          reported(false)
+      {
+      }
+
+      virtual ~Gather()
+      {
+        delete policy;
+      }
+
+      std::string name() const
+      {
+        return "gather(" + prefix + ")";
+      }
+
+      void setUp(const int& nbFeatures, const int& nbActive)
+      {
+        this->nbActive = nbActive;
+        {
+          AllocationPolicyScope scope(policy);
+          weights = new PVector<double>(nbFeatures);
+        }
+        // Touches every page, which also places them
+        Random<double> random;
+        random.reseed(uint32_t(42));
+        for (int i = 0; i < nbFeatures; i++)
+          weights->setEntry(i, random.nextReal());
+        indexes.resize(1 << 20);
+        for (size_t i = 0; i < indexes.size(); i++)
+          indexes[i] = random.nextInt(nbFeatures);
+        cursor = 0;
+      }
+
+      void step()
+      {
+        const double* data = weights->getValues();
+        const int* index = &indexes[cursor];
+        double sum = 0;
+        for (int i = 0; i < nbActive; i++)
+          sum += data[index[i]];
+        cursor += nbActive;
+        if (cursor + nbActive > indexes.size())
+          cursor = 0;
+        BenchmarkRunner::sink() = sum;
+      }
+
+      void tearDown()
+      {
+        delete weights;
+        weights = 0;
+        if (!policy || reported)
+          return;
+        reported = true;
+        if (policy->getNbHugePageFallbacks())
+          std::cout << "  " << name() << ": no explicit huge pages reserved"
+              << " (/proc/sys/vm/nr_hugepages), fell back to transparent huge pages" << std::endl;
+        if (policy->getNbNumaFallbacks())
+          std::cout << "  " << name() << ": mbind(2) failed, the pages stay local" << std::endl;
+      }
+  };
+
+  void usage()
+  {
+    std::cout << "usage: RLLibGather [--size-mb n] [--json file] [--filter name] [--min-time ms]"
+        << " [--repetitions n] [--label text] [--node n]" << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::string json, filter, label("HEAD");
+  double minTimeInMilliSec = 100;
+  int nbRepetitions = 5, sizeInMB = 256, node = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg(argv[i]);
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--size-mb" && hasValue)
+      sizeInMB = std::atoi(argv[++i]);
+    else if (arg == "--json" && hasValue)
+      json = argv[++i];
+    else if (arg == "--filter" && hasValue)
+      filter = argv[++i];
+    else if (arg == "--min-time" && hasValue)
+      minTimeInMilliSec = std::atof(argv[++i]);
+    else if (arg == "--repetitions" && hasValue)
+      nbRepetitions = std::atoi(argv[++i]);
+    else if (arg == "--label" && hasValue)
+      label = argv[++i];
+    else if (arg == "--node" && hasValue)
+      node = std::atoi(argv[++i]);
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+  if (sizeInMB < 1 || sizeInMB > 8192)
+  {
+    usage();
+    return 1;
+  }
+
+  // One table of sizeInMB, gathered by 64 (a tile coder) to 1024 active features
+  std::vector<int> nbFeatures, nbActive;
+  nbFeatures.push_back(int(size_t(sizeInMB) * 1024 * 1024 / sizeof(double)));
+  nbActive.push_back(64);
+  nbActive.push_back(1024);
+
+  const std::vector<int> nodes = AllocationPolicy::onlineNodes();
+  std::cout << "table: " << sizeInMB << " MB, NUMA nodes: " << nodes.size() << std::endl;
+
+  std::vector<Microbenchmark*> benchmarks;
+  benchmarks.push_back(new Gather("new[]", 0));
+  benchmarks.push_back(new Gather("aligned64", new AllocationPolicy));
+  benchmarks.push_back(
+      new Gather("transparentHugePages",
+          new AllocationPolicy(AllocationPolicy::CACHE_LINE_SIZE,
+              AllocationPolicy::TRANSPARENT_HUGE_PAGES)));
+  benchmarks.push_back(
+      new Gather("explicitHugePages",
+          new AllocationPolicy(AllocationPolicy::CACHE_LINE_SIZE,
+              AllocationPolicy::EXPLICIT_HUGE_PAGES)));
+  benchmarks.push_back(
+      new Gather("numaBind",
+          new AllocationPolicy(AllocationPolicy::CACHE_LINE_SIZE, AllocationPolicy::NO_HUGE_PAGES,
+              AllocationPolicy::NUMA_BIND, node)));
+  benchmarks.push_back(
+      new Gather("numaInterleave",
+          new AllocationPolicy(AllocationPolicy::CACHE_LINE_SIZE, AllocationPolicy::NO_HUGE_PAGES,
+              AllocationPolicy::NUMA_INTERLEAVE)));
+  benchmarks.push_back(
+      new Gather("numaInterleave+transparentHugePages",
+          new AllocationPolicy(AllocationPolicy::CACHE_LINE_SIZE,
+              AllocationPolicy::TRANSPARENT_HUGE_PAGES, AllocationPolicy::NUMA_INTERLEAVE)));
+
+  BenchmarkRunner runner(minTimeInMilliSec, nbRepetitions, filter);
+  runner.printHeader(std::cout);
+  for (size_t i = 0; i < benchmarks.size(); i++)
+  {
+    runner.run(benchmarks[i], nbFeatures, nbActive);
+    delete benchmarks[i];
+  }
+
+  // The throughput, relative to the default allocation
+  std::cout << std::endl;
+  const std::vector<BenchmarkRunner::Result>& results = runner.getResults();
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const BenchmarkRunner::Result& r = results[i];
+    double baseline = 0;
+    for (size_t j = 0; j < results.size(); j++)
+      if (results[j].name == "gather(new[])" && results[j].nbActive == r.nbActive)
+        baseline = results[j].median;
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-44s %7d %10.1f Mgathers/s %7.2fx", r.name.c_str(),
+        r.nbActive, r.nbActive * 1e3 / r.median, baseline > 0 ? baseline / r.median : 0.0);
+    std::cout << line << std::endl;
+  }
+
+  if (!json.empty())
+  {
+    std::ofstream out(json.c_str());
+    if (!out)
+    {
+      std::cerr << "ERROR! (persist) file=" << json << std::endl;
+      return 1;
+    }
+    runner.writeJson(out, label, "double");
+  }
+  return 0;
+}
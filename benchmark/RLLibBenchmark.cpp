@@ -0,0 +1,751 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * RLLibBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+//
+#include "RL.h"
+#include "Trace.h"
+#include "Tiles.h"
+#include "Policy.h"
+#include "Hashing.h"
+#include "PredictorAlgorithm.h"
+#include "StateToStateAction.h"
+#include "Benchmark.h"
+
+using namespace RLLib;
+
+/**
+ * The microbenchmarks of the core primitives: the vector operations, the tile
+ * coder and its hashing, the traces, the updates of the TD learners, and the
+ * updates of the policies. The sparse vectors phi_t and phi_tp1 have nbActive
+ * features spread over nbFeatures; the dense vectors have nbFeatures.
+ */
+namespace
+{
+  template<typename T>
+  class Fixture: public Microbenchmark
+  {
+    protected:
+      std::string prefix;
+      Random<T>* random;
+      SVector<T>* phi_t;
+      SVector<T>* phi_tp1;
+      PVector<T>* dense_t;
+      PVector<T>* dense_tp1;
+      int nbFeatures, nbActive;
+
+    public:
+      Fixture(const std::string& prefix) :
+          prefix(prefix), random(new Random<T>), phi_t(0), phi_tp1(0), dense_t(0), dense_tp1(0), //
+          nbFeatures(0), nbActive(0)
+      {
+      }
+
+      virtual ~Fixture()
+      {
+        delete random;
+      }
+
+      std::string name() const
+      {
+        return prefix;
+      }
+
+      void setUp(const int& nbFeatures, const int& nbActive)
+      {
+        this->nbFeatures = nbFeatures;
+        this->nbActive = nbActive;
+        random->reseed(uint32_t(42));
+        phi_t = newSparse();
+        phi_tp1 = newSparse();
+        dense_t = newDense();
+        dense_tp1 = newDense();
+        setUpBenchmark();
+      }
+
+      void tearDown()
+      {
+        tearDownBenchmark();
+        delete phi_t;
+        delete phi_tp1;
+        delete dense_t;
+        delete dense_tp1;
+      }
+
+    protected:
+      virtual void setUpBenchmark()
+      {
+      }
+
+      virtual void tearDownBenchmark()
+      {
+      }
+
+      // One active feature in each of nbActive strides, as the tilings of a tile coder
+      SVector<T>* newSparse()
+      {
+        SVector<T>* phi = new SVector<T>(nbFeatures);
+        const int stride = nbFeatures / nbActive;
+        for (int i = 0; i < nbActive; i++)
+          phi->setEntry(i * stride + random->nextInt(stride), T(1));
+        return phi;
+      }
+
+      PVector<T>* newDense()
+      {
+        PVector<T>* x = new PVector<T>(nbFeatures);
+        for (int i = 0; i < nbFeatures; i++)
+          x->setEntry(i, random->nextReal() - T(0.5));
+        return x;
+      }
+
+      // Alternates the two sparse vectors, as consecutive time steps
+      void swap()
+      {
+        std::swap(phi_t, phi_tp1);
+      }
+  };
+
+  template<typename T>
+  class DenseDot: public Fixture<T>
+  {
+    public:
+      DenseDot() :
+          Fixture<T>("PVector::dot(PVector)")
+      {
+      }
+      bool sparse() const
+      {
+        return false;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = this->dense_t->dot(this->dense_tp1);
+      }
+  };
+
+  template<typename T>
+  class DenseAddToSelf: public Fixture<T>
+  {
+    public:
+      DenseAddToSelf() :
+          Fixture<T>("PVector::addToSelf(PVector)")
+      {
+      }
+      bool sparse() const
+      {
+        return false;
+      }
+      void step()
+      {
+        this->dense_t->addToSelf(T(1e-3), this->dense_tp1);
+      }
+  };
+
+  template<typename T>
+  class DenseMapMultiply: public Fixture<T>
+  {
+    public:
+      DenseMapMultiply() :
+          Fixture<T>("PVector::mapMultiplyToSelf")
+      {
+      }
+      bool sparse() const
+      {
+        return false;
+      }
+      void step()
+      {
+        this->dense_t->mapMultiplyToSelf(T(0.999));
+      }
+  };
+
+  template<typename T>
+  class DenseSparseDot: public Fixture<T>
+  {
+    public:
+      DenseSparseDot() :
+          Fixture<T>("PVector::dot(SVector)")
+      {
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = this->dense_t->dot(this->phi_t);
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class DenseSparseAddToSelf: public Fixture<T>
+  {
+    public:
+      DenseSparseAddToSelf() :
+          Fixture<T>("PVector::addToSelf(SVector)")
+      {
+      }
+      void step()
+      {
+        this->dense_t->addToSelf(T(1e-3), this->phi_t);
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class SparseDot: public Fixture<T>
+  {
+    public:
+      SparseDot() :
+          Fixture<T>("SVector::dot(SVector)")
+      {
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = this->phi_t->dot(this->phi_tp1);
+      }
+  };
+
+  template<typename T>
+  class SparseAddToSelf: public Fixture<T>
+  {
+    protected:
+      SVector<T>* x;
+    public:
+      SparseAddToSelf() :
+          Fixture<T>("SVector::addToSelf(SVector)"), x(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        x = new SVector<T>(this->nbFeatures);
+      }
+      void tearDownBenchmark()
+      {
+        delete x;
+      }
+      void step()
+      {
+        x->addToSelf(T(1e-3), this->phi_t);
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class SparseMapMultiply: public Fixture<T>
+  {
+    public:
+      SparseMapMultiply() :
+          Fixture<T>("SVector::mapMultiplyToSelf")
+      {
+      }
+      void step()
+      {
+        this->phi_t->mapMultiplyToSelf(T(1));
+      }
+  };
+
+  // nbActive tilings of two inputs, hashed into nbFeatures
+  template<typename T, template<typename > class H>
+  class TilesBenchmark: public Fixture<T>
+  {
+    protected:
+      Hashing<T>* hashing;
+      Tiles<T>* tiles;
+      PVector<T>* inputs;
+    public:
+      TilesBenchmark(const std::string& name) :
+          Fixture<T>(name), hashing(0), tiles(0), inputs(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        hashing = new H<T>(this->random, this->nbFeatures);
+        tiles = new Tiles<T>(hashing);
+        inputs = new PVector<T>(2);
+      }
+      void tearDownBenchmark()
+      {
+        delete hashing;
+        delete tiles;
+        delete inputs;
+      }
+      void step()
+      {
+        inputs->setEntry(0, this->random->nextReal() * 10);
+        inputs->setEntry(1, this->random->nextReal() * 10);
+        this->phi_t->clear();
+        tiles->tiles(this->phi_t, this->nbActive, inputs);
+      }
+  };
+
+  // The coordinates of a tile of two inputs
+  template<typename T, template<typename > class H>
+  class HashBenchmark: public Fixture<T>
+  {
+    protected:
+      Hashing<T>* hashing;
+      int coordinates[3];
+    public:
+      HashBenchmark(const std::string& name) :
+          Fixture<T>(name), hashing(0)
+      {
+      }
+      bool sparse() const
+      {
+        return false;
+      }
+      void setUpBenchmark()
+      {
+        hashing = new H<T>(this->random, this->nbFeatures);
+        coordinates[0] = coordinates[1] = coordinates[2] = 0;
+      }
+      void tearDownBenchmark()
+      {
+        delete hashing;
+      }
+      void step()
+      {
+        ++coordinates[0];
+        coordinates[1] += coordinates[0] & 1;
+        coordinates[2] = coordinates[0] & 15;
+        BenchmarkRunner::sink() = hashing->hash(coordinates, 3);
+      }
+  };
+
+  // lambda = 0.9: the trace holds the features of the last steps
+  template<typename T, template<typename > class E>
+  class TraceBenchmark: public Fixture<T>
+  {
+    protected:
+      Trace<T>* e;
+    public:
+      TraceBenchmark(const std::string& name) :
+          Fixture<T>(name), e(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        e = new E<T>(this->nbFeatures);
+      }
+      void tearDownBenchmark()
+      {
+        delete e;
+      }
+      void step()
+      {
+        e->update(T(0.9), this->phi_t);
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class TDBenchmark: public Fixture<T>
+  {
+    protected:
+      OnPolicyTD<T>* td;
+    public:
+      TDBenchmark() :
+          Fixture<T>("TD::update"), td(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        td = new TD<T>(T(0.1) / this->nbActive, T(0.99), this->nbFeatures);
+        td->initialize();
+      }
+      void tearDownBenchmark()
+      {
+        delete td;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = td->update(this->phi_t, this->phi_tp1, T(-1));
+        this->swap();
+      }
+  };
+
+  // The TD(lambda) learners on a replacing trace
+  template<typename T, template<typename > class L>
+  class TDLambdaBenchmark: public Fixture<T>
+  {
+    protected:
+      Trace<T>* e;
+      OnPolicyTD<T>* td;
+    public:
+      TDLambdaBenchmark(const std::string& name) :
+          Fixture<T>(name), e(0), td(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        e = new RTrace<T>(this->nbFeatures);
+        td = new L<T>(T(0.1) / this->nbActive, T(0.99), T(0.7), e);
+        td->initialize();
+      }
+      void tearDownBenchmark()
+      {
+        delete td;
+        delete e;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = td->update(this->phi_t, this->phi_tp1, T(-1));
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class SarsaBenchmark: public Fixture<T>
+  {
+    protected:
+      Trace<T>* e;
+      Sarsa<T>* sarsa;
+    public:
+      SarsaBenchmark() :
+          Fixture<T>("Sarsa::update"), e(0), sarsa(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        e = new RTrace<T>(this->nbFeatures);
+        sarsa = new Sarsa<T>(T(0.1) / this->nbActive, T(0.99), T(0.7), e);
+        sarsa->initialize();
+      }
+      void tearDownBenchmark()
+      {
+        delete sarsa;
+        delete e;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = sarsa->update(this->phi_t, this->phi_tp1, T(-1));
+        this->swap();
+      }
+  };
+
+  // The gradient TD learners, off-policy with rho = 1
+  template<typename T>
+  class GTDLambdaBenchmark: public Fixture<T>
+  {
+    protected:
+      Trace<T>* e;
+      OffPolicyTD<T>* gtd;
+    public:
+      GTDLambdaBenchmark() :
+          Fixture<T>("GTDLambda::update"), e(0), gtd(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        e = new ATrace<T>(this->nbFeatures);
+        gtd = new GTDLambda<T>(T(0.1) / this->nbActive, T(0.001) / this->nbActive, T(0.99),
+            T(0.7), e);
+        gtd->initialize();
+      }
+      void tearDownBenchmark()
+      {
+        delete gtd;
+        delete e;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = gtd->update(this->phi_t, this->phi_tp1, T(1), T(-1), T(0));
+        this->swap();
+      }
+  };
+
+  template<typename T>
+  class GQBenchmark: public Fixture<T>
+  {
+    protected:
+      Trace<T>* e;
+      GQ<T>* gq;
+    public:
+      GQBenchmark() :
+          Fixture<T>("GQ::update"), e(0), gq(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        e = new ATrace<T>(this->nbFeatures);
+        gq = new GQ<T>(T(0.1) / this->nbActive, T(0.001) / this->nbActive, T(0.99), T(0.7), e);
+        gq->initialize();
+      }
+      void tearDownBenchmark()
+      {
+        delete gq;
+        delete e;
+      }
+      void step()
+      {
+        BenchmarkRunner::sink() = gq->update(this->phi_t, this->phi_tp1, T(1), T(-1), T(0));
+        this->swap();
+      }
+  };
+
+  // The update of a policy on the representations of three actions
+  template<typename T>
+  class PolicyBenchmark: public Fixture<T>
+  {
+    protected:
+      Actions<T>* actions;
+      Representations<T>* phis_t;
+      Representations<T>* phis_tp1;
+      Trace<T>* e;
+      Sarsa<T>* sarsa;
+      Policy<T>* policy;
+    public:
+      PolicyBenchmark(const std::string& name) :
+          Fixture<T>(name), actions(0), phis_t(0), phis_tp1(0), e(0), sarsa(0), policy(0)
+      {
+      }
+      void setUpBenchmark()
+      {
+        actions = newActions();
+        phis_t = newRepresentations();
+        phis_tp1 = newRepresentations();
+        e = new RTrace<T>(this->nbFeatures);
+        sarsa = new Sarsa<T>(T(0.1) / this->nbActive, T(0.99), T(0.7), e);
+        for (int i = 0; i < this->nbFeatures; i++)
+          sarsa->weights()->setEntry(i, this->dense_t->getEntry(i));
+        policy = newPolicy();
+      }
+      void tearDownBenchmark()
+      {
+        delete policy;
+        delete sarsa;
+        delete e;
+        delete phis_t;
+        delete phis_tp1;
+        delete actions;
+      }
+      void step()
+      {
+        policy->update(phis_t);
+        BenchmarkRunner::sink() = policy->sampleAction()->id();
+        std::swap(phis_t, phis_tp1);
+      }
+
+    protected:
+      virtual Actions<T>* newActions()
+      {
+        return new ActionArray<T>(3);
+      }
+
+      Representations<T>* newRepresentations()
+      {
+        Representations<T>* phis = new Representations<T>(this->nbFeatures, actions);
+        for (typename Actions<T>::const_iterator a = actions->begin(); a != actions->end(); ++a)
+        {
+          SVector<T>* phi = this->newSparse();
+          phis->set(phi, *a);
+          delete phi;
+        }
+        return phis;
+      }
+
+      virtual Policy<T>* newPolicy() =0;
+  };
+
+  template<typename T>
+  class GreedyBenchmark: public PolicyBenchmark<T>
+  {
+    public:
+      GreedyBenchmark() :
+          PolicyBenchmark<T>("Greedy::update")
+      {
+      }
+      Policy<T>* newPolicy()
+      {
+        return new Greedy<T>(this->actions, this->sarsa);
+      }
+  };
+
+  template<typename T>
+  class EpsilonGreedyBenchmark: public PolicyBenchmark<T>
+  {
+    public:
+      EpsilonGreedyBenchmark() :
+          PolicyBenchmark<T>("EpsilonGreedy::update")
+      {
+      }
+      Policy<T>* newPolicy()
+      {
+        return new EpsilonGreedy<T>(this->random, this->actions, this->sarsa, T(0.1));
+      }
+  };
+
+  template<typename T>
+  class SoftMaxBenchmark: public PolicyBenchmark<T>
+  {
+    public:
+      SoftMaxBenchmark() :
+          PolicyBenchmark<T>("SoftMax::update")
+      {
+      }
+      Policy<T>* newPolicy()
+      {
+        return new SoftMax<T>(this->random, this->actions, this->sarsa);
+      }
+  };
+
+  template<typename T>
+  class BoltzmannBenchmark: public PolicyBenchmark<T>
+  {
+    public:
+      BoltzmannBenchmark() :
+          PolicyBenchmark<T>("BoltzmannDistribution::update")
+      {
+      }
+      Policy<T>* newPolicy()
+      {
+        return new BoltzmannDistribution<T>(this->random, this->actions, this->nbFeatures);
+      }
+  };
+
+  // One continuous action
+  template<typename T>
+  class NormalBenchmark: public PolicyBenchmark<T>
+  {
+    public:
+      NormalBenchmark() :
+          PolicyBenchmark<T>("NormalDistribution::update")
+      {
+      }
+      Actions<T>* newActions()
+      {
+        ActionArray<T>* actions = new ActionArray<T>(1);
+        actions->push_back(0, T(0));
+        return actions;
+      }
+      Policy<T>* newPolicy()
+      {
+        return new NormalDistribution<T>(this->random, this->actions, T(0), T(1),
+            this->nbFeatures);
+      }
+  };
+
+  template<typename T>
+  void runAll(BenchmarkRunner& runner, const std::vector<int>& nbFeatures,
+      const std::vector<int>& nbActive)
+  {
+    std::vector<Microbenchmark*> benchmarks;
+    benchmarks.push_back(new DenseDot<T>);
+    benchmarks.push_back(new DenseAddToSelf<T>);
+    benchmarks.push_back(new DenseMapMultiply<T>);
+    benchmarks.push_back(new DenseSparseDot<T>);
+    benchmarks.push_back(new DenseSparseAddToSelf<T>);
+    benchmarks.push_back(new SparseDot<T>);
+    benchmarks.push_back(new SparseAddToSelf<T>);
+    benchmarks.push_back(new SparseMapMultiply<T>);
+    benchmarks.push_back(new TilesBenchmark<T, UNH>("Tiles::tiles(UNH)"));
+    benchmarks.push_back(new TilesBenchmark<T, MurmurHashing>("Tiles::tiles(MurmurHashing)"));
+    benchmarks.push_back(new HashBenchmark<T, UNH>("UNH::hash"));
+    benchmarks.push_back(new HashBenchmark<T, MurmurHashing>("MurmurHashing::hash"));
+    benchmarks.push_back(new TraceBenchmark<T, ATrace>("ATrace::update"));
+    benchmarks.push_back(new TraceBenchmark<T, RTrace>("RTrace::update"));
+    benchmarks.push_back(new TDBenchmark<T>);
+    benchmarks.push_back(new TDLambdaBenchmark<T, TDLambda>("TDLambda::update"));
+    benchmarks.push_back(new TDLambdaBenchmark<T, TDLambdaTrue>("TDLambdaTrue::update"));
+    benchmarks.push_back(new SarsaBenchmark<T>);
+    benchmarks.push_back(new GTDLambdaBenchmark<T>);
+    benchmarks.push_back(new GQBenchmark<T>);
+    benchmarks.push_back(new GreedyBenchmark<T>);
+    benchmarks.push_back(new EpsilonGreedyBenchmark<T>);
+    benchmarks.push_back(new SoftMaxBenchmark<T>);
+    benchmarks.push_back(new BoltzmannBenchmark<T>);
+    benchmarks.push_back(new NormalBenchmark<T>);
+    for (size_t i = 0; i < benchmarks.size(); i++)
+    {
+      runner.run(benchmarks[i], nbFeatures, nbActive);
+      delete benchmarks[i];
+    }
+  }
+
+  void usage()
+  {
+    std::cout << "usage: RLLibBenchmark [--json file] [--filter name] [--min-time ms]"
+        << " [--repetitions n] [--label text] [--float] [--quick]" << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::string json, filter, label("HEAD");
+  double minTimeInMilliSec = 20;
+  int nbRepetitions = 5;
+  bool single = false, quick = false;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg(argv[i]);
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--json" && hasValue)
+      json = argv[++i];
+    else if (arg == "--filter" && hasValue)
+      filter = argv[++i];
+    else if (arg == "--min-time" && hasValue)
+      minTimeInMilliSec = std::atof(argv[++i]);
+    else if (arg == "--repetitions" && hasValue)
+      nbRepetitions = std::atoi(argv[++i]);
+    else if (arg == "--label" && hasValue)
+      label = argv[++i];
+    else if (arg == "--float")
+      single = true;
+    else if (arg == "--quick")
+      quick = true;
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+
+  // The sweep: 2^10 to 2^18 features, 8 to 512 active features
+  std::vector<int> nbFeatures, nbActive;
+  nbFeatures.push_back(1 << 10);
+  nbFeatures.push_back(1 << 14);
+  if (!quick)
+    nbFeatures.push_back(1 << 18);
+  nbActive.push_back(8);
+  nbActive.push_back(64);
+  if (!quick)
+    nbActive.push_back(512);
+
+  BenchmarkRunner runner(minTimeInMilliSec, nbRepetitions, filter);
+  runner.printHeader(std::cout);
+  if (single)
+    runAll<float>(runner, nbFeatures, nbActive);
+  else
+    runAll<double>(runner, nbFeatures, nbActive);
+
+  if (!json.empty())
+  {
+    std::ofstream out(json.c_str());
+    if (!out)
+    {
+      std::cerr << "ERROR! (persist) file=" << json << std::endl;
+      return 1;
+    }
+    runner.writeJson(out, label, single ? "float" : "double");
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Statistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include <cmath>
+#include <vector>
+
+/**
+ * The sample statistics of the benchmark repetitions, and Welch's t-test to
+ * decide whether two sets of repetitions have different means without
+ * assuming equal variances.
+ */
+class Statistics
+{
+  public:
+    static double mean(const std::vector<double>& values)
+    {
+      double sum = 0;
+      for (size_t i = 0; i < values.size(); i++)
+        sum += values[i];
+      return values.empty() ? 0 : sum / values.size();
+    }
+
+    // The unbiased sample variance
+    static double variance(const std::vector<double>& values)
+    {
+      if (values.size() < 2)
+        return 0;
+      const double m = mean(values);
+      double sum = 0;
+      for (size_t i = 0; i < values.size(); i++)
+        sum += (values[i] - m) * (values[i] - m);
+      return sum / (values.size() - 1);
+    }
+
+    /**
+     * The one-sided p-value of the hypothesis mean(a) < mean(b). Both samples
+     * need two values; p is 0 or 1 when both variances are zero.
+     */
+    static double welchLess(const std::vector<double>& a, const std::vector<double>& b)
+    {
+      const double va = variance(a) / a.size(), vb = variance(b) / b.size();
+      const double difference = mean(a) - mean(b);
+      if (va + vb == 0)
+        return difference < 0 ? 0 : 1;
+      const double t = difference / std::sqrt(va + vb);
+      const double df = (va + vb) * (va + vb)
+          / (va * va / (a.size() - 1) + vb * vb / (b.size() - 1));
+      return studentCdf(t, df);
+    }
+
+    // P(T <= t) for Student's t distribution with df degrees of freedom
+    static double studentCdf(const double& t, const double& df)
+    {
+      const double tail = 0.5 * incompleteBeta(df / 2.0, 0.5, df / (df + t * t));
+      return t > 0 ? 1.0 - tail : tail;
+    }
+
+    // The regularized incomplete beta function I_x(a, b)
+    static double incompleteBeta(const double& a, const double& b, const double& x)
+    {
+      if (x <= 0)
+        return 0;
+      if (x >= 1)
+        return 1;
+      const double front = std::exp(
+          std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x)
+              + b * std::log(1.0 - x));
+      // The continued fraction converges quickly for x < (a + 1) / (a + b + 2)
+      if (x < (a + 1.0) / (a + b + 2.0))
+        return front * continuedFraction(a, b, x) / a;
+      return 1.0 - front * continuedFraction(b, a, 1.0 - x) / b;
+    }
+
+  private:
+    // Lentz's method for the continued fraction of I_x(a, b)
+    static double continuedFraction(const double& a, const double& b, const double& x)
+    {
+      const double tiny = 1e-300, epsilon = 1e-14;
+      double c = 1.0, d = 1.0 - (a + b) * x / (a + 1.0);
+      if (std::fabs(d) < tiny)
+        d = tiny;
+      d = 1.0 / d;
+      double h = d;
+      for (int m = 1; m <= 300; m++)
+      {
+        const int m2 = 2 * m;
+        // The even step
+        double aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny)
+          d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny)
+          c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+        // The odd step
+        aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny)
+          d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny)
+          c = tiny;
+        d = 1.0 / d;
+        const double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < epsilon)
+          break;
+      }
+      return h;
+    }
+};
+
+#endif /* STATISTICS_H_ */
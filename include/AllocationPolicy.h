@@ -0,0 +1,474 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ *
+ * AllocationPolicy.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef ALLOCATIONPOLICY_H_
+#define ALLOCATIONPOLICY_H_
+
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace RLLib
+{
+  /**
+   * How the large arrays of the vectors are allocated, e.g., the weights of
+   * a hashed tile coder: their alignment, their pages, and their NUMA nodes.
+   * While an AllocationPolicyScope is active, the arrays of at least
+   * minimumSize bytes of the vectors (DenseVector, PVector, and the index
+   * arrays of SparseVector) follow the policy of the thread; the smaller
+   * ones, and all the arrays without a policy, use new T[].
+   *
+   * The huge pages cut the TLB misses of random gathers over a large table:
+   * TRANSPARENT aligns the array to a huge page and madvise(MADV_HUGEPAGE),
+   * EXPLICIT maps it with MAP_HUGETLB from the pages reserved in
+   * /proc/sys/vm/nr_hugepages, and falls back to TRANSPARENT when there are
+   * not enough. BIND places the pages of the array on one NUMA node,
+   * INTERLEAVE spreads them round-robin on the online nodes, both with
+   * mbind(2) before the first touch; LOCAL leaves them to the first touch.
+   * The huge pages and NUMA placement are Linux-only; elsewhere the policy
+   * only aligns. The policy must outlive its scopes, and the arrays keep the
+   * placement they had when they were allocated.
+   */
+  class AllocationPolicy
+  {
+    public:
+      enum HugePages
+      {
+        NO_HUGE_PAGES, TRANSPARENT_HUGE_PAGES, EXPLICIT_HUGE_PAGES
+      };
+
+      enum Numa
+      {
+        NUMA_LOCAL, NUMA_BIND, NUMA_INTERLEAVE
+      };
+
+      enum
+      {
+        CACHE_LINE_SIZE = 64, HUGE_PAGE_SIZE = 2 * 1024 * 1024, MAX_BLOCKS = 1024
+      };
+
+    protected:
+      size_t alignment;
+      HugePages hugePages;
+      Numa numa;
+      int numaNode;
+      size_t minimumSize;
+      int nbHugePageFallbacks;
+      int nbNumaFallbacks;
+
+      // An allocation of the policy: p, in the region of length bytes at base; p is 0 when free
+      struct Block
+      {
+          void* p;
+          void* base;
+          size_t length;
+          bool mapped;
+      };
+
+    public:
+      AllocationPolicy(const size_t& alignment = CACHE_LINE_SIZE, const HugePages& hugePages =
+          NO_HUGE_PAGES, const Numa& numa = NUMA_LOCAL, const int& numaNode = 0,
+          const size_t& minimumSize = 64 * 1024) :
+          alignment(alignment), hugePages(hugePages), numa(numa), numaNode(numaNode), //
+          minimumSize(minimumSize), nbHugePageFallbacks(0), nbNumaFallbacks(0)
+      {
+      }
+
+      virtual ~AllocationPolicy()
+      {
+      }
+
+      size_t getAlignment() const
+      {
+        return alignment;
+      }
+
+      HugePages getHugePages() const
+      {
+        return hugePages;
+      }
+
+      Numa getNuma() const
+      {
+        return numa;
+      }
+
+      size_t getMinimumSize() const
+      {
+        return minimumSize;
+      }
+
+      // The EXPLICIT allocations that fell back to transparent huge pages
+      int getNbHugePageFallbacks() const
+      {
+        return nbHugePageFallbacks;
+      }
+
+      // The allocations that could not be bound or interleaved, and stay local
+      int getNbNumaFallbacks() const
+      {
+        return nbNumaFallbacks;
+      }
+
+      bool applies(const size_t& bytes) const
+      {
+        return bytes >= minimumSize;
+      }
+
+      /**
+       * bytes aligned to the policy; released with release(..). 0 when
+       * MAX_BLOCKS arrays of the policies are alive, and the array then goes
+       * to the heap.
+       */
+      void* allocate(const size_t& bytes)
+      {
+        Block block;
+        block.p = 0;
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        if (hugePages != NO_HUGE_PAGES || numa != NUMA_LOCAL)
+          block = map(bytes);
+#endif
+        if (!block.p)
+        {
+          // Over-allocates by the alignment, which is a power of two
+          const size_t a = alignment > sizeof(void*) ? alignment : sizeof(void*);
+          char* base = new char[bytes + a];
+          block.base = base;
+          block.length = bytes + a;
+          block.mapped = false;
+          block.p = reinterpret_cast<void*>((reinterpret_cast<size_t>(base) + a - 1) & ~(a - 1));
+        }
+        if (!registerBlock(block))
+        {
+#if !defined(EMBEDDED_MODE)
+          std::cerr << "ERROR! AllocationPolicy: more than " << int(MAX_BLOCKS)
+              << " arrays; the allocations go to the heap" << std::endl;
+#endif
+          deallocate(block);
+          return 0;
+        }
+        return block.p;
+      }
+
+      // The policy of the AllocationPolicyScope of this thread; 0 if none
+      static AllocationPolicy*& current()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        static thread_local AllocationPolicy* policy = 0;
+#else
+        static AllocationPolicy* policy = 0;
+#endif
+        return policy;
+      }
+
+      // Releases p if a policy allocated it, whichever policy; false otherwise. Does not lock.
+      static bool release(void* p)
+      {
+        Block block;
+        if (!p || !unregisterBlock(p, block))
+          return false;
+        deallocate(block);
+        return true;
+      }
+
+      // The live arrays of all the policies
+      static int getNbBlocks()
+      {
+        return load(nbBlocks());
+      }
+
+      // The online NUMA nodes; {0} when unknown
+      static std::vector<int> onlineNodes()
+      {
+        std::vector<int> nodes;
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        // e.g., 0-1 or 0,2-3
+        FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+        if (file)
+        {
+          int first = 0, last = 0;
+          char separator = 0;
+          while (std::fscanf(file, "%d", &first) == 1)
+          {
+            last = first;
+            if (std::fscanf(file, "%c", &separator) == 1 && separator == '-')
+            {
+              if (std::fscanf(file, "%d", &last) != 1)
+                break;
+              if (std::fscanf(file, "%c", &separator) != 1)
+                separator = 0;
+            }
+            for (int node = first; node <= last; node++)
+              nodes.push_back(node);
+            if (separator != ',')
+              break;
+          }
+          std::fclose(file);
+        }
+#endif
+        if (nodes.empty())
+          nodes.push_back(0);
+        return nodes;
+      }
+
+    private:
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+      Block map(const size_t& bytes)
+      {
+        Block block;
+        block.p = 0;
+        block.mapped = true;
+        const size_t hugeLength = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#if defined(MAP_HUGETLB)
+        if (hugePages == EXPLICIT_HUGE_PAGES)
+        {
+          void* address = mmap(0, hugeLength, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          if (address != MAP_FAILED)
+          {
+            block.p = block.base = address;
+            block.length = hugeLength;
+          }
+        }
+#endif
+        if (!block.p)
+        {
+          if (hugePages == EXPLICIT_HUGE_PAGES)
+            ++nbHugePageFallbacks;
+          // Over-maps by a huge page to align the array to one; mmap aligns to a page
+          const size_t length = hugePages != NO_HUGE_PAGES ? hugeLength + HUGE_PAGE_SIZE : bytes;
+          void* address = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+          if (address == MAP_FAILED)
+            return block;
+          block.base = address;
+          block.length = length;
+          block.p = address;
+          if (hugePages != NO_HUGE_PAGES)
+          {
+            const size_t aligned = (reinterpret_cast<size_t>(address) + HUGE_PAGE_SIZE - 1)
+                & ~size_t(HUGE_PAGE_SIZE - 1);
+            block.p = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+            madvise(block.p, hugeLength, MADV_HUGEPAGE);
+#endif
+          }
+        }
+        if (numa != NUMA_LOCAL && !bind(block.p, bytes))
+          ++nbNumaFallbacks;
+        return block;
+      }
+
+      bool bind(void* p, const size_t& bytes) const
+      {
+#if defined(SYS_mbind)
+        // MPOL_BIND and MPOL_INTERLEAVE of <numaif.h>, without linking libnuma
+        const int MPOL_BIND_ = 2, MPOL_INTERLEAVE_ = 3;
+        const int nbBits = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask(16, 0UL);
+        std::vector<int> nodes;
+        if (numa == NUMA_BIND)
+          nodes.push_back(numaNode);
+        else
+          nodes = onlineNodes();
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+          if (nodes[i] < 0 || nodes[i] >= int(mask.size()) * nbBits)
+            return false;
+          mask[nodes[i] / nbBits] |= 1UL << (nodes[i] % nbBits);
+        }
+        // mbind(..) works on whole pages
+        const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+        const size_t start = reinterpret_cast<size_t>(p) & ~(pageSize - 1);
+        const size_t length = reinterpret_cast<size_t>(p) + bytes - start;
+        return syscall(SYS_mbind, start, length, numa == NUMA_BIND ? MPOL_BIND_ : MPOL_INTERLEAVE_,
+            &mask[0], mask.size() * nbBits + 1, 0) == 0;
+#else
+        return false;
+#endif
+      }
+#endif
+
+      static void deallocate(const Block& block)
+      {
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        if (block.mapped)
+        {
+          munmap(block.base, block.length);
+          return;
+        }
+#endif
+        delete[] static_cast<char*>(block.base);
+      }
+
+      // Zero-initialized, and never destroyed: the vectors may be deleted at exit
+      static Block* blocks()
+      {
+        static Block all[MAX_BLOCKS];
+        return all;
+      }
+
+      // The blocks in use are below it; it never decreases
+      static int& highWater()
+      {
+        static int nbSlots = 0;
+        return nbSlots;
+      }
+
+      // The blocks in use, so that the arrays of the vectors without a policy do not scan
+      static int& nbBlocks()
+      {
+        static int nb = 0;
+        return nb;
+      }
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+      template<typename V>
+      static V load(const V& v)
+      {
+        return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+      }
+
+      template<typename V>
+      static void store(V& v, const V& value)
+      {
+        __atomic_store_n(&v, value, __ATOMIC_RELEASE);
+      }
+
+      template<typename V>
+      static void add(V& v, const V& value)
+      {
+        __atomic_add_fetch(&v, value, __ATOMIC_ACQ_REL);
+      }
+
+      // v = value if v == expected; otherwise, expected = v
+      template<typename V>
+      static bool compareExchange(V& v, V& expected, const V& value)
+      {
+        return __atomic_compare_exchange_n(&v, &expected, value, false, __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE);
+      }
+#else
+      template<typename V>
+      static V load(const V& v)
+      {
+        return v;
+      }
+
+      template<typename V>
+      static void store(V& v, const V& value)
+      {
+        v = value;
+      }
+
+      template<typename V>
+      static void add(V& v, const V& value)
+      {
+        v += value;
+      }
+
+      template<typename V>
+      static bool compareExchange(V& v, V& expected, const V& value)
+      {
+        if (v != expected)
+        {
+          expected = v;
+          return false;
+        }
+        v = value;
+        return true;
+      }
+#endif
+
+      // Claims a free slot for block.p; false when all the slots are taken
+      static bool registerBlock(const Block& block)
+      {
+        for (int i = 0; i < int(MAX_BLOCKS); i++)
+        {
+          Block& slot = blocks()[i];
+          void* free = 0;
+          if (!compareExchange(slot.p, free, block.p))
+            continue;
+          // Only the owner of p releases it, after allocate(..) returned it
+          slot.base = block.base;
+          slot.length = block.length;
+          slot.mapped = block.mapped;
+          add(nbBlocks(), 1);
+          int nbSlots = load(highWater());
+          while (nbSlots < i + 1 && !compareExchange(highWater(), nbSlots, i + 1))
+            ;
+          return true;
+        }
+        return false;
+      }
+
+      static bool unregisterBlock(void* p, Block& block)
+      {
+        if (!load(nbBlocks()))
+          return false;
+        for (int i = 0; i < load(highWater()); i++)
+        {
+          Block& slot = blocks()[i];
+          if (load(slot.p) != p)
+            continue;
+          block = slot;
+          block.p = p;
+          add(nbBlocks(), -1);
+          store(slot.p, (void*) 0);
+          return true;
+        }
+        return false;
+      }
+  };
+
+  // Allocates the large arrays with the policy in this thread while the scope is alive; nests
+  class AllocationPolicyScope
+  {
+    private:
+      AllocationPolicy* previous;
+
+    public:
+      AllocationPolicyScope(AllocationPolicy* policy) :
+          previous(AllocationPolicy::current())
+      {
+        AllocationPolicy::current() = policy;
+      }
+
+      ~AllocationPolicyScope()
+      {
+        AllocationPolicy::current() = previous;
+      }
+  };
+
+}  // namespace RLLib
+
+#endif /* ALLOCATIONPOLICY_H_ */
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ *
+ * Arena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <new>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+//
+#include "AllocationPolicy.h"
+
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace RLLib
+{
+  /**
+   * One contiguous region, optionally backed by huge pages, that holds the
+   * vectors and the small objects of an agent. While an ArenaScope is
+   * active, the objects derived from ArenaAllocated (vectors, traces,
+   * policies, projectors, learners, agents, ...) and the entries of the
+   * vectors are bump-allocated in the region of its arena; they are
+   * contiguous in the order of the construction of the agent.
+   *
+   * Deleting an object of the arena releases nothing: the arena frees the
+   * whole region at once, and the objects that own only memory need not be
+   * deleted. Delete the others before the arena. The std containers inside
+   * the objects still use the heap. save(..) and restore(..) copy the
+   * region in bulk, e.g., to roll an agent back. An arena is used by one
+   * thread at a time.
+   */
+  class Arena
+  {
+    public:
+      enum
+      {
+        HUGE_PAGE_SIZE = 2 * 1024 * 1024, MAX_ARENAS = 64
+      };
+
+    protected:
+      char* region;
+      size_t capacity;
+      size_t used;
+      bool mapped;
+      bool hugePages;
+      int nbOverflows;
+
+    public:
+      Arena(const size_t& capacity, const bool& hugePages = false) :
+          region(0), capacity(capacity), used(0), mapped(false), hugePages(false), nbOverflows(0)
+      {
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        if (hugePages)
+        {
+#if defined(MAP_HUGETLB)
+          // Explicit huge pages, when the system reserved some
+          const size_t length = (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+          void* address = mmap(0, length, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+          if (address != MAP_FAILED)
+          {
+            region = static_cast<char*>(address);
+            this->capacity = length;
+            this->hugePages = true;
+          }
+#endif
+        }
+        if (!region)
+        {
+          void* address = mmap(0, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+              -1, 0);
+          if (address != MAP_FAILED)
+          {
+            region = static_cast<char*>(address);
+#if defined(MADV_HUGEPAGE)
+            // Otherwise, transparent huge pages
+            if (hugePages)
+              this->hugePages = madvise(region, capacity, MADV_HUGEPAGE) == 0;
+#endif
+          }
+        }
+        mapped = region != 0;
+#endif
+        if (!region)
+          region = new char[capacity];
+        if (!registerArena(this))
+        {
+#if !defined(EMBEDDED_MODE)
+          std::cerr << "ERROR! Arena: more than " << int(MAX_ARENAS)
+              << " arenas; the allocations go to the heap" << std::endl;
+#endif
+          used = this->capacity; // nothing fits
+        }
+      }
+
+      ~Arena()
+      {
+        unregisterArena(this);
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        if (mapped)
+        {
+          munmap(region, capacity);
+          return;
+        }
+#endif
+        delete[] region;
+      }
+
+    private:
+      Arena(const Arena& that);
+      Arena& operator=(const Arena& that);
+
+    public:
+      // size bytes aligned to alignment (a power of two); 0 when the region is full
+      void* allocate(const size_t& size, const size_t& alignment = 16)
+      {
+        const size_t address = reinterpret_cast<size_t>(region) + used;
+        const size_t start = ((address + alignment - 1) & ~(alignment - 1))
+            - reinterpret_cast<size_t>(region);
+        if (start + size > capacity)
+        {
+#if !defined(EMBEDDED_MODE)
+          if (!nbOverflows)
+            std::cerr << "ERROR! Arena: " << capacity
+                << " bytes are full; the allocations fall back to the heap" << std::endl;
+#endif
+          ++nbOverflows;
+          return 0;
+        }
+        used = start + size;
+        return region + start;
+      }
+
+      bool owns(const void* p) const
+      {
+        const char* c = static_cast<const char*>(p);
+        return c >= region && c < region + capacity;
+      }
+
+      size_t getCapacity() const
+      {
+        return capacity;
+      }
+
+      size_t getUsed() const
+      {
+        return used;
+      }
+
+      // True when the region is backed by explicit or transparent huge pages
+      bool isHugePageBacked() const
+      {
+        return hugePages;
+      }
+
+      // The allocations that did not fit, and went to the heap
+      int getNbOverflows() const
+      {
+        return nbOverflows;
+      }
+
+      // Copies the used bytes of the region, i.e., the state of the objects in the arena
+      void save(std::vector<char>& out) const
+      {
+        out.assign(region, region + used);
+      }
+
+      /**
+       * Restores the objects of the arena to a save(..) in bulk. The objects
+       * are at the same addresses, so that their pointers stay valid, as long
+       * as nothing was allocated in the arena since the save(..).
+       */
+      bool restore(const std::vector<char>& in)
+      {
+        if (in.size() != used)
+        {
+#if !defined(EMBEDDED_MODE)
+          std::cerr << "ERROR! Arena::restore: " << used << " bytes used, " << in.size()
+              << " bytes saved" << std::endl;
+#endif
+          return false;
+        }
+        if (used)
+          std::memcpy(region, &in[0], used);
+        return true;
+      }
+
+      // The arena of the ArenaScope of this thread; 0 if none
+      static Arena*& current()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        static thread_local Arena* arena = 0;
+#else
+        static Arena* arena = 0;
+#endif
+        return arena;
+      }
+
+      /**
+       * The arena of p; 0 if p is on the heap. Without locks: compares p to
+       * the regions in the slots of the live arenas, which the threads that
+       * delete objects read while other threads create and delete arenas.
+       */
+      static Arena* owner(const void* p)
+      {
+        const size_t address = reinterpret_cast<size_t>(p);
+        const int nbSlots = load(highWater());
+        for (int i = 0; i < nbSlots; i++)
+        {
+          Slot& slot = slots()[i];
+          // The region is published after its arena, and withdrawn before it
+          const size_t begin = load(slot.begin);
+          if (begin && address >= begin && address < load(slot.end))
+            return load(slot.arena);
+        }
+        return 0;
+      }
+
+      static void* allocateObject(const size_t& size)
+      {
+        Arena* arena = current();
+        void* p = arena ? arena->allocate(size) : 0;
+        return p ? p : ::operator new(size);
+      }
+
+      static void releaseObject(void* p)
+      {
+        if (p && !owner(p))
+          ::operator delete(p);
+      }
+
+      /**
+       * Uninitialized, like new T[size]; the arrays above a cache line are
+       * aligned to one. Without an arena, the large arrays follow the
+       * AllocationPolicy of the thread, if any.
+       */
+      template<typename T>
+      static T* newArray(const int& size)
+      {
+        Arena* arena = current();
+        const size_t bytes = size_t(size) * sizeof(T);
+        void* p = arena ? arena->allocate(bytes, bytes >= 64 ? 64 : 16) : 0;
+        if (!p && !arena)
+        {
+          AllocationPolicy* policy = AllocationPolicy::current();
+          if (policy && policy->applies(bytes))
+            p = policy->allocate(bytes);
+        }
+        return p ? static_cast<T*>(p) : new T[size];
+      }
+
+      template<typename T>
+      static void deleteArray(T* p)
+      {
+        if (p && !owner(p) && !AllocationPolicy::release(p))
+          delete[] p;
+      }
+
+    private:
+      // The region [begin, end) of a live arena; begin is 0 when the slot is free
+      struct Slot
+      {
+          size_t begin;
+          size_t end;
+          Arena* arena;
+      };
+
+      // Zero-initialized, and never destroyed: the objects may be deleted at exit
+      static Slot* slots()
+      {
+        static Slot all[MAX_ARENAS];
+        return all;
+      }
+
+      // The slots in use are below it; it never decreases
+      static int& highWater()
+      {
+        static int nbSlots = 0;
+        return nbSlots;
+      }
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+      template<typename V>
+      static V load(const V& v)
+      {
+        return __atomic_load_n(&v, __ATOMIC_ACQUIRE);
+      }
+
+      template<typename V>
+      static void store(V& v, const V& value)
+      {
+        __atomic_store_n(&v, value, __ATOMIC_RELEASE);
+      }
+
+      // v = value if v == expected; otherwise, expected = v
+      template<typename V>
+      static bool compareExchange(V& v, V& expected, const V& value)
+      {
+        return __atomic_compare_exchange_n(&v, &expected, value, false, __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE);
+      }
+#else
+      template<typename V>
+      static V load(const V& v)
+      {
+        return v;
+      }
+
+      template<typename V>
+      static void store(V& v, const V& value)
+      {
+        v = value;
+      }
+
+      template<typename V>
+      static bool compareExchange(V& v, V& expected, const V& value)
+      {
+        if (v != expected)
+        {
+          expected = v;
+          return false;
+        }
+        v = value;
+        return true;
+      }
+#endif
+
+      // False when all the slots are taken
+      static bool registerArena(Arena* arena)
+      {
+        for (int i = 0; i < int(MAX_ARENAS); i++)
+        {
+          Slot& slot = slots()[i];
+          Arena* free = 0;
+          if (!compareExchange(slot.arena, free, arena))
+            continue;
+          store(slot.end, reinterpret_cast<size_t>(arena->region) + arena->capacity);
+          store(slot.begin, reinterpret_cast<size_t>(arena->region));
+          int nbSlots = load(highWater());
+          while (nbSlots < i + 1 && !compareExchange(highWater(), nbSlots, i + 1))
+            ;
+          return true;
+        }
+        return false;
+      }
+
+      static void unregisterArena(Arena* arena)
+      {
+        for (int i = 0; i < load(highWater()); i++)
+        {
+          Slot& slot = slots()[i];
+          if (load(slot.arena) != arena)
+            continue;
+          store(slot.begin, size_t(0));
+          store(slot.end, size_t(0));
+          store(slot.arena, (Arena*) 0);
+          break;
+        }
+        if (current() == arena)
+          current() = 0;
+      }
+  };
+
+  // Allocates in the arena of the thread while the scope is alive; the scopes nest
+  class ArenaScope
+  {
+    private:
+      Arena* previous;
+
+    public:
+      ArenaScope(Arena* arena) :
+          previous(Arena::current())
+      {
+        Arena::current() = arena;
+      }
+
+      ~ArenaScope()
+      {
+        Arena::current() = previous;
+      }
+  };
+
+  // The objects of the classes derived from it are allocated in the current arena, if any
+  class ArenaAllocated
+  {
+    public:
+      static void* operator new(size_t size)
+      {
+        return Arena::allocateObject(size);
+      }
+
+      static void operator delete(void* p)
+      {
+        Arena::releaseObject(p);
+      }
+
+      // The class-scope operator new hides the global forms, which are restored here
+      static void* operator new(size_t size, const std::nothrow_t&) noexcept
+      {
+        try
+        {
+          return Arena::allocateObject(size);
+        }
+        catch (const std::bad_alloc&)
+        {
+          return 0;
+        }
+      }
+
+      static void operator delete(void* p, const std::nothrow_t&) noexcept
+      {
+        Arena::releaseObject(p);
+      }
+
+      static void* operator new(size_t, void* p) noexcept
+      {
+        return p;
+      }
+
+      static void operator delete(void*, void*) noexcept
+      {
+      }
+  };
+
+}  // namespace RLLib
+
+#endif /* ARENA_H_ */
@@ -0,0 +1,910 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Checkpoint.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "Vector.h"
+#include "Timeline.h"
+
+#if !defined(EMBEDDED_MODE)
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+namespace RLLib
+{
+
+  /**
+   * Block codec of the checkpoints. A vector is cut in blocks of BLOCK_SIZE
+   * entries and each block is stored with the cheapest of:
+   *   ZERO_BLOCKS:   a run of blocks without any non-zero entry,
+   *   SPARSE_BLOCK:  the offsets and the values of the non-zero entries,
+   *   DENSE_BLOCK:   the raw entries,
+   *   SHUFFLED_BLOCK: the entries with their bytes regrouped by significance
+   *                  (the sign and exponent bytes become runs) and run-length
+   *                  coded.
+   */
+  class CheckpointCodec
+  {
+    public:
+      enum
+      {
+        BLOCK_SHIFT = 10, BLOCK_SIZE = 1 << BLOCK_SHIFT
+      };
+
+      enum BlockType
+      {
+        ZERO_BLOCKS = 0, SPARSE_BLOCK = 1, DENSE_BLOCK = 2, SHUFFLED_BLOCK = 3
+      };
+
+      // Byte plane b of the output holds the byte b of every entry
+      static void shuffle(const unsigned char* in, const int& nbEntries, const int& entrySize,
+          unsigned char* out)
+      {
+        for (int i = 0; i < nbEntries; i++)
+          for (int b = 0; b < entrySize; b++)
+            out[b * nbEntries + i] = in[i * entrySize + b];
+      }
+
+      static void unshuffle(const unsigned char* in, const int& nbEntries, const int& entrySize,
+          unsigned char* out)
+      {
+        for (int i = 0; i < nbEntries; i++)
+          for (int b = 0; b < entrySize; b++)
+            out[i * entrySize + b] = in[b * nbEntries + i];
+      }
+
+      /**
+       * PackBits style coding: a control byte c < 128 is followed by c + 1
+       * literal bytes; c >= 128 repeats the next byte c - 125 times.
+       */
+      static void encode(const unsigned char* in, const size_t& length,
+          std::vector<unsigned char>& out)
+      {
+        size_t i = 0;
+        while (i < length)
+        {
+          size_t run = 1;
+          while (i + run < length && run < 130 && in[i + run] == in[i])
+            ++run;
+          if (run >= 3)
+          {
+            out.push_back((unsigned char) (run + 125));
+            out.push_back(in[i]);
+            i += run;
+            continue;
+          }
+          // Literals up to the next run of three
+          size_t literal = 0;
+          while (i + literal < length && literal < 128)
+          {
+            if (i + literal + 2 < length && in[i + literal] == in[i + literal + 1]
+                && in[i + literal] == in[i + literal + 2])
+              break;
+            ++literal;
+          }
+          out.push_back((unsigned char) (literal - 1));
+          out.insert(out.end(), in + i, in + i + literal);
+          i += literal;
+        }
+      }
+
+      static bool decode(const unsigned char* in, const size_t& length, unsigned char* out,
+          const size_t& outLength)
+      {
+        size_t i = 0, o = 0;
+        while (i < length)
+        {
+          const unsigned char control = in[i++];
+          if (control < 128)
+          {
+            const size_t literal = size_t(control) + 1;
+            if (i + literal > length || o + literal > outLength)
+              return false;
+            std::memcpy(out + o, in + i, literal);
+            i += literal;
+            o += literal;
+          }
+          else
+          {
+            const size_t run = size_t(control) - 125;
+            if (i >= length || o + run > outLength)
+              return false;
+            std::memset(out + o, in[i++], run);
+            o += run;
+          }
+        }
+        return o == outLength;
+      }
+  };
+
+  /**
+   * A single file checkpoint of named parameter vectors, e.g., the u_mean and
+   * u_stddev of an actor together with the v and the w of its critic. Zero
+   * regions of the hashed tables cost a few bytes, and the file is written and
+   * read with one bulk operation.
+   *
+   * Vectors are registered once with add(..); persist(..) and resurrect(..)
+   * then save or restore all of them. Nothing is printed on the stdout.
+   */
+  template<typename T>
+  class Checkpoint
+  {
+    protected:
+      typedef CheckpointCodec Codec;
+      std::vector<std::string> names;
+      std::vector<Vector<T>*> vectors;
+
+    public:
+      Checkpoint()
+      {
+      }
+
+      virtual ~Checkpoint()
+      {
+      }
+
+      virtual void add(const std::string& name, Vector<T>* vector)
+      {
+        names.push_back(name);
+        vectors.push_back(vector);
+      }
+
+      // Adds name.0, name.1, ...
+      void add(const std::string& name, Vectors<T>* parameters)
+      {
+        for (int i = 0; i < parameters->dimension(); i++)
+        {
+          std::stringstream ss;
+          ss << name << "." << i;
+          add(ss.str(), parameters->getEntry(i));
+        }
+      }
+
+      int dimension() const
+      {
+        return vectors.size();
+      }
+
+      bool persist(const char* f) const
+      {
+        RLLIB_TIMELINE("checkpoint");
+        std::vector<unsigned char> out;
+        appendHeader(out, "RLLIBCKP");
+        for (size_t k = 0; k < vectors.size(); k++)
+          encode(names[k], vectors[k], out);
+        return writeFile(f, out);
+      }
+
+      bool resurrect(const char* f)
+      {
+        RLLIB_TIMELINE("resurrect");
+        std::vector<unsigned char> in;
+        size_t position = 0;
+        uint32_t nbVectors = 0;
+        if (!readFile(f, "RLLIBCKP", in, position, nbVectors))
+          return false;
+        for (uint32_t k = 0; k < nbVectors; k++)
+        {
+          if (!decode(in, position))
+          {
+            std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+            return false;
+          }
+        }
+        return true;
+      }
+
+    protected:
+      enum
+      {
+        VERSION = 1
+      };
+
+      template<class U>
+      static void append(std::vector<unsigned char>& out, const U& value)
+      {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(U));
+      }
+
+      template<class U>
+      static bool read(const std::vector<unsigned char>& in, size_t& position, U& value)
+      {
+        if (position + sizeof(U) > in.size())
+          return false;
+        std::memcpy(&value, &in[position], sizeof(U));
+        position += sizeof(U);
+        return true;
+      }
+
+      static uint64_t checksum(const unsigned char* bytes, const size_t& length)
+      {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < length; i++)
+        {
+          hash ^= bytes[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+
+      void appendHeader(std::vector<unsigned char>& out, const char* magic) const
+      {
+        out.insert(out.end(), magic, magic + 8);
+        append(out, uint32_t(VERSION));
+        append(out, uint32_t(sizeof(T)));
+        append(out, uint32_t(vectors.size()));
+      }
+
+      // Appends the checksum and writes the file with one bulk operation
+      static bool writeFile(const char* f, std::vector<unsigned char>& out)
+      {
+        append(out, checksum(&out[0], out.size()));
+        std::ofstream of;
+        of.open(f, std::ofstream::out | std::ofstream::binary);
+        if (!of.is_open())
+        {
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+          return false;
+        }
+        of.write((const char*) &out[0], out.size());
+        of.close();
+        return of.good();
+      }
+
+      // Reads and checks a file; position is set after the header
+      static bool readFile(const char* f, const char* magic, std::vector<unsigned char>& in,
+          size_t& position, uint32_t& nbVectors)
+      {
+        std::ifstream ifs;
+        ifs.open(f, std::ifstream::in | std::ifstream::binary);
+        if (!ifs.is_open())
+        {
+          std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+          return false;
+        }
+        ifs.seekg(0, std::ifstream::end);
+        const size_t length = size_t(ifs.tellg());
+        ifs.seekg(0, std::ifstream::beg);
+        in.resize(length);
+        if (length > 0)
+          ifs.read((char*) &in[0], length);
+        ifs.close();
+
+        position = 8;
+        uint32_t version = 0, scalarSize = 0;
+        uint64_t expected = 0;
+        if (length < 8 + 3 * sizeof(uint32_t) + sizeof(uint64_t)
+            || std::memcmp(&in[0], magic, 8) != 0 || !read(in, position, version)
+            || !read(in, position, scalarSize) || !read(in, position, nbVectors)
+            || version != VERSION || scalarSize != sizeof(T))
+        {
+          std::cerr << "ERROR! (resurrect) not a compatible checkpoint, file=" << f << std::endl;
+          return false;
+        }
+        const size_t end = length - sizeof(uint64_t);
+        std::memcpy(&expected, &in[end], sizeof(expected));
+        if (expected != checksum(&in[0], end))
+        {
+          std::cerr << "ERROR! (resurrect) corrupted checkpoint, file=" << f << std::endl;
+          return false;
+        }
+        in.resize(end);
+        return true;
+      }
+
+      static void appendName(const std::string& name, const Vector<T>* vector,
+          std::vector<unsigned char>& out)
+      {
+        append(out, uint32_t(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+        append(out, int32_t(vector->dimension()));
+      }
+
+      // Finds the registered vector of the next name and dimension of the input
+      Vector<T>* readName(const std::vector<unsigned char>& in, size_t& position) const
+      {
+        uint32_t nameLength = 0;
+        int32_t dimension = 0;
+        if (!read(in, position, nameLength) || position + nameLength > in.size())
+          return 0;
+        const std::string name(in.begin() + position, in.begin() + position + nameLength);
+        position += nameLength;
+        if (!read(in, position, dimension))
+          return 0;
+        for (size_t k = 0; k < names.size(); k++)
+          if (names[k] == name && vectors[k]->dimension() == dimension)
+            return vectors[k];
+        std::cerr << "ERROR! (resurrect) vector=" << name << " is not registered"
+            << " or has a different dimension" << std::endl;
+        return 0;
+      }
+
+      // Appends the cheapest coding of a block that has at least one non-zero entry
+      static void encodeBlock(const T* values, const int& size, std::vector<unsigned char>& out,
+          std::vector<unsigned char>& shuffled, std::vector<unsigned char>& compressed)
+      {
+        int nbNonZeros = 0;
+        for (int i = 0; i < size; i++)
+          if (values[i] != T(0))
+            ++nbNonZeros;
+        const size_t denseSize = size * sizeof(T);
+        const size_t sparseSize = sizeof(uint16_t) + nbNonZeros * (sizeof(uint16_t) + sizeof(T));
+        // The shuffled coding needs at least two bytes per run of 130: below, the sparse one wins
+        const size_t minShuffledSize = sizeof(uint32_t) + 2 * ((denseSize + 129) / 130);
+        size_t shuffledSize = minShuffledSize;
+        if (sparseSize > minShuffledSize || sparseSize >= denseSize)
+        {
+          shuffled.resize(Codec::BLOCK_SIZE * sizeof(T));
+          Codec::shuffle(reinterpret_cast<const unsigned char*>(values), size, sizeof(T),
+              &shuffled[0]);
+          compressed.clear();
+          Codec::encode(&shuffled[0], denseSize, compressed);
+          shuffledSize = sizeof(uint32_t) + compressed.size();
+        }
+
+        if (sparseSize <= shuffledSize && sparseSize < denseSize)
+        {
+          out.push_back(Codec::SPARSE_BLOCK);
+          append(out, uint16_t(nbNonZeros));
+          for (int i = 0; i < size; i++)
+            if (values[i] != T(0))
+              append(out, uint16_t(i));
+          for (int i = 0; i < size; i++)
+            if (values[i] != T(0))
+              append(out, values[i]);
+        }
+        else if (shuffledSize < denseSize)
+        {
+          out.push_back(Codec::SHUFFLED_BLOCK);
+          append(out, uint32_t(compressed.size()));
+          out.insert(out.end(), compressed.begin(), compressed.end());
+        }
+        else
+        {
+          out.push_back(Codec::DENSE_BLOCK);
+          const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+          out.insert(out.end(), bytes, bytes + denseSize);
+        }
+      }
+
+      // Decodes a SPARSE_BLOCK, a DENSE_BLOCK or a SHUFFLED_BLOCK
+      static bool decodeBlock(const unsigned char& type, const std::vector<unsigned char>& in,
+          size_t& position, T* values, const int& size, std::vector<unsigned char>& shuffled)
+      {
+        switch (type)
+        {
+          case Codec::SPARSE_BLOCK:
+          {
+            uint16_t nbNonZeros = 0;
+            if (!read(in, position, nbNonZeros)
+                || position + nbNonZeros * (sizeof(uint16_t) + sizeof(T)) > in.size())
+              return false;
+            std::fill(values, values + size, T(0));
+            const size_t offsets = position;
+            position += nbNonZeros * sizeof(uint16_t);
+            for (int i = 0; i < nbNonZeros; i++)
+            {
+              uint16_t offset;
+              std::memcpy(&offset, &in[offsets + i * sizeof(uint16_t)], sizeof(offset));
+              if (offset >= size)
+                return false;
+              std::memcpy(values + offset, &in[position], sizeof(T));
+              position += sizeof(T);
+            }
+            return true;
+          }
+          case Codec::DENSE_BLOCK:
+          {
+            if (position + size * sizeof(T) > in.size())
+              return false;
+            std::memcpy(values, &in[position], size * sizeof(T));
+            position += size * sizeof(T);
+            return true;
+          }
+          case Codec::SHUFFLED_BLOCK:
+          {
+            uint32_t compressedSize = 0;
+            shuffled.resize(Codec::BLOCK_SIZE * sizeof(T));
+            if (!read(in, position, compressedSize) || position + compressedSize > in.size()
+                || !Codec::decode(&in[position], compressedSize, &shuffled[0], size * sizeof(T)))
+              return false;
+            Codec::unshuffle(&shuffled[0], size, sizeof(T),
+                reinterpret_cast<unsigned char*>(values));
+            position += compressedSize;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      // Dense entries of a vector; sparse vectors are copied in buffer
+      static const T* denseValues(const Vector<T>* vector, PVector<T>*& buffer)
+      {
+        const DenseVector<T>* dense = RTTI<T>::constDenseVector(vector);
+        if (dense)
+          return dense->getValues();
+        buffer = new PVector<T>(vector->dimension());
+        buffer->set(vector);
+        return buffer->getValues();
+      }
+
+      // Copies the entries decoded in values back into a sparse vector
+      static void setSparse(Vector<T>* vector, const T* values)
+      {
+        vector->clear();
+        for (int i = 0; i < vector->dimension(); i++)
+          if (values[i] != T(0))
+            vector->setEntry(i, values[i]);
+      }
+
+      static void appendZeroBlocks(std::vector<unsigned char>& out, uint32_t& zeroBlocks)
+      {
+        if (zeroBlocks == 0)
+          return;
+        out.push_back(Codec::ZERO_BLOCKS);
+        append(out, zeroBlocks);
+        zeroBlocks = 0;
+      }
+
+      // The indexes of the non-zero entries of a sparse vector, in increasing order
+      static void sortedIndexes(const SparseVector<T>* vector, std::vector<int>& indexes)
+      {
+        indexes.assign(vector->nonZeroIndexes(),
+            vector->nonZeroIndexes() + vector->nonZeroElements());
+        std::sort(indexes.begin(), indexes.end());
+      }
+
+      static void encode(const std::string& name, const Vector<T>* vector,
+          std::vector<unsigned char>& out)
+      {
+        appendName(name, vector, out);
+        const SparseVector<T>* sparse = RTTI<T>::constSparseVector(vector);
+        if (sparse)
+        {
+          encodeSparse(sparse, out);
+          return;
+        }
+        PVector<T>* buffer = 0;
+        const T* values = denseValues(vector, buffer);
+        const int dimension = vector->dimension();
+        std::vector<unsigned char> shuffled, compressed;
+        uint32_t zeroBlocks = 0;
+        for (int begin = 0; begin < dimension; begin += Codec::BLOCK_SIZE)
+        {
+          const int size = std::min(int(Codec::BLOCK_SIZE), dimension - begin);
+          if (std::count(values + begin, values + begin + size, T(0)) == size)
+          {
+            ++zeroBlocks;
+            continue;
+          }
+          appendZeroBlocks(out, zeroBlocks);
+          encodeBlock(values + begin, size, out, shuffled, compressed);
+        }
+        appendZeroBlocks(out, zeroBlocks);
+        delete buffer;
+      }
+
+      // Visits the blocks of the non-zero entries only, in the same format as the dense vectors
+      static void encodeSparse(const SparseVector<T>* vector, std::vector<unsigned char>& out)
+      {
+        const int dimension = vector->dimension();
+        const int nbBlocks = (dimension + Codec::BLOCK_SIZE - 1) / Codec::BLOCK_SIZE;
+        std::vector<int> indexes;
+        sortedIndexes(vector, indexes);
+        std::vector<T> block(Codec::BLOCK_SIZE, T(0));
+        std::vector<unsigned char> shuffled, compressed;
+        uint32_t zeroBlocks = 0;
+        int next = 0; // the first block not written
+        size_t i = 0;
+        while (i < indexes.size())
+        {
+          const int current = indexes[i] >> Codec::BLOCK_SHIFT;
+          const int begin = current << Codec::BLOCK_SHIFT;
+          zeroBlocks += current - next;
+          appendZeroBlocks(out, zeroBlocks);
+          size_t j = i;
+          for (; j < indexes.size() && indexes[j] >> Codec::BLOCK_SHIFT == current; j++)
+            block[indexes[j] - begin] = vector->getEntry(indexes[j]);
+          encodeBlock(&block[0], std::min(int(Codec::BLOCK_SIZE), dimension - begin), out,
+              shuffled, compressed);
+          for (; i < j; i++)
+            block[indexes[i] - begin] = T(0);
+          next = current + 1;
+        }
+        zeroBlocks += nbBlocks - next;
+        appendZeroBlocks(out, zeroBlocks);
+      }
+
+      bool decode(const std::vector<unsigned char>& in, size_t& position)
+      {
+        Vector<T>* vector = readName(in, position);
+        if (!vector)
+          return false;
+        const int dimension = vector->dimension();
+        DenseVector<T>* dense = RTTI<T>::denseVector(vector);
+        std::vector<T> buffer;
+        T* values = 0;
+        if (dense)
+          values = dense->getValues();
+        else
+        {
+          buffer.resize(dimension);
+          values = &buffer[0];
+        }
+
+        std::vector<unsigned char> shuffled;
+        int begin = 0;
+        while (begin < dimension)
+        {
+          if (position >= in.size())
+            return false;
+          const int size = std::min(int(Codec::BLOCK_SIZE), dimension - begin);
+          const unsigned char type = in[position++];
+          if (type == Codec::ZERO_BLOCKS)
+          {
+            uint32_t nbBlocks = 0;
+            if (!read(in, position, nbBlocks) || nbBlocks == 0)
+              return false;
+            // A corrupt count must not run past the vector
+            const size_t end = size_t(begin) + size_t(nbBlocks) * Codec::BLOCK_SIZE;
+            if (end - Codec::BLOCK_SIZE >= size_t(dimension))
+              return false;
+            std::fill(values + begin, values + std::min(size_t(dimension), end), T(0));
+            begin = int(std::min(size_t(dimension), end));
+            continue;
+          }
+          if (!decodeBlock(type, in, position, values + begin, size, shuffled))
+            return false;
+          begin += size;
+        }
+
+        if (!dense)
+          setSparse(vector, values);
+        return true;
+      }
+  };
+
+  /**
+   * A checkpoint that writes a full base snapshot once, and then delta
+   * segments with only the blocks modified since the previous persist(..).
+   * The registered dense vectors track their dirty blocks (see
+   * DenseVector<T>::trackDirtyBlocks()); for the sparse vectors, e.g., the
+   * traces, the checkpoint keeps a fingerprint of each non-zero block and
+   * writes the blocks whose fingerprint changed, or that became zero. The
+   * segments of f are f.delta.1, f.delta.2,
+   * ..., and are applied in order by resurrect(f). compact(), which is called
+   * every compactionPeriod segments when it is positive, merges the segments
+   * into a new base.
+   */
+  template<typename T>
+  class IncrementalCheckpoint: public Checkpoint<T>
+  {
+    protected:
+      typedef Checkpoint<T> Base;
+      typedef CheckpointCodec Codec;
+      int compactionPeriod;
+      std::string base;
+      int nbSegments;
+
+      // A non-zero block of a sparse vector, as of the last persist(..) or resurrect(..)
+      struct BlockFingerprint
+      {
+          uint32_t block;
+          uint64_t hash;
+      };
+      std::vector<std::vector<BlockFingerprint> > fingerprints;
+
+    public:
+      IncrementalCheckpoint(const int& compactionPeriod = 0) :
+          compactionPeriod(compactionPeriod), nbSegments(0)
+      {
+      }
+
+      virtual ~IncrementalCheckpoint()
+      {
+      }
+
+      using Base::add;
+      void add(const std::string& name, Vector<T>* vector)
+      {
+        Base::add(name, vector);
+        fingerprints.push_back(std::vector<BlockFingerprint>());
+        DenseVector<T>* dense = RTTI<T>::denseVector(vector);
+        if (dense)
+          dense->trackDirtyBlocks(Codec::BLOCK_SHIFT);
+      }
+
+      int getNbSegments() const
+      {
+        return nbSegments;
+      }
+
+      /**
+       * Writes the base snapshot f, or a delta segment when the base of this
+       * checkpoint is already f.
+       */
+      bool persist(const char* f)
+      {
+        RLLIB_TIMELINE("checkpoint");
+        if (base != f)
+        {
+          removeSegments(f);
+          base = f;
+          nbSegments = 0;
+          return persistBase();
+        }
+        std::vector<unsigned char> out;
+        Base::appendHeader(out, "RLLIBDLT");
+        Base::append(out, uint32_t(nbSegments + 1));
+        for (size_t k = 0; k < Base::vectors.size(); k++)
+          encodeDelta(Base::names[k], Base::vectors[k], fingerprints[k], out);
+        if (!Base::writeFile(segment(f, nbSegments + 1).c_str(), out))
+          return false;
+        ++nbSegments;
+        clearDirtyBlocks(false);
+        if (compactionPeriod > 0 && nbSegments >= compactionPeriod)
+          return compact();
+        return true;
+      }
+
+      // Restores the base snapshot f, and then applies its delta segments
+      bool resurrect(const char* f)
+      {
+        if (!Base::resurrect(f))
+          return false;
+        int sequence = 1;
+        for (; std::ifstream(segment(f, sequence).c_str()).good(); ++sequence)
+        {
+          if (!resurrectDelta(segment(f, sequence).c_str(), sequence))
+            return false;
+        }
+        base = f;
+        nbSegments = sequence - 1;
+        clearDirtyBlocks();
+        return true;
+      }
+
+      // Replaces the base and its segments with one snapshot of the vectors
+      bool compact()
+      {
+        if (base.empty())
+          return false;
+        const std::string tmp = base + ".tmp";
+        if (!Base::persist(tmp.c_str()) || std::rename(tmp.c_str(), base.c_str()) != 0)
+          return false;
+        removeSegments(base.c_str());
+        nbSegments = 0;
+        clearDirtyBlocks();
+        return true;
+      }
+
+    protected:
+      static std::string segment(const char* f, const int& sequence)
+      {
+        std::stringstream ss;
+        ss << f << ".delta." << sequence;
+        return ss.str();
+      }
+
+      static void removeSegments(const char* f)
+      {
+        for (int sequence = 1; std::remove(segment(f, sequence).c_str()) == 0; ++sequence)
+          ;
+      }
+
+      bool persistBase()
+      {
+        const std::string tmp = base + ".tmp";
+        if (!Base::persist(tmp.c_str()) || std::rename(tmp.c_str(), base.c_str()) != 0)
+          return false;
+        clearDirtyBlocks();
+        return true;
+      }
+
+      // The vectors are clean; also takes the fingerprints of the sparse vectors if needed
+      void clearDirtyBlocks(const bool& sparseToo = true)
+      {
+        for (size_t k = 0; k < Base::vectors.size(); k++)
+        {
+          DenseVector<T>* dense = RTTI<T>::denseVector(Base::vectors[k]);
+          if (dense && dense->dirtyBlocks())
+            dense->dirtyBlocks()->clear();
+          const SparseVector<T>* sparse = RTTI<T>::constSparseVector(Base::vectors[k]);
+          if (sparse && sparseToo)
+            takeFingerprints(sparse, fingerprints[k]);
+        }
+      }
+
+      static void takeFingerprints(const SparseVector<T>* vector,
+          std::vector<BlockFingerprint>& blocks)
+      {
+        std::vector<int> indexes;
+        Base::sortedIndexes(vector, indexes);
+        blocks.clear();
+        for (size_t i = 0; i < indexes.size(); i++)
+        {
+          const uint32_t block = uint32_t(indexes[i] >> Codec::BLOCK_SHIFT);
+          if (blocks.empty() || blocks.back().block != block)
+          {
+            BlockFingerprint fingerprint = { block, 14695981039346656037ULL };
+            blocks.push_back(fingerprint);
+          }
+          const T value = vector->getEntry(indexes[i]);
+          const int offset = indexes[i] & (Codec::BLOCK_SIZE - 1);
+          uint64_t& hash = blocks.back().hash;
+          hash = (hash ^ uint64_t(offset)) * 1099511628211ULL;
+          const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+          for (size_t b = 0; b < sizeof(T); b++)
+            hash = (hash ^ bytes[b]) * 1099511628211ULL;
+        }
+      }
+
+      // name, dimension, number of blocks, then (block index, block) pairs
+      static void encodeDelta(const std::string& name, const Vector<T>* vector,
+          std::vector<BlockFingerprint>& previous, std::vector<unsigned char>& out)
+      {
+        Base::appendName(name, vector, out);
+        const SparseVector<T>* sparse = RTTI<T>::constSparseVector(vector);
+        if (sparse)
+        {
+          encodeSparseDelta(sparse, previous, out);
+          return;
+        }
+        const int dimension = vector->dimension();
+        const int nbBlocks = (dimension + Codec::BLOCK_SIZE - 1) / Codec::BLOCK_SIZE;
+        const DenseVector<T>* dense = RTTI<T>::constDenseVector(vector);
+        const DirtyBlocks* dirty = dense ? dense->dirtyBlocks() : 0;
+        PVector<T>* buffer = 0;
+        const T* values = Base::denseValues(vector, buffer);
+        const size_t nbBlocksPosition = out.size();
+        Base::append(out, uint32_t(0));
+        uint32_t nbWritten = 0;
+        std::vector<unsigned char> shuffled, compressed;
+        for (int block = 0; block < nbBlocks; block++)
+        {
+          if (dirty && !dirty->isDirty(block))
+            continue;
+          const int begin = block * Codec::BLOCK_SIZE;
+          Base::append(out, uint32_t(block));
+          Base::encodeBlock(values + begin, std::min(int(Codec::BLOCK_SIZE), dimension - begin),
+              out, shuffled, compressed);
+          ++nbWritten;
+        }
+        std::memcpy(&out[nbBlocksPosition], &nbWritten, sizeof(nbWritten));
+        delete buffer;
+      }
+
+      /**
+       * Writes the blocks of a sparse vector that changed since the fingerprints
+       * of previous, which it then replaces: the new and modified non-zero
+       * blocks, and the blocks that became zero.
+       */
+      static void encodeSparseDelta(const SparseVector<T>* vector,
+          std::vector<BlockFingerprint>& previous, std::vector<unsigned char>& out)
+      {
+        const int dimension = vector->dimension();
+        std::vector<BlockFingerprint> current;
+        takeFingerprints(vector, current);
+        std::vector<int> indexes;
+        Base::sortedIndexes(vector, indexes);
+        std::vector<T> block(Codec::BLOCK_SIZE, T(0));
+        std::vector<unsigned char> shuffled, compressed;
+        const size_t nbBlocksPosition = out.size();
+        Base::append(out, uint32_t(0));
+        uint32_t nbWritten = 0;
+        size_t p = 0, c = 0, i = 0;
+        while (p < previous.size() || c < current.size())
+        {
+          const bool fromPrevious = c == current.size()
+              || (p < previous.size() && previous[p].block < current[c].block);
+          const uint32_t index = fromPrevious ? previous[p].block : current[c].block;
+          const bool unchanged = !fromPrevious && p < previous.size()
+              && previous[p].block == index && previous[p].hash == current[c].hash;
+          const int begin = int(index) << Codec::BLOCK_SHIFT;
+          // The entries of the block, if it is still non-zero
+          size_t j = i;
+          if (!fromPrevious)
+            for (; j < indexes.size() && indexes[j] >> Codec::BLOCK_SHIFT == int(index); j++)
+              block[indexes[j] - begin] = vector->getEntry(indexes[j]);
+          if (!unchanged)
+          {
+            Base::append(out, index);
+            Base::encodeBlock(&block[0], std::min(int(Codec::BLOCK_SIZE), dimension - begin),
+                out, shuffled, compressed);
+            ++nbWritten;
+          }
+          for (; i < j; i++)
+            block[indexes[i] - begin] = T(0);
+          if (p < previous.size() && previous[p].block == index)
+            ++p;
+          if (!fromPrevious)
+            ++c;
+        }
+        std::memcpy(&out[nbBlocksPosition], &nbWritten, sizeof(nbWritten));
+        previous.swap(current);
+      }
+
+      bool resurrectDelta(const char* f, const int& sequence)
+      {
+        std::vector<unsigned char> in;
+        size_t position = 0;
+        uint32_t nbVectors = 0, readSequence = 0;
+        if (!Base::readFile(f, "RLLIBDLT", in, position, nbVectors)
+            || !Base::read(in, position, readSequence) || int(readSequence) != sequence)
+          return false;
+        std::vector<unsigned char> shuffled;
+        for (uint32_t k = 0; k < nbVectors; k++)
+        {
+          Vector<T>* vector = Base::readName(in, position);
+          if (!vector || !decodeDelta(in, position, vector, shuffled))
+          {
+            std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+            return false;
+          }
+        }
+        return true;
+      }
+
+      static bool decodeDelta(const std::vector<unsigned char>& in, size_t& position,
+          Vector<T>* vector, std::vector<unsigned char>& shuffled)
+      {
+        const int dimension = vector->dimension();
+        DenseVector<T>* dense = RTTI<T>::denseVector(vector);
+        // The blocks of the other vectors are decoded one at a time
+        std::vector<T> block;
+        if (!dense)
+          block.resize(Codec::BLOCK_SIZE);
+        uint32_t nbBlocks = 0;
+        bool result = Base::read(in, position, nbBlocks);
+        for (uint32_t i = 0; result && i < nbBlocks; i++)
+        {
+          uint32_t index = 0;
+          result = Base::read(in, position, index) && position < in.size()
+              && size_t(index) * Codec::BLOCK_SIZE < size_t(dimension);
+          if (!result)
+            break;
+          const int begin = index * Codec::BLOCK_SIZE;
+          const int size = std::min(int(Codec::BLOCK_SIZE), dimension - begin);
+          const unsigned char type = in[position++];
+          if (dense)
+          {
+            result = Base::decodeBlock(type, in, position, dense->getValues() + begin, size,
+                shuffled);
+            continue;
+          }
+          result = Base::decodeBlock(type, in, position, &block[0], size, shuffled);
+          for (int offset = 0; result && offset < size; offset++)
+            vector->setEntry(begin + offset, block[offset]);
+        }
+        return result;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* !defined(EMBEDDED_MODE) */
+
+#endif /* CHECKPOINT_H_ */
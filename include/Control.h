@@ -45,6 +45,19 @@ namespace RLLib
           const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1) =0;
       virtual T computeValueFunction(const Vector<T>* x) const =0;
       virtual const Predictor<T>* predictor() const =0;
+
+      // step(..) split in two: stepAction(..) samples a_tp1 with the current weights, and
+      // stepUpdate() learns the transition later. The arguments must stay valid until
+      // stepUpdate(). A control that is not split learns in stepAction(..).
+      virtual const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        return step(x_t, a_t, x_tp1, r_tp1, z_tp1);
+      }
+
+      virtual void stepUpdate()
+      {
+      }
   };
 
   template<typename T>
@@ -59,12 +72,43 @@ namespace RLLib
   template<typename T>
   class OffPolicyControlLearner: public Control<T>
   {
+    private:
+      // The transition deferred by stepAction(..)
+      const Vector<T>* pending_x_t;
+      const Action<T>* pending_a_t;
+      const Vector<T>* pending_x_tp1;
+      T pending_r_tp1, pending_z_tp1;
+
     public:
+      OffPolicyControlLearner() :
+          pending_x_t(0), pending_a_t(0), pending_x_tp1(0), pending_r_tp1(0), pending_z_tp1(0)
+      {
+      }
+
       virtual ~OffPolicyControlLearner()
       {
       }
       virtual void learn(const Vector<T>* x_t, const Action<T>* a_t, const Vector<T>* x_tp1,
           const T& r_tp1, const T& z_tp1) = 0;
+
+      void stepUpdate()
+      {
+        if (!pending_x_tp1)
+          return;
+        learn(pending_x_t, pending_a_t, pending_x_tp1, pending_r_tp1, pending_z_tp1);
+        pending_x_tp1 = 0;
+      }
+
+    protected:
+      void defer(const Vector<T>* x_t, const Action<T>* a_t, const Vector<T>* x_tp1,
+          const T& r_tp1, const T& z_tp1)
+      {
+        pending_x_t = x_t;
+        pending_a_t = a_t;
+        pending_x_tp1 = x_tp1;
+        pending_r_tp1 = r_tp1;
+        pending_z_tp1 = z_tp1;
+      }
   };
 
   template<typename T>
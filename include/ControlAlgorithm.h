@@ -40,17 +40,21 @@ namespace RLLib
       StateToStateAction<T>* toStateAction;
       Sarsa<T>* sarsa;
       Vector<T>* xa_t;
+      const Vector<T>* xa_tp1; // deferred by stepAction(..), in the buffer of toStateAction
+      T r_tp1;
 
     public:
       SarsaControl(Policy<T>* acting, StateToStateAction<T>* toStateAction, Sarsa<T>* sarsa) :
-          acting(acting), toStateAction(toStateAction), sarsa(sarsa), xa_t(0)
+          acting(acting), toStateAction(toStateAction), sarsa(sarsa),
+          // Sized from the Sarsa weights, so that a snapshot taken before initialize(..) restores
+          // the state-action vector of the current step
+          xa_t(new SVector<T>(sarsa->weights()->dimension())), xa_tp1(0), r_tp1(0)
       {
       }
 
       virtual ~SarsaControl()
       {
-        if (xa_t)
-          delete xa_t;
+        delete xa_t;
       }
 
       const Action<T>* initialize(const Vector<T>* x)
@@ -76,6 +80,28 @@ namespace RLLib
         return a_tp1;
       }
 
+      const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        (void) x_t;
+        (void) a_t;
+        (void) z_tp1;
+        const Representations<T>* phi_tp1 = toStateAction->stateActions(x_tp1);
+        const Action<T>* a_tp1 = Policies::sampleAction(acting, phi_tp1);
+        xa_tp1 = phi_tp1->at(a_tp1);
+        this->r_tp1 = r_tp1;
+        return a_tp1;
+      }
+
+      void stepUpdate()
+      {
+        if (!xa_tp1)
+          return;
+        sarsa->update(xa_t, xa_tp1, r_tp1);
+        Vectors<T>::bufferedCopy(xa_tp1, xa_t);
+        xa_tp1 = 0;
+      }
+
       void reset()
       {
         sarsa->reset();
@@ -112,6 +138,20 @@ namespace RLLib
         sarsa->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("sarsa", sarsa);
+        archive->add("xa_t", xa_t);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        acting->memoryFootprint(node, "acting");
+        toStateAction->memoryFootprint(node, "toStateAction");
+        xa_t->memoryFootprint(node, "xa_t");
+      }
+
   };
 
   template<typename T>
@@ -120,13 +160,14 @@ namespace RLLib
     protected:
       Actions<T>* actions;
       VectorPool<T>* pool;
+      Vector<T>* xa_bar_tp1; // deferred by stepAction(..)
       typedef SarsaControl<T> Base;
     public:
 
       ExpectedSarsaControl(Policy<T>* acting, StateToStateAction<T>* toStateAction, Sarsa<T>* sarsa,
           Actions<T>* actions) :
           SarsaControl<T>(acting, toStateAction, sarsa), actions(actions), //
-          pool(new VectorPool<T>(toStateAction->dimension()))
+          pool(new VectorPool<T>(toStateAction->dimension())), xa_bar_tp1(0)
       {
       }
       virtual ~ExpectedSarsaControl()
@@ -159,6 +200,44 @@ namespace RLLib
         return a_tp1;
       }
 
+      const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        (void) x_t;
+        (void) a_t;
+        (void) z_tp1;
+        const Representations<T>* phi_tp1 = Base::toStateAction->stateActions(x_tp1);
+        const Action<T>* a_tp1 = Policies::sampleAction(Base::acting, phi_tp1);
+        xa_bar_tp1 = pool->newVector(phi_tp1->at(a_tp1));
+        xa_bar_tp1->clear();
+        for (typename Actions<T>::const_iterator a = actions->begin(); a != actions->end(); ++a)
+        {
+          T pi = Base::acting->pi(*a);
+          if (pi != 0)
+            xa_bar_tp1->addToSelf(pi, phi_tp1->at(*a));
+        }
+        Base::xa_tp1 = phi_tp1->at(a_tp1);
+        Base::r_tp1 = r_tp1;
+        return a_tp1;
+      }
+
+      void stepUpdate()
+      {
+        if (!Base::xa_tp1)
+          return;
+        Base::sarsa->update(Base::xa_t, xa_bar_tp1, Base::r_tp1);
+        Vectors<T>::bufferedCopy(Base::xa_tp1, Base::xa_t);
+        Base::xa_tp1 = 0;
+        pool->releaseAll();
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        Base::componentsFootprint(node);
+        pool->memoryFootprint(node, "pool");
+      }
+
   };
 
   /**
@@ -199,6 +278,7 @@ namespace RLLib
 
       T update(const Vector<T>* x_t, const Action<T>* a_t, const Vector<T>* x_tp1, const T& r_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(initialized);
         const Representations<T>* phi_t = toStateAction->stateActions(x_t);
         Vectors<T>::bufferedCopy(phi_t->at(a_t), phi_sa_t);
@@ -206,7 +286,8 @@ namespace RLLib
         const Action<T>* at_star = target->sampleBestAction();
         const Representations<T>* phi_tp1 = toStateAction->stateActions(x_tp1);
         target->update(phi_tp1);
-        delta = r_tp1 + gamma * target->sampleBestActionValue() - q->dot(phi_sa_t);
+        delta = TDError<T>::compute(r_tp1, gamma, target->sampleBestActionValue(),
+            q->dot(phi_sa_t));
         if (a_t->id() == at_star->id())
           e->update(gamma * lambda, phi_sa_t);
         else
@@ -252,6 +333,20 @@ namespace RLLib
         q->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("q", q);
+        archive->add("e", e->vect());
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        toStateAction->memoryFootprint(node, "toStateAction");
+        target->memoryFootprint(node, "target");
+        if (phi_sa_t)
+          phi_sa_t->memoryFootprint(node, "phi_sa_t");
+      }
   };
 
 // Gradient decent control
@@ -294,6 +389,13 @@ namespace RLLib
         return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
       }
 
+      const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        OffPolicyControlLearner<T>::defer(x_t, a_t, x_tp1, r_tp1, z_tp1);
+        return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
+      }
+
       void reset()
       {
         q->reset();
@@ -330,6 +432,18 @@ namespace RLLib
       {
         q->resurrect(f);
       }
+
+      void accept(Archive<T>* archive)
+      {
+        archive->add("q", q);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        behavior->memoryFootprint(node, "behavior");
+        toStateAction->memoryFootprint(node, "toStateAction");
+      }
   };
 
 // Gradient decent control
@@ -352,7 +466,10 @@ namespace RLLib
       GreedyGQ(Policy<T>* target, Policy<T>* behavior, Actions<T>* actions,
           StateToStateAction<T>* toStateAction, GQ<T>* gq) :
           rho_t(0), target(target), behavior(behavior), actions(actions), //
-          toStateAction(toStateAction), gq(gq), phi_t(0), phi_bar_tp1(0)
+          toStateAction(toStateAction), gq(gq),
+          // Sized from the GQ weights, which have the dimension of the state-action vectors
+          // whatever toStateAction->dimension() is; a snapshot before initialize(..) has it
+          phi_t(new SVector<T>(gq->weights()->dimension())), phi_bar_tp1(0)
       {
       }
 
@@ -410,6 +527,13 @@ namespace RLLib
         return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
       }
 
+      const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        OffPolicyControlLearner<T>::defer(x_t, a_t, x_tp1, r_tp1, z_tp1);
+        return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
+      }
+
       void reset()
       {
         gq->reset();
@@ -445,6 +569,22 @@ namespace RLLib
       {
         gq->resurrect(f);
       }
+
+      void accept(Archive<T>* archive)
+      {
+        archive->add("gq", gq);
+        archive->add("phi_t", phi_t);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        target->memoryFootprint(node, "target");
+        behavior->memoryFootprint(node, "behavior");
+        toStateAction->memoryFootprint(node, "toStateAction");
+        if (phi_bar_tp1)
+          phi_bar_tp1->memoryFootprint(node, "phi_bar_tp1");
+      }
   };
 
   template<typename T>
@@ -518,6 +658,16 @@ namespace RLLib
         u->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->addVectors("u", u);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        targetPolicy->memoryFootprint(node, "targetPolicy");
+      }
   };
 
   template<typename T>
@@ -549,6 +699,7 @@ namespace RLLib
       void update(const Representations<T>* phi_t, const Action<T>* a_t, T const& rho_t,
           const T& delta_t)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(Base::initialized);
         const Vectors<T>* gradLog = Base::targetPolicy->computeGradLog(phi_t, a_t);
         for (int i = 0; i < e_u->dimension(); i++)
@@ -564,6 +715,12 @@ namespace RLLib
         Base::reset();
         e_u->clear();
       }
+
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->addTraces("e_u", e_u);
+      }
   };
 
   template<typename T>
@@ -583,7 +740,9 @@ namespace RLLib
       OffPAC(Policy<T>* behavior, OffPolicyTD<T>* critic, ActorOffPolicy<T>* actor,
           StateToStateAction<T>* toStateAction, Projector<T>* projector) :
           rho_t(0), delta_t(0), behavior(behavior), critic(critic), actor(actor), //
-          toStateAction(toStateAction), projector(projector), phi_t(0)
+          toStateAction(toStateAction), projector(projector),
+          // Of the vector type of the projections of the critic, e.g., dense for Fourier bases
+          phi_t(projector->newVector())
       {
       }
 
@@ -626,6 +785,13 @@ namespace RLLib
         return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
       }
 
+      const Action<T>* stepAction(const Vector<T>* x_t, const Action<T>* a_t,
+          const Vector<T>* x_tp1, const T& r_tp1, const T& z_tp1)
+      {
+        OffPolicyControlLearner<T>::defer(x_t, a_t, x_tp1, r_tp1, z_tp1);
+        return Policies::sampleAction(behavior, toStateAction->stateActions(x_tp1));
+      }
+
       void reset()
       {
         critic->reset();
@@ -670,6 +836,21 @@ namespace RLLib
         actor->resurrect(factor.c_str());
 #endif
       }
+
+      void accept(Archive<T>* archive)
+      {
+        archive->add("critic", critic);
+        archive->add("actor", actor);
+        archive->add("phi_t", phi_t);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        behavior->memoryFootprint(node, "behavior");
+        toStateAction->memoryFootprint(node, "toStateAction");
+        projector->memoryFootprint(node, "projector");
+      }
   };
 
   template<typename T>
@@ -701,6 +882,7 @@ namespace RLLib
 
       void update(const Representations<T>* phi_t, const Action<T>* a_t, const T& delta_t)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(initialized);
         const Vectors<T>* gradLog = policyDistribution->computeGradLog(phi_t, a_t);
         for (int i = 0; i < gradLog->dimension(); i++)
@@ -727,6 +909,16 @@ namespace RLLib
         u->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->addVectors("u", u);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        policyDistribution->memoryFootprint(node, "policyDistribution");
+      }
   };
 
   template<typename T>
@@ -745,9 +937,9 @@ namespace RLLib
         ASSERT(e->dimension() == Base::u->dimension());
       }
 
-      void initialize(const Vector<T>* x)
+      void initialize()
       {
-        Base::initialize(x);
+        Base::initialize();
         e->clear();
       }
 
@@ -757,8 +949,15 @@ namespace RLLib
         e->clear();
       }
 
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->addTraces("e", e);
+      }
+
       void update(const Representations<T>* phi_t, const Action<T>* a_t, T delta)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(Base::initialized);
         const Vectors<T>* gradLog = Base::policy()->computeGradLog(phi_t, a_t);
         for (int i = 0; i < Base::u->dimension(); i++)
@@ -793,6 +992,7 @@ namespace RLLib
 
       void update(const Representations<T>* phi_t, const Action<T>* a_t, T delta)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(Base::initialized);
         const Vectors<T>* gradLog = Base::policy()->computeGradLog(phi_t, a_t);
         T advantageValue = T(0);
@@ -814,6 +1014,11 @@ namespace RLLib
         w->clear();
       }
 
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->addVectors("w", w);
+      }
   };
 
   template<typename T>
@@ -829,7 +1034,9 @@ namespace RLLib
     public:
       AbstractActorCritic(OnPolicyTD<T>* critic, ActorOnPolicy<T>* actor, Projector<T>* projector,
           StateToStateAction<T>* toStateAction) :
-          critic(critic), actor(actor), projector(projector), toStateAction(toStateAction), phi_t(0)
+          critic(critic), actor(actor), projector(projector), toStateAction(toStateAction), //
+          // The state features of the last step; here, to be archived from the first snapshot
+          phi_t(projector->newVector())
       {
       }
 
@@ -920,6 +1127,19 @@ namespace RLLib
 #endif
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("critic", critic);
+        archive->add("actor", actor);
+        archive->add("phi_t", phi_t);
+      }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        projector->memoryFootprint(node, "projector");
+        toStateAction->memoryFootprint(node, "toStateAction");
+      }
   };
 
   template<typename T>
@@ -981,6 +1201,12 @@ namespace RLLib
         Vectors<T>::bufferedCopy(phi_tp1, Base::phi_t);
         return delta_t;
       }
+
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->add("averageReward", averageReward);
+      }
   };
 
 } // namespace RLLib
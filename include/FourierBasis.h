@@ -125,6 +125,7 @@ namespace RLLib
        */
       const Vector<T>* project(const Vector<T>* x, const int& h1)
       {
+        RLLIB_PROBE(PROJECTION);
         featureVector->clear();
         if (x->empty())
           return featureVector;
@@ -140,6 +141,7 @@ namespace RLLib
 
       const Vector<T>* project(const Vector<T>* x)
       {
+        RLLIB_PROBE(PROJECTION);
         return project(x, 0);
       }
 
@@ -153,10 +155,32 @@ namespace RLLib
         return featureVector->dimension();
       }
 
+      Vector<T>* newVector() const
+      {
+        return featureVector->newInstance(featureVector->dimension());
+      }
+
       const std::vector<Vector<T>*>& getMultipliers() const
       {
         return multipliers;
       }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        featureVector->memoryFootprint(node, "phi");
+        MemoryFootprint* coefficients = node->child("multipliers", 0);
+        coefficients->add(multipliers.capacity() * sizeof(Vector<T>*),
+            multipliers.size() * sizeof(Vector<T>*));
+        for (size_t i = 0; i < multipliers.size(); i++)
+        {
+          MemoryFootprint multiplier;
+          multipliers[i]->memoryFootprint(&multiplier, "multiplier");
+          coefficients->add(multiplier.allocatedBytes(), multiplier.liveBytes());
+        }
+      }
   };
 
 }  // namespace RLLib 
@@ -27,8 +27,53 @@
 namespace RLLib
 {
 
+  template<typename T> class Random;
+  template<typename T> class Traces;
+  template<typename T> class ParameterizedFunction;
+
+  /**
+   * Visitor of the complete state of a learner: the weights, but also the
+   * traces, the auxiliary weights, the adaptive step sizes, and the scalars
+   * carried between two updates. A learner exposes its state in
+   * ParameterizedFunction<T>::accept(..); e.g., a Snapshot<T> copies it.
+   */
+  template<typename T>
+  class Archive
+  {
+    public:
+      virtual ~Archive()
+      {
+      }
+      virtual void add(const char* name, Vector<T>* vector) =0;
+      virtual void add(const char* name, T& scalar) =0;
+      virtual void add(const char* name, Random<T>* random) =0;
+      // The names of the state of function are prefixed with name
+      virtual void add(const char* name, ParameterizedFunction<T>* function) =0;
+
+      // Adds name.0, name.1, ...
+      void addVectors(const char* name, Vectors<T>* vectors)
+      {
+        char entry[256];
+        for (int i = 0; i < vectors->dimension(); i++)
+        {
+          snprintf(entry, sizeof(entry), "%s.%i", name, i);
+          add(entry, vectors->getEntry(i));
+        }
+      }
+
+      void addTraces(const char* name, Traces<T>* traces)
+      {
+        char entry[256];
+        for (int i = 0; i < traces->dimension(); i++)
+        {
+          snprintf(entry, sizeof(entry), "%s.%i", name, i);
+          add(entry, traces->getEntry(i)->vect());
+        }
+      }
+  };
+
   template<typename T>
-  class ParameterizedFunction
+  class ParameterizedFunction: public ArenaAllocated
   {
     public:
       virtual ~ParameterizedFunction()
@@ -36,8 +81,67 @@ namespace RLLib
       }
       virtual void persist(const char* f) const =0;
       virtual void resurrect(const char* f) =0;
+
+      // Exposes the state to archive; nothing by default
+      virtual void accept(Archive<T>* /*archive*/)
+      {
+      }
+
+      // Adds the node name, with the state exposed by accept(..), to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const;
+
+    protected:
+      // Adds the components and the buffers that accept(..) does not expose
+      virtual void componentsFootprint(MemoryFootprint* /*node*/) const
+      {
+      }
+  };
+
+  // The footprint of the state of a ParameterizedFunction<T>
+  template<typename T>
+  class MemoryFootprintArchive: public Archive<T>
+  {
+    protected:
+      MemoryFootprint* footprint;
+
+    public:
+      MemoryFootprintArchive(MemoryFootprint* footprint) :
+          footprint(footprint)
+      {
+      }
+
+      void add(const char* name, Vector<T>* vector)
+      {
+        vector->memoryFootprint(footprint, name);
+      }
+
+      void add(const char* /*name*/, T& /*scalar*/)
+      {
+      }
+
+      void add(const char* /*name*/, Random<T>* /*random*/)
+      {
+      }
+
+      void add(const char* name, ParameterizedFunction<T>* function)
+      {
+        function->memoryFootprint(footprint, name);
+      }
   };
 
+  template<typename T>
+  void ParameterizedFunction<T>::memoryFootprint(MemoryFootprint* footprint,
+      const std::string& name) const
+  {
+    MemoryFootprint* node = footprint->child(name, this);
+    if (!node)
+      return;
+    MemoryFootprintArchive<T> archive(node);
+    // accept(..) does not modify the function
+    const_cast<ParameterizedFunction<T>*>(this)->accept(&archive);
+    componentsFootprint(node);
+  }
+
   template<typename T>
   class LinearLearner: public ParameterizedFunction<T>
   {
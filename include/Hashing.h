@@ -23,6 +23,7 @@
 #define HASHING_H_
 
 #include <limits.h>
+#include <algorithm>
 
 #include "Mathema.h"
 
@@ -30,18 +31,32 @@ namespace RLLib
 {
 
   template<typename T>
-  class Hashing
+  class Hashing: public ArenaAllocated
   {
     public:
       enum
       {
         MAX_NUM_VARS = 20          // Maximum number of variables in a grid-tiling
       };
+
+      /**
+       * Using this to identify the hashing function (no RTTI)
+       */
+      enum HashingType
+      {
+        BASE_HASHING, UNH_HASHING, MURMUR_HASHING
+      };
+
       virtual ~Hashing()
       {
       }
       virtual int hash(int* ints/*coordinates*/, int num_ints) =0;
       virtual int getMemorySize() const =0;
+
+      virtual HashingType getHashingType() const
+      {
+        return BASE_HASHING;
+      }
   };
 
   template<typename T>
@@ -73,9 +88,15 @@ namespace RLLib
     private:
       typedef AbstractHashing<T> Base;
 
+    public:
+      enum
+      {
+        RANDOM_SEQUENCE_LENGTH = 16384 // 2^14 {old: 2048}
+      };
+
     protected:
       int increment;
-      unsigned int rndseq[16384]; // 2^14 (16384)  {old: 2048}
+      unsigned int rndseq[RANDOM_SEQUENCE_LENGTH];
 
     public:
       UNH(Random<T>* random, const int& memorySize) :
@@ -84,7 +105,7 @@ namespace RLLib
         /*First call to hashing, initialize table of random numbers */
         //printf("inside tiles \n");
         //srand(0);
-        for (int k = 0; k < 16384/*2048*/; k++)
+        for (int k = 0; k < RANDOM_SEQUENCE_LENGTH; k++)
         {
           rndseq[k] = 0;
           for (int i = 0; i < int(sizeof(int)); ++i)
@@ -93,6 +114,33 @@ namespace RLLib
         //srand(time(0));
       }
 
+      // Restores the hashing from a previously generated table of random numbers
+      UNH(const unsigned int* rndseq, const int& memorySize, const int& increment = 470) :
+          AbstractHashing<T>(0, memorySize), increment(increment)
+      {
+        std::copy(rndseq, rndseq + RANDOM_SEQUENCE_LENGTH, this->rndseq);
+      }
+
+      typename Hashing<T>::HashingType getHashingType() const
+      {
+        return Hashing<T>::UNH_HASHING;
+      }
+
+      const unsigned int* getRandomSequence() const
+      {
+        return rndseq;
+      }
+
+      int getRandomSequenceLength() const
+      {
+        return RANDOM_SEQUENCE_LENGTH;
+      }
+
+      int getIncrement() const
+      {
+        return increment;
+      }
+
       /** hash_UNH
        *  Takes an array of integers and returns the corresponding tile after hashing
        */
@@ -139,10 +187,26 @@ namespace RLLib
       {
       }
 
+      // Restores the hashing from a known seed
+      MurmurHashing(const uint32_t& seed, const int& memorySize) :
+          AbstractHashing<T>(0, memorySize), seed(seed), out(0)
+      {
+      }
+
       virtual ~MurmurHashing()
       {
       }
 
+      typename Hashing<T>::HashingType getHashingType() const
+      {
+        return Hashing<T>::MURMUR_HASHING;
+      }
+
+      uint32_t getSeed() const
+      {
+        return seed;
+      }
+
     public:
       /**
        * https://code.google.com/p/smhasher/
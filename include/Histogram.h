@@ -0,0 +1,200 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * Histogram.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <algorithm>
+
+namespace RLLib
+{
+  /**
+   * A latency histogram of fixed memory, in the manner of HdrHistogram. The
+   * values below SUB_COUNT have a bucket each; above, each power of two is
+   * split into HALF_COUNT buckets, so that a value and the bucket that
+   * reports it differ by less than 1/HALF_COUNT (3.1%). The values are
+   * integers, e.g., ns; the values of 2^(MAX_EXPONENT + 1) or more land in
+   * the last bucket, but min() and max() are exact.
+   *
+   * Recording does not allocate, and the histograms of the threads, or of
+   * the runs, merge into one with merge(..).
+   */
+  class LatencyHistogram
+  {
+    public:
+      enum
+      {
+        SUB_BITS = 6,
+        SUB_COUNT = 1 << SUB_BITS,
+        HALF_COUNT = SUB_COUNT / 2,
+        MAX_EXPONENT = 40, // 2^41 ns is 36 minutes
+        NB_BUCKETS = SUB_COUNT + (MAX_EXPONENT - SUB_BITS + 1) * HALF_COUNT
+      };
+
+    protected:
+      uint64_t counts[NB_BUCKETS];
+      uint64_t totalCount;
+      uint64_t minValue;
+      uint64_t maxValue;
+      double sum;
+
+    public:
+      LatencyHistogram()
+      {
+        reset();
+      }
+
+      void reset()
+      {
+        std::fill(counts, counts + NB_BUCKETS, 0);
+        totalCount = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+        sum = 0;
+      }
+
+      void record(const uint64_t& value)
+      {
+        ++counts[bucketIndex(value)];
+        ++totalCount;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        sum += value;
+      }
+
+      void merge(const LatencyHistogram& that)
+      {
+        for (int i = 0; i < NB_BUCKETS; i++)
+          counts[i] += that.counts[i];
+        totalCount += that.totalCount;
+        minValue = std::min(minValue, that.minValue);
+        maxValue = std::max(maxValue, that.maxValue);
+        sum += that.sum;
+      }
+
+      uint64_t count() const
+      {
+        return totalCount;
+      }
+
+      uint64_t min() const
+      {
+        return totalCount ? minValue : 0;
+      }
+
+      uint64_t max() const
+      {
+        return maxValue;
+      }
+
+      double mean() const
+      {
+        return totalCount ? sum / totalCount : 0;
+      }
+
+      uint64_t countAt(const int& index) const
+      {
+        return counts[index];
+      }
+
+      // The value that percentile% of the values do not exceed, e.g., 99.9
+      uint64_t percentile(const double& percentile) const
+      {
+        if (!totalCount)
+          return 0;
+        const uint64_t rank = std::max(uint64_t(1),
+            uint64_t(std::ceil(percentile / 100.0 * totalCount)));
+        uint64_t seen = 0;
+        for (int i = 0; i < NB_BUCKETS; i++)
+        {
+          seen += counts[i];
+          if (seen >= rank)
+            return std::max(std::min(bucketUpper(i), maxValue), minValue);
+        }
+        return maxValue;
+      }
+
+      // One line: the count, the percentiles and the max, the values divided by scale
+      void print(std::ostream& out, const char* name, const double& scale = 1000.0) const
+      {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+            "%s n=%llu min=%.1f p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f mean=%.1f", name,
+            (unsigned long long) totalCount, min() / scale, percentile(50) / scale,
+            percentile(90) / scale, percentile(99) / scale, percentile(99.9) / scale,
+            max() / scale, mean() / scale);
+        out << line << std::endl;
+      }
+
+      static int bucketIndex(const uint64_t& value)
+      {
+        if (value < uint64_t(SUB_COUNT))
+          return int(value);
+        const int exponent = highestBit(value);
+        if (exponent > MAX_EXPONENT)
+          return NB_BUCKETS - 1;
+        const int shift = exponent - SUB_BITS + 1;
+        return SUB_COUNT + (exponent - SUB_BITS) * HALF_COUNT + int(value >> shift) - HALF_COUNT;
+      }
+
+      // The smallest value of the bucket index
+      static uint64_t bucketLower(const int& index)
+      {
+        if (index < SUB_COUNT)
+          return index;
+        const int octave = (index - SUB_COUNT) / HALF_COUNT;
+        const uint64_t sub = (index - SUB_COUNT) % HALF_COUNT + HALF_COUNT;
+        return sub << (octave + 1);
+      }
+
+      // The largest value of the bucket index
+      static uint64_t bucketUpper(const int& index)
+      {
+        if (index < SUB_COUNT)
+          return index;
+        if (index == NB_BUCKETS - 1)
+          return UINT64_MAX;
+        const int octave = (index - SUB_COUNT) / HALF_COUNT;
+        return bucketLower(index) + (uint64_t(1) << (octave + 1)) - 1;
+      }
+
+    private:
+      static int highestBit(const uint64_t& value)
+      {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        for (uint64_t v = value; v >>= 1;)
+          ++bit;
+        return bit;
+#endif
+      }
+  };
+
+}  // namespace RLLib
+
+#endif /* HISTOGRAM_H_ */
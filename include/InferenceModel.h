@@ -0,0 +1,443 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * InferenceModel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef INFERENCEMODEL_H_
+#define INFERENCEMODEL_H_
+
+#include "Control.h"
+#include "Hashing.h"
+#include "Projector.h"
+#include "StateToStateAction.h"
+
+#if !defined(EMBEDDED_MODE)
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#if !defined(_MSC_VER)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace RLLib
+{
+
+  /**
+   * On-disk layout of a frozen inference model. The header is followed by four
+   * sections, each one starting at a multiple of ALIGNMENT bytes:
+   *   [grid resolutions (nbInputs x T)]
+   *   [hashing table (UNH only, UNH<T>::RANDOM_SEQUENCE_LENGTH x uint32)]
+   *   [action values (nbActions x actionDimension x T)]
+   *   [weights (nbWeights x T)]
+   * Everything is stored in the native byte order of the exporting machine.
+   */
+  struct InferenceModelHeader
+  {
+      enum
+      {
+        VERSION = 1, ALIGNMENT = 64
+      };
+
+      char magic[8];
+      uint32_t version;
+      uint32_t scalarSize;
+      uint32_t hashingType;
+      uint32_t hashingIncrement;
+      uint32_t hashingSeed;
+      int32_t memorySize;
+      int32_t nbInputs;
+      int32_t nbTilings;
+      int32_t includeActiveFeature;
+      int32_t nbActions;
+      int32_t actionDimension;
+      int32_t nbWeights;
+      uint64_t gridResolutionsOffset;
+      uint64_t hashingTableOffset;
+      uint64_t actionsOffset;
+      uint64_t weightsOffset;
+      uint64_t fileSize;
+  };
+
+  /**
+   * A frozen, greedy controller that runs directly on top of a memory-mapped
+   * model file. Nothing but the projection state is allocated on the heap: the
+   * weights are read in place from the mapping.
+   *
+   * The model is produced from a trained agent with InferenceControl<T>::persist(..).
+   * Use it with ControlAgent<T> to evaluate the frozen policy with RLRunner<T>.
+   */
+  template<typename T>
+  class InferenceControl: public Control<T>
+  {
+    protected:
+      const char* mapped;
+      size_t mappedLength;
+      const InferenceModelHeader* header;
+      const T* weights;
+      Hashing<T>* hashing;
+      Vector<T>* gridResolutions;
+      TileCoderHashing<T>* projector;
+      Actions<T>* actions;
+
+    public:
+      InferenceControl(const char* f) :
+          mapped(0), mappedLength(0), header(0), weights(0), hashing(0), gridResolutions(0), //
+          projector(0), actions(0)
+      {
+        resurrect(f);
+      }
+
+      virtual ~InferenceControl()
+      {
+        unload();
+      }
+
+      const Action<T>* initialize(const Vector<T>* x)
+      {
+        return proposeAction(x);
+      }
+
+      void reset()
+      {/*The model is frozen*/
+      }
+
+      const Action<T>* proposeAction(const Vector<T>* x)
+      {
+        // Same tie breaking as Greedy<T>: the first action with the largest value
+        const Action<T>* bestAction = actions->getEntry(0);
+        T bestValue = computeQ(x, bestAction);
+        for (int i = 1; i < actions->dimension(); i++)
+        {
+          const Action<T>* a = actions->getEntry(i);
+          const T value = computeQ(x, a);
+          if (value > bestValue)
+          {
+            bestValue = value;
+            bestAction = a;
+          }
+        }
+        return bestAction;
+      }
+
+      const Action<T>* step(const Vector<T>* x_t, const Action<T>* a_t, const Vector<T>* x_tp1,
+          const T& r_tp1, const T& z_tp1)
+      {
+        return proposeAction(x_tp1);
+      }
+
+      T computeQ(const Vector<T>* x, const Action<T>* a)
+      {
+        const Vector<T>* phi =
+            actions->dimension() == 1 ? projector->project(x) : projector->project(x, a->id());
+        return RTTI<T>::constSparseVector(phi)->dotProduct(weights);
+      }
+
+      T computeValueFunction(const Vector<T>* x) const
+      {
+        InferenceControl<T>* that = const_cast<InferenceControl<T>*>(this);
+        T value = that->computeQ(x, actions->getEntry(0));
+        for (int i = 1; i < actions->dimension(); i++)
+          value = std::max(value, that->computeQ(x, actions->getEntry(i)));
+        return value;
+      }
+
+      // The frozen model has no predictor; the weights live in the mapping.
+      const Predictor<T>* predictor() const
+      {
+        return 0;
+      }
+
+      const Actions<T>* getActions() const
+      {
+        return actions;
+      }
+
+      const T* getWeights() const
+      {
+        return weights;
+      }
+
+      int dimension() const
+      {
+        return header->nbWeights;
+      }
+
+      size_t sizeInBytes() const
+      {
+        return mappedLength;
+      }
+
+      // Writes the mapped model back to the disk.
+      void persist(const char* f) const
+      {
+        std::ofstream of;
+        of.open(f, std::ofstream::out | std::ofstream::binary);
+        if (of.is_open())
+        {
+          of.write(mapped, mappedLength);
+          of.close();
+        }
+        else
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+      }
+
+      void resurrect(const char* f)
+      {
+        unload();
+        if (!map(f))
+        {
+          std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+          exit(-1);
+        }
+        header = reinterpret_cast<const InferenceModelHeader*>(mapped);
+        if (!isValid(header, mappedLength))
+        {
+          std::cerr << "ERROR! (resurrect) not a compatible inference model, file=" << f
+              << std::endl;
+          exit(-1);
+        }
+
+        switch (header->hashingType)
+        {
+          case Hashing<T>::UNH_HASHING:
+            hashing = new UNH<T>(
+                reinterpret_cast<const unsigned int*>(mapped + header->hashingTableOffset),
+                header->memorySize, header->hashingIncrement);
+            break;
+          case Hashing<T>::MURMUR_HASHING:
+            hashing = new MurmurHashing<T>(header->hashingSeed, header->memorySize);
+            break;
+          default:
+            std::cerr << "ERROR! (resurrect) unknown hashing, file=" << f << std::endl;
+            exit(-1);
+        }
+
+        const T* resolutions = reinterpret_cast<const T*>(mapped + header->gridResolutionsOffset);
+        gridResolutions = new PVector<T>(header->nbInputs);
+        for (int i = 0; i < header->nbInputs; i++)
+          gridResolutions->setEntry(i, resolutions[i]);
+        projector = new TileCoderHashing<T>(hashing, header->nbInputs, gridResolutions,
+            header->nbTilings, header->includeActiveFeature != 0);
+
+        const T* values = reinterpret_cast<const T*>(mapped + header->actionsOffset);
+        actions = new ActionArray<T>(header->nbActions);
+        for (int a = 0; a < header->nbActions; a++)
+          for (int i = 0; i < header->actionDimension; i++)
+            actions->push_back(a, values[a * header->actionDimension + i]);
+
+        weights = reinterpret_cast<const T*>(mapped + header->weightsOffset);
+        if (projector->dimension() != header->nbWeights)
+        {
+          std::cerr << "ERROR! (resurrect) weights do not match the projector, file=" << f
+              << std::endl;
+          exit(-1);
+        }
+      }
+
+      /**
+       * Checks that a header of a model of length bytes is compatible with T, and
+       * that each one of its sections lies within the model, before any of them is read.
+       */
+      static bool isValid(const InferenceModelHeader* h, const size_t& length)
+      {
+        if (length < sizeof(InferenceModelHeader) || std::memcmp(h->magic, "RLLIBINF", 8) != 0
+            || h->version != InferenceModelHeader::VERSION || h->scalarSize != sizeof(T)
+            || h->fileSize != length)
+          return false;
+        if (h->memorySize <= 0 || h->nbInputs < 0 || h->nbInputs > Hashing<T>::MAX_NUM_VARS
+            || h->nbTilings <= 0 || h->nbActions <= 0 || h->actionDimension < 0
+            || h->nbWeights < 0)
+          return false;
+        if (h->hashingType == Hashing<T>::UNH_HASHING
+            && !isSection(h->hashingTableOffset, UNH<T>::RANDOM_SEQUENCE_LENGTH,
+                sizeof(unsigned int), length))
+          return false;
+        return isSection(h->gridResolutionsOffset, h->nbInputs, sizeof(T), length)
+            && isSection(h->actionsOffset, uint64_t(h->nbActions) * h->actionDimension,
+                sizeof(T), length) && isSection(h->weightsOffset, h->nbWeights, sizeof(T), length);
+      }
+
+      /**
+       * Exports a trained agent that uses a TileCoderHashing<T> projector with
+       * StateActionTilings<T>, e.g., Sarsa or GreedyGQ, into a single file that
+       * can be mapped by InferenceControl<T>.
+       */
+      static bool persist(const char* f, const TileCoderHashing<T>* projector,
+          const Actions<T>* actions, const Vector<T>* weights)
+      {
+        const Hashing<T>* hashing = projector->getHashing();
+        const Vector<T>* resolutions = projector->getGridResolutions();
+        InferenceModelHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "RLLIBINF", 8);
+        h.version = InferenceModelHeader::VERSION;
+        h.scalarSize = sizeof(T);
+        h.hashingType = hashing->getHashingType();
+        h.memorySize = hashing->getMemorySize();
+        h.nbInputs = resolutions->dimension();
+        h.nbTilings = projector->getNbTilings();
+        h.includeActiveFeature = projector->isIncludeActiveFeature() ? 1 : 0;
+        h.nbActions = actions->dimension();
+        h.actionDimension = actions->getEntry(0)->dimension();
+        h.nbWeights = weights->dimension();
+
+        const unsigned int* hashingTable = 0;
+        int hashingTableLength = 0;
+        switch (h.hashingType)
+        {
+          case Hashing<T>::UNH_HASHING:
+          {
+            const UNH<T>* unh = static_cast<const UNH<T>*>(hashing);
+            hashingTable = unh->getRandomSequence();
+            hashingTableLength = unh->getRandomSequenceLength();
+            h.hashingIncrement = unh->getIncrement();
+            break;
+          }
+          case Hashing<T>::MURMUR_HASHING:
+            h.hashingSeed = static_cast<const MurmurHashing<T>*>(hashing)->getSeed();
+            break;
+          default:
+            std::cerr << "ERROR! (persist) unsupported hashing, file=" << f << std::endl;
+            return false;
+        }
+        if (h.nbWeights != projector->dimension())
+        {
+          std::cerr << "ERROR! (persist) weights do not match the projector, file=" << f
+              << std::endl;
+          return false;
+        }
+        for (int a = 1; a < h.nbActions; a++)
+          ASSERT(actions->getEntry(a)->dimension() == h.actionDimension);
+
+        h.gridResolutionsOffset = align(sizeof(h));
+        h.hashingTableOffset = align(h.gridResolutionsOffset + h.nbInputs * sizeof(T));
+        h.actionsOffset = align(h.hashingTableOffset + hashingTableLength * sizeof(unsigned int));
+        h.weightsOffset = align(h.actionsOffset + h.nbActions * h.actionDimension * sizeof(T));
+        h.fileSize = h.weightsOffset + h.nbWeights * sizeof(T);
+
+        std::vector<char> buffer(h.fileSize, 0);
+        std::memcpy(&buffer[0], &h, sizeof(h));
+        T* resolutionsOut = reinterpret_cast<T*>(&buffer[h.gridResolutionsOffset]);
+        for (int i = 0; i < h.nbInputs; i++)
+          resolutionsOut[i] = resolutions->getEntry(i);
+        if (hashingTableLength > 0)
+          std::memcpy(&buffer[h.hashingTableOffset], hashingTable,
+              hashingTableLength * sizeof(unsigned int));
+        T* actionsOut = reinterpret_cast<T*>(&buffer[h.actionsOffset]);
+        for (int a = 0; a < h.nbActions; a++)
+          for (int i = 0; i < h.actionDimension; i++)
+            actionsOut[a * h.actionDimension + i] = actions->getEntry(a)->getEntry(i);
+        T* weightsOut = reinterpret_cast<T*>(&buffer[h.weightsOffset]);
+        for (int i = 0; i < h.nbWeights; i++)
+          weightsOut[i] = weights->getEntry(i);
+
+        std::ofstream of;
+        of.open(f, std::ofstream::out | std::ofstream::binary);
+        if (!of.is_open())
+        {
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+          return false;
+        }
+        of.write(&buffer[0], buffer.size());
+        of.close();
+        return true;
+      }
+
+    private:
+      // Whether count elements of size bytes, aligned at offset, fit in length bytes
+      static bool isSection(const uint64_t& offset, const uint64_t& count, const size_t& size,
+          const size_t& length)
+      {
+        return offset % size == 0 && offset <= length && count <= (length - offset) / size;
+      }
+
+      static uint64_t align(const uint64_t& offset)
+      {
+        return (offset + InferenceModelHeader::ALIGNMENT - 1)
+            & ~uint64_t(InferenceModelHeader::ALIGNMENT - 1);
+      }
+
+      bool map(const char* f)
+      {
+#if defined(_MSC_VER)
+        std::ifstream ifs(f, std::ifstream::in | std::ifstream::binary);
+        if (!ifs.is_open())
+          return false;
+        ifs.seekg(0, std::ifstream::end);
+        mappedLength = static_cast<size_t>(ifs.tellg());
+        ifs.seekg(0, std::ifstream::beg);
+        char* buffer = new char[mappedLength];
+        ifs.read(buffer, mappedLength);
+        mapped = buffer;
+        return mappedLength >= sizeof(InferenceModelHeader);
+#else
+        int fd = open(f, O_RDONLY);
+        if (fd < 0)
+          return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(InferenceModelHeader)))
+        {
+          close(fd);
+          return false;
+        }
+        void* address = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED)
+          return false;
+        mapped = static_cast<const char*>(address);
+        mappedLength = st.st_size;
+        return true;
+#endif
+      }
+
+      void unload()
+      {
+        delete actions;
+        delete projector;
+        delete gridResolutions;
+        delete hashing;
+        actions = 0;
+        projector = 0;
+        gridResolutions = 0;
+        hashing = 0;
+        if (mapped)
+        {
+#if defined(_MSC_VER)
+          delete[] mapped;
+#else
+          munmap(const_cast<char*>(mapped), mappedLength);
+#endif
+        }
+        mapped = 0;
+        mappedLength = 0;
+        header = 0;
+        weights = 0;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* !defined(EMBEDDED_MODE) */
+
+#endif /* INFERENCEMODEL_H_ */
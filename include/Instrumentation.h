@@ -0,0 +1,423 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Instrumentation.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+#include "PerfCounters.h"
+#include "Timeline.h"
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+#include <mutex>
+#endif
+
+namespace RLLib
+{
+  /**
+   * The time spent in the phases of the agent step. The probes, see
+   * RLLIB_PROBE, accumulate the exclusive time of their scope: the time of
+   * the probes nested in a scope goes to their own phase, e.g., the trace
+   * update of a TD(lambda) update counts as TRACE, not as LEARNER.
+   *
+   * Each thread accumulates into its own counters. snapshot(..) reads those
+   * of the calling thread, so that a runner only sees its own steps (the
+   * runners interleaved on one thread by an RLRunnerScheduler share them).
+   * The counters are registered once and live until the end of the process,
+   * so that snapshotAll(..) also sums the threads that are done (e.g., the
+   * learner thread of PipelinedLearnerAgent).
+   *
+   * With enablePerfCounters(true), the probes also count the hardware events
+   * of PerfCounters (cycles, instructions, cache and branch misses) of their
+   * scope, exclusive as the time. Each thread opens its counters at its first
+   * probe. The probes whose counters could not be read (not permitted, or a
+   * failed read) count no events, and eventCounts tells them apart from the
+   * probes that counted 0. Reading the counters costs a system call per
+   * probe, which the times then include.
+   *
+   * While the Timeline is started, each probe also records its scope as a
+   * span named after its phase.
+   */
+  class Instrumentation
+  {
+    public:
+      enum Phase
+      {
+        AGENT, // RLAgent::initialize(..) and RLAgent::getAtp1(..), less the phases below
+        PROJECTION,
+        STATE_ACTIONS,
+        POLICY,
+        TRACE,
+        LEARNER,
+        NB_PHASES
+      };
+
+      struct Breakdown
+      {
+          uint64_t nanos[NB_PHASES];
+          uint64_t counts[NB_PHASES];
+          uint64_t eventCounts[NB_PHASES]; // the probes whose events were read
+          uint64_t events[NB_PHASES][PerfCounters::NB_EVENTS];
+
+          Breakdown()
+          {
+            clear();
+          }
+
+          void clear()
+          {
+            for (int i = 0; i < NB_PHASES; i++)
+            {
+              nanos[i] = counts[i] = eventCounts[i] = 0;
+              for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+                events[i][j] = 0;
+            }
+          }
+
+          Breakdown operator-(const Breakdown& that) const
+          {
+            Breakdown difference;
+            for (int i = 0; i < NB_PHASES; i++)
+            {
+              difference.nanos[i] = nanos[i] - that.nanos[i];
+              difference.counts[i] = counts[i] - that.counts[i];
+              difference.eventCounts[i] = eventCounts[i] - that.eventCounts[i];
+              for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+                difference.events[i][j] = events[i][j] - that.events[i][j];
+            }
+            return difference;
+          }
+
+          bool hasEvents() const
+          {
+            for (int i = 0; i < NB_PHASES; i++)
+              if (eventCounts[i])
+                return true;
+            return false;
+          }
+
+          uint64_t totalNanos() const
+          {
+            uint64_t total = 0;
+            for (int i = 0; i < NB_PHASES; i++)
+              total += nanos[i];
+            return total;
+          }
+
+          /**
+           * One line per phase: the share of the time, ns per step and ns per
+           * call, then, if counted, the instructions per cycle and the misses
+           * per call, or unavailable for the phases without a read
+           */
+          void print(std::ostream& out, const int& nbSteps) const
+          {
+            const double total = double(totalNanos());
+            const bool withEvents = hasEvents();
+            char line[256];
+            for (int i = 0; i < NB_PHASES; i++)
+            {
+              int length = std::snprintf(line, sizeof(line),
+                  "%-14s %6.1f%% %10.1f ns/step %10.1f ns/call", name(Phase(i)),
+                  total > 0 ? 100.0 * nanos[i] / total : 0.0,
+                  nbSteps > 0 ? double(nanos[i]) / nbSteps : 0.0,
+                  counts[i] ? double(nanos[i]) / counts[i] : 0.0);
+              if (withEvents && !eventCounts[i])
+                std::snprintf(line + length, sizeof(line) - length, " events unavailable");
+              else if (withEvents)
+              {
+                const uint64_t* e = events[i];
+                const double calls = double(eventCounts[i]);
+                std::snprintf(line + length, sizeof(line) - length,
+                    " %5.2f IPC %8.2f LLC-miss %8.2f L1D-miss %8.2f br-miss /call",
+                    e[PerfCounters::CYCLES] ?
+                        double(e[PerfCounters::INSTRUCTIONS]) / e[PerfCounters::CYCLES] : 0.0,
+                    e[PerfCounters::LLC_MISSES] / calls, e[PerfCounters::L1D_MISSES] / calls,
+                    e[PerfCounters::BRANCH_MISSES] / calls);
+              }
+              out << line << std::endl;
+            }
+          }
+      };
+
+      // The counters of one thread; childNanos and childEvents are those of the nested probes
+      struct Counters
+      {
+          uint64_t nanos[NB_PHASES];
+          uint64_t counts[NB_PHASES];
+          uint64_t eventCounts[NB_PHASES];
+          uint64_t events[NB_PHASES][PerfCounters::NB_EVENTS];
+          uint64_t childNanos;
+          uint64_t childEvents[PerfCounters::NB_EVENTS];
+          PerfCounters perf;
+          bool perfOpened; // open() was tried
+
+          Counters() :
+              childNanos(0), perfOpened(false)
+          {
+            for (int i = 0; i < NB_PHASES; i++)
+            {
+              nanos[i] = counts[i] = eventCounts[i] = 0;
+              for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+                events[i][j] = 0;
+            }
+            for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+              childEvents[j] = 0;
+          }
+      };
+
+      static const char* name(const Phase& phase)
+      {
+        static const char* names[] = { "agent", "projection", "stateActions", "policy", "trace",
+            "learner" };
+        return names[phase];
+      }
+
+      // In ns, from a monotonic clock
+      static uint64_t now()
+      {
+        return Timeline::now();
+      }
+
+      // The counters of the calling thread
+      static Counters* counters()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        static thread_local Counters* local = registerThread();
+        return local;
+#else
+        static Counters global;
+        return &global;
+#endif
+      }
+
+      // The counters of the calling thread
+      static void snapshot(Breakdown& breakdown)
+      {
+        breakdown.clear();
+        accumulate(breakdown, counters());
+      }
+
+      // Sums the counters of all the threads
+      static void snapshotAll(Breakdown& breakdown)
+      {
+        breakdown.clear();
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        std::lock_guard<std::mutex> lock(registryMutex());
+        const std::vector<Counters*>& threads = registry();
+        for (size_t t = 0; t < threads.size(); t++)
+          accumulate(breakdown, threads[t]);
+#else
+        accumulate(breakdown, counters());
+#endif
+      }
+
+      /**
+       * Counts the hardware events in the probes of all the threads, from
+       * their next probe on; true if the counters of the calling thread are
+       * available.
+       */
+      static bool enablePerfCounters(const bool& enable)
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        __atomic_store_n(&perfEnabled(), enable, __ATOMIC_RELAXED);
+#else
+        perfEnabled() = enable;
+#endif
+        return enable && perfCounters(counters());
+      }
+
+      // The hardware counters of the thread of counters, if enabled and available; otherwise 0
+      static PerfCounters* perfCounters(Counters* counters)
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        if (!__atomic_load_n(&perfEnabled(), __ATOMIC_RELAXED))
+#else
+        if (!perfEnabled())
+#endif
+          return 0;
+        if (!counters->perfOpened)
+        {
+          counters->perfOpened = true;
+          counters->perf.open();
+        }
+        return counters->perf.isOpen() ? &counters->perf : 0;
+      }
+
+      // Adds to the counters of the calling thread; only the owner thread writes them
+      static void add(Counters* counters, const Phase& phase, const uint64_t& nanos)
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        __atomic_store_n(&counters->nanos[phase], counters->nanos[phase] + nanos,
+            __ATOMIC_RELAXED);
+        __atomic_store_n(&counters->counts[phase], counters->counts[phase] + 1,
+            __ATOMIC_RELAXED);
+#else
+        counters->nanos[phase] += nanos;
+        ++counters->counts[phase];
+#endif
+      }
+
+      // Adds the hardware events of a probe to the counters of the calling thread
+      static void add(Counters* counters, const Phase& phase, const uint64_t* events)
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        __atomic_store_n(&counters->eventCounts[phase], counters->eventCounts[phase] + 1,
+            __ATOMIC_RELAXED);
+        for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+          __atomic_store_n(&counters->events[phase][j], counters->events[phase][j] + events[j],
+              __ATOMIC_RELAXED);
+#else
+        ++counters->eventCounts[phase];
+        for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+          counters->events[phase][j] += events[j];
+#endif
+      }
+
+    private:
+      // Adds the counters of a thread, which may be written concurrently by their owner
+      static void accumulate(Breakdown& breakdown, const Counters* counters)
+      {
+        for (int i = 0; i < NB_PHASES; i++)
+        {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+          breakdown.nanos[i] += __atomic_load_n(&counters->nanos[i], __ATOMIC_RELAXED);
+          breakdown.counts[i] += __atomic_load_n(&counters->counts[i], __ATOMIC_RELAXED);
+          breakdown.eventCounts[i] += __atomic_load_n(&counters->eventCounts[i], __ATOMIC_RELAXED);
+          for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+            breakdown.events[i][j] += __atomic_load_n(&counters->events[i][j], __ATOMIC_RELAXED);
+#else
+          breakdown.nanos[i] += counters->nanos[i];
+          breakdown.counts[i] += counters->counts[i];
+          breakdown.eventCounts[i] += counters->eventCounts[i];
+          for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+            breakdown.events[i][j] += counters->events[i][j];
+#endif
+        }
+      }
+
+      static bool& perfEnabled()
+      {
+        static bool enabled = false;
+        return enabled;
+      }
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+      static std::vector<Counters*>& registry()
+      {
+        static std::vector<Counters*> threads;
+        return threads;
+      }
+
+      static std::mutex& registryMutex()
+      {
+        static std::mutex mutex;
+        return mutex;
+      }
+
+      static Counters* registerThread()
+      {
+        Counters* local = new Counters;
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(local);
+        return local;
+      }
+#endif
+  };
+
+  // Accumulates the exclusive time of its scope into phase
+  class ScopedProbe
+  {
+    protected:
+      Instrumentation::Counters* counters;
+      Instrumentation::Phase phase;
+      PerfCounters* perf;
+      bool counting;
+      uint64_t start;
+      uint64_t parentChildNanos;
+      uint64_t startEvents[PerfCounters::NB_EVENTS];
+      uint64_t parentChildEvents[PerfCounters::NB_EVENTS];
+
+    public:
+      ScopedProbe(const Instrumentation::Phase& phase) :
+          counters(Instrumentation::counters()), phase(phase), //
+          perf(Instrumentation::perfCounters(counters)), counting(false), start(0), //
+          parentChildNanos(counters->childNanos)
+      {
+        counters->childNanos = 0;
+        if (perf)
+        {
+          for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+          {
+            parentChildEvents[j] = counters->childEvents[j];
+            counters->childEvents[j] = 0;
+          }
+          // Without a first read, the scope counts no events
+          counting = perf->read(startEvents);
+        }
+        start = Instrumentation::now();
+      }
+
+      ~ScopedProbe()
+      {
+        const uint64_t end = Instrumentation::now();
+        if (Timeline::enabled())
+          Timeline::record(Instrumentation::name(phase), start, end);
+        const uint64_t elapsed = end - start;
+        const uint64_t nested = std::min(counters->childNanos, elapsed);
+        Instrumentation::add(counters, phase, elapsed - nested);
+        counters->childNanos = parentChildNanos + elapsed;
+        if (perf)
+        {
+          uint64_t events[PerfCounters::NB_EVENTS];
+          const bool counted = counting && perf->read(events);
+          for (int j = 0; j < PerfCounters::NB_EVENTS; j++)
+          {
+            // The scaled counts of a multiplexed group may go backwards: clamp at 0
+            const uint64_t total = counted && events[j] > startEvents[j] ?
+                events[j] - startEvents[j] : 0;
+            events[j] = total - std::min(counters->childEvents[j], total);
+            counters->childEvents[j] = parentChildEvents[j] + total;
+          }
+          if (counted)
+            Instrumentation::add(counters, phase, events);
+        }
+      }
+  };
+
+}  // namespace RLLib
+
+/**
+ * Probes the rest of the scope when RLLib is compiled with
+ * RLLIB_INSTRUMENTATION (cmake -DRLLIB_INSTRUMENTATION=ON); otherwise it
+ * compiles to nothing.
+ */
+#if defined(RLLIB_INSTRUMENTATION)
+#define RLLIB_PROBE(phase) RLLib::ScopedProbe rllibProbe(RLLib::Instrumentation::phase)
+#else
+#define RLLIB_PROBE(phase)
+#endif
+
+#endif /* INSTRUMENTATION_H_ */
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * MappedVector.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef MAPPEDVECTOR_H_
+#define MAPPEDVECTOR_H_
+
+#include "Vector.h"
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+#include <stdint.h>
+#include <limits.h>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace RLLib
+{
+
+  /**
+   * Header of a mapped weight file. The entries start at dataOffset, which is
+   * page aligned, and are stored in the native byte order.
+   */
+  struct MappedVectorHeader
+  {
+      enum
+      {
+        VERSION = 1, DATA_OFFSET = 4096
+      };
+
+      char magic[8];
+      uint32_t version;
+      uint32_t vectorType;
+      uint32_t scalarSize;
+      uint32_t reserved;
+      int64_t dimension;
+      uint64_t dataOffset;
+      uint64_t checksum; // FNV-1a of the entries
+  };
+
+  /**
+   * A PVector<T> whose entries live in a memory-mapped weight file. Opening a
+   * table is O(1): pages are loaded on demand, shared between the processes
+   * that map the same file, and tables larger than the RAM are paged by the OS.
+   *
+   * READ_ONLY maps the file copy-on-write: the vector can be used for
+   * inference and the file is never modified. SHARED writes the updates
+   * through to the file, e.g., for learning; call sync() to flush them and to
+   * refresh the checksum.
+   */
+  template<typename T>
+  class MappedPVector: public PVector<T>
+  {
+    private:
+      typedef PVector<T> Base;
+
+    public:
+      enum MappingMode
+      {
+        READ_ONLY, SHARED
+      };
+
+    protected:
+      MappingMode mode;
+      char* mapped;
+      size_t mappedLength;
+
+    public:
+      MappedPVector(const char* f, const MappingMode& mode = READ_ONLY) :
+          PVector<T>(0, 0), mode(mode), mapped(0), mappedLength(0)
+      {
+        resurrect(f);
+      }
+
+      virtual ~MappedPVector()
+      {
+        unmap();
+      }
+
+    private:
+      MappedPVector(const MappedPVector<T>& that);
+      MappedPVector<T>& operator=(const MappedPVector<T>& that);
+
+    public:
+      MappingMode getMappingMode() const
+      {
+        return mode;
+      }
+
+      const MappedVectorHeader* header() const
+      {
+        return reinterpret_cast<const MappedVectorHeader*>(mapped);
+      }
+
+      // Flushes the updates of a SHARED mapping to the disk.
+      void sync()
+      {
+        if (mode != SHARED)
+          return;
+        reinterpret_cast<MappedVectorHeader*>(mapped)->checksum = checksum(Base::data,
+            Base::capacity);
+        msync(mapped, mappedLength, MS_SYNC);
+      }
+
+      // Reads every entry; use it when the content of the file is not trusted.
+      bool verify() const
+      {
+        return header()->checksum == checksum(Base::data, Base::capacity);
+      }
+
+      // Writes a copy of the entries with the mapped format.
+      void persist(const char* f) const
+      {
+        persist(f, this);
+      }
+
+      // Maps a new file; the previous mapping is released.
+      void resurrect(const char* f)
+      {
+        unmap();
+        const int flags = mode == SHARED ? O_RDWR : O_RDONLY;
+        int fd = ::open(f, flags);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(MappedVectorHeader)))
+        {
+          if (fd >= 0)
+            close(fd);
+          std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+          exit(-1);
+        }
+        // READ_ONLY maps copy-on-write: written pages become private to the process
+        void* address = mmap(0, st.st_size, PROT_READ | PROT_WRITE,
+            mode == SHARED ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED)
+        {
+          std::cerr << "ERROR! (resurrect) mmap file=" << f << std::endl;
+          exit(-1);
+        }
+        mapped = static_cast<char*>(address);
+        mappedLength = st.st_size;
+
+        const MappedVectorHeader* h = header();
+        if (!isValid(h, mappedLength))
+        {
+          std::cerr << "ERROR! (resurrect) not a compatible mapped vector, file=" << f
+              << std::endl;
+          exit(-1);
+        }
+        Base::data = reinterpret_cast<T*>(mapped + h->dataOffset);
+        Base::capacity = int(h->dimension);
+      }
+
+      /**
+       * Checks that a header of a file of length bytes is compatible with T, and
+       * that its entries lie within the file, before they are mapped.
+       */
+      static bool isValid(const MappedVectorHeader* h, const size_t& length)
+      {
+        // The entries are compared in counts, so that the check cannot wrap
+        return length >= sizeof(MappedVectorHeader) && std::memcmp(h->magic, "RLLIBVEC", 8) == 0
+            && h->version == MappedVectorHeader::VERSION
+            && h->vectorType == Vector<T>::DENSE_VECTOR && h->scalarSize == sizeof(T)
+            && h->dimension >= 0 && h->dimension <= INT_MAX
+            && h->dataOffset >= sizeof(MappedVectorHeader) && h->dataOffset % sizeof(T) == 0
+            && h->dataOffset <= length
+            && uint64_t(h->dimension) <= (length - h->dataOffset) / sizeof(T);
+      }
+
+      /**
+       * Writes the entries of a vector into a file that can be mapped.
+       */
+      static bool persist(const char* f, const Vector<T>* that)
+      {
+        std::ofstream of;
+        of.open(f, std::ofstream::out | std::ofstream::binary);
+        if (!of.is_open())
+        {
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+          return false;
+        }
+        const DenseVector<T>* dense = RTTI<T>::constDenseVector(that);
+        PVector<T>* copy = 0;
+        if (!dense)
+        {
+          copy = new PVector<T>(that->dimension());
+          copy->set(that);
+          dense = copy;
+        }
+        MappedVectorHeader h = newHeader(that->dimension());
+        h.checksum = checksum(dense->getValues(), dense->dimension());
+        std::vector<char> padding(h.dataOffset - sizeof(h), 0);
+        of.write((const char*) &h, sizeof(h));
+        of.write(&padding[0], padding.size());
+        of.write((const char*) dense->getValues(), dense->dimension() * sizeof(T));
+        of.close();
+        delete copy;
+        return true;
+      }
+
+      /**
+       * Creates a zero initialized table without writing its entries: the file
+       * system allocates the blocks lazily, so the table can exceed the RAM.
+       */
+      static bool create(const char* f, const int& dimension)
+      {
+        int fd = ::open(f, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+          std::cerr << "ERROR! (create) file=" << f << std::endl;
+          return false;
+        }
+        MappedVectorHeader h = newHeader(dimension);
+        h.checksum = zeroChecksum(dimension);
+        const bool result = ::write(fd, &h, sizeof(h)) == ssize_t(sizeof(h))
+            && ftruncate(fd, h.dataOffset + dimension * sizeof(T)) == 0;
+        close(fd);
+        return result;
+      }
+
+    private:
+      static MappedVectorHeader newHeader(const int& dimension)
+      {
+        MappedVectorHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "RLLIBVEC", 8);
+        h.version = MappedVectorHeader::VERSION;
+        h.vectorType = Vector<T>::DENSE_VECTOR;
+        h.scalarSize = sizeof(T);
+        h.dimension = dimension;
+        h.dataOffset = MappedVectorHeader::DATA_OFFSET;
+        return h;
+      }
+
+      static uint64_t update(uint64_t hash, const unsigned char* bytes, const size_t& length)
+      {
+        for (size_t i = 0; i < length; i++)
+        {
+          hash ^= bytes[i];
+          hash *= 1099511628211ULL;
+        }
+        return hash;
+      }
+
+      static uint64_t checksum(const T* values, const int& dimension)
+      {
+        return update(14695981039346656037ULL, reinterpret_cast<const unsigned char*>(values),
+            dimension * sizeof(T));
+      }
+
+      static uint64_t zeroChecksum(const int& dimension)
+      {
+        const T zero = T(0);
+        uint64_t hash = 14695981039346656037ULL;
+        for (int i = 0; i < dimension; i++)
+          hash = update(hash, reinterpret_cast<const unsigned char*>(&zero), sizeof(T));
+        return hash;
+      }
+
+      void unmap()
+      {
+        if (mapped)
+          munmap(mapped, mappedLength);
+        mapped = 0;
+        mappedLength = 0;
+        // The base class must not release the mapped entries
+        Base::data = 0;
+        Base::capacity = 0;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* !defined(EMBEDDED_MODE) && !defined(_MSC_VER) */
+
+#endif /* MAPPEDVECTOR_H_ */
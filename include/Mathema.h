@@ -51,10 +51,40 @@ namespace RLLib
       template<typename T>
       inline static bool checkDistribution(const Vector<T>* distribution)
       {
-        T sum = T(0);
+        typename Accumulator<T>::type sum(0);
         for (int i = 0; i < distribution->dimension(); i++)
           sum += distribution->getEntry(i);
-        return std::abs(1.0f - sum) < 1e-6f;/*for stability*/
+        // single precision rounding grows with the number of actions
+        const double tolerance = std::max(1e-6,
+            double(distribution->dimension()) * std::numeric_limits<T>::epsilon());
+        return std::abs(1.0 - double(sum)) < tolerance;/*for stability*/
+      }
+  };
+
+  /**
+   * The TD error computed with a single rounding to T (see Accumulator<T>).
+   */
+  template<typename T>
+  class TDError
+  {
+    private:
+      typedef typename Accumulator<T>::type Accumulated;
+
+    public:
+      // delta = r_tp1 + gamma_tp1 * v_tp1 - v_t
+      inline static T compute(const T& r_tp1, const T& gamma_tp1, const T& v_tp1, const T& v_t)
+      {
+        return T(
+            Accumulated(r_tp1) + Accumulated(gamma_tp1) * Accumulated(v_tp1) - Accumulated(v_t));
+      }
+
+      // delta = r_tp1 + gamma_tp1 * v_tp1 - v_t + (1 - gamma_tp1) * z_tp1
+      inline static T compute(const T& r_tp1, const T& gamma_tp1, const T& v_tp1, const T& v_t,
+          const T& z_tp1)
+      {
+        return T(
+            Accumulated(r_tp1) + (Accumulated(1) - Accumulated(gamma_tp1)) * Accumulated(z_tp1)
+                + Accumulated(gamma_tp1) * Accumulated(v_tp1) - Accumulated(v_t));
       }
   };
 
@@ -92,6 +122,23 @@ namespace RLLib
           mix();
       }
 
+      // The four words of the generator, e.g., to resume a sequence
+      void getState(uint32_t* state) const
+      {
+        state[0] = x;
+        state[1] = y;
+        state[2] = z;
+        state[3] = w;
+      }
+
+      void setState(const uint32_t* state)
+      {
+        x = state[0];
+        y = state[1];
+        z = state[2];
+        w = state[3];
+      }
+
       void reseed(uint64_t seed)
       {
         x = 0x498b3bc5 ^ (uint32_t) (seed >> 0);
@@ -157,9 +204,13 @@ namespace RLLib
   {
     private:
       Xorshift xorshift;
+      // The second deviate of nextGaussian(..)
+      T n2;
+      int n2_cached;
 
     public:
-      Random()
+      Random() :
+          n2(0), n2_cached(0)
       {
       }
 
@@ -167,6 +218,22 @@ namespace RLLib
       {
         //::srand(seed);
         xorshift.reseed(seed);
+        n2_cached = 0;
+      }
+
+      // The generator and the cached deviate, e.g., to resume a sequence
+      void getState(uint32_t* state, T& cachedGaussian, bool& isCached) const
+      {
+        xorshift.getState(state);
+        cachedGaussian = n2;
+        isCached = n2_cached != 0;
+      }
+
+      void setState(const uint32_t* state, const T& cachedGaussian, const bool& isCached)
+      {
+        xorshift.setState(state);
+        n2 = cachedGaussian;
+        n2_cached = isCached ? 1 : 0;
       }
 
       inline int rand()
@@ -215,8 +282,6 @@ namespace RLLib
       // http://en.literateprograms.org/Box-Muller_transform_(C)
       inline T nextGaussian(const T& mean, const T& stddev)
       {
-        static T n2 = T(0);
-        static int n2_cached = 0;
         if (!n2_cached)
         {
           T x, y, r;
@@ -325,18 +390,18 @@ namespace RLLib
         ranges.clear();
       }
 
-      Ranges(const Range<T>& that)
+      Ranges(const Ranges<T>& that)
       {
-        for (typename Vectors<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+        for (typename Ranges<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
           ranges.push_back(*iter);
       }
 
       Ranges<T>& operator=(const Ranges<T>& that)
       {
-        if (this != that)
+        if (this != &that)
         {
           ranges.clear();
-          for (typename Vectors<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+          for (typename Ranges<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
             ranges.push_back(*iter);
         }
         return *this;
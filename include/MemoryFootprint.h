@@ -0,0 +1,176 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * MemoryFootprint.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef MEMORYFOOTPRINT_H_
+#define MEMORYFOOTPRINT_H_
+
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <ostream>
+
+namespace RLLib
+{
+  /**
+   * A hierarchical report of the heap memory of the components of an agent.
+   * Each node counts the bytes allocated by one component, e.g., the
+   * capacity of a vector, and the bytes live in it, e.g., the active entries
+   * of a sparse vector; the totals include the children.
+   *
+   * The components add their node with child(..), keyed by their address: a
+   * component shared by others, e.g., a projector used by the
+   * StateToStateAction<T> and by the learner, is counted once, in the first
+   * node that adds it. The objects themselves, a few words each, are not
+   * counted, only the buffers that they own.
+   */
+  class MemoryFootprint
+  {
+    protected:
+      std::string name;
+      size_t allocated;
+      size_t live;
+      std::vector<MemoryFootprint*> children;
+      std::set<const void*>* components; // shared by the nodes of the report
+      bool root;
+
+    public:
+      MemoryFootprint(const std::string& name = "total") :
+          name(name), allocated(0), live(0), components(new std::set<const void*>), root(true)
+      {
+      }
+
+      ~MemoryFootprint()
+      {
+        for (size_t i = 0; i < children.size(); i++)
+          delete children[i];
+        if (root)
+          delete components;
+      }
+
+    private:
+      MemoryFootprint(const std::string& name, std::set<const void*>* components) :
+          name(name), allocated(0), live(0), components(components), root(false)
+      {
+      }
+
+      MemoryFootprint(const MemoryFootprint& that);
+      MemoryFootprint& operator=(const MemoryFootprint& that);
+
+    public:
+      // The node of the component; 0 if the component is already in the report
+      MemoryFootprint* child(const std::string& name, const void* component)
+      {
+        if (component && !components->insert(component).second)
+          return 0;
+        MemoryFootprint* node = new MemoryFootprint(name, components);
+        children.push_back(node);
+        return node;
+      }
+
+      // Counts bytes allocated by this node, of which live are in use
+      void add(const size_t& allocated, const size_t& live)
+      {
+        this->allocated += allocated;
+        this->live += live;
+      }
+
+      const std::string& getName() const
+      {
+        return name;
+      }
+
+      size_t allocatedBytes() const
+      {
+        size_t total = allocated;
+        for (size_t i = 0; i < children.size(); i++)
+          total += children[i]->allocatedBytes();
+        return total;
+      }
+
+      size_t liveBytes() const
+      {
+        size_t total = live;
+        for (size_t i = 0; i < children.size(); i++)
+          total += children[i]->liveBytes();
+        return total;
+      }
+
+      int nbChildren() const
+      {
+        return int(children.size());
+      }
+
+      const MemoryFootprint* getChild(const int& index) const
+      {
+        return children[index];
+      }
+
+      // The node at path, e.g., "control/critic/v"; 0 if none
+      const MemoryFootprint* find(const std::string& path) const
+      {
+        const size_t slash = path.find('/');
+        const std::string first(path, 0, slash);
+        for (size_t i = 0; i < children.size(); i++)
+          if (children[i]->name == first)
+            return slash == std::string::npos ?
+                children[i] : children[i]->find(path.substr(slash + 1));
+        return 0;
+      }
+
+      // One line per node, down to maxDepth (-1: all): the allocated and the live KB
+      void print(std::ostream& out, const int& maxDepth = -1) const
+      {
+        print(out, 0, maxDepth, allocatedBytes());
+      }
+
+      // Clears the report, e.g., to report again after N episodes
+      void clear()
+      {
+        for (size_t i = 0; i < children.size(); i++)
+          delete children[i];
+        children.clear();
+        components->clear();
+        allocated = live = 0;
+      }
+
+    private:
+      void print(std::ostream& out, const int& depth, const int& maxDepth,
+          const size_t& total) const
+      {
+        const size_t allocatedTotal = allocatedBytes(), liveTotal = liveBytes();
+        char line[256];
+        std::snprintf(line, sizeof(line), "%*s%-*s %12.1f KB %12.1f KB live %5.1f%%", 2 * depth,
+            "", 40 - 2 * depth > 0 ? 40 - 2 * depth : 1, name.c_str(), allocatedTotal / 1024.0,
+            liveTotal / 1024.0, total ? 100.0 * allocatedTotal / total : 0.0);
+        out << line << std::endl;
+        if (maxDepth >= 0 && depth >= maxDepth)
+          return;
+        for (size_t i = 0; i < children.size(); i++)
+          children[i]->print(out, depth + 1, maxDepth, total);
+      }
+  };
+
+}  // namespace RLLib
+
+#endif /* MEMORYFOOTPRINT_H_ */
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * PerfCounters.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include <stdint.h>
+
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace RLLib
+{
+  /**
+   * The hardware counters of the calling thread, from perf_event_open(..), in
+   * user space only, so that perf_event_paranoid 2 suffices. The counters are
+   * opened as one group, so that they count over the same intervals; the
+   * counters that the CPU, the VM or the kernel do not support are left out,
+   * and read as 0. open() fails (e.g., EACCES, ENOENT, or not Linux) without
+   * side effects, and the counters are then unavailable.
+   *
+   * A read costs a system call (about 1us), so the counters are only read
+   * when enabled, see Instrumentation::enablePerfCounters(..).
+   */
+  class PerfCounters
+  {
+    public:
+      enum Event
+      {
+        CYCLES, INSTRUCTIONS, LLC_MISSES, L1D_MISSES, BRANCH_MISSES, NB_EVENTS
+      };
+
+    protected:
+      int fds[NB_EVENTS]; // -1: not counted
+      int nbOpened;
+
+    public:
+      PerfCounters() :
+          nbOpened(0)
+      {
+        for (int i = 0; i < NB_EVENTS; i++)
+          fds[i] = -1;
+      }
+
+      ~PerfCounters()
+      {
+        close();
+      }
+
+      static const char* name(const Event& event)
+      {
+        static const char* names[] = { "cycles", "instructions", "LLC-misses", "L1D-misses",
+            "branch-misses" };
+        return names[event];
+      }
+
+      // Opens the group on the calling thread; true if at least one counter counts
+      bool open()
+      {
+        close();
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        int leader = -1;
+        for (int i = 0; i < NB_EVENTS; i++)
+        {
+          perf_event_attr attr;
+          std::memset(&attr, 0, sizeof(attr));
+          attr.size = sizeof(attr);
+          config(Event(i), attr);
+          attr.disabled = leader == -1;
+          attr.exclude_kernel = 1;
+          attr.exclude_hv = 1;
+          attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+              | PERF_FORMAT_TOTAL_TIME_RUNNING;
+          fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+          if (fds[i] == -1)
+            continue;
+          if (leader == -1)
+            leader = fds[i];
+          ++nbOpened;
+        }
+        if (leader != -1)
+        {
+          ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+          ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+        return nbOpened > 0;
+      }
+
+      void close()
+      {
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        // The members first, the leader last
+        for (int i = NB_EVENTS - 1; i >= 0; i--)
+          if (fds[i] != -1)
+            ::close(fds[i]);
+#endif
+        for (int i = 0; i < NB_EVENTS; i++)
+          fds[i] = -1;
+        nbOpened = 0;
+      }
+
+      bool isOpen() const
+      {
+        return nbOpened > 0;
+      }
+
+      bool isAvailable(const Event& event) const
+      {
+        return fds[event] != -1;
+      }
+
+      /**
+       * The counts since open(), scaled up when the kernel multiplexed the
+       * group with other groups; the unavailable events are 0.
+       */
+      bool read(uint64_t values[NB_EVENTS]) const
+      {
+        for (int i = 0; i < NB_EVENTS; i++)
+          values[i] = 0;
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+        if (!nbOpened)
+          return false;
+        // nr, time enabled, time running, then the values in the order of opening
+        uint64_t buffer[3 + NB_EVENTS];
+        int leader = 0;
+        while (fds[leader] == -1)
+          ++leader;
+        const ssize_t size = ::read(fds[leader], buffer, sizeof(buffer));
+        if (size < ssize_t(3 * sizeof(uint64_t)) || int(buffer[0]) != nbOpened)
+          return false;
+        const double scale = (buffer[2] && buffer[2] < buffer[1]) ?
+            double(buffer[1]) / buffer[2] : 1.0;
+        for (int i = 0, j = 3; i < NB_EVENTS; i++)
+          if (fds[i] != -1)
+            values[i] = scale == 1.0 ? buffer[j++] : uint64_t(buffer[j++] * scale);
+        return true;
+#else
+        return false;
+#endif
+      }
+
+    private:
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+      static void config(const Event& event, perf_event_attr& attr)
+      {
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (event)
+        {
+          case CYCLES:
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+          case INSTRUCTIONS:
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+          case LLC_MISSES:
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+          case L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+          default:
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        }
+      }
+#endif
+
+      // Not copyable: the descriptors belong to one thread
+      PerfCounters(const PerfCounters&);
+      PerfCounters& operator=(const PerfCounters&);
+  };
+
+}  // namespace RLLib
+
+#endif /* PERFCOUNTERS_H_ */
@@ -31,7 +31,7 @@
 namespace RLLib
 {
   template<typename T>
-  class Policy
+  class Policy: public ArenaAllocated
   {
     public:
       virtual ~Policy()
@@ -41,6 +41,12 @@ namespace RLLib
       virtual T pi(const Action<T>* a) =0;
       virtual const Action<T>* sampleAction() =0;
       virtual const Action<T>* sampleBestAction() =0;
+
+      // Adds the node name of this policy, with its buffers, to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        footprint->child(name, this);
+      }
   };
 
   class Policies
@@ -128,9 +134,22 @@ namespace RLLib
         delete multigrad;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        u_mean->memoryFootprint(node, "u_mean");
+        u_stddev->memoryFootprint(node, "u_stddev");
+        gradMean->memoryFootprint(node, "gradMean");
+        gradStddev->memoryFootprint(node, "gradStddev");
+        x->memoryFootprint(node, "x");
+      }
+
     public:
       void update(const Representations<T>* phi)
       {
+        RLLIB_PROBE(POLICY);
         // N(mu,var) for single action, single representation only
         ASSERT((phi->dimension() == 1) && (actions->dimension() == 1));
         x->set(phi->at(actions->getEntry(defaultAction)));
@@ -258,6 +277,13 @@ namespace RLLib
         delete a_t;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          policy->memoryFootprint(node, "policy");
+      }
+
     private:
       // From (c, a, min(), max()) to (0, a', -1, 1)
       T normalize(const Range<T>* range, const T& a)
@@ -338,6 +364,13 @@ namespace RLLib
         delete distribution;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          distribution->memoryFootprint(node, "distribution");
+      }
+
       T pi(const Action<T>* action)
       {
         return distribution->at(action->id());
@@ -393,8 +426,20 @@ namespace RLLib
         delete multigrad;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        Base::distribution->memoryFootprint(node, "distribution");
+        avg->memoryFootprint(node, "avg");
+        grad->memoryFootprint(node, "grad");
+        u->memoryFootprint(node, "u");
+      }
+
       void update(const Representations<T>* phi)
       {
+        RLLIB_PROBE(POLICY);
         ASSERT(Base::actions->dimension() == phi->dimension());
         Base::distribution->clear();
         avg->clear();
@@ -479,6 +524,7 @@ namespace RLLib
 
       void update(const Representations<T>* phi)
       {
+        RLLIB_PROBE(POLICY);
         ASSERT(Base::actions->dimension() == phi->dimension());
         Base::distribution->clear();
         T sum = T(0);
@@ -573,6 +619,13 @@ namespace RLLib
         delete distribution;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          distribution->memoryFootprint(node, "distribution");
+      }
+
       void update(const Representations<T>* phi)
       {
         // 50% prev action
@@ -635,14 +688,22 @@ namespace RLLib
 
     public:
       Greedy(Actions<T>* actions, Predictor<T>* predictor) :
-          actions(actions), predictor(predictor), actionValues(new T[actions->dimension()]), //
-          bestValue(0.0f), bestAction(0)
+          actions(actions), predictor(predictor), //
+          actionValues(Arena::newArray<T>(actions->dimension())), bestValue(0.0f), bestAction(0)
       {
       }
 
       virtual ~Greedy()
       {
-        delete[] actionValues;
+        Arena::deleteArray(actionValues);
+      }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          node->child("actionValues", 0)->add(actions->dimension() * sizeof(T),
+              actions->dimension() * sizeof(T));
       }
 
     private:
@@ -675,6 +736,7 @@ namespace RLLib
 
       void update(const Representations<T>* phi_tp1)
       {
+        RLLIB_PROBE(POLICY);
         updateActionValues(phi_tp1);
         findBestAction();
       }
@@ -756,8 +818,16 @@ namespace RLLib
         delete distribution;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          distribution->memoryFootprint(node, "distribution");
+      }
+
       void update(const Representations<T>* phis)
       {
+        RLLIB_PROBE(POLICY);
         ASSERT(actions->dimension() == phis->dimension());
         distribution->clear();
         T sum = T(0);
@@ -62,8 +62,9 @@ namespace RLLib
       virtual T update(const Vector<T>* x_t, const Vector<T>* x_tp1, const T& r_tp1,
           const T& gamma_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(initialized);
-        delta_t = r_tp1 + gamma_tp1 * v->dot(x_tp1) - v->dot(x_t);
+        delta_t = TDError<T>::compute(r_tp1, gamma_tp1, v->dot(x_tp1), v->dot(x_t));
         v->addToSelf(alpha_v * delta_t, x_t);
         return delta_t;
       }
@@ -94,6 +95,12 @@ namespace RLLib
         v->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("v", v);
+        archive->add("alpha_v", alpha_v);
+      }
+
       Vector<T>* weights() const
       {
         return v;
@@ -133,6 +140,13 @@ namespace RLLib
         gamma_t = Base::gamma;
         e->clear();
       }
+
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->add("e", e->vect());
+        archive->add("gamma_t", gamma_t);
+      }
   };
 
   template<typename T>
@@ -154,8 +168,10 @@ namespace RLLib
     public:
       T update(const Vector<T>* x_t, const Vector<T>* x_tp1, const T& r_tp1, const T& gamma_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(TD<T>::initialized);
-        TD<T>::delta_t = r_tp1 + gamma_tp1 * TD<T>::v->dot(x_tp1) - TD<T>::v->dot(x_t);
+        TD<T>::delta_t = TDError<T>::compute(r_tp1, gamma_tp1, TD<T>::v->dot(x_tp1),
+            TD<T>::v->dot(x_t));
         Base::e->update(Base::lambda * Base::gamma_t, x_t, TD<T>::alpha_v);
         TD<T>::v->addToSelf(TD<T>::delta_t, Base::e->vect());
         Base::gamma_t = gamma_tp1;
@@ -191,10 +207,11 @@ namespace RLLib
 
       T update(const Vector<T>* x_t, const Vector<T>* x_tp1, const T& r_tp1, const T& gamma_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(TD<T>::initialized);
         v_t = TD<T>::v->dot(x_t);
         v_tp1 = TD<T>::v->dot(x_tp1);
-        TD<T>::delta_t = r_tp1 + gamma_tp1 * v_tp1 - v_t;
+        TD<T>::delta_t = TDError<T>::compute(r_tp1, gamma_tp1, v_tp1, v_t);
 
         Base::e->update(Base::gamma_t * Base::lambda, x_t,
             (T(1) - TD<T>::alpha_v * Base::gamma_t * Base::lambda * Base::e->vect()->dot(x_t)));
@@ -206,6 +223,11 @@ namespace RLLib
         return TD<T>::delta_t;
       }
 
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->add("v_old", v_old);
+      }
   };
 
   template<typename T>
@@ -247,8 +269,10 @@ namespace RLLib
     public:
       T update(const Vector<T>* x_t, const Vector<T>* x_tp1, const T& r_tp1, const T& gamma_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(TD<T>::initialized);
-        TD<T>::delta_t = r_tp1 + gamma_tp1 * TD<T>::v->dot(x_tp1) - TD<T>::v->dot(x_t);
+        TD<T>::delta_t = TDError<T>::compute(r_tp1, gamma_tp1, TD<T>::v->dot(x_tp1),
+            TD<T>::v->dot(x_t));
         Base::e->update(Base::lambda * Base::gamma_t, x_t);
         updateAlpha(x_t, x_tp1, gamma_tp1);
         TD<T>::v->addToSelf(TD<T>::alpha_v * TD<T>::delta_t, Base::e->vect());
@@ -290,11 +314,12 @@ namespace RLLib
 
       virtual T update(const Vector<T>* phi_t, const Vector<T>* phi_tp1, const T& r_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(initialized);
         v_t = q->dot(phi_t);
         v_tp1 = q->dot(phi_tp1);
         e->update(gamma * lambda, phi_t, alpha);
-        delta = r_tp1 + gamma * v_tp1 - v_t;
+        delta = TDError<T>::compute(r_tp1, gamma, v_tp1, v_t);
         q->addToSelf(delta, e->vect());
         return delta;
       }
@@ -321,6 +346,13 @@ namespace RLLib
         q->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("q", q);
+        archive->add("e", e->vect());
+        archive->add("alpha", alpha);
+      }
+
       Vector<T>* weights() const
       {
         return q;
@@ -354,11 +386,12 @@ namespace RLLib
 
       T update(const Vector<T>* phi_t, const Vector<T>* phi_tp1, const T& r_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(Base::initialized);
 
         Base::v_t = Base::q->dot(phi_t);
         Base::v_tp1 = Base::q->dot(phi_tp1);
-        Base::delta = r_tp1 + Base::gamma * Base::v_tp1 - Base::v_t;
+        Base::delta = TDError<T>::compute(r_tp1, Base::gamma, Base::v_tp1, Base::v_t);
 
         Base::e->update(Base::gamma * Base::lambda, phi_t,
             (T(1) - Base::alpha * Base::gamma * Base::lambda * Base::e->vect()->dot(phi_t)));
@@ -368,6 +401,12 @@ namespace RLLib
         v_old = Base::v_tp1;
         return Base::delta;
       }
+
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->add("v_old", v_old);
+      }
   };
 
   template<typename T>
@@ -411,11 +450,12 @@ namespace RLLib
     public:
       T update(const Vector<T>* phi_t, const Vector<T>* phi_tp1, const T& r_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(Base::initialized);
         Base::v_t = Base::q->dot(phi_t);
         Base::v_tp1 = Base::q->dot(phi_tp1);
         Base::e->update(Base::gamma * Base::lambda, phi_t);
-        Base::delta = r_tp1 + Base::gamma * Base::v_tp1 - Base::v_t;
+        Base::delta = TDError<T>::compute(r_tp1, Base::gamma, Base::v_tp1, Base::v_t);
         updateAlpha(phi_t, phi_tp1);
         Base::q->addToSelf(Base::alpha * Base::delta, Base::e->vect());
         return Base::delta;
@@ -460,9 +500,9 @@ namespace RLLib
       T update(const Vector<T>* phi_t, const Vector<T>* phi_bar_tp1, const T& gamma_tp1,
           const T& lambda_tp1, const T& rho_t, const T& r_tp1, const T& z_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         ASSERT(initialized);
-        delta_t = //
-            r_tp1 + (T(1) - gamma_tp1) * z_tp1 + gamma_tp1 * v->dot(phi_bar_tp1) - v->dot(phi_t);
+        delta_t = TDError<T>::compute(r_tp1, gamma_tp1, v->dot(phi_bar_tp1), v->dot(phi_t), z_tp1);
         e->update(gamma_t * lambda_t * rho_t, phi_t);
         // v
         // part 1
@@ -515,11 +555,26 @@ namespace RLLib
         v->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("v", v);
+        archive->add("w", w);
+        archive->add("e", e->vect());
+        archive->add("gamma_t", gamma_t);
+        archive->add("lambda_t", lambda_t);
+      }
+
       Vector<T>* weights() const
       {
         return v;
       }
 
+      // The auxiliary weights of the gradient correction
+      Vector<T>* secondaryWeights() const
+      {
+        return w;
+      }
+
       void set_gamma_tp1(const T& gamma_tp1)
       {
         this->gamma_tp1 = gamma_tp1;
@@ -601,11 +656,26 @@ namespace RLLib
         v->resurrect(f);
       }
 
+    public:
+      void accept(Archive<T>* archive)
+      {
+        archive->add("v", v);
+        archive->add("w", w);
+        archive->add("e", e->vect());
+        archive->add("gamma_t", gamma_t);
+        archive->add("lambda_t", lambda_t);
+      }
+
       Vector<T>* weights() const
       {
         return v;
       }
 
+      // The auxiliary weights of the gradient correction
+      Vector<T>* secondaryWeights() const
+      {
+        return w;
+      }
   };
 
 // Prediction problems
@@ -625,8 +695,9 @@ namespace RLLib
       T update(const Vector<T>* phi_t, const Vector<T>* phi_tp1, const T& gamma_tp1,
           const T& lambda_tp1, const T& rho_t, const T& r_tp1, const T& z_tp1)
       {
-        Base::delta_t = r_tp1 + (T(1) - gamma_tp1) * z_tp1 + gamma_tp1 * Base::v->dot(phi_tp1)
-            - Base::v->dot(phi_t);
+        RLLIB_PROBE(LEARNER);
+        Base::delta_t = TDError<T>::compute(r_tp1, gamma_tp1, Base::v->dot(phi_tp1),
+            Base::v->dot(phi_t), z_tp1);
         Base::e->update(Base::gamma_t * Base::lambda_t, phi_t);
         Base::e->vect()->mapMultiplyToSelf(rho_t);
 
@@ -683,9 +754,10 @@ namespace RLLib
       T update(const Vector<T>* phi_t, const Vector<T>* phi_tp1, const T& gamma_tp1,
           const T& lambda_tp1, const T& rho_t, const T& r_tp1, const T& z_tp1)
       {
+        RLLIB_PROBE(LEARNER);
         v_t = Base::v->dot(phi_t);
         v_tp1 = Base::v->dot(phi_tp1);
-        Base::delta_t = r_tp1 + (T(1) - gamma_tp1) * z_tp1 + gamma_tp1 * v_tp1 - v_t;
+        Base::delta_t = TDError<T>::compute(r_tp1, gamma_tp1, v_tp1, v_t, z_tp1);
 
         // e
         Base::e->update(Base::gamma_t * Base::lambda_t, phi_t, Base::alpha_v * //
@@ -731,6 +803,14 @@ namespace RLLib
         rho_tm1 = 0;
       }
 
+      void accept(Archive<T>* archive)
+      {
+        Base::accept(archive);
+        archive->add("e_d", e_d->vect());
+        archive->add("e_w", e_w->vect());
+        archive->add("v_old", v_old);
+        archive->add("rho_tm1", rho_tm1);
+      }
   };
 
 } // namespace RLLib
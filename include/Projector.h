@@ -25,6 +25,7 @@
 #include "Action.h"
 #include "Tiles.h"
 #include "Vector.h"
+#include "Instrumentation.h"
 
 namespace RLLib
 {
@@ -34,7 +35,7 @@ namespace RLLib
    * @class T feature type
    */
   template<typename T>
-  class Projector
+  class Projector: public ArenaAllocated
   {
     public:
       virtual ~Projector()
@@ -44,6 +45,18 @@ namespace RLLib
       virtual const Vector<T>* project(const Vector<T>* x) =0;
       virtual T vectorNorm() const =0;
       virtual int dimension() const =0;
+
+      // An empty vector of the type of the projections, e.g., to buffer one
+      virtual Vector<T>* newVector() const
+      {
+        return new SVector<T>(dimension());
+      }
+
+      // Adds the node name of this projector, with its buffers, to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        footprint->child(name, this);
+      }
   };
 
   /**
@@ -77,6 +90,7 @@ namespace RLLib
 
       const Vector<T>* project(const Vector<T>* x, const int& h1)
       {
+        RLLIB_PROBE(PROJECTION);
         vector->clear();
         if (x->empty())
           return vector;
@@ -92,6 +106,7 @@ namespace RLLib
 
       const Vector<T>* project(const Vector<T>* x)
       {
+        RLLIB_PROBE(PROJECTION);
         vector->clear();
         if (x->empty())
           return vector;
@@ -115,6 +130,23 @@ namespace RLLib
         return vector->dimension();
       }
 
+      int getNbTilings() const
+      {
+        return nbTilings;
+      }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          vector->memoryFootprint(node, "phi");
+      }
+
+      bool isIncludeActiveFeature() const
+      {
+        return includeActiveFeature;
+      }
+
   };
 
   template<typename T>
@@ -151,6 +183,27 @@ namespace RLLib
         delete tiles;
       }
 
+      const Vector<T>* getGridResolutions() const
+      {
+        return gridResolutions;
+      }
+
+      Hashing<T>* getHashing() const
+      {
+        return tiles->getHashing();
+      }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        Base::vector->memoryFootprint(node, "phi");
+        gridResolutions->memoryFootprint(node, "gridResolutions");
+        inputs->memoryFootprint(node, "inputs");
+        tiles->memoryFootprint(node, "tiles");
+      }
+
       void coder(const Vector<T>* x)
       {
         inputs->clear();
@@ -0,0 +1,573 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QuantizedVector.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef QUANTIZEDVECTOR_H_
+#define QUANTIZEDVECTOR_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <cmath>
+
+#include "Vector.h"
+#include "Predictor.h"
+
+namespace RLLib
+{
+
+  /**
+   * IEEE 754 half precision (fp16) and bfloat16 encodings. Both conversions
+   * round to the nearest even value.
+   */
+  class HalfPrecision
+  {
+    public:
+      static uint16_t floatToHalf(const float& value)
+      {
+        uint32_t f;
+        std::memcpy(&f, &value, sizeof(f));
+        const uint32_t sign = (f >> 16) & 0x8000;
+        const uint32_t exponent = (f >> 23) & 0xff;
+        uint32_t mantissa = f & 0x7fffff;
+        if (exponent == 0xff) // inf or nan
+          return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+        const int e = int(exponent) - 127 + 15;
+        if (e >= 31) // overflow
+          return sign | 0x7c00;
+        if (e <= 0) // subnormal or zero
+        {
+          if (e < -10)
+            return sign;
+          mantissa |= 0x800000;
+          const int shift = 14 - e;
+          uint32_t half = mantissa >> shift;
+          const uint32_t remainder = mantissa & ((1u << shift) - 1);
+          const uint32_t middle = 1u << (shift - 1);
+          if (remainder > middle || (remainder == middle && (half & 1)))
+            ++half;
+          return sign | half;
+        }
+        uint32_t half = (uint32_t(e) << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1fff;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+          ++half; // a carry into the exponent correctly rounds up to inf
+        return sign | half;
+      }
+
+      static float halfToFloat(const uint16_t& half)
+      {
+        const uint32_t sign = uint32_t(half & 0x8000) << 16;
+        const uint32_t exponent = (half >> 10) & 0x1f;
+        const uint32_t mantissa = half & 0x3ff;
+        uint32_t f;
+        if (exponent == 0)
+        {
+          const float value = float(mantissa) * 5.9604644775390625e-8f; // 2^-24
+          return sign ? -value : value;
+        }
+        else if (exponent == 31)
+          f = sign | 0x7f800000 | (mantissa << 13);
+        else
+          f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        float value;
+        std::memcpy(&value, &f, sizeof(value));
+        return value;
+      }
+
+      static uint16_t floatToBFloat16(const float& value)
+      {
+        uint32_t f;
+        std::memcpy(&f, &value, sizeof(f));
+        if ((f & 0x7fffffff) > 0x7f800000) // nan stays a (quiet) nan
+          return uint16_t((f >> 16) | 0x40);
+        f += 0x7fff + ((f >> 16) & 1);
+        return uint16_t(f >> 16);
+      }
+
+      static float bfloat16ToFloat(const uint16_t& bfloat16)
+      {
+        const uint32_t f = uint32_t(bfloat16) << 16;
+        float value;
+        std::memcpy(&value, &f, sizeof(value));
+        return value;
+      }
+  };
+
+  /**
+   * Read-mostly, reduced precision storage for a weight vector. The dot products
+   * consume the sparse features of the projectors directly, decoding only the
+   * entries that are gathered. Use set(..) to quantize a full precision vector.
+   */
+  template<typename T>
+  class QuantizedVector
+  {
+    public:
+      enum QuantizedType
+      {
+        INT8_QUANTIZED, FLOAT16_QUANTIZED, BFLOAT16_QUANTIZED
+      };
+
+    protected:
+      QuantizedType quantizedType;
+      int capacity;
+
+      QuantizedVector(const QuantizedType& quantizedType, const int& capacity) :
+          quantizedType(quantizedType), capacity(capacity)
+      {
+      }
+
+    public:
+      virtual ~QuantizedVector()
+      {
+      }
+
+      int dimension() const
+      {
+        return capacity;
+      }
+
+      QuantizedType getQuantizedType() const
+      {
+        return quantizedType;
+      }
+
+      virtual T getEntry(const int& index) const =0;
+      virtual T dot(const Vector<T>* that) const =0;
+      virtual QuantizedVector<T>* set(const Vector<T>* that) =0;
+      // Number of bytes used by the weights and the scale factors
+      virtual size_t sizeInBytes() const =0;
+
+#if !defined(EMBEDDED_MODE)
+      void persist(const char* f) const
+      {
+        std::ofstream of;
+        of.open(f, std::ofstream::out | std::ofstream::binary);
+        if (of.is_open())
+        {
+          int type = quantizedType;
+          write(of, type);
+          write(of, capacity);
+          persistData(of);
+          of.close();
+        }
+        else
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+      }
+
+      void resurrect(const char* f)
+      {
+        std::ifstream ifs;
+        ifs.open(f, std::ifstream::in | std::ifstream::binary);
+        if (ifs.is_open())
+        {
+          int type;
+          read(ifs, type);
+          read(ifs, capacity);
+          if (!ifs || type != quantizedType || capacity <= 0)
+          {
+            std::cerr << "ERROR! (resurrect) not a compatible quantized vector, file=" << f
+                << std::endl;
+            exit(-1);
+          }
+          resurrectData(ifs);
+          ifs.close();
+        }
+        else
+        {
+          std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+          exit(-1);
+        }
+      }
+
+    protected:
+      virtual void persistData(std::ostream& o) const =0;
+      virtual void resurrectData(std::istream& i) =0;
+
+      template<class U> void write(std::ostream &o, U& value) const
+      {
+        char *s = (char *) &value;
+        o.write(s, sizeof(value));
+      }
+
+      template<class U> void read(std::istream &i, U& value) const
+      {
+        char *s = (char *) &value;
+        i.read(s, sizeof(value));
+      }
+
+      // Exits unless the stream holds exactly the given number of bytes past its position
+      static void checkRemaining(std::istream& i, const uint64_t& nbBytes)
+      {
+        const std::streampos position = i.tellg();
+        i.seekg(0, std::istream::end);
+        const std::streampos end = i.tellg();
+        i.seekg(position);
+        if (!i || position < 0 || uint64_t(end - position) != nbBytes)
+        {
+          std::cerr << "ERROR! (resurrect) the data does not match the dimension" << std::endl;
+          exit(-1);
+        }
+      }
+#endif
+  };
+
+  /**
+   * Symmetric int8 quantization with one scale factor for each block of
+   * 2^blockShift consecutive weights. Hashed tile coding spreads the weights of
+   * a state uniformly, so small blocks keep the outliers of one tile from
+   * flattening the rest of the table.
+   */
+  template<typename T>
+  class Int8Vector: public QuantizedVector<T>
+  {
+    private:
+      typedef QuantizedVector<T> Base;
+    protected:
+      int blockShift;
+      int nbBlocks;
+      int8_t* data;
+      float* scales;
+
+    public:
+      Int8Vector(const int& capacity = 1, const int& blockShift = 6) :
+          QuantizedVector<T>(Base::INT8_QUANTIZED, capacity), blockShift(blockShift), //
+          nbBlocks(((capacity - 1) >> blockShift) + 1), data(new int8_t[capacity]), //
+          scales(new float[nbBlocks])
+      {
+        std::fill(data, data + capacity, 0);
+        std::fill(scales, scales + nbBlocks, 0.0f);
+      }
+
+      virtual ~Int8Vector()
+      {
+        delete[] data;
+        delete[] scales;
+      }
+
+      T getEntry(const int& index) const
+      {
+        ASSERT(index >= 0 && index < Base::capacity);
+        return T(scales[index >> blockShift]) * T(data[index]);
+      }
+
+      T dot(const Vector<T>* that) const
+      {
+        ASSERT(Base::capacity == that->dimension());
+        T result = T(0);
+        const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
+        if (other)
+        {
+          const int* indexes = other->nonZeroIndexes();
+          const T* values = other->getValues();
+          for (int position = 0; position < other->nonZeroElements(); position++)
+          {
+            const int index = indexes[position];
+            result += values[position] * T(scales[index >> blockShift]) * T(data[index]);
+          }
+          return result;
+        }
+        for (int i = 0; i < Base::capacity; i++)
+          result += that->getEntry(i) * T(scales[i >> blockShift]) * T(data[i]);
+        return result;
+      }
+
+      QuantizedVector<T>* set(const Vector<T>* that)
+      {
+        ASSERT(Base::capacity == that->dimension());
+        for (int block = 0; block < nbBlocks; block++)
+        {
+          const int begin = block << blockShift;
+          const int end = std::min(Base::capacity, begin + (1 << blockShift));
+          T maxAbs = T(0);
+          for (int i = begin; i < end; i++)
+            maxAbs = std::max(maxAbs, T(std::fabs(that->getEntry(i))));
+          scales[block] = float(maxAbs / T(127));
+          const T inverseScale = maxAbs > T(0) ? T(127) / maxAbs : T(0);
+          for (int i = begin; i < end; i++)
+          {
+            const long q = lround(that->getEntry(i) * inverseScale);
+            data[i] = int8_t(std::max(-127L, std::min(127L, q)));
+          }
+        }
+        return this;
+      }
+
+      size_t sizeInBytes() const
+      {
+        return Base::capacity * sizeof(int8_t) + nbBlocks * sizeof(float);
+      }
+
+      int getBlockSize() const
+      {
+        return 1 << blockShift;
+      }
+
+#if !defined(EMBEDDED_MODE)
+    protected:
+      void persistData(std::ostream& o) const
+      {
+        int shift = blockShift;
+        Base::write(o, shift);
+        o.write((const char*) scales, nbBlocks * sizeof(float));
+        o.write((const char*) data, Base::capacity * sizeof(int8_t));
+      }
+
+      void resurrectData(std::istream& i)
+      {
+        Base::read(i, blockShift);
+        if (!i || blockShift < 0 || blockShift > 30)
+        {
+          std::cerr << "ERROR! (resurrect) blockShift=" << blockShift << std::endl;
+          exit(-1);
+        }
+        nbBlocks = ((Base::capacity - 1) >> blockShift) + 1;
+        Base::checkRemaining(i,
+            uint64_t(Base::capacity) * sizeof(int8_t) + uint64_t(nbBlocks) * sizeof(float));
+        delete[] data;
+        delete[] scales;
+        data = new int8_t[Base::capacity];
+        scales = new float[nbBlocks];
+        i.read((char*) scales, nbBlocks * sizeof(float));
+        i.read((char*) data, Base::capacity * sizeof(int8_t));
+      }
+#endif
+  };
+
+  /**
+   * Shared storage for the 16 bit encodings.
+   */
+  template<typename T, float (*decode)(const uint16_t&), uint16_t (*encode)(const float&)>
+  class HalfVector: public QuantizedVector<T>
+  {
+    private:
+      typedef QuantizedVector<T> Base;
+    protected:
+      uint16_t* data;
+
+    public:
+      HalfVector(const typename Base::QuantizedType& quantizedType, const int& capacity) :
+          QuantizedVector<T>(quantizedType, capacity), data(new uint16_t[capacity])
+      {
+        std::fill(data, data + capacity, 0);
+      }
+
+      virtual ~HalfVector()
+      {
+        delete[] data;
+      }
+
+      T getEntry(const int& index) const
+      {
+        ASSERT(index >= 0 && index < Base::capacity);
+        return T(decode(data[index]));
+      }
+
+      T dot(const Vector<T>* that) const
+      {
+        ASSERT(Base::capacity == that->dimension());
+        T result = T(0);
+        const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
+        if (other)
+        {
+          const int* indexes = other->nonZeroIndexes();
+          const T* values = other->getValues();
+          for (int position = 0; position < other->nonZeroElements(); position++)
+            result += values[position] * T(decode(data[indexes[position]]));
+          return result;
+        }
+        for (int i = 0; i < Base::capacity; i++)
+          result += that->getEntry(i) * T(decode(data[i]));
+        return result;
+      }
+
+      QuantizedVector<T>* set(const Vector<T>* that)
+      {
+        ASSERT(Base::capacity == that->dimension());
+        for (int i = 0; i < Base::capacity; i++)
+          data[i] = encode(float(that->getEntry(i)));
+        return this;
+      }
+
+      size_t sizeInBytes() const
+      {
+        return Base::capacity * sizeof(uint16_t);
+      }
+
+#if !defined(EMBEDDED_MODE)
+    protected:
+      void persistData(std::ostream& o) const
+      {
+        o.write((const char*) data, Base::capacity * sizeof(uint16_t));
+      }
+
+      void resurrectData(std::istream& i)
+      {
+        Base::checkRemaining(i, uint64_t(Base::capacity) * sizeof(uint16_t));
+        delete[] data;
+        data = new uint16_t[Base::capacity];
+        i.read((char*) data, Base::capacity * sizeof(uint16_t));
+      }
+#endif
+  };
+
+  template<typename T>
+  class Float16Vector: public HalfVector<T, HalfPrecision::halfToFloat, HalfPrecision::floatToHalf>
+  {
+    public:
+      Float16Vector(const int& capacity = 1) :
+          HalfVector<T, HalfPrecision::halfToFloat, HalfPrecision::floatToHalf>(
+              QuantizedVector<T>::FLOAT16_QUANTIZED, capacity)
+      {
+      }
+  };
+
+  template<typename T>
+  class BFloat16Vector: public HalfVector<T, HalfPrecision::bfloat16ToFloat,
+      HalfPrecision::floatToBFloat16>
+  {
+    public:
+      BFloat16Vector(const int& capacity = 1) :
+          HalfVector<T, HalfPrecision::bfloat16ToFloat, HalfPrecision::floatToBFloat16>(
+              QuantizedVector<T>::BFLOAT16_QUANTIZED, capacity)
+      {
+      }
+  };
+
+  /**
+   * Offline construction and conversion of quantized weights.
+   */
+  template<typename T>
+  class Quantizer
+  {
+    public:
+      static QuantizedVector<T>* newInstance(const typename QuantizedVector<T>::QuantizedType& type,
+          const int& capacity)
+      {
+        switch (type)
+        {
+          case QuantizedVector<T>::INT8_QUANTIZED:
+            return new Int8Vector<T>(capacity);
+          case QuantizedVector<T>::FLOAT16_QUANTIZED:
+            return new Float16Vector<T>(capacity);
+          case QuantizedVector<T>::BFLOAT16_QUANTIZED:
+            return new BFloat16Vector<T>(capacity);
+        }
+        return 0;
+      }
+
+      static QuantizedVector<T>* quantize(const typename QuantizedVector<T>::QuantizedType& type,
+          const Vector<T>* that)
+      {
+        QuantizedVector<T>* result = newInstance(type, that->dimension());
+        result->set(that);
+        return result;
+      }
+
+#if !defined(EMBEDDED_MODE)
+      // Converts a PVector<T> written with persist(..) into a quantized weight file.
+      static void convert(const char* pvectorFile, const char* quantizedFile,
+          const typename QuantizedVector<T>::QuantizedType& type)
+      {
+        PVector<T> weights;
+        weights.resurrect(pvectorFile);
+        QuantizedVector<T>* result = quantize(type, &weights);
+        result->persist(quantizedFile);
+        delete result;
+      }
+
+      static QuantizedVector<T>* resurrect(const char* quantizedFile)
+      {
+        std::ifstream ifs;
+        ifs.open(quantizedFile, std::ifstream::in | std::ifstream::binary);
+        if (!ifs.is_open())
+        {
+          std::cerr << "ERROR! (resurrect) file=" << quantizedFile << std::endl;
+          exit(-1);
+        }
+        int type = -1;
+        ifs.read((char*) &type, sizeof(type));
+        ifs.close();
+        if (type < QuantizedVector<T>::INT8_QUANTIZED
+            || type > QuantizedVector<T>::BFLOAT16_QUANTIZED)
+        {
+          std::cerr << "ERROR! (resurrect) unknown quantized type=" << type << ", file="
+              << quantizedFile << std::endl;
+          exit(-1);
+        }
+        QuantizedVector<T>* result = newInstance(
+            typename QuantizedVector<T>::QuantizedType(type), 1);
+        result->resurrect(quantizedFile);
+        return result;
+      }
+#endif
+  };
+
+  /**
+   * Inference-only linear predictor on top of quantized weights. It can replace
+   * the learner as the predictor of Greedy<T>, e.g., to evaluate a frozen agent.
+   */
+  template<typename T>
+  class QuantizedPredictor: public Predictor<T>
+  {
+    protected:
+      const QuantizedVector<T>* q;
+      mutable PVector<T>* decoded;
+
+    public:
+      QuantizedPredictor(const QuantizedVector<T>* q) :
+          q(q), decoded(0)
+      {
+      }
+
+      virtual ~QuantizedPredictor()
+      {
+        delete decoded;
+      }
+
+      T predict(const Vector<T>* x) const
+      {
+        return q->dot(x);
+      }
+
+      /**
+       * The decoded weights, in full precision. They are decoded on the first
+       * call, which costs the memory the quantization saves; predict(..) only
+       * uses the quantized weights.
+       */
+      Vector<T>* weights() const
+      {
+        if (!decoded)
+        {
+          decoded = new PVector<T>(q->dimension());
+          for (int i = 0; i < q->dimension(); i++)
+            decoded->setEntry(i, q->getEntry(i));
+        }
+        return decoded;
+      }
+
+      const QuantizedVector<T>* quantizedWeights() const
+      {
+        return q;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* QUANTIZEDVECTOR_H_ */
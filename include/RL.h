@@ -26,15 +26,25 @@
 #include <typeinfo>
 #endif
 
+#include <algorithm>
+
 #include "Vector.h"
 #include "Action.h"
 #include "Mathema.h"
 #include "Control.h"
+#include "Instrumentation.h"
+#include "Histogram.h"
 
 #if !defined(EMBEDDED_MODE)
 #include "Timer.h"
 #endif
 
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 namespace RLLib
 {
 
@@ -74,7 +84,7 @@ namespace RLLib
   };
 
   template<typename T>
-  class RLAgent
+  class RLAgent: public ArenaAllocated
   {
     protected:
       Control<T>* control;
@@ -92,6 +102,11 @@ namespace RLLib
       virtual const Action<T>* getAtp1(const TRStep<T>* step) =0;
       virtual void reset() =0;
 
+      // Completes the work deferred by getAtp1(..), while the problem is busy
+      virtual void flush()
+      {
+      }
+
       virtual Control<T>* getRLAgent() const
       {
         return control;
@@ -101,6 +116,14 @@ namespace RLLib
       {
         return control->computeValueFunction(x);
       }
+
+      // Adds the node name, with the control, to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          control->memoryFootprint(node, "control");
+      }
   };
 
   template<typename T>
@@ -134,8 +157,13 @@ namespace RLLib
 
       const Action<T>* getAtp1(const TRStep<T>* step)
       {
-        const Action<T>* a_tp1 = Base::control->step(x_t, a_t,
-            (step->endOfEpisode ? absorbingState : step->o_tp1), step->r_tp1, step->z_tp1);
+        const Action<T>* a_tp1;
+        {
+          // The update and the next action are one step of the control
+          RLLIB_TIMELINE("learn");
+          a_tp1 = Base::control->step(x_t, a_t,
+              (step->endOfEpisode ? absorbingState : step->o_tp1), step->r_tp1, step->z_tp1);
+        }
         a_t = a_tp1;
         Vectors<T>::bufferedCopy(step->o_tp1, x_t);
         return a_t;
@@ -147,6 +175,174 @@ namespace RLLib
       }
   };
 
+  /**
+   * A LearnerAgent that returns the next action before it learns: getAtp1(..)
+   * samples a_tp1 with the current weights (Control<T>::stepAction(..)), and
+   * the update of the transition (Control<T>::stepUpdate()) runs either on a
+   * learner thread, or in flush(), which the caller invokes while the problem
+   * computes its next step (RLRunner::resume() does). The action latency is
+   * then the cost of the features and of the policy alone.
+   *
+   * The tradeoff: a control that learns before it samples (the off-policy
+   * controls) samples a_tp1 with weights that miss the update of the last
+   * transition, i.e., they are one step stale; each transition is still
+   * learned once and in order. SarsaControl samples a_tp1 before its update
+   * anyway, so its pipelined steps are exactly those of a LearnerAgent.
+   *
+   * The next getAtp1(..), initialize(..), reset() and flush() wait for the
+   * pending update: at most one update is in flight, and the learner never
+   * runs concurrently with the agent. Call flush() before reading the control
+   * from another agent.
+   */
+  template<typename T>
+  class PipelinedLearnerAgent: public RLAgent<T>
+  {
+      typedef RLAgent<T> Base;
+    private:
+      const Action<T>* a_t;
+      Vector<T>* absorbingState;
+      Vector<T>* x_t;
+      Vector<T>* x_tp1; // the pending update reads the copies of the agent
+      bool pending;
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+      std::thread* learner;
+      std::mutex mutex;
+      std::condition_variable condition;
+      bool stopped;
+#endif
+
+    public:
+      PipelinedLearnerAgent(Control<T>* control, const bool& threaded = false) :
+          RLAgent<T>(control), a_t(0), absorbingState(new PVector<T>(0)), x_t(0), x_tp1(0), //
+          pending(false)
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+              , learner(0), stopped(false)
+#endif
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        if (threaded)
+          learner = new std::thread(&PipelinedLearnerAgent<T>::run, this);
+#else
+        (void) threaded;
+#endif
+      }
+
+      virtual ~PipelinedLearnerAgent()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        if (learner)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+          }
+          condition.notify_all();
+          learner->join();
+          delete learner;
+        }
+#endif
+        delete absorbingState;
+        if (x_t)
+          delete x_t;
+        if (x_tp1)
+          delete x_tp1;
+      }
+
+    private:
+      PipelinedLearnerAgent(const PipelinedLearnerAgent<T>& that);
+      PipelinedLearnerAgent<T>& operator=(const PipelinedLearnerAgent<T>& that);
+
+    public:
+      const Action<T>* initialize(const TRStep<T>* step)
+      {
+        flush();
+        a_t = Base::control->initialize(step->o_tp1);
+        Vectors<T>::bufferedCopy(step->o_tp1, x_t);
+        return a_t;
+      }
+
+      const Action<T>* getAtp1(const TRStep<T>* step)
+      {
+        flush();
+        Vectors<T>::bufferedCopy(step->o_tp1, x_tp1);
+        const Action<T>* a_tp1 = Base::control->stepAction(x_t, a_t,
+            (step->endOfEpisode ? absorbingState : x_tp1), step->r_tp1, step->z_tp1);
+        a_t = a_tp1;
+        std::swap(x_t, x_tp1);
+        post();
+        return a_t;
+      }
+
+      void flush()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        if (learner)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          while (pending)
+            condition.wait(lock);
+          return;
+        }
+#endif
+        if (pending)
+        {
+          RLLIB_TIMELINE("learn");
+          Base::control->stepUpdate();
+          pending = false;
+        }
+      }
+
+      void reset()
+      {
+        flush();
+        Base::control->reset();
+      }
+
+    private:
+      void post()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        if (learner)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = true;
+          }
+          condition.notify_all();
+          return;
+        }
+#endif
+        pending = true;
+      }
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+      static void run(PipelinedLearnerAgent<T>* agent)
+      {
+        agent->loop();
+      }
+
+      void loop()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+          while (!pending && !stopped)
+            condition.wait(lock);
+          if (!pending)
+            break;
+          lock.unlock();
+          {
+            RLLIB_TIMELINE("learn");
+            Base::control->stepUpdate();
+          }
+          lock.lock();
+          pending = false;
+          condition.notify_all();
+        }
+      }
+#endif
+  };
+
   template<typename T>
   class ControlAgent: public RLAgent<T>
   {
@@ -227,6 +423,16 @@ namespace RLLib
         output->updateTRStep(r(), z(), endOfEpisode());
       }
 
+      /**
+       * Whether the observation that follows initialize() or step(..) is
+       * available. A problem whose environment is external (a socket, a robot)
+       * returns false until it arrives, and updateTRStep() reads it.
+       */
+      virtual bool ready()
+      {
+        return true;
+      }
+
       virtual void draw() const
       {/*To output useful information*/
       }
@@ -270,10 +476,15 @@ namespace RLLib
           T averageTimePerStep;
           T episodeR;
           T episodeZ;
+          // The time of the phases of the agent in the episode, see RLLIB_PROBE
+          Instrumentation::Breakdown phases;
+          // The step latencies of the episode; 0 unless enableLatencyHistograms(true)
+          const LatencyHistogram* latencies;
 
         public:
           Event() :
-              nbTotalTimeSteps(0), nbEpisodeDone(0), averageTimePerStep(0), episodeR(0), episodeZ(0)
+              nbTotalTimeSteps(0), nbEpisodeDone(0), averageTimePerStep(0), episodeR(0), //
+              episodeZ(0), latencies(0)
           {
           }
 
@@ -294,6 +505,7 @@ namespace RLLib
       int nbRuns;
       int nbEpisodeDone;
       bool endingOfEpisode;
+      bool awaiting;
       bool verbose;
 
 #if !defined(EMBEDDED_MODE)
@@ -308,6 +520,10 @@ namespace RLLib
 
       bool enableTestEpisodesAfterEachRun;
       int maxTestEpisodesAfterEachRun;
+      Instrumentation::Breakdown episodeStart;
+      LatencyHistogram* episodeLatencies; // in ns, of the getAtp1(..) of the episode
+      LatencyHistogram* runLatencies; // the episodes of the current run
+      uint64_t episodeStartTime; // of the Timeline; 0 if not recorded
     public:
       int timeStep;
       T episodeR;
@@ -318,15 +534,17 @@ namespace RLLib
           const int nbEpisodes = -1, const int nbRuns = -1) :
           agent(agent), problem(problem), agentAction(0), maxEpisodeTimeSteps(maxEpisodeTimeSteps), //
           nbEpisodes(nbEpisodes), nbRuns(nbRuns), nbEpisodeDone(0), endingOfEpisode(false), //
-          verbose(true), totalTimeInMilliseconds(0), enableStatistics(false), //
-          enableTestEpisodesAfterEachRun(false), maxTestEpisodesAfterEachRun(20), timeStep(0), //
-          episodeR(0), episodeZ(0)
+          awaiting(false), verbose(true), totalTimeInMilliseconds(0), enableStatistics(false), //
+          enableTestEpisodesAfterEachRun(false), maxTestEpisodesAfterEachRun(20), //
+          episodeLatencies(0), runLatencies(0), episodeStartTime(0), timeStep(0), episodeR(0), //
+          episodeZ(0)
       {
       }
 
       ~RLRunner()
       {
         onEpisodeEnd.clear();
+        enableLatencyHistograms(false);
       }
 
       void setVerbose(const bool& verbose)
@@ -354,6 +572,38 @@ namespace RLLib
         this->enableTestEpisodesAfterEachRun = enableTestEpisodesAfterEachRun;
       }
 
+      /**
+       * Records the time of each RLAgent::getAtp1(..) in ns, in a histogram of
+       * the episode, merged at the end of the episode into the histogram of
+       * the run. The events receive the former; run() prints the latter.
+       */
+      void enableLatencyHistograms(const bool& enable)
+      {
+        if (enable && !episodeLatencies)
+        {
+          episodeLatencies = new LatencyHistogram;
+          runLatencies = new LatencyHistogram;
+        }
+        else if (!enable)
+        {
+          delete episodeLatencies;
+          delete runLatencies;
+          episodeLatencies = runLatencies = 0;
+        }
+      }
+
+      // The step latencies of the current, or the last, episode; 0 when disabled
+      const LatencyHistogram* getEpisodeLatencies() const
+      {
+        return episodeLatencies;
+      }
+
+      // The step latencies of the episodes of the current, or the last, run; 0 when disabled
+      const LatencyHistogram* getRunLatencies() const
+      {
+        return runLatencies;
+      }
+
       void benchmark()
       {
 #if !defined(EMBEDDED_MODE)
@@ -376,33 +626,74 @@ namespace RLLib
 
       void step()
       {
-        if (!agentAction)
+        act();
+        observe();
+      }
+
+      /**
+       * Resumes the episode loop: sends the action of the agent to the problem,
+       * and returns false while the problem awaits its environment (see
+       * RLProblem::ready()); otherwise the agent observes and decides. One
+       * thread can interleave many runners, see RLRunnerScheduler<T>.
+       */
+      bool resume()
+      {
+        if (!awaiting)
+        {
+          act();
+          awaiting = true;
+        }
+        if (!problem->ready())
         {
+          agent->flush();
+          return false;
+        }
+        awaiting = false;
+        observe();
+        return true;
+      }
+
+    protected:
+      // Starts an episode, or steps through the problem with the action of the agent
+      void act()
+      {
+        if (!agentAction)
           /*Initialize the problem*/
           problem->initialize();
-          /*Update the state variables*/
-          problem->updateTuple();
+        else
+          /*Step through the problem*/
+          problem->step(agentAction);
+      }
 
+      // Updates the state variables, and gets the next action of the agent
+      void observe()
+      {
+        /*Update the state variables*/
+        problem->updateTuple();
+
+        if (!agentAction)
+        {
           /*Statistic variables*/
           timeStep = 0;
           episodeR = 0;
           episodeZ = 0;
           totalTimeInMilliseconds = 0;
+#if defined(RLLIB_INSTRUMENTATION)
+          Instrumentation::snapshot(episodeStart);
+#endif
+          if (episodeLatencies)
+            episodeLatencies->reset();
+          episodeStartTime = Timeline::enabled() ? Timeline::now() : 0;
           /*The episode is just started*/
           endingOfEpisode = false;
           problem->getTRStep()->setForcedEndOfEpisode(endingOfEpisode);
         }
-        else
-        {
-          /*Step through the problem*/
-          problem->step(agentAction);
-          /*Update the state variables*/
-          problem->updateTuple();
-        }
 
         if (!agentAction)
         {
           /*Initialize the control agent and get the first action*/
+          RLLIB_TIMELINE("initialize");
+          RLLIB_PROBE(AGENT);
           agentAction = agent->initialize(problem->getTRStep());
         }
         else
@@ -415,11 +706,23 @@ namespace RLLib
           //step->setForcedEndOfEpisode(endingOfEpisode);
 #if !defined(EMBEDDED_MODE)
           timer.start();
-#endif
-          agentAction = agent->getAtp1(step);
-#if !defined(EMBEDDED_MODE)
+          {
+            RLLIB_PROBE(AGENT);
+            agentAction = agent->getAtp1(step);
+          }
           timer.stop();
+          // The span of the step is the timer of the step: no other clock reads
+          if (Timeline::enabled())
+            Timeline::record("step", timer.getStartInNanoSec(), timer.getStopInNanoSec());
           totalTimeInMilliseconds += timer.getElapsedTimeInMilliSec();
+          if (episodeLatencies)
+            episodeLatencies->record(uint64_t(timer.getElapsedTimeInMicroSec() * 1000.0));
+#else
+          {
+            RLLIB_TIMELINE("step");
+            RLLIB_PROBE(AGENT);
+            agentAction = agent->getAtp1(step);
+          }
 #endif
         }
 
@@ -441,6 +744,15 @@ namespace RLLib
           ++nbEpisodeDone;
           /*Set the initial marker*/
           agentAction = 0;
+          Instrumentation::Breakdown phases;
+#if defined(RLLIB_INSTRUMENTATION)
+          Instrumentation::snapshot(phases);
+          phases = phases - episodeStart;
+#endif
+          if (runLatencies)
+            runLatencies->merge(*episodeLatencies);
+          if (episodeStartTime)
+            Timeline::record("episode", episodeStartTime, Timeline::now(), nbEpisodeDone - 1);
           // Fire the events
           for (typename std::vector<Event*>::iterator iter = onEpisodeEnd.begin();
               iter != onEpisodeEnd.end(); ++iter)
@@ -451,12 +763,15 @@ namespace RLLib
             e->averageTimePerStep = (totalTimeInMilliseconds / timeStep);
             e->episodeR = episodeR;
             e->episodeZ = episodeZ;
+            e->phases = phases;
+            e->latencies = episodeLatencies;
             e->update();
           }
         }
 
       }
 
+    public:
       void runEpisodes()
       {
         do
@@ -471,6 +786,8 @@ namespace RLLib
 #if !defined(EMBEDDED_MODE)
         std::cout << "\n@@ Evaluate=" << enableTestEpisodesAfterEachRun << std::endl;
 #endif
+        RLLIB_TIMELINE("evaluate");
+        agent->flush();
         RLAgent<T>* evaluateAgent = new ControlAgent<T>(agent->getRLAgent());
         RLRunner<T>* runner = new RLRunner<T>(evaluateAgent, problem, maxEpisodeTimeSteps,
             nbEpisodes, nbRuns);
@@ -489,9 +806,16 @@ namespace RLLib
           if (enableStatistics)
             statistics.clear();
           nbEpisodeDone = 0;
+          if (runLatencies)
+            runLatencies->reset();
           // For each run
           agent->reset();
           runEpisodes();
+          if (runLatencies && verbose)
+          {
+            std::cout << std::endl;
+            runLatencies->print(std::cout, "@@ step(us)");
+          }
           if (enableStatistics)
             benchmark();
 
@@ -501,6 +825,15 @@ namespace RLLib
 #endif
       }
 
+      // Starts over with a reset agent; the next step() begins a new episode
+      void reset()
+      {
+        agent->reset();
+        agentAction = 0;
+        nbEpisodeDone = 0;
+        awaiting = false;
+      }
+
       bool isBeginingOfEpisode() const
       {
         return agentAction == 0;
@@ -536,6 +869,7 @@ namespace RLLib
 #if !defined(EMBEDDED_MODE)
         if (problem->dimension() == 2) // only for two state variables
         {
+          agent->flush();
           std::ofstream out(outFile);
           PVector<T> x_t(2);
           for (T x = 0; x <= 10; x += 0.1f)
@@ -557,6 +891,64 @@ namespace RLLib
       }
   };
 
+  /**
+   * Interleaves many agent/problem pairs on one thread: a runner whose
+   * problem awaits its environment is suspended, and the others proceed.
+   * idle() is called when no runner could proceed, e.g., to wait on the
+   * sockets of the problems; by default, it yields the processor.
+   */
+  template<typename T>
+  class RLRunnerScheduler
+  {
+    protected:
+      std::vector<RLRunner<T>*> runners;
+
+    public:
+      virtual ~RLRunnerScheduler()
+      {
+      }
+
+      void add(RLRunner<T>* runner)
+      {
+        runners.push_back(runner);
+      }
+
+      // Resumes every runner once; returns the number of steps taken
+      int poll()
+      {
+        int nbSteps = 0;
+        for (typename std::vector<RLRunner<T>*>::iterator iter = runners.begin();
+            iter != runners.end(); ++iter)
+          if ((*iter)->isRunning() && (*iter)->resume())
+            ++nbSteps;
+        return nbSteps;
+      }
+
+      // Runs until every runner has done its episodes
+      void run()
+      {
+        while (isRunning())
+          if (!poll())
+            idle();
+      }
+
+      bool isRunning() const
+      {
+        for (typename std::vector<RLRunner<T>*>::const_iterator iter = runners.begin();
+            iter != runners.end(); ++iter)
+          if ((*iter)->isRunning())
+            return true;
+        return false;
+      }
+
+      virtual void idle()
+      {
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+        std::this_thread::yield();
+#endif
+      }
+  };
+
 }  // namespace RLLib
 
 #endif /* RL_H_ */
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * RealTimeRunner.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef REALTIMERUNNER_H_
+#define REALTIMERUNNER_H_
+
+#include "RL.h"
+#include "Histogram.h"
+
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+namespace RLLib
+{
+
+  /**
+   * An RLRunner that steps the agent on a fixed period, e.g., the 10ms cycle
+   * of the NAO. The loop sleeps with clock_nanosleep(..) until the absolute
+   * start of the next period, so the jitter does not accumulate.
+   *
+   * initializeRealTime() removes the timer slack of the thread, and optionally
+   * pins it to a CPU, switches it to SCHED_FIFO, and locks the memory with
+   * mlockall(..); the current pages are faulted in, the stack is pre-faulted,
+   * and the heap neither trims nor maps new pages, so the pages freed in
+   * steady state stay locked. The agents do not allocate in steady state: the
+   * first steps (the warm-up) size their buffers, then the runner checks that
+   * the heap in use does not grow.
+   *
+   * The episodes run until nbEpisodes are done, or forever with nbEpisodes
+   * -1, until stop(). A step that ends after the start of the next period
+   * misses its deadline; the runner then skips the periods already elapsed.
+   * The step times and the wake-up latencies are recorded in ns, in
+   * LatencyHistogram(s).
+   */
+  template<typename T>
+  class RealTimeRunner: public RLRunner<T>
+  {
+    private:
+      typedef RLRunner<T> Base;
+
+    public:
+      enum
+      {
+        STACK_PREFAULT = 256 * 1024
+      };
+
+    protected:
+      long periodInNanoSec;
+      int cpu; // -1: not pinned
+      int priority; // SCHED_FIFO priority, 0: the default scheduler
+      bool lockMemory;
+      int nbWarmUpSteps;
+      std::atomic<bool> stopped; // lock-free, so that stop() is safe in a signal handler
+
+      long nbSteps;
+      long nbDeadlineMisses;
+      long nbMissedPeriods;
+      double maxStepTimeInMicroSec;
+      double maxLatencyInMicroSec;
+      LatencyHistogram stepTimeHistogram;
+      LatencyHistogram latencyHistogram;
+      long heapInUse;
+      long heapGrowth;
+
+    public:
+      RealTimeRunner(RLAgent<T>* agent, RLProblem<T>* problem, const int& maxEpisodeTimeSteps,
+          const double& periodInMicroSec, const int nbEpisodes = -1, const int nbRuns = -1) :
+          RLRunner<T>(agent, problem, maxEpisodeTimeSteps, nbEpisodes, nbRuns), //
+          periodInNanoSec(long(periodInMicroSec * 1000.0)), cpu(-1), priority(0), //
+          lockMemory(true), nbWarmUpSteps(100), stopped(false)
+      {
+        clearReport();
+      }
+
+      void setCpu(const int& cpu)
+      {
+        this->cpu = cpu;
+      }
+
+      void setPriority(const int& priority)
+      {
+        this->priority = priority;
+      }
+
+      void setLockMemory(const bool& lockMemory)
+      {
+        this->lockMemory = lockMemory;
+      }
+
+      void setWarmUpSteps(const int& nbWarmUpSteps)
+      {
+        this->nbWarmUpSteps = nbWarmUpSteps;
+      }
+
+      // Applies the CPU, the priority and the memory locking; false if one failed
+      bool initializeRealTime()
+      {
+        bool result = true;
+        prctl(PR_SET_TIMERSLACK, 1UL); // the default slack delays the wake-ups by 50us
+        if (cpu >= 0)
+        {
+          cpu_set_t cpus;
+          CPU_ZERO(&cpus);
+          CPU_SET(cpu, &cpus);
+          const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+          if (error)
+          {
+            std::cerr << "ERROR! pthread_setaffinity_np cpu=" << cpu << " " << std::strerror(error)
+                << std::endl;
+            result = false;
+          }
+        }
+        if (priority > 0)
+        {
+          struct sched_param param;
+          std::memset(&param, 0, sizeof(param));
+          param.sched_priority = priority;
+          const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+          if (error)
+          {
+            std::cerr << "ERROR! pthread_setschedparam SCHED_FIFO priority=" << priority << " "
+                << std::strerror(error) << std::endl;
+            result = false;
+          }
+        }
+        if (lockMemory)
+        {
+          mallopt(M_TRIM_THRESHOLD, -1);
+          mallopt(M_MMAP_MAX, 0);
+          if (mlockall(MCL_CURRENT | MCL_FUTURE))
+          {
+            std::cerr << "ERROR! mlockall " << std::strerror(errno) << std::endl;
+            result = false;
+          }
+          prefaultStack();
+        }
+        return result;
+      }
+
+      // Unlocks the memory and restores the default heap of glibc, after initializeRealTime()
+      void releaseRealTime()
+      {
+        if (!lockMemory)
+          return;
+        munlockall();
+        mallopt(M_TRIM_THRESHOLD, 128 * 1024);
+        mallopt(M_MMAP_MAX, 65536);
+      }
+
+      // Runs the episodes, one step per period, until stop()
+      void runRealTime()
+      {
+        clearReport();
+        stopped = false;
+        if (nbWarmUpSteps <= 0)
+          heapInUse = heapInUseNow();
+        struct timespec next, now, end;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        long step = 0;
+        do
+        {
+          clock_gettime(CLOCK_MONOTONIC, &now);
+          const double latency = elapsedInMicroSec(next, now);
+          Base::step();
+          clock_gettime(CLOCK_MONOTONIC, &end);
+          addPeriod(next);
+          if (++step > nbWarmUpSteps)
+            record(latency, elapsedInMicroSec(now, end), end, next);
+          else if (step == nbWarmUpSteps)
+            heapInUse = heapInUseNow();
+          // After a deadline miss, start over at the next period
+          while (isBefore(next, end))
+          {
+            addPeriod(next);
+            if (step > nbWarmUpSteps)
+              ++nbMissedPeriods;
+          }
+          while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, 0) == EINTR)
+            ;
+        }
+        while (!stopped && (Base::nbEpisodes < 0 || Base::nbEpisodeDone < Base::nbEpisodes));
+        if (step >= nbWarmUpSteps)
+          heapGrowth = heapInUseNow() - heapInUse;
+      }
+
+      // Ends runRealTime() after the current step; safe from another thread or a signal handler
+      void stop()
+      {
+        stopped = true;
+      }
+
+      long getNbSteps() const
+      {
+        return nbSteps;
+      }
+
+      long getNbDeadlineMisses() const
+      {
+        return nbDeadlineMisses;
+      }
+
+      long getNbMissedPeriods() const
+      {
+        return nbMissedPeriods;
+      }
+
+      double getMaxStepTimeInMicroSec() const
+      {
+        return maxStepTimeInMicroSec;
+      }
+
+      double getMaxLatencyInMicroSec() const
+      {
+        return maxLatencyInMicroSec;
+      }
+
+      const LatencyHistogram& getStepTimeHistogram() const
+      {
+        return stepTimeHistogram;
+      }
+
+      const LatencyHistogram& getLatencyHistogram() const
+      {
+        return latencyHistogram;
+      }
+
+      // The bytes allocated on the heap in steady state, and not freed
+      long getHeapGrowth() const
+      {
+        return heapGrowth;
+      }
+
+      void printReport(std::ostream& out) const
+      {
+        out << "period=" << periodInNanoSec / 1000.0 << "us steps=" << nbSteps
+            << " deadlineMisses=" << nbDeadlineMisses << " missedPeriods=" << nbMissedPeriods
+            << " maxStep=" << maxStepTimeInMicroSec << "us maxLatency=" << maxLatencyInMicroSec
+            << "us heapGrowth=" << heapGrowth << "B" << std::endl;
+        stepTimeHistogram.print(out, "step(us)");
+        latencyHistogram.print(out, "latency(us)");
+      }
+
+    protected:
+      void clearReport()
+      {
+        nbSteps = nbDeadlineMisses = nbMissedPeriods = 0;
+        maxStepTimeInMicroSec = maxLatencyInMicroSec = 0;
+        stepTimeHistogram.reset();
+        latencyHistogram.reset();
+        heapInUse = heapGrowth = 0;
+      }
+
+      void record(const double& latency, const double& stepTime, const struct timespec& end,
+          const struct timespec& deadline)
+      {
+        ++nbSteps;
+        if (isBefore(deadline, end))
+          ++nbDeadlineMisses;
+        maxStepTimeInMicroSec = std::max(maxStepTimeInMicroSec, stepTime);
+        maxLatencyInMicroSec = std::max(maxLatencyInMicroSec, latency);
+        stepTimeHistogram.record(uint64_t(std::max(stepTime, 0.0) * 1000.0));
+        latencyHistogram.record(uint64_t(std::max(latency, 0.0) * 1000.0));
+      }
+
+      void addPeriod(struct timespec& t) const
+      {
+        t.tv_nsec += periodInNanoSec;
+        while (t.tv_nsec >= 1000000000L)
+        {
+          t.tv_nsec -= 1000000000L;
+          ++t.tv_sec;
+        }
+      }
+
+      static bool isBefore(const struct timespec& a, const struct timespec& b)
+      {
+        return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+      }
+
+      static double elapsedInMicroSec(const struct timespec& from, const struct timespec& to)
+      {
+        return (to.tv_sec - from.tv_sec) * 1e6 + (to.tv_nsec - from.tv_nsec) / 1e3;
+      }
+
+      static long heapInUseNow()
+      {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        return long(mallinfo2().uordblks);
+#else
+        return long(mallinfo().uordblks);
+#endif
+      }
+
+      static void prefaultStack()
+      {
+        volatile unsigned char stack[STACK_PREFAULT];
+        for (size_t i = 0; i < sizeof(stack); i += 4096)
+          stack[i] = 0;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* !defined(EMBEDDED_MODE) && defined(__linux__) */
+
+#endif /* REALTIMERUNNER_H_ */
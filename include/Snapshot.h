@@ -0,0 +1,354 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Snapshot.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "Checkpoint.h"
+#include "Function.h"
+#include "Mathema.h"
+#include "Timer.h"
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace RLLib
+{
+
+  /**
+   * The complete state of learners: the vectors, scalars and random number
+   * generators exposed by their accept(..), plus any state added by the user,
+   * e.g., the last observation of the control loop. A learner restored from a
+   * snapshot continues exactly as the original one.
+   *
+   * capture() copies the state into a staging area with one memcpy per dense
+   * vector; the staging area doubles the memory of the state. persistAsync(..)
+   * captures and returns, while a background thread compresses the staging
+   * area (see Checkpoint<T>), writes it to a temporary file, calls fsync, and
+   * renames the file. The next capture() waits for the previous write.
+   */
+  template<typename T>
+  class Snapshot: public Archive<T>, protected Checkpoint<T>
+  {
+    protected:
+      typedef Checkpoint<T> Base;
+      std::string prefix;
+      std::vector<Vector<T>*> staged;
+      std::vector<std::string> scalarNames;
+      std::vector<T*> scalars;
+      std::vector<T> stagedScalars;
+      std::vector<std::string> randomNames;
+      std::vector<Random<T>*> randoms;
+      std::vector<uint32_t> stagedRandoms;
+      std::vector<T> stagedGaussians;
+      std::vector<char> stagedCached;
+
+      std::thread* writer;
+      mutable std::mutex mutex;
+      std::condition_variable condition;
+      bool pending, stopped, result;
+      std::string pendingFile;
+      double captureTime, writeTime;
+
+    public:
+      Snapshot() :
+          writer(0), pending(false), stopped(false), result(true), captureTime(0), writeTime(0)
+      {
+      }
+
+      virtual ~Snapshot()
+      {
+        if (writer)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+          }
+          condition.notify_all();
+          writer->join();
+          delete writer;
+        }
+        for (typename std::vector<Vector<T>*>::iterator iter = staged.begin();
+            iter != staged.end(); ++iter)
+          delete *iter;
+      }
+
+    private:
+      Snapshot(const Snapshot<T>& that);
+      Snapshot<T>& operator=(const Snapshot<T>& that);
+
+    public:
+      void add(const char* name, Vector<T>* vector)
+      {
+        Base::add(prefix + name, vector);
+        staged.push_back(vector->newInstance(vector->dimension()));
+      }
+
+      void add(const char* name, T& scalar)
+      {
+        scalarNames.push_back(prefix + name);
+        scalars.push_back(&scalar);
+        stagedScalars.push_back(scalar);
+      }
+
+      void add(const char* name, Random<T>* random)
+      {
+        randomNames.push_back(prefix + name);
+        randoms.push_back(random);
+        stagedRandoms.resize(stagedRandoms.size() + 4);
+        stagedGaussians.push_back(T(0));
+        stagedCached.push_back(0);
+      }
+
+      void add(const char* name, ParameterizedFunction<T>* function)
+      {
+        const std::string outer(prefix);
+        prefix.append(name).append(".");
+        function->accept(this);
+        prefix = outer;
+      }
+
+      // Copies the state into the staging area
+      void capture()
+      {
+        wait();
+        RLLIB_TIMELINE("capture");
+        Timer timer;
+        timer.start();
+        for (size_t k = 0; k < staged.size(); k++)
+        {
+          const Vector<T>* vector = Base::vectors[k];
+          const DenseVector<T>* dense = RTTI<T>::constDenseVector(vector);
+          if (dense)
+            std::copy(dense->getValues(), dense->getValues() + dense->dimension(),
+                RTTI<T>::denseVector(staged[k])->getValues());
+          else
+            staged[k]->set(vector);
+        }
+        for (size_t k = 0; k < scalars.size(); k++)
+          stagedScalars[k] = *scalars[k];
+        for (size_t k = 0; k < randoms.size(); k++)
+        {
+          bool isCached;
+          randoms[k]->getState(&stagedRandoms[4 * k], stagedGaussians[k], isCached);
+          stagedCached[k] = isCached;
+        }
+        timer.stop();
+        captureTime = timer.getElapsedTimeInMilliSec();
+      }
+
+      // Captures and writes the state before returning
+      bool persist(const char* f)
+      {
+        capture();
+        return write(f);
+      }
+
+      // Captures the state; a background thread writes it
+      void persistAsync(const char* f)
+      {
+        capture();
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!writer)
+          writer = new std::thread(&Snapshot<T>::run, this);
+        pendingFile = f;
+        pending = true;
+        condition.notify_all();
+      }
+
+      // Waits for the background write, and returns whether it succeeded
+      bool wait()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (pending)
+          condition.wait(lock);
+        return result;
+      }
+
+      bool resurrect(const char* f)
+      {
+        wait();
+        std::vector<unsigned char> in;
+        size_t position = 0;
+        uint32_t nbVectors = 0;
+        if (!Base::readFile(f, "RLLIBSNP", in, position, nbVectors))
+          return false;
+        bool restored = nbVectors == Base::vectors.size();
+        for (uint32_t k = 0; restored && k < nbVectors; k++)
+          restored = Base::decode(in, position);
+        uint32_t nbScalars = 0, nbRandoms = 0;
+        restored = restored && Base::read(in, position, nbScalars);
+        for (uint32_t k = 0; restored && k < nbScalars; k++)
+        {
+          T value;
+          const int index = readName(in, position, scalarNames);
+          restored = index >= 0 && Base::read(in, position, value);
+          if (restored)
+            *scalars[index] = value;
+        }
+        restored = restored && Base::read(in, position, nbRandoms);
+        for (uint32_t k = 0; restored && k < nbRandoms; k++)
+        {
+          uint32_t state[4], isCached = 0;
+          T cachedGaussian;
+          const int index = readName(in, position, randomNames);
+          for (int i = 0; restored && i < 4; i++)
+            restored = index >= 0 && Base::read(in, position, state[i]);
+          restored = restored && Base::read(in, position, isCached)
+              && Base::read(in, position, cachedGaussian);
+          if (restored)
+            randoms[index]->setState(state, cachedGaussian, isCached != 0);
+        }
+        if (!restored)
+          std::cerr << "ERROR! (resurrect) file=" << f << std::endl;
+        return restored;
+      }
+
+      int dimension() const
+      {
+        return Base::vectors.size() + scalars.size() + randoms.size();
+      }
+
+      // Time the control loop was stopped by the last capture()
+      double getCaptureTimeInMilliSec() const
+      {
+        return captureTime;
+      }
+
+      // Time to compress and to write the last snapshot
+      double getWriteTimeInMilliSec() const
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        return writeTime;
+      }
+
+    protected:
+      static void run(Snapshot<T>* snapshot)
+      {
+        snapshot->loop();
+      }
+
+      void loop()
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+          while (!pending && !stopped)
+            condition.wait(lock);
+          if (!pending)
+            break;
+          const std::string f(pendingFile);
+          lock.unlock();
+          const bool written = write(f.c_str());
+          lock.lock();
+          result = written;
+          pending = false;
+          condition.notify_all();
+        }
+      }
+
+      static void appendName(const std::string& name, std::vector<unsigned char>& out)
+      {
+        Base::append(out, uint32_t(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+      }
+
+      static int readName(const std::vector<unsigned char>& in, size_t& position,
+          const std::vector<std::string>& names)
+      {
+        uint32_t length = 0;
+        if (!Base::read(in, position, length) || position + length > in.size())
+          return -1;
+        const std::string name(in.begin() + position, in.begin() + position + length);
+        position += length;
+        for (size_t k = 0; k < names.size(); k++)
+          if (names[k] == name)
+            return k;
+        return -1;
+      }
+
+      // Writes the staging area
+      bool write(const char* f)
+      {
+        RLLIB_TIMELINE("snapshot");
+        Timer timer;
+        timer.start();
+        std::vector<unsigned char> out;
+        Base::appendHeader(out, "RLLIBSNP");
+        for (size_t k = 0; k < staged.size(); k++)
+          Base::encode(Base::names[k], staged[k], out);
+        Base::append(out, uint32_t(scalars.size()));
+        for (size_t k = 0; k < scalars.size(); k++)
+        {
+          appendName(scalarNames[k], out);
+          Base::append(out, stagedScalars[k]);
+        }
+        Base::append(out, uint32_t(randoms.size()));
+        for (size_t k = 0; k < randoms.size(); k++)
+        {
+          appendName(randomNames[k], out);
+          for (int i = 0; i < 4; i++)
+            Base::append(out, stagedRandoms[4 * k + i]);
+          Base::append(out, uint32_t(stagedCached[k]));
+          Base::append(out, stagedGaussians[k]);
+        }
+        Base::append(out, Base::checksum(&out[0], out.size()));
+
+        // A crash during the write leaves the previous snapshot
+        const std::string tmp = std::string(f) + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+          return false;
+        }
+        size_t written = 0;
+        while (written < out.size())
+        {
+          const ssize_t n = ::write(fd, &out[written], out.size() - written);
+          if (n <= 0)
+            break;
+          written += n;
+        }
+        const bool synced = written == out.size() && fsync(fd) == 0;
+        close(fd);
+        if (!synced || std::rename(tmp.c_str(), f) != 0)
+        {
+          std::cerr << "ERROR! (persist) file=" << f << std::endl;
+          return false;
+        }
+        timer.stop();
+        // Published under the mutex: write(..) may run on the writer thread
+        std::lock_guard<std::mutex> lock(mutex);
+        writeTime = timer.getElapsedTimeInMilliSec();
+        return true;
+      }
+  };
+
+} // namespace RLLib
+
+#endif /* !defined(EMBEDDED_MODE) && !defined(_MSC_VER) */
+
+#endif /* SNAPSHOT_H_ */
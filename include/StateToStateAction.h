@@ -28,7 +28,7 @@ namespace RLLib
 {
 
   template<typename T>
-  class Representations
+  class Representations: public ArenaAllocated
   {
     protected:
       std::vector<Vector<T>*> phis;
@@ -84,10 +84,24 @@ namespace RLLib
             ++iter)
           (*iter)->clear();
       }
+
+      // Adds the node name, with one child per action, to footprint
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        char entry[32];
+        for (size_t i = 0; i < phis.size(); i++)
+        {
+          std::snprintf(entry, sizeof(entry), "phi.%i", int(i));
+          phis[i]->memoryFootprint(node, entry);
+        }
+      }
   };
 
   template<typename T>
-  class StateToStateAction
+  class StateToStateAction: public ArenaAllocated
   {
     public:
       virtual ~StateToStateAction()
@@ -98,6 +112,12 @@ namespace RLLib
       virtual const Actions<T>* getActions() const =0;
       virtual T vectorNorm() const =0;
       virtual int dimension() const =0;
+
+      // Adds the node name, with the projector and the buffers, to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        footprint->child(name, this);
+      }
   };
 
 // Tile coding base projector to state action
@@ -120,6 +140,15 @@ namespace RLLib
         delete phis;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        projector->memoryFootprint(node, "projector");
+        phis->memoryFootprint(node, "phis");
+      }
+
       const Vector<T>* stateAction(const Vector<T>* x, const Action<T>* a)
       {
         if (actions->dimension() == 1)
@@ -130,6 +159,7 @@ namespace RLLib
 
       const Representations<T>* stateActions(const Vector<T>* x)
       {
+        RLLIB_PROBE(STATE_ACTIONS);
         ASSERT(actions->dimension() == phis->dimension());
         if (x->empty())
         {
@@ -184,6 +214,16 @@ namespace RLLib
         delete phi;
       }
 
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        projector->memoryFootprint(node, "projector");
+        phis->memoryFootprint(node, "phis");
+        phi->memoryFootprint(node, "phi");
+      }
+
       const Vector<T>* stateAction(const Vector<T>* x, const Action<T>* a)
       {
         phi->clear();
@@ -197,6 +237,7 @@ namespace RLLib
 
       const Representations<T>* stateActions(const Vector<T>* x)
       {
+        RLLIB_PROBE(STATE_ACTIONS);
         ASSERT(actions->dimension() == phis->dimension());
         for (typename Actions<T>::const_iterator a = actions->begin(); a != actions->end(); ++a)
           phis->set(stateAction(x, *a), *a);
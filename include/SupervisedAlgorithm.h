@@ -75,6 +75,11 @@ namespace RLLib
         w->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("w", w);
+      }
+
       Vector<T>* weights() const
       {
         return w;
@@ -151,10 +156,23 @@ namespace RLLib
         w->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("w", w);
+        archive->add("alphas", alphas);
+        archive->add("hs", hs);
+      }
+
       Vector<T>* weights() const
       {
         return w;
       }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        pool->memoryFootprint(node, "pool");
+      }
   };
 
   template<typename T>
@@ -229,10 +247,23 @@ namespace RLLib
         w->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("w", w);
+        archive->add("alphas", alphas);
+        archive->add("hs", hs);
+      }
+
       Vector<T>* weights() const
       {
         return w;
       }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        pool->memoryFootprint(node, "pool");
+      }
   };
 
   template<typename T>
@@ -294,13 +325,13 @@ namespace RLLib
           for (int i = 0; i < sresult->nonZeroElements(); i++)
           {
             int index = activeIndexes[i];
-            piX2->setEntry(index, std::max(0.0, 1.0 - piX2->getEntry(index)));
+            piX2->setEntry(index, std::max(T(0), T(1) - piX2->getEntry(index)));
           }
         }
         else
         {
           for (int index = 0; index < piX2->dimension(); index++)
-            piX2->setEntry(index, std::max(0.0, 1.0 - piX2->getEntry(index)));
+            piX2->setEntry(index, std::max(T(0), T(1) - piX2->getEntry(index)));
         }
         Vector<T>* piDeltaXPiX2 = pool->newVector(piX)->mapMultiplyToSelf(delta)->ebeMultiplyToSelf(
             piX2);
@@ -335,10 +366,24 @@ namespace RLLib
         w->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("w", w);
+        archive->add("alphas", alphas);
+        archive->add("betas", betas);
+        archive->add("hs", hs);
+      }
+
       Vector<T>* weights() const
       {
         return w;
       }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        pool->memoryFootprint(node, "pool");
+      }
   };
 
   template<typename T>
@@ -432,10 +477,24 @@ namespace RLLib
         w->resurrect(f);
       }
 
+      void accept(Archive<T>* archive)
+      {
+        archive->add("w", w);
+        archive->add("alphas", alphas);
+        archive->add("h", h);
+        archive->add("v", v);
+      }
+
       Vector<T>* weights() const
       {
         return w;
       }
+
+    protected:
+      void componentsFootprint(MemoryFootprint* node) const
+      {
+        pool->memoryFootprint(node, "pool");
+      }
   };
 
 } // namespace RLLib
@@ -56,7 +56,7 @@ namespace RLLib
 {
 
   template<typename T>
-  class Tiles
+  class Tiles: public ArenaAllocated
   {
     protected:
       int qstate[Hashing<T>::MAX_NUM_VARS];
@@ -82,6 +82,20 @@ namespace RLLib
         delete f_tmp_arr;
       }
 
+      Hashing<T>* getHashing() const
+      {
+        return hashing;
+      }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        i_tmp_arr->memoryFootprint(node, "i_tmp_arr");
+        f_tmp_arr->memoryFootprint(node, "f_tmp_arr");
+      }
+
       void tiles(Vector<T>* the_tiles,      // provided array contains returned tiles (tile indices)
           int num_tilings,           // number of tile indices to be returned in tiles
           const Vector<T>* floats,            // array of floating point variables
@@ -122,7 +136,7 @@ namespace RLLib
           /* add additional indices for tiling and hashing_set so they hash differently */
           coordinates[i] = j;
 
-          the_tiles->setEntry(hashing->hash(coordinates, num_coordinates), 1.0f);
+          the_tiles->setEntry(hashing->hash(coordinates, num_coordinates), T(1));
         }
       }
 
@@ -286,7 +300,7 @@ namespace RLLib
           /* add additional indices for tiling and hashing_set so they hash differently */
           coordinates[i] = j;
 
-          the_tiles->setEntry(hashing->hash(coordinates, num_coordinates), 1.0f);
+          the_tiles->setEntry(hashing->hash(coordinates, num_coordinates), T(1));
         }
         return;
       }
@@ -0,0 +1,404 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * Timeline.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+#include <cstdio>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+#include <condition_variable>
+#include <unistd.h>
+#endif
+
+namespace RLLib
+{
+  /**
+   * A timeline of the spans of the agents, the runners, the checkpoints and
+   * the background threads, written in the trace event format of Chrome
+   * (chrome://tracing) and Perfetto (ui.perfetto.dev).
+   *
+   * Each thread records into its own ring of RING_SIZE spans, without locks;
+   * a background thread drains the rings into the file every FLUSH_PERIOD
+   * ms. A span costs two clock reads and a store; a ring that the writer did
+   * not drain in time drops the spans, see getNbDropped(). The ring of a
+   * thread is drained and released when the thread exits. The names must
+   * live until stop(), e.g., string literals, and need no JSON escaping.
+   * Until start(..), a span costs a relaxed load.
+   */
+  class Timeline
+  {
+    public:
+      enum
+      {
+        RING_SIZE = 1 << 14, FLUSH_PERIOD = 10
+      };
+
+      struct Span
+      {
+          const char* name;
+          uint64_t start; // ns
+          uint64_t duration; // ns
+          int64_t value; // shown as args.value if >= 0
+      };
+
+      // In ns, from a monotonic clock
+      static uint64_t now()
+      {
+#ifdef _MSC_VER
+        static LARGE_INTEGER frequency = { 0 };
+        if (!frequency.QuadPart)
+          QueryPerformanceFrequency(&frequency);
+        LARGE_INTEGER count;
+        QueryPerformanceCounter(&count);
+        return uint64_t(count.QuadPart * (1e9 / frequency.QuadPart));
+#else
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return uint64_t(time.tv_sec) * 1000000000ULL + time.tv_nsec;
+#endif
+      }
+
+#if !defined(EMBEDDED_MODE) && !defined(_MSC_VER)
+    private:
+      // The spans of one thread; head is written by the thread, tail by the writer
+      struct Ring
+      {
+          Span spans[RING_SIZE];
+          uint64_t head;
+          uint64_t tail;
+          uint64_t nbDropped;
+          int tid;
+      };
+
+      struct Writer
+      {
+          std::mutex mutex; // the rings, and the file
+          std::condition_variable condition;
+          std::vector<Ring*> rings;
+          std::FILE* file;
+          std::thread* thread;
+          bool stopped;
+          bool first;
+          bool enabled;
+          int nbThreads; // the tids
+          uint64_t nbDropped; // by the threads that exited
+
+          Writer() :
+              file(0), thread(0), stopped(false), first(true), enabled(false), nbThreads(0), //
+              nbDropped(0)
+          {
+          }
+      };
+
+      // Releases the ring of its thread when the thread exits
+      struct RingOwner
+      {
+          Ring*& local;
+          bool& exited;
+
+          RingOwner(Ring*& local, bool& exited) :
+              local(local), exited(exited)
+          {
+          }
+
+          ~RingOwner()
+          {
+            Writer& w = writer();
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (w.file)
+              drain(w, local);
+            w.nbDropped += local->nbDropped;
+            for (size_t r = 0; r < w.rings.size(); r++)
+              if (w.rings[r] == local)
+              {
+                w.rings[r] = w.rings.back();
+                w.rings.pop_back();
+                break;
+              }
+            delete local;
+            local = 0;
+            exited = true;
+          }
+      };
+
+      static Writer& writer()
+      {
+        static Writer* writer = new Writer; // outlives the threads that record at exit
+        return *writer;
+      }
+
+      // The ring of the calling thread; 0 once the thread is exiting
+      static Ring* ring()
+      {
+        static thread_local Ring* local = 0;
+        static thread_local bool exited = false;
+        if (!local && !exited)
+        {
+          Ring* ring = new Ring;
+          ring->head = ring->tail = ring->nbDropped = 0;
+          {
+            Writer& w = writer();
+            std::lock_guard<std::mutex> lock(w.mutex);
+            ring->tid = ++w.nbThreads;
+            w.rings.push_back(ring);
+          }
+          local = ring;
+          static thread_local RingOwner owner(local, exited);
+        }
+        return local;
+      }
+
+    public:
+      static bool enabled()
+      {
+        return __atomic_load_n(&writer().enabled, __ATOMIC_RELAXED);
+      }
+
+      // Starts recording into fileName; false if the file can not be written
+      static bool start(const char* fileName)
+      {
+        stop();
+        Writer& w = writer();
+        std::unique_lock<std::mutex> lock(w.mutex);
+        w.file = std::fopen(fileName, "w");
+        if (!w.file)
+        {
+          std::cerr << "ERROR! (Timeline) file=" << fileName << std::endl;
+          return false;
+        }
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", w.file);
+        w.first = true;
+        w.stopped = false;
+        for (size_t r = 0; r < w.rings.size(); r++)
+          w.rings[r]->tail = __atomic_load_n(&w.rings[r]->head, __ATOMIC_ACQUIRE);
+        w.thread = new std::thread(&Timeline::loop);
+        __atomic_store_n(&w.enabled, true, __ATOMIC_RELAXED);
+        return true;
+      }
+
+      // Stops recording, and completes the file with the spans recorded so far
+      static void stop()
+      {
+        Writer& w = writer();
+        __atomic_store_n(&w.enabled, false, __ATOMIC_RELAXED);
+        std::unique_lock<std::mutex> lock(w.mutex);
+        if (!w.thread)
+          return;
+        w.stopped = true;
+        w.condition.notify_all();
+        std::thread* thread = w.thread;
+        w.thread = 0;
+        lock.unlock();
+        thread->join();
+        delete thread;
+        lock.lock();
+        drain(w);
+        std::fputs("\n]}\n", w.file);
+        std::fclose(w.file);
+        w.file = 0;
+      }
+
+      // Records a span of the calling thread; from and to are now() values
+      static void record(const char* name, const uint64_t& from, const uint64_t& to,
+          const int64_t& value = -1)
+      {
+        Ring* r = ring();
+        if (!r)
+          return;
+        const uint64_t head = r->head;
+        if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= uint64_t(RING_SIZE))
+        {
+          __atomic_store_n(&r->nbDropped, r->nbDropped + 1, __ATOMIC_RELAXED);
+          return;
+        }
+        Span& span = r->spans[head & (RING_SIZE - 1)];
+        span.name = name;
+        span.start = from;
+        span.duration = to - from;
+        span.value = value;
+        __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+      }
+
+      // The spans dropped by all the threads because their ring was full
+      static uint64_t getNbDropped()
+      {
+        Writer& w = writer();
+        std::lock_guard<std::mutex> lock(w.mutex);
+        uint64_t nbDropped = w.nbDropped;
+        for (size_t r = 0; r < w.rings.size(); r++)
+          nbDropped += __atomic_load_n(&w.rings[r]->nbDropped, __ATOMIC_RELAXED);
+        return nbDropped;
+      }
+
+    private:
+      static void loop()
+      {
+        Writer& w = writer();
+        std::unique_lock<std::mutex> lock(w.mutex);
+        while (!w.stopped)
+        {
+          drain(w);
+          w.condition.wait_for(lock, std::chrono::milliseconds(int(FLUSH_PERIOD)));
+        }
+      }
+
+      // Writes the spans of all the rings; with the mutex of w
+      static void drain(Writer& w)
+      {
+        for (size_t r = 0; r < w.rings.size(); r++)
+          drain(w, w.rings[r]);
+        std::fflush(w.file);
+      }
+
+      // Writes the spans of ring; with the mutex of w
+      static void drain(Writer& w, Ring* ring)
+      {
+        const uint64_t pid = uint64_t(getpid());
+        // The numbers of a span, without its name
+        char line[192];
+        const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        for (uint64_t i = ring->tail; i < head; i++)
+        {
+          // The formatting of the spans is the cost of the writer: no printf(..)
+          const Span& span = ring->spans[i & (RING_SIZE - 1)];
+          std::fputs(w.first ? "{\"name\":\"" : ",\n{\"name\":\"", w.file);
+          std::fputs(span.name, w.file);
+          char* p = append(line, "\",\"ph\":\"X\",\"pid\":");
+          p = append(p, pid);
+          p = append(p, ",\"tid\":");
+          p = append(p, uint64_t(ring->tid));
+          p = append(p, ",\"ts\":");
+          p = appendMicros(p, span.start);
+          p = append(p, ",\"dur\":");
+          p = appendMicros(p, span.duration);
+          if (span.value >= 0)
+          {
+            p = append(p, ",\"args\":{\"value\":");
+            p = append(p, uint64_t(span.value));
+            *p++ = '}';
+          }
+          *p++ = '}';
+          std::fwrite(line, 1, p - line, w.file);
+          w.first = false;
+        }
+        __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+      }
+
+      static char* append(char* p, const char* text)
+      {
+        while (*text)
+          *p++ = *text++;
+        return p;
+      }
+
+      static char* append(char* p, uint64_t value)
+      {
+        char digits[20];
+        int n = 0;
+        do
+        {
+          digits[n++] = char('0' + value % 10);
+          value /= 10;
+        } while (value);
+        while (n)
+          *p++ = digits[--n];
+        return p;
+      }
+
+      // ns as us, with the ns as decimals
+      static char* appendMicros(char* p, const uint64_t& nanos)
+      {
+        p = append(p, nanos / 1000);
+        const unsigned fraction = unsigned(nanos % 1000);
+        *p++ = '.';
+        *p++ = char('0' + fraction / 100);
+        *p++ = char('0' + fraction / 10 % 10);
+        *p++ = char('0' + fraction % 10);
+        return p;
+      }
+#else
+    public:
+      static bool enabled()
+      {
+        return false;
+      }
+
+      static bool start(const char*)
+      {
+        return false;
+      }
+
+      static void stop()
+      {
+      }
+
+      static void record(const char*, const uint64_t&, const uint64_t&, const int64_t& = -1)
+      {
+      }
+
+      static uint64_t getNbDropped()
+      {
+        return 0;
+      }
+#endif
+  };
+
+  // Records its scope as a span, if the timeline is enabled
+  class TimelineScope
+  {
+    protected:
+      const char* name;
+      int64_t value;
+      uint64_t start; // 0: not recorded
+
+    public:
+      TimelineScope(const char* name, const int64_t& value = -1) :
+          name(name), value(value), start(Timeline::enabled() ? Timeline::now() : 0)
+      {
+      }
+
+      ~TimelineScope()
+      {
+        if (start)
+          Timeline::record(name, start, Timeline::now(), value);
+      }
+  };
+
+}  // namespace RLLib
+
+#define RLLIB_TIMELINE(name) RLLib::TimelineScope rllibTimeline(name)
+
+#endif /* TIMELINE_H_ */
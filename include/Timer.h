@@ -26,9 +26,10 @@
 #ifdef _MSC_VER
 #include <windows.h>
 #else
-#include <sys/time.h>
+#include <time.h>
 #endif
 #include <stdlib.h>
+#include <stdint.h>
 
 namespace RLLib
 {
@@ -42,8 +43,8 @@ namespace RLLib
         startCount.QuadPart = 0;
         endCount.QuadPart = 0;
 #else
-        startCount.tv_sec = startCount.tv_usec = 0;
-        endCount.tv_sec = endCount.tv_usec = 0;
+        startCount.tv_sec = startCount.tv_nsec = 0;
+        endCount.tv_sec = endCount.tv_nsec = 0;
 #endif
 
         stopped = 0;
@@ -61,7 +62,7 @@ namespace RLLib
 #ifdef _MSC_VER
             QueryPerformanceCounter(&startCount);
 #else
-        gettimeofday(&startCount, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &startCount);
 #endif
       }
 
@@ -72,7 +73,7 @@ namespace RLLib
 #ifdef _MSC_VER
         QueryPerformanceCounter(&endCount);
 #else
-        gettimeofday(&endCount, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &endCount);
 #endif
       }
 
@@ -86,15 +87,34 @@ namespace RLLib
         endTimeInMicroSec = endCount.QuadPart * (1000000.0 / frequency.QuadPart);
 #else
         if (!stopped)
-          gettimeofday(&endCount, NULL);
+          clock_gettime(CLOCK_MONOTONIC, &endCount);
 
-        startTimeInMicroSec = (startCount.tv_sec * 1000000.0) + startCount.tv_usec;
-        endTimeInMicroSec = (endCount.tv_sec * 1000000.0) + endCount.tv_usec;
+        startTimeInMicroSec = (startCount.tv_sec * 1000000.0) + startCount.tv_nsec * 0.001;
+        endTimeInMicroSec = (endCount.tv_sec * 1000000.0) + endCount.tv_nsec * 0.001;
 #endif
 
         return endTimeInMicroSec - startTimeInMicroSec;
       }
 
+      // The start and the stop of the timer, in ns of the monotonic clock of Timeline::now()
+      uint64_t getStartInNanoSec() const
+      {
+#ifdef _MSC_VER
+        return uint64_t(startCount.QuadPart * (1e9 / frequency.QuadPart));
+#else
+        return uint64_t(startCount.tv_sec) * 1000000000ULL + startCount.tv_nsec;
+#endif
+      }
+
+      uint64_t getStopInNanoSec() const
+      {
+#ifdef _MSC_VER
+        return uint64_t(endCount.QuadPart * (1e9 / frequency.QuadPart));
+#else
+        return uint64_t(endCount.tv_sec) * 1000000000ULL + endCount.tv_nsec;
+#endif
+      }
+
       double getElapsedTimeInSec()
       {
         return this->getElapsedTimeInMicroSec() * 0.000001;
@@ -121,8 +141,9 @@ namespace RLLib
       LARGE_INTEGER startCount;//
       LARGE_INTEGER endCount;//
 #else
-      timeval startCount;                         //
-      timeval endCount;                           //
+      // The monotonic clock does not jump with the adjustments of the wall clock
+      timespec startCount;                        //
+      timespec endCount;                          //
 #endif
   };
 
@@ -24,12 +24,13 @@
 
 #include "Mathema.h"
 #include "Vector.h"
+#include "Instrumentation.h"
 
 namespace RLLib
 {
 
   template<typename T>
-  class Trace
+  class Trace: public ArenaAllocated
   {
     public:
       virtual ~Trace()
@@ -38,6 +39,19 @@ namespace RLLib
       virtual void update(const T& lambda, const Vector<T>* phi, const T& factor = T(1)) =0;
       virtual void clear() =0;
       virtual Vector<T>* vect() const =0;
+
+      // Allocates room for maximumSize active features, so that the trace does not grow
+      virtual void reserve(const int& /*maximumSize*/)
+      {
+      }
+
+      // Adds the node name of this trace, with its vector, to footprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (node)
+          vect()->memoryFootprint(node, "vector");
+      }
   };
 
   template<typename T>
@@ -84,6 +98,7 @@ namespace RLLib
 
       void update(const T& lambda, const Vector<T>* phi, const T& factor = T(1))
       {
+        RLLIB_PROBE(TRACE);
         updateVector(lambda, phi, factor);
         adjustUpdate();
         clearBelowThreshold();
@@ -100,6 +115,13 @@ namespace RLLib
         return vector;
       }
 
+      void reserve(const int& maximumSize)
+      {
+        SparseVector<T>* svector = RTTI<T>::sparseVector(vector);
+        if (svector)
+          svector->reserve(maximumSize);
+      }
+
     protected:
       virtual void adjustUpdate()
       { // Nothing to be adjusted.
@@ -230,6 +252,7 @@ namespace RLLib
 
       void update(const T& lambda, const Vector<T>* phi, const T& factor = T(1))
       {
+        RLLIB_PROBE(TRACE);
         trace->update(lambda, phi, factor);
         controlLength();
       }
@@ -243,10 +266,16 @@ namespace RLLib
       {
         return trace->vect();
       }
+
+      // The trace exceeds maximumLength by the active features of phi before update(..) trims it
+      void reserve(const int& maximumSize)
+      {
+        trace->reserve(maximumSize);
+      }
   };
 
   template<typename T>
-  class Traces
+  class Traces: public ArenaAllocated
   {
     protected:
       typename std::vector<Trace<T>*> traces;
@@ -265,16 +294,16 @@ namespace RLLib
 
       Traces(const Traces<T>& that)
       {
-        for (typename Traces<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+        for (typename Traces<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
           traces.push_back(*iter);
       }
 
       Traces<T>& operator=(const Traces<T>& that)
       {
-        if (this != that)
+        if (this != &that)
         {
           traces.clear();
-          for (typename Traces<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+          for (typename Traces<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
             traces.push_back(*iter);
         }
         return *this;
@@ -320,11 +349,28 @@ namespace RLLib
         return traces.at(index);
       }
 
+      // Adds name.0, name.1, ... to footprint
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        char entry[32];
+        for (size_t i = 0; i < traces.size(); i++)
+        {
+          std::snprintf(entry, sizeof(entry), ".%i", int(i));
+          traces[i]->memoryFootprint(footprint, name + entry);
+        }
+      }
+
       void clear()
       {
         for (typename Traces<T>::iterator iter = begin(); iter != end(); ++iter)
           (*iter)->clear();
       }
+
+      void reserve(const int& maximumSize)
+      {
+        for (typename Traces<T>::iterator iter = begin(); iter != end(); ++iter)
+          (*iter)->reserve(maximumSize);
+      }
   };
 
 } // namespace RLLib
@@ -22,7 +22,9 @@
 #ifndef VECTOR_H_
 #define VECTOR_H_
 
+#include "Arena.h"
 #include "Affirm.h"
+#include "MemoryFootprint.h"
 
 #if !defined(EMBEDDED_MODE)
 #include <iostream>
@@ -51,13 +53,34 @@ namespace RLLib
   template<typename T> std::ostream& operator<<(std::ostream& out, const SparseVector<T>& that);
   template<typename T> std::ostream& operator<<(std::ostream& out, const Vector<T>* that);
 #endif
+
+  /**
+   * Type used to accumulate the reductions of a Vector<T>, i.e., dot products,
+   * sums, and norms. Define RLLIB_MIXED_PRECISION to store float parameters
+   * while accumulating in double.
+   */
+  template<typename T>
+  class Accumulator
+  {
+    public:
+      typedef T type;
+  };
+
+#if defined(RLLIB_MIXED_PRECISION)
+  template<>
+  class Accumulator<float>
+  {
+    public:
+      typedef double type;
+  };
+#endif
   /**
    * This is used in parameter representation in a given vector space for
    * Machine Learning purposes. This implementation is specialized for sparse
    * vector representation, that is much common in Reinforcement Learning.
    */
   template<typename T>
-  class Vector
+  class Vector: public ArenaAllocated
   {
     public:
       /**
@@ -122,6 +145,8 @@ namespace RLLib
       // Storage management
       virtual void persist(const char* f) const =0;
       virtual void resurrect(const char* f) =0;
+      // Adds the node name of this vector to footprint, see MemoryFootprint
+      virtual void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const =0;
 
       // Return the type of the vector for alternative dynamic checks.
       virtual VectorType getVectorType() const
@@ -145,28 +170,124 @@ namespace RLLib
 #endif
   };
 
+  /**
+   * One bit per block of 2^blockShift entries of a DenseVector<T>, set when an
+   * entry of the block may have been modified, e.g., to write only the modified
+   * blocks of a checkpoint.
+   */
+  class DirtyBlocks
+  {
+    protected:
+      int blockShift;
+      int nbBlocks;
+      int nbWords;
+      unsigned int* bits;
+
+    public:
+      DirtyBlocks(const int& capacity, const int& blockShift) :
+          blockShift(blockShift), nbBlocks(((capacity - 1) >> blockShift) + 1), //
+          nbWords((nbBlocks + 31) / 32), bits(new unsigned int[nbWords])
+      {
+        markAll();
+      }
+
+      ~DirtyBlocks()
+      {
+        delete[] bits;
+      }
+
+    private:
+      DirtyBlocks(const DirtyBlocks& that);
+      DirtyBlocks& operator=(const DirtyBlocks& that);
+
+    public:
+      void mark(const int& index)
+      {
+        const int block = index >> blockShift;
+        bits[block >> 5] |= 1u << (block & 31);
+      }
+
+      void mark(const int* indexes, const int& nbIndexes)
+      {
+        for (const int* index = indexes; index < indexes + nbIndexes; ++index)
+          mark(*index);
+      }
+
+      void markAll()
+      {
+        std::fill(bits, bits + nbWords, ~0u);
+      }
+
+      void clear()
+      {
+        std::fill(bits, bits + nbWords, 0u);
+      }
+
+      bool isDirty(const int& block) const
+      {
+        return (bits[block >> 5] >> (block & 31)) & 1u;
+      }
+
+      int nbDirtyBlocks() const
+      {
+        int result = 0;
+        for (int block = 0; block < nbBlocks; block++)
+          if (isDirty(block))
+            ++result;
+        return result;
+      }
+
+      int getNbBlocks() const
+      {
+        return nbBlocks;
+      }
+
+      int getBlockShift() const
+      {
+        return blockShift;
+      }
+
+      size_t bytes() const
+      {
+        return nbWords * sizeof(unsigned int);
+      }
+  };
+
   template<typename T>
   class DenseVector: public Vector<T>
   {
     protected:
       int capacity;
       T* data;
+      DirtyBlocks* dirty;
 
     public:
       DenseVector(const int& capacity = 1) :
-          Vector<T>(Vector<T>::DENSE_VECTOR), capacity(capacity), data(new T[capacity])
+          Vector<T>(Vector<T>::DENSE_VECTOR), capacity(capacity), //
+          data(Arena::newArray<T>(capacity)), dirty(0)
       {
         std::fill(data, data + capacity, 0);
       }
 
       virtual ~DenseVector()
       {
-        delete[] data;
+        Arena::deleteArray(data);
+        if (dirty)
+          delete dirty;
       }
 
+    protected:
+      // Adopts the entries of an external buffer, e.g., a memory-mapped file
+      DenseVector(T* data, const int& capacity) :
+          Vector<T>(Vector<T>::DENSE_VECTOR), capacity(capacity), data(data), dirty(0)
+      {
+      }
+
+    public:
       // Implementation details for copy constructor and operator
       DenseVector(const DenseVector<T>& that) :
-          Vector<T>(Vector<T>::DENSE_VECTOR), capacity(that.capacity), data(new T[that.capacity])
+          Vector<T>(Vector<T>::DENSE_VECTOR), capacity(that.capacity), //
+          data(Arena::newArray<T>(that.capacity)), dirty(0)
       {
         std::copy(that.data, that.data + that.capacity, data);
       }
@@ -175,14 +296,59 @@ namespace RLLib
       {
         if (this != &that)
         {
-          delete[] data; // delete old
+          Arena::deleteArray(data); // delete old
           capacity = that.capacity;
-          data = new T[capacity];
+          data = Arena::newArray<T>(capacity);
           std::copy(that.data, that.data + capacity, data);
+          if (dirty)
+            trackDirtyBlocks(dirty->getBlockShift(), true);
         }
         return *this;
       }
 
+      /**
+       * Tracks the blocks of 2^blockShift entries modified from now on; all the
+       * blocks start dirty. Handing out the entries for writing marks them dirty:
+       * all of them for getValues(), the active entries of that for
+       * getValues(that), and the entry for operator[]. The reads go through the
+       * const overloads, which mark nothing.
+       */
+      void trackDirtyBlocks(const int& blockShift = 10, const bool& reset = false)
+      {
+        if (dirty && dirty->getBlockShift() == blockShift && !reset)
+          return;
+        if (dirty)
+          delete dirty;
+        dirty = new DirtyBlocks(capacity, blockShift);
+      }
+
+      void untrackDirtyBlocks()
+      {
+        if (dirty)
+          delete dirty;
+        dirty = 0;
+      }
+
+      DirtyBlocks* dirtyBlocks()
+      {
+        return dirty;
+      }
+
+      const DirtyBlocks* dirtyBlocks() const
+      {
+        return dirty;
+      }
+
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        node->add(capacity * sizeof(T), capacity * sizeof(T));
+        if (dirty)
+          node->add(dirty->bytes(), dirty->bytes());
+      }
+
     public:
       int dimension() const
       {
@@ -210,20 +376,21 @@ namespace RLLib
 
       T l1Norm() const
       {
-        T result = T(0);
+        typename Accumulator<T>::type result(0);
         for (int i = 0; i < capacity; i++)
           result += std::abs(data[i]);
-        return result;
+        return T(result);
       }
 
       T sum() const
       {
-        return std::accumulate(data, data + capacity, T(0));
+        return T(std::accumulate(data, data + capacity, typename Accumulator<T>::type(0)));
       }
 
-      // Return the data as an array
+      // Return the data as an array; all the blocks are marked dirty
       T* getValues()
       {
+        markAll();
         return data;
       }
 
@@ -232,10 +399,19 @@ namespace RLLib
         return data;
       }
 
+      // The data, to write the active entries of that only
+      T* getValues(const SparseVector<T>* that)
+      {
+        mark(that);
+        return data;
+      }
+
       // Get elements
       T& operator[](const int& index)
       {
         ASSERT(index >= 0 && index < capacity);
+        if (dirty)
+          dirty->mark(index);
         return data[index];
       }
 
@@ -265,6 +441,7 @@ namespace RLLib
       void clear()
       {
         std::fill(data, data + capacity, 0);
+        markAll();
       }
 
       void setEntry(const int& index, const T& value)
@@ -281,6 +458,7 @@ namespace RLLib
       {
         for (int i = 0; i < capacity; i++)
           data[i] += value;
+        markAll();
         return this;
       }
 
@@ -288,6 +466,7 @@ namespace RLLib
       {
         for (T* i = data; i < data + capacity; ++i)
           *i *= d;
+        markAll();
         return this;
       }
 
@@ -296,6 +475,7 @@ namespace RLLib
         ASSERT(this->dimension() == that->dimension());
         for (int i = 0; i < this->dimension(); i++)
           data[i] *= that->getEntry(i);
+        markAll();
         return this;
       }
 
@@ -308,12 +488,14 @@ namespace RLLib
           if (thatValue != 0)
             data[i] /= thatValue;
         }
+        markAll();
         return this;
       }
 
       Vector<T>* set(const T& value)
       {
         std::fill(data, data + capacity, value);
+        markAll();
         return this;
       }
 
@@ -357,14 +539,18 @@ namespace RLLib
           int rcapacity;
           Vector<T>::read(ifs, rcapacity);
           //ASSERT(capacity == rcapacity);
-          delete[] data;
-          capacity = rcapacity;
-          data = new T[capacity];
-          clear();
+          if (capacity != rcapacity)
+          {
+            Arena::deleteArray(data);
+            capacity = rcapacity;
+            data = Arena::newArray<T>(capacity);
+            if (dirty)
+              trackDirtyBlocks(dirty->getBlockShift(), true);
+          }
+          markAll();
           printf("vectorType=%i rcapacity=%i \n", vectorType, rcapacity);
-          // Read data
-          for (int j = 0; j < capacity; j++)
-            Vector<T>::read(ifs, data[j]);
+          // Read data in bulk; no need to clear the entries first
+          ifs.read(reinterpret_cast<char*>(data), capacity * sizeof(T));
           ifs.close();
           std::cout << "## DenseVector (sum=" << sum() << ", l1Norm=" << l1Norm() << ", maxNorm="
               << maxNorm() << ") resurrected=" << f;
@@ -383,6 +569,18 @@ namespace RLLib
           const DenseVector<O>& that);
 #endif
 
+    protected:
+      void markAll()
+      {
+        if (dirty)
+          dirty->markAll();
+      }
+
+      void mark(const SparseVector<T>* that)
+      {
+        if (dirty)
+          dirty->mark(that->nonZeroIndexes(), that->nonZeroElements());
+      }
   };
 
   /**
@@ -405,24 +603,26 @@ namespace RLLib
       SparseVector(const int& capacity = 1, const int& activeIndexesLength = 10) :
           Vector<T>(Vector<T>::SPARSE_VECTOR), indexesPositionLength(capacity), //
           activeIndexesLength(activeIndexesLength), nbActive(0), //
-          indexesPosition(new int[indexesPositionLength]), //
-          activeIndexes(new int[activeIndexesLength]), values(new T[activeIndexesLength])
+          indexesPosition(Arena::newArray<int>(indexesPositionLength)), //
+          activeIndexes(Arena::newArray<int>(activeIndexesLength)), //
+          values(Arena::newArray<T>(activeIndexesLength))
       {
         std::fill(indexesPosition, indexesPosition + capacity, -1);
       }
 
       virtual ~SparseVector()
       {
-        delete[] indexesPosition;
-        delete[] activeIndexes;
-        delete[] values;
+        Arena::deleteArray(indexesPosition);
+        Arena::deleteArray(activeIndexes);
+        Arena::deleteArray(values);
       }
 
       SparseVector(const SparseVector<T>& that) :
           Vector<T>(Vector<T>::SPARSE_VECTOR), indexesPositionLength(that.indexesPositionLength), //
           activeIndexesLength(that.activeIndexesLength), nbActive(that.nbActive), //
-          indexesPosition(new int[that.indexesPositionLength]), //
-          activeIndexes(new int[that.activeIndexesLength]), values(new T[that.activeIndexesLength])
+          indexesPosition(Arena::newArray<int>(that.indexesPositionLength)), //
+          activeIndexes(Arena::newArray<int>(that.activeIndexesLength)), //
+          values(Arena::newArray<T>(that.activeIndexesLength))
       {
         std::copy(that.indexesPosition, that.indexesPosition + that.indexesPositionLength,
             indexesPosition);
@@ -433,15 +633,15 @@ namespace RLLib
       {
         if (this != &that)
         {
-          delete[] indexesPosition;
-          delete[] activeIndexes;
-          delete[] values;
+          Arena::deleteArray(indexesPosition);
+          Arena::deleteArray(activeIndexes);
+          Arena::deleteArray(values);
           indexesPositionLength = that.indexesPositionLength;
           activeIndexesLength = that.activeIndexesLength;
           nbActive = that.nbActive;
-          indexesPosition = new int[indexesPositionLength];
-          activeIndexes = new int[activeIndexesLength];
-          values = new T[activeIndexesLength];
+          indexesPosition = Arena::newArray<int>(indexesPositionLength);
+          activeIndexes = Arena::newArray<int>(activeIndexesLength);
+          values = Arena::newArray<T>(activeIndexesLength);
 
           std::copy(that.indexesPosition, that.indexesPosition + that.indexesPositionLength,
               indexesPosition);
@@ -498,30 +698,40 @@ namespace RLLib
           setNonZeroEntry(index, value);
       }
 
-    private:
-      void allocate(int sizeRequired)
+    public:
+      /**
+       * Allocates room for nbActive active entries, e.g., the maximum size of
+       * a trace, so that the vector does not grow while it is used
+       */
+      void reserve(const int& nbActive)
       {
-        if (activeIndexesLength >= sizeRequired)
+        if (activeIndexesLength >= nbActive)
           return;
-        int newCapacity = (sizeRequired * 3) / 2 + 1;
-        int* newActiveIndexes = new int[newCapacity];
-        T* newValues = new T[newCapacity];
+        int* newActiveIndexes = Arena::newArray<int>(nbActive);
+        T* newValues = Arena::newArray<T>(nbActive);
 
         std::copy(activeIndexes, activeIndexes + activeIndexesLength, newActiveIndexes);
-        std::fill(newActiveIndexes + activeIndexesLength, newActiveIndexes + newCapacity, 0);
+        std::fill(newActiveIndexes + activeIndexesLength, newActiveIndexes + nbActive, 0);
 
         std::copy(values, values + activeIndexesLength, newValues);
-        std::fill(newValues + activeIndexesLength, newValues + newCapacity, 0);
+        std::fill(newValues + activeIndexesLength, newValues + nbActive, 0);
 
-        activeIndexesLength = newCapacity;
+        activeIndexesLength = nbActive;
         // remove old pointers
-        delete[] activeIndexes;
-        delete[] values;
+        Arena::deleteArray(activeIndexes);
+        Arena::deleteArray(values);
         // set new pointers
         activeIndexes = newActiveIndexes;
         values = newValues;
       }
 
+    private:
+      void allocate(int sizeRequired)
+      {
+        if (activeIndexesLength < sizeRequired)
+          reserve((sizeRequired * 3) / 2 + 1);
+      }
+
       void appendEntry(const int& index, const T& value)
       {
         allocate(nbActive + 1);
@@ -563,7 +773,7 @@ namespace RLLib
 
       T sum() const
       {
-        return std::accumulate(values, values + nbActive, T(0));
+        return T(std::accumulate(values, values + nbActive, typename Accumulator<T>::type(0)));
       }
 
       const int* nonZeroIndexes() const
@@ -576,6 +786,21 @@ namespace RLLib
         return indexesPosition;
       }
 
+      /**
+       * The active entries, allocated with a growth factor of 1.5, and the
+       * dense map from the indexes to their positions, a child node
+       */
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        node->add(activeIndexesLength * (sizeof(int) + sizeof(T)),
+            nbActive * (sizeof(int) + sizeof(T)));
+        node->child("indexesPosition", 0)->add(indexesPositionLength * sizeof(int),
+            indexesPositionLength * sizeof(int));
+      }
+
       int nonZeroElements() const
       {
         return nbActive;
@@ -607,10 +832,10 @@ namespace RLLib
 
       T l1Norm() const
       {
-        T result = T(0);
+        typename Accumulator<T>::type result(0);
         for (int position = 0; position < nbActive; position++)
           result += std::abs(values[position]);
-        return result;
+        return T(result);
       }
 
       T* getValues()
@@ -625,10 +850,11 @@ namespace RLLib
 
       T dotProduct(const T* data) const
       {
-        T result = T(0);
+        typedef typename Accumulator<T>::type Accumulated;
+        Accumulated result(0);
         for (int position = 0; position < nbActive; position++)
-          result += data[activeIndexes[position]] * values[position];
-        return result;
+          result += Accumulated(data[activeIndexes[position]]) * Accumulated(values[position]);
+        return T(result);
       }
 
       void addSelfTo(const T& factor, T* data) const
@@ -695,8 +921,8 @@ namespace RLLib
           Vector<T>::read(ifs, rnbActive);
           //ASSERT(indexesPositionLength == rcapacity);
           indexesPositionLength = rcapacity;
-          delete[] indexesPosition;
-          indexesPosition = new int[indexesPositionLength];
+          Arena::deleteArray(indexesPosition);
+          indexesPosition = Arena::newArray<int>(indexesPositionLength);
           std::fill(indexesPosition, indexesPosition + indexesPositionLength, -1);
           clear();
           // Verbose
@@ -786,6 +1012,14 @@ namespace RLLib
       {
       }
 
+    protected:
+      PVector(T* data, const int& capacity) :
+          DenseVector<T>(data, capacity)
+      {
+      }
+
+    public:
+
       PVector(const PVector<T>& that) :
           DenseVector<T>(that)
       {
@@ -806,6 +1040,7 @@ namespace RLLib
       {
         for (T* i = Base::data; i < Base::data + this->dimension(); ++i)
           *i *= d;
+        Base::markAll();
         return *this;
       }
 
@@ -817,10 +1052,11 @@ namespace RLLib
         if (other)
           return other->dotProduct(this->getValues());
 
-        T result = T(0);
+        typedef typename Accumulator<T>::type Accumulated;
+        Accumulated result(0);
         for (int i = 0; i < this->dimension(); i++)
-          result += Base::data[i] * that->getEntry(i);
-        return result;
+          result += Accumulated(Base::data[i]) * Accumulated(that->getEntry(i));
+        return T(result);
       }
 
       Vector<T>* addToSelf(const T& factor, const Vector<T>* that)
@@ -829,12 +1065,13 @@ namespace RLLib
         const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
         if (other)
         {
-          other->addSelfTo(factor, this->getValues());
+          other->addSelfTo(factor, Base::getValues(other));
           return this;
         }
 
         for (int i = 0; i < this->dimension(); i++) // FixMe: SIMD
           Base::data[i] += factor * that->getEntry(i);
+        Base::markAll();
         return this;
       }
 
@@ -849,12 +1086,13 @@ namespace RLLib
         const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
         if (other)
         {
-          other->subtractSelfTo(this->getValues());
+          other->subtractSelfTo(Base::getValues(other));
           return this;
         }
 
         for (int i = 0; i < this->dimension(); i++) // FixMe: SIMD
           Base::data[i] -= that->getEntry(i);
+        Base::markAll();
         return this;
       }
 
@@ -864,12 +1102,13 @@ namespace RLLib
         const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
         if (other)
         {
-          other->subtractSelfTo(this->getValues());
+          other->subtractSelfTo(Base::getValues(other));
           return *this;
         }
 
         for (int i = 0; i < this->dimension(); i++) // FixMe: SIMD
           Base::data[i] -= that->getEntry(i);
+        Base::markAll();
         return *this;
       }
 
@@ -879,12 +1118,13 @@ namespace RLLib
         const SparseVector<T>* other = RTTI<T>::constSparseVector(that);
         if (other)
         {
-          other->addSelfTo(T(1), this->getValues());
+          other->addSelfTo(T(1), Base::getValues(other));
           return *this;
         }
 
         for (int i = 0; i < this->dimension(); i++) // FixMe: SIMD
           Base::data[i] += that->getEntry(i);
+        Base::markAll();
         return *this;
       }
 
@@ -897,6 +1137,7 @@ namespace RLLib
           if (thatValue != 0)
             Base::data[i] /= thatValue;
         }
+        Base::markAll();
         return *this;
       }
 
@@ -908,7 +1149,7 @@ namespace RLLib
         if (other)
         {
           std::copy(other->getValues(), other->getValues() + other->dimension(),
-              this->getValues() + offset); // FixMe: SIMD
+              Base::data + offset); // FixMe: SIMD
           return this;
         }
 
@@ -989,10 +1230,12 @@ namespace RLLib
         if (other && other->nonZeroElements() < this->nonZeroElements())
           return other->dot(this);
 
-        T result = T(0);
+        typedef typename Accumulator<T>::type Accumulated;
+        Accumulated result(0);
         for (int position = 0; position < Base::nbActive; position++)
-          result += that->getEntry(Base::activeIndexes[position]) * Base::values[position];
-        return result;
+          result += Accumulated(that->getEntry(Base::activeIndexes[position]))
+              * Accumulated(Base::values[position]);
+        return T(result);
       }
 
       Vector<T>* addToSelf(const T& value)
@@ -1170,16 +1413,16 @@ namespace RLLib
 
       Vectors(const Vectors<T>& that)
       {
-        for (typename Vectors<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+        for (typename Vectors<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
           vectors.push_back(*iter);
       }
 
       Vectors<T>& operator=(const Vectors<T>& that)
       {
-        if (this != that)
+        if (this != &that)
         {
           vectors.clear();
-          for (typename Vectors<T>::iterator iter = that.begin(); iter != that.end(); ++iter)
+          for (typename Vectors<T>::const_iterator iter = that.begin(); iter != that.end(); ++iter)
             vectors.push_back(*iter);
         }
         return *this;
@@ -1231,6 +1474,17 @@ namespace RLLib
         return vectors.at(index);
       }
 
+      // Adds name.0, name.1, ... to footprint
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        char entry[32];
+        for (size_t i = 0; i < vectors.size(); i++)
+        {
+          std::snprintf(entry, sizeof(entry), ".%i", int(i));
+          vectors[i]->memoryFootprint(footprint, name + entry);
+        }
+      }
+
       void persist(const char* f) const
       {
 #if !defined(EMBEDDED_MODE)
@@ -1336,7 +1590,7 @@ namespace RLLib
           const SparseVector<T>* other, const T& min)
       {
         const int* activeIndexes = other->nonZeroIndexes();
-        T* resultValues = result->getValues();
+        T* resultValues = result->getValues(other);
         const T* otherValues = other->getValues();
         for (int i = 0; i < other->nonZeroElements(); i++)
         {
@@ -1475,10 +1729,37 @@ namespace RLLib
         return stackedVectors[nbAllocation - 1]->set(v);
       }
 
+      // Allocates nbVectors vectors like prototype, handed out by newVector(..) without growing
+      void reserve(const int& nbVectors, const Vector<T>* prototype)
+      {
+        stackedVectors.reserve(nbVectors);
+        while (static_cast<int>(stackedVectors.size()) < nbVectors)
+        {
+          stackedVectors.push_back(prototype->newInstance(dimension));
+          stackedVectors.back()->set(prototype);
+        }
+      }
+
       void releaseAll()
       {
         nbAllocation = 0;
       }
+
+      // The vectors of the pool; those handed out since releaseAll() are live
+      void memoryFootprint(MemoryFootprint* footprint, const std::string& name) const
+      {
+        MemoryFootprint* node = footprint->child(name, this);
+        if (!node)
+          return;
+        node->add(stackedVectors.capacity() * sizeof(Vector<T>*),
+            stackedVectors.size() * sizeof(Vector<T>*));
+        for (size_t i = 0; i < stackedVectors.size(); i++)
+        {
+          MemoryFootprint vector;
+          stackedVectors[i]->memoryFootprint(&vector, "vector");
+          node->add(vector.allocatedBytes(), int(i) < nbAllocation ? vector.liveBytes() : 0);
+        }
+      }
   };
 
 #if !defined(EMBEDDED_MODE)
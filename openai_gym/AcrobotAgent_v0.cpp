@@ -51,3 +51,12 @@ const RLLib::Action<double>* AcrobotAgent_v0::step()
   return simulator->getAgentAction();
 }
 
+void AcrobotAgent_v0::reset()
+{
+  simulator->reset();
+}
+
+void AcrobotAgent_v0::accept(RLLib::Archive<double>* archive)
+{
+  archive->add("control", control);
+}
@@ -0,0 +1,204 @@
+/*
+ * AsyncTcpServer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#include <boost/bind.hpp>
+//
+#include "AsyncTcpServer.h"
+
+AsyncTcpSession::AsyncTcpSession(boost::asio::io_service& io_service) :
+    socket(io_service), payload(1)
+{
+}
+
+AsyncTcpSession::~AsyncTcpSession()
+{
+}
+
+boost::asio::ip::tcp::socket& AsyncTcpSession::getSocket()
+{
+  return socket;
+}
+
+void AsyncTcpSession::start()
+{
+  socket.set_option(boost::asio::ip::tcp::no_delay(true));
+  // The first four bytes select the protocol
+  boost::asio::async_read(socket, boost::asio::buffer(&header.magic, sizeof(header.magic)),
+      boost::bind(&AsyncTcpSession::onMagic, shared_from_this(),
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpSession::onMagic(const boost::system::error_code& error)
+{
+  if (error)
+  {
+    close(error);
+    return;
+  }
+  if (header.magic == RLLibOpenAiGymProtocol::MAGIC)
+  {
+    const size_t offset = sizeof(header.magic);
+    boost::asio::async_read(socket,
+        boost::asio::buffer(reinterpret_cast<char*>(&header) + offset, sizeof(header) - offset),
+        boost::bind(&AsyncTcpSession::onHeader, shared_from_this(),
+            boost::asio::placeholders::error));
+  }
+  else
+  {
+    text.assign(reinterpret_cast<const char*>(&header.magic), sizeof(header.magic));
+    readText();
+  }
+}
+
+void AsyncTcpSession::readHeader()
+{
+  boost::asio::async_read(socket, boost::asio::buffer(&header, sizeof(header)),
+      boost::bind(&AsyncTcpSession::onHeader, shared_from_this(),
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpSession::onHeader(const boost::system::error_code& error)
+{
+  if (error || !RLLibOpenAiGymProtocol::isValid(header))
+  {
+    close(error);
+    return;
+  }
+  // The buffers only grow, so the steps do not allocate; in size_t, so that it cannot wrap
+  const size_t payloadSize = header.payloadSize;
+  if (payload.size() < payloadSize + 1)
+    payload.resize(payloadSize + 1);
+  boost::asio::async_read(socket, boost::asio::buffer(&payload[0], payloadSize),
+      boost::bind(&AsyncTcpSession::onPayload, shared_from_this(),
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpSession::onPayload(const boost::system::error_code& error)
+{
+  if (error)
+  {
+    close(error);
+    return;
+  }
+  if (!proxy.toRLLib(header, &payload[0], reply))
+  {
+    close(boost::system::error_code()); // A malformed frame
+    return;
+  }
+  boost::asio::async_write(socket, boost::asio::buffer(reply),
+      boost::bind(&AsyncTcpSession::onBinaryReply, shared_from_this(),
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpSession::onBinaryReply(const boost::system::error_code& error)
+{
+  if (error)
+    close(error);
+  else
+    readHeader();
+}
+
+void AsyncTcpSession::readText()
+{
+  socket.async_read_some(boost::asio::buffer(buffer),
+      boost::bind(&AsyncTcpSession::onText, shared_from_this(), boost::asio::placeholders::error,
+          boost::asio::placeholders::bytes_transferred));
+}
+
+void AsyncTcpSession::onText(const boost::system::error_code& error, size_t length)
+{
+  if (error)
+  {
+    close(error);
+    return;
+  }
+  text = proxy.toRLLib(text.append(buffer, length));
+  boost::asio::async_write(socket, boost::asio::buffer(text),
+      boost::bind(&AsyncTcpSession::onTextReply, shared_from_this(),
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpSession::onTextReply(const boost::system::error_code& error)
+{
+  text.clear();
+  if (error)
+    close(error);
+  else
+    readText();
+}
+
+void AsyncTcpSession::close(const boost::system::error_code& error)
+{
+  // The session is released with the last handler that refers to it
+  if (error && error != boost::asio::error::eof
+      && error != boost::asio::error::connection_reset)
+    std::cerr << "Exception in session: " << error.message() << "\n";
+  else if (!error)
+    std::cerr << "Exception in session: invalid frame\n";
+  boost::system::error_code ignored;
+  socket.close(ignored);
+}
+
+AsyncTcpServer::AsyncTcpServer(const unsigned short& port, const size_t& nbThreads) :
+    port(port), nextIoService(0), acceptor(io_service)
+{
+  for (size_t i = 0; i < std::max(nbThreads, size_t(1)); ++i)
+  {
+    io_services.push_back(io_service_ptr(new boost::asio::io_service(1)));
+    works.push_back(work_ptr(new boost::asio::io_service::work(*io_services.back())));
+  }
+}
+
+AsyncTcpServer::~AsyncTcpServer()
+{
+}
+
+void AsyncTcpServer::server()
+{
+  std::cout << "AsyncTcpServer::server threads=" << io_services.size() << std::endl;
+  const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
+  acceptor.open(endpoint.protocol());
+  acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+  acceptor.bind(endpoint);
+  acceptor.listen();
+  accept();
+
+  boost::thread_group threads;
+  for (size_t i = 0; i < io_services.size(); ++i)
+    threads.create_thread(
+        boost::bind(&boost::asio::io_service::run, io_services[i].get()));
+  io_service.run();
+  threads.join_all();
+}
+
+void AsyncTcpServer::stop()
+{
+  io_service.stop();
+  works.clear();
+  for (size_t i = 0; i < io_services.size(); ++i)
+    io_services[i]->stop();
+}
+
+void AsyncTcpServer::accept()
+{
+  // The sessions are pinned to the io_services in turn
+  io_service_ptr pinned = io_services[nextIoService];
+  nextIoService = (nextIoService + 1) % io_services.size();
+  session_ptr session(new AsyncTcpSession(*pinned));
+  acceptor.async_accept(session->getSocket(),
+      boost::bind(&AsyncTcpServer::onAccept, this, pinned, session,
+          boost::asio::placeholders::error));
+}
+
+void AsyncTcpServer::onAccept(io_service_ptr pinned, session_ptr session,
+    const boost::system::error_code& error)
+{
+  // start() runs on the thread of the session
+  if (!error)
+    pinned->post(boost::bind(&AsyncTcpSession::start, session));
+  accept();
+}
@@ -0,0 +1,89 @@
+/*
+ * AsyncTcpServer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#ifndef OPENAI_GYM_ASYNCTCPSERVER_H_
+#define OPENAI_GYM_ASYNCTCPSERVER_H_
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <boost/asio.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/enable_shared_from_this.hpp>
+//
+#include "RLLibOpenAiGymProxy.h"
+#include "RLLibOpenAiGymTransport.h"
+
+/**
+ * One connection of the AsyncTcpServer. All the handlers of a session run on
+ * the thread of its io_service, so the agent of the proxy is never accessed
+ * concurrently and needs no locks. The protocol is selected as in
+ * SyncTcpServer::session.
+ */
+class AsyncTcpSession: public boost::enable_shared_from_this<AsyncTcpSession>
+{
+  protected:
+    boost::asio::ip::tcp::socket socket;
+    RLLibOpenAiGymProxy proxy;
+    RLLibOpenAiGymProtocol::FrameHeader header;
+    std::vector<char> payload, reply;
+    char buffer[1024];
+    std::string text;
+
+  public:
+    AsyncTcpSession(boost::asio::io_service& io_service);
+    virtual ~AsyncTcpSession();
+
+    boost::asio::ip::tcp::socket& getSocket();
+    void start();
+
+  protected:
+    void onMagic(const boost::system::error_code& error);
+    void readHeader();
+    void onHeader(const boost::system::error_code& error);
+    void onPayload(const boost::system::error_code& error);
+    void onBinaryReply(const boost::system::error_code& error);
+    void readText();
+    void onText(const boost::system::error_code& error, size_t length);
+    void onTextReply(const boost::system::error_code& error);
+    void close(const boost::system::error_code& error);
+};
+
+/**
+ * Multiplexes all the sessions over nbThreads threads; each thread runs its
+ * own io_service, and the sessions are assigned to them in turn.
+ */
+class AsyncTcpServer: public RLLibOpenAiGymTransport
+{
+  private:
+    typedef boost::shared_ptr<AsyncTcpSession> session_ptr;
+    typedef boost::shared_ptr<boost::asio::io_service> io_service_ptr;
+    typedef boost::shared_ptr<boost::asio::io_service::work> work_ptr;
+
+  protected:
+    unsigned short port;
+    std::vector<io_service_ptr> io_services;
+    std::vector<work_ptr> works;
+    size_t nextIoService;
+    boost::asio::io_service io_service; // accepts the connections
+    boost::asio::ip::tcp::acceptor acceptor;
+
+  public:
+    AsyncTcpServer(const unsigned short& port, const size_t& nbThreads);
+    virtual ~AsyncTcpServer();
+
+    void server();
+    void stop();
+
+  protected:
+    void accept();
+    void onAccept(io_service_ptr pinned, session_ptr session,
+        const boost::system::error_code& error);
+};
+
+#endif /* OPENAI_GYM_ASYNCTCPSERVER_H_ */
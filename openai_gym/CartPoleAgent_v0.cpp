@@ -56,3 +56,13 @@ const RLLib::Action<double>* CartPoleAgent_v0::step()
   simulator->step();
   return simulator->getAgentAction();
 }
+
+void CartPoleAgent_v0::reset()
+{
+  simulator->reset();
+}
+
+void CartPoleAgent_v0::accept(RLLib::Archive<double>* archive)
+{
+  archive->add("control", control);
+}
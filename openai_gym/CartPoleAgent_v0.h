@@ -77,6 +77,8 @@ class CartPoleAgent_v0: public CartPoleAgent_v0Base
     CartPoleAgent_v0();
     virtual ~CartPoleAgent_v0();
     const RLLib::Action<double>* step();
+    void reset();
+    void accept(RLLib::Archive<double>* archive);
 };
 
 #endif /* OPENAI_GYM_CARTPOLEAGENT_V0_H_ */
@@ -54,3 +54,12 @@ const RLLib::Action<double>* LunarLanderAgent_v2::step()
   return simulator->getAgentAction();
 }
 
+void LunarLanderAgent_v2::reset()
+{
+  simulator->reset();
+}
+
+void LunarLanderAgent_v2::accept(RLLib::Archive<double>* archive)
+{
+  archive->add("control", control);
+}
@@ -50,3 +50,12 @@ const RLLib::Action<double>* MountainCarAgent_v0::step()
   return simulator->getAgentAction();
 }
 
+void MountainCarAgent_v0::reset()
+{
+  simulator->reset();
+}
+
+void MountainCarAgent_v0::accept(RLLib::Archive<double>* archive)
+{
+  archive->add("control", control);
+}
@@ -68,6 +68,8 @@ class MountainCarAgent_v0: public MountainCarAgent_v0Base
     MountainCarAgent_v0();
     virtual ~MountainCarAgent_v0();
     const RLLib::Action<double>* step();
+    void reset();
+    void accept(RLLib::Archive<double>* archive);
 };
 
 #endif /* OPENAI_GYM_MOUNTAINCARAGENT_V0_H_ */
@@ -72,3 +72,13 @@ const RLLib::Action<double>* PendulumAgent_v0::step()
   simulator->step();
   return simulator->getAgentAction();
 }
+
+void PendulumAgent_v0::reset()
+{
+  simulator->reset();
+}
+
+void PendulumAgent_v0::accept(RLLib::Archive<double>* archive)
+{
+  archive->add("control", control);
+}
@@ -95,6 +95,8 @@ class PendulumAgent_v0: public PendulumAgent_v0Base
     PendulumAgent_v0();
     virtual ~PendulumAgent_v0();
     const RLLib::Action<double>* step();
+    void reset();
+    void accept(RLLib::Archive<double>* archive);
 };
 
 #endif /* OPENAI_GYM_PENDULUMAGENT_V0_H_ */
@@ -25,6 +25,61 @@ class RLLibOpenAiGymAgent
     }
 
     virtual const RLLib::Action<double>* step() =0;
+
+    // Restores the agent to its initial state; pooled agents are reset before reuse
+    virtual void reset()
+    {
+    }
+
+    // Exposes the learned state, e.g., to a RLLib::Snapshot<double>
+    virtual void accept(RLLib::Archive<double>* archive)
+    {
+    }
+};
+
+/**
+ * The vectors and the scalars exposed by an agent; copies the state of an
+ * agent into another agent of the same type with one copy per vector.
+ */
+class RLLibOpenAiGymAgentState: public RLLib::Archive<double>
+{
+  protected:
+    std::vector<RLLib::Vector<double>*> vectors;
+    std::vector<double*> scalars;
+
+  public:
+    RLLibOpenAiGymAgentState(RLLibOpenAiGymAgent* agent)
+    {
+      agent->accept(this);
+    }
+
+    void add(const char* name, RLLib::Vector<double>* vector)
+    {
+      vectors.push_back(vector);
+    }
+
+    void add(const char* name, double& scalar)
+    {
+      scalars.push_back(&scalar);
+    }
+
+    void add(const char* name, RLLib::Random<double>* random)
+    {
+      // Each agent keeps its own stream
+    }
+
+    void add(const char* name, RLLib::ParameterizedFunction<double>* function)
+    {
+      function->accept(this);
+    }
+
+    void copyTo(RLLibOpenAiGymAgentState* that) const
+    {
+      for (size_t i = 0; i < vectors.size() && i < that->vectors.size(); ++i)
+        that->vectors[i]->set(vectors[i]);
+      for (size_t i = 0; i < scalars.size() && i < that->scalars.size(); ++i)
+        *that->scalars[i] = *scalars[i];
+    }
 };
 
 #endif /* OPENAI_GYM_RLLIBOPENAIGYMAGENT_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "RLLibOpenAiGymAgentRegistry.h"
+#include "Snapshot.h"
 
 RLLibOpenAiGymAgentRegistry::RLLibOpenAiGymAgentRegistry()
 {
@@ -15,7 +16,14 @@ RLLibOpenAiGymAgentRegistry::~RLLibOpenAiGymAgentRegistry()
 {
   for (auto iter = registry.begin(); iter != registry.end(); ++iter)
   {
-    delete iter->second;
+    Entry* entry = iter->second;
+    for (size_t i = 0; i < entry->pool.size(); ++i)
+      delete entry->pool[i];
+    for (auto state = entry->states.begin(); state != entry->states.end(); ++state)
+      delete state->second;
+    delete entry->prototypeState;
+    delete entry->prototype;
+    delete entry;
   }
 }
 
@@ -25,15 +33,33 @@ RLLibOpenAiGymAgentRegistry& RLLibOpenAiGymAgentRegistry::getInstance()
   return theInstance;
 }
 
+RLLibOpenAiGymAgentRegistry::Entry* RLLibOpenAiGymAgentRegistry::find(const std::string& env)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unordered_map<std::string, Entry*>::iterator iter = registry.find(env);
+  return iter != registry.end() ? iter->second : nullptr;
+}
+
 RLLibOpenAiGymAgent* RLLibOpenAiGymAgentRegistry::make(const std::string& env)
 {
   // Register OpenAI Gym agents here
   std::cout << "env: [" << env << "]" << std::endl;
 
-  std::unordered_map<std::string, Entry*>::iterator iter = registry.find(env);
-  if (iter != RLLibOpenAiGymAgentRegistry::getInstance().registry.end())
+  Entry* entry = find(env);
+  if (entry)
   {
-    return iter->second->factory->make();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!entry->pool.empty())
+      {
+        RLLibOpenAiGymAgent* agent = entry->pool.back();
+        entry->pool.pop_back();
+        return agent;
+      }
+    }
+    RLLibOpenAiGymAgent* agent = entry->factory->make();
+    initialize(entry, agent);
+    return agent;
   }
   else
   {
@@ -42,9 +68,96 @@ RLLibOpenAiGymAgent* RLLibOpenAiGymAgentRegistry::make(const std::string& env)
 
 }
 
+void RLLibOpenAiGymAgentRegistry::release(const std::string& env, RLLibOpenAiGymAgent* agent)
+{
+  Entry* entry = find(env);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!entry || entry->pool.size() >= entry->poolSize)
+    {
+      if (entry)
+      {
+        auto state = entry->states.find(agent);
+        if (state != entry->states.end())
+        {
+          delete state->second;
+          entry->states.erase(state);
+        }
+      }
+      delete agent;
+      return;
+    }
+  }
+  // The reset is a copy of the state into the vectors of the agent
+  agent->reset();
+  initialize(entry, agent);
+  std::lock_guard<std::mutex> lock(mutex);
+  entry->pool.push_back(agent);
+}
+
+bool RLLibOpenAiGymAgentRegistry::reserve(const std::string& env, const size_t& nbAgents,
+    const std::string& checkpoint)
+{
+  Entry* entry = find(env);
+  if (!entry)
+  {
+    std::cerr << "ERROR! (reserve) env=" << env << std::endl;
+    return false;
+  }
+  if (!checkpoint.empty() && !entry->prototype)
+  {
+    RLLibOpenAiGymAgent* prototype = entry->factory->make();
+    RLLib::Snapshot<double> snapshot;
+    prototype->accept(&snapshot);
+    if (!snapshot.resurrect(checkpoint.c_str()))
+    {
+      delete prototype;
+      return false;
+    }
+    RLLibOpenAiGymAgentState* prototypeState = new RLLibOpenAiGymAgentState(prototype);
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->prototypeState = prototypeState;
+    entry->prototype = prototype;
+  }
+
+  std::vector<RLLibOpenAiGymAgent*> agents;
+  for (size_t i = 0; i < nbAgents; ++i)
+  {
+    agents.push_back(entry->factory->make());
+    initialize(entry, agents.back());
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  entry->poolSize += nbAgents;
+  entry->pool.insert(entry->pool.end(), agents.begin(), agents.end());
+  std::cout << "reserve: env: " << env << " agents: " << entry->pool.size() << std::endl;
+  return true;
+}
+
+void RLLibOpenAiGymAgentRegistry::initialize(Entry* entry, RLLibOpenAiGymAgent* agent)
+{
+  // The state of an agent is built with the agent, so that a reused agent does not allocate
+  RLLibOpenAiGymAgentState* state = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!entry->prototypeState)
+      return;
+    auto iter = entry->states.find(agent);
+    if (iter != entry->states.end())
+      state = iter->second;
+  }
+  if (!state)
+  {
+    state = new RLLibOpenAiGymAgentState(agent);
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->states.emplace(agent, state);
+  }
+  entry->prototypeState->copyTo(state);
+}
+
 void RLLibOpenAiGymAgentRegistry::registerInstance(const std::string& name, const std::string& env,
     RLLibOpenAiGymAgentFactory* factory)
 {
   std::cout << "registering: name: " << name << " env: " << env << std::endl;
+  std::lock_guard<std::mutex> lock(mutex);
   registry.emplace(env, new Entry(name, env, factory));
 }
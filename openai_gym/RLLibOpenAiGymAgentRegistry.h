@@ -11,6 +11,8 @@
 #include "RLLibOpenAiGymAgent.h"
 #include "RLLibOpenAiGymAgentFactory.h"
 
+#include <mutex>
+#include <vector>
 #include <iostream>
 #include <unordered_map>
 
@@ -23,23 +25,47 @@ class RLLibOpenAiGymAgentRegistry
         std::string name;
         std::string env;
         RLLibOpenAiGymAgentFactory* factory;
+        RLLibOpenAiGymAgent* prototype; // the state of the new agents, when warm-started
+        RLLibOpenAiGymAgentState* prototypeState;
+        std::vector<RLLibOpenAiGymAgent*> pool; // ready agents
+        size_t poolSize;
+        // The state of each agent of the entry, built once, when warm-started
+        std::unordered_map<RLLibOpenAiGymAgent*, RLLibOpenAiGymAgentState*> states;
 
         Entry(const std::string& name, const std::string& env, RLLibOpenAiGymAgentFactory* factory) :
-            name(name), env(env), factory(factory)
+            name(name), env(env), factory(factory), prototype(nullptr), prototypeState(nullptr), //
+            poolSize(0)
         {
         }
 
     };
     std::unordered_map<std::string, Entry*> registry; // env, entry
+    std::mutex mutex; // the sessions of the transports make agents concurrently; guards registry
 
   public:
 
     static RLLibOpenAiGymAgentRegistry& getInstance();
 
     RLLibOpenAiGymAgent* make(const std::string& env);
+    // Gives an agent back; it is reset and pooled, or deleted when the pool is full
+    void release(const std::string& env, RLLibOpenAiGymAgent* agent);
+    /**
+     * Builds nbAgents agents of env ahead of the sessions, so that make(env)
+     * does not construct the hashing tables, the weight vectors, etc. When a
+     * checkpoint is given (a RLLib::Snapshot<double> of an agent's accept(..)),
+     * the agents start from its state.
+     */
+    bool reserve(const std::string& env, const size_t& nbAgents,
+        const std::string& checkpoint = "");
     void registerInstance(const std::string& name, const std::string& env,
         RLLibOpenAiGymAgentFactory* factory);
 
+  protected:
+    // The entry of env, or nullptr; the entries live as long as the registry
+    Entry* find(const std::string& env);
+    // Restores the state of a new or a reused agent
+    void initialize(Entry* entry, RLLibOpenAiGymAgent* agent);
+
   private:
     RLLibOpenAiGymAgentRegistry();
     ~RLLibOpenAiGymAgentRegistry();
@@ -0,0 +1,148 @@
+/*
+ * RLLibOpenAiGymProtocol.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#ifndef OPENAI_GYM_RLLIBOPENAIGYMPROTOCOL_H_
+#define OPENAI_GYM_RLLIBOPENAIGYMPROTOCOL_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The binary protocol of openai_gym.py is little endian"
+#endif
+
+/**
+ * Binary framed protocol between openai_gym.py and the agents. Every message
+ * is a FrameHeader followed by payloadSize bytes, at most MAX_FRAME_SIZE; the
+ * peer of a larger frame is disconnected. openai_gym.py packs all the fields
+ * little endian, and the agents copy them as they are, so the agents only
+ * build on little endian hosts. A session is binary when its first four bytes
+ * are MAGIC, otherwise it falls back to the text protocol.
+ *
+ * INIT    payload: the name of the environment; the reply is READY or UNKNOWN.
+ * STEP    payload: StepHeader followed by nbObservations float32 or float64
+ *         (scalarType); the reply is ACTION or END.
+ * ACTION  payload: one float64, the action of the agent.
+ * END     no payload, the agent exhausted its time-steps.
+ *
+ * BATCH_STEP    payload: BatchHeader followed by nbInstances STEP payloads,
+ *               one per environment instance, at most MAX_BATCH_SIZE;
+ *               instance k is stepped by the k-th agent of the session,
+ *               which is created on first use.
+ * BATCH_ACTION  payload: BatchHeader followed by nbInstances ActionRecords.
+ *
+ * A step of another scalar type, or whose payload is not exactly its
+ * observations, closes the session.
+ */
+namespace RLLibOpenAiGymProtocol
+{
+  enum
+  {
+    MAGIC = 0x42474C52, // "RLGB"
+    VERSION = 1
+  };
+
+  // The largest payload of a frame
+  const uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+  // The most environment instances of a batch, i.e., agents of a session
+  const uint32_t MAX_BATCH_SIZE = 1024;
+
+  enum MessageType
+  {
+    INIT = 1, READY = 2, UNKNOWN = 3, STEP = 4, ACTION = 5, END = 6, BATCH_STEP = 7,
+    BATCH_ACTION = 8
+  };
+
+  enum ScalarType
+  {
+    FLOAT32 = 1, FLOAT64 = 2
+  };
+
+  struct FrameHeader
+  {
+      uint32_t magic;
+      uint8_t version;
+      uint8_t type;
+      uint8_t scalarType;
+      uint8_t reserved;
+      uint32_t payloadSize;
+  };
+
+  // episodeState: 0 new epoch, 1 episode starts, 2 episode continues, 3 episode ends
+  struct StepHeader
+  {
+      int32_t episodeState;
+      uint32_t nbObservations;
+      double reward;
+  };
+
+  struct BatchHeader
+  {
+      uint32_t nbInstances;
+      uint32_t reserved;
+  };
+
+  // type: ACTION, or END when the agent of the instance exhausted its time-steps
+  struct ActionRecord
+  {
+      uint32_t type;
+      uint32_t reserved;
+      double action;
+  };
+
+  inline bool isScalarType(const uint8_t& scalarType)
+  {
+    return scalarType == FLOAT32 || scalarType == FLOAT64;
+  }
+
+  inline size_t scalarSize(const uint8_t& scalarType)
+  {
+    return scalarType == FLOAT32 ? sizeof(float) : sizeof(double);
+  }
+
+  // The bytes of the STEP payload at payload, within size bytes; 0 if it is malformed
+  inline size_t stepSize(const uint8_t& scalarType, const char* payload, const size_t& size)
+  {
+    StepHeader step;
+    if (!isScalarType(scalarType) || size < sizeof(step))
+      return 0;
+    std::memcpy(&step, payload, sizeof(step));
+    const size_t scalar = scalarSize(scalarType);
+    if (step.nbObservations > (size - sizeof(step)) / scalar)
+      return 0;
+    return sizeof(step) + step.nbObservations * scalar;
+  }
+
+  // Whether the header starts a frame of the protocol; the connection is closed otherwise,
+  // before its payload is read. The observations of the steps are of a known scalar type.
+  inline bool isValid(const FrameHeader& header)
+  {
+    return header.magic == MAGIC && header.payloadSize <= MAX_FRAME_SIZE
+        && ((header.type != STEP && header.type != BATCH_STEP) || isScalarType(header.scalarType));
+  }
+
+  // Writes a frame into out; out keeps its capacity between the messages. The
+  // payload is left to the caller when it is null.
+  inline void encode(std::vector<char>& out, const MessageType& type, const void* payload = 0,
+      const uint32_t& payloadSize = 0)
+  {
+    FrameHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.type = type;
+    header.scalarType = FLOAT64;
+    header.reserved = 0;
+    header.payloadSize = payloadSize;
+    out.resize(sizeof(header) + payloadSize);
+    std::memcpy(&out[0], &header, sizeof(header));
+    if (payload)
+      std::memcpy(&out[sizeof(header)], payload, payloadSize);
+  }
+}
+
+#endif /* OPENAI_GYM_RLLIBOPENAIGYMPROTOCOL_H_ */
@@ -5,25 +5,48 @@
  *      Author: sabeyruw
  */
 
+#include <cstdio>
 #include <cassert>
-#include <sstream>
+#include <cstdlib>
 #include <iostream>
-#include <iterator>
 #include <algorithm>
 //
 #include "RLLibOpenAiGymProxy.h"
 
-RLLibOpenAiGymProxy::RLLibOpenAiGymProxy() :
-    agent(NULL)
+RLLibOpenAiGymProxy::RLLibOpenAiGymProxy()
 {
 }
 
 RLLibOpenAiGymProxy::~RLLibOpenAiGymProxy()
 {
-  if (!agent)
+  clear();
+}
+
+void RLLibOpenAiGymProxy::clear()
+{
+  // The agents return to the pool of the registry
+  for (size_t i = 0; i < agents.size(); ++i)
+    RLLibOpenAiGymAgentRegistry::getInstance().release(env, agents[i]);
+  agents.clear();
+}
+
+bool RLLibOpenAiGymProxy::init(const std::string& env)
+{
+  clear();
+  this->env = env;
+  return getAgent(0) != NULL;
+}
+
+RLLibOpenAiGymAgent* RLLibOpenAiGymProxy::getAgent(const size_t& instance)
+{
+  while (agents.size() <= instance && !env.empty())
   {
-    delete agent;
+    RLLibOpenAiGymAgent* agent = RLLibOpenAiGymAgentRegistry::getInstance().make(env);
+    if (!agent)
+      break;
+    agents.push_back(agent);
   }
+  return instance < agents.size() ? agents[instance] : NULL;
 }
 
 std::string RLLibOpenAiGymProxy::toRLLib(const std::string& str)
@@ -35,13 +58,7 @@ std::string RLLibOpenAiGymProxy::toRLLib(const std::string& str)
   {
     if ((cmdIdx = str.find("__I__")) != std::string::npos)
     {
-      if (agent)
-      {
-        delete agent;
-        agent = 0;
-      }
-      agent = RLLibOpenAiGymAgentRegistry::getInstance().make(str.substr(cmdIdx + 6));
-      return agent ? "__A__" : "__?__";
+      return init(str.substr(cmdIdx + 6)) ? "__A__" : "__?__";
     }
     else
     {
@@ -49,49 +66,167 @@ std::string RLLibOpenAiGymProxy::toRLLib(const std::string& str)
     }
   }
 
-  std::stringstream ss(str);
-  std::vector<std::string> tokens;
-  std::copy(std::istream_iterator<std::string>(ss), std::istream_iterator<std::string>(),
-      std::back_inserter(tokens));
-
-  agent->problem->step_tp1->observation_tp1.clear();
-  std::stringstream ssEpisodeState(tokens[tokens.size() - 1]);
-  ssEpisodeState >> agent->problem->step_tp1->episode_state_tp1;
-
-  std::stringstream ssEpisodeReward(tokens[tokens.size() - 2]);
-  ssEpisodeReward >> agent->problem->step_tp1->reward_tp1;
+  RLLibOpenAiGymAgent* agent = getAgent(0);
+  if (!agent)
+  {
+    return "__?__";
+  }
 
-  agent->problem->step_tp1->observation_tp1.resize(tokens.size() - 2);
-  for (size_t i = 0; i < tokens.size() - 2; ++i)
+  // The observations, the reward and the episode state are parsed in place into the vector of
+  // the previous step: a step does not allocate once the vector has reached its size
+  OpenAiGymTRStep* step_tp1 = agent->problem->step_tp1;
+  std::vector<double>& values = step_tp1->observation_tp1;
+  values.clear();
+  const char* begin = str.c_str();
+  char* end = NULL;
+  for (double x = std::strtod(begin, &end); end != begin; x = std::strtod(begin, &end))
+  {
+    values.push_back(x);
+    begin = end;
+  }
+  if (values.size() < 2)
   {
-    std::stringstream ssStateVar(tokens[i]);
-    ssStateVar >> agent->problem->step_tp1->observation_tp1[i];
+    return "__?__";
   }
+  step_tp1->episode_state_tp1 = int(values.back());
+  values.pop_back();
+  step_tp1->reward_tp1 = values.back();
+  values.pop_back();
 
   //assert(agent->problem->step_tp1->observation_tp1.size() == agent->problem->dimension());
 
-  /*for (size_t i = 0; i < agent->problem->step_tp1->observation_tp1.size(); ++i)
-   {
-   std::cout << agent->problem->step_tp1->observation_tp1[i] << " ";
-   }
-
-   std::cout << " r: " << agent->problem->step_tp1->reward_tp1 << std::endl;
-   */
   const RLLib::Action<double>* action_tp1 = agent->step();
 
   // The action_tp1 will be nullptr when the agent exhausted all the time-steps.
   // Then we send an episode end signal to OpenAI Gym to reset the environment.
-  std::stringstream ssAction_tp1;
-  if (action_tp1)
+  if (!action_tp1)
   {
-    ssAction_tp1 << action_tp1->getEntry();
+    return "__E__";
   }
-  else
+
+  // Short enough for the inline buffer of std::string
+  char action[16];
+  std::snprintf(action, sizeof(action), "%g", action_tp1->getEntry());
+  return action;
+}
+
+bool RLLibOpenAiGymProxy::toRLLib(const RLLibOpenAiGymProtocol::FrameHeader& header,
+    const char* payload, std::vector<char>& reply)
+{
+  using namespace RLLibOpenAiGymProtocol;
+  if (header.version != VERSION)
+  {
+    encode(reply, UNKNOWN);
+    return true;
+  }
+
+  if (header.type == INIT)
   {
-    ssAction_tp1 << "__E__";
+    encode(reply, init(std::string(payload, header.payloadSize)) ? READY : UNKNOWN);
+    return true;
   }
 
-  return ssAction_tp1.str();
+  // The bytes are only reinterpreted as observations of a known scalar type, and all of them
+  if ((header.type == STEP || header.type == BATCH_STEP) && !isScalarType(header.scalarType))
+    return false;
 
+  if (header.type == STEP)
+  {
+    if (stepSize(header.scalarType, payload, header.payloadSize) != header.payloadSize)
+      return false;
+    RLLibOpenAiGymAgent* agent = getAgent(0);
+    if (!agent)
+    {
+      encode(reply, UNKNOWN);
+      return true;
+    }
+    decodeStep(agent, header.scalarType, payload);
+    const RLLib::Action<double>* action_tp1 = agent->step();
+    if (action_tp1)
+    {
+      const double action = action_tp1->getEntry();
+      encode(reply, ACTION, &action, sizeof(action));
+    }
+    else
+      encode(reply, END);
+    return true;
+  }
+
+  if (header.type != BATCH_STEP)
+  {
+    encode(reply, UNKNOWN);
+    return true;
+  }
+  BatchHeader batch;
+  if (header.payloadSize < sizeof(batch))
+    return false;
+  std::memcpy(&batch, payload, sizeof(batch));
+  // The whole batch is validated before the agents are created and any instance is decoded,
+  // so a malformed batch has no effect
+  if (batch.nbInstances == 0 || batch.nbInstances > MAX_BATCH_SIZE)
+    return false;
+  size_t position = sizeof(batch);
+  for (uint32_t k = 0; k < batch.nbInstances; ++k)
+  {
+    const size_t read = stepSize(header.scalarType, payload + position,
+        header.payloadSize - position);
+    if (!read)
+      return false;
+    position += read;
+  }
+  if (position != header.payloadSize)
+    return false;
+  if (!getAgent(batch.nbInstances - 1))
+  {
+    encode(reply, UNKNOWN);
+    return true;
+  }
+  position = sizeof(batch);
+  for (uint32_t k = 0; k < batch.nbInstances; ++k)
+  {
+    position += decodeStep(agents[k], header.scalarType, payload + position);
+  }
+
+  encode(reply, BATCH_ACTION, 0, sizeof(batch) + batch.nbInstances * sizeof(ActionRecord));
+  char* out = &reply[sizeof(FrameHeader)];
+  std::memcpy(out, &batch, sizeof(batch));
+  out += sizeof(batch);
+  for (uint32_t k = 0; k < batch.nbInstances; ++k, out += sizeof(ActionRecord))
+  {
+    const RLLib::Action<double>* action_tp1 = agents[k]->step();
+    ActionRecord record;
+    record.type = action_tp1 ? ACTION : END;
+    record.reserved = 0;
+    record.action = action_tp1 ? action_tp1->getEntry() : 0;
+    std::memcpy(out, &record, sizeof(record));
+  }
+  return true;
 }
 
+size_t RLLibOpenAiGymProxy::decodeStep(RLLibOpenAiGymAgent* agent, const uint8_t& scalarType,
+    const char* payload)
+{
+  using namespace RLLibOpenAiGymProtocol;
+  StepHeader step;
+  std::memcpy(&step, payload, sizeof(step));
+  const size_t scalar = scalarSize(scalarType);
+
+  // The observations are copied into the vector of the previous step
+  OpenAiGymTRStep* step_tp1 = agent->problem->step_tp1;
+  step_tp1->observation_tp1.resize(step.nbObservations);
+  const char* observations = payload + sizeof(step);
+  for (uint32_t i = 0; i < step.nbObservations; ++i)
+  {
+    if (scalarType == FLOAT32)
+    {
+      float x;
+      std::memcpy(&x, observations + i * scalar, scalar);
+      step_tp1->observation_tp1[i] = x;
+    }
+    else
+      std::memcpy(&step_tp1->observation_tp1[i], observations + i * scalar, scalar);
+  }
+  step_tp1->reward_tp1 = step.reward;
+  step_tp1->episode_state_tp1 = step.episodeState;
+  return sizeof(step) + step.nbObservations * scalar;
+}
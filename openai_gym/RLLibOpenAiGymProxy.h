@@ -12,17 +12,32 @@
 #include <iostream>
 //
 #include "RLLibOpenAiGymAgentRegistry.h"
+#include "RLLibOpenAiGymProtocol.h"
 
 class RLLibOpenAiGymProxy
 {
   private:
-    RLLibOpenAiGymAgent* agent;
+    std::string env;
+    std::vector<RLLibOpenAiGymAgent*> agents; // one per environment instance
 
   public:
     RLLibOpenAiGymProxy();
     virtual ~RLLibOpenAiGymProxy();
 
     std::string toRLLib(const std::string& str);
+    // Binary protocol: decodes the request frame and writes the reply frame into reply; false if
+    // the frame is malformed, and the session must be closed
+    bool toRLLib(const RLLibOpenAiGymProtocol::FrameHeader& header, const char* payload,
+        std::vector<char>& reply);
+
+  protected:
+    void clear();
+    bool init(const std::string& env);
+    // The agent of an environment instance, created on first use
+    RLLibOpenAiGymAgent* getAgent(const size_t& instance);
+    // Copies a STEP payload, validated with stepSize(..), into the problem of agent; returns the
+    // bytes read
+    size_t decodeStep(RLLibOpenAiGymAgent* agent, const uint8_t& scalarType, const char* payload);
 };
 
 #endif /* OPENAI_GYM_RLLIBOPENAIGYMPROXY_H_ */
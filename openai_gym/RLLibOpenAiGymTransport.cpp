@@ -0,0 +1,25 @@
+/*
+ * RLLibOpenAiGymTransport.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#include <cstdlib>
+//
+#include "RLLibOpenAiGymTransport.h"
+#include "SyncTcpServer.h"
+#include "AsyncTcpServer.h"
+#include "ShmServer.h"
+
+RLLibOpenAiGymTransport* RLLibOpenAiGymTransport::make(const std::string& transport,
+    const std::string& address, const size_t& nbThreads)
+{
+  if (transport == "sync")
+    return new SyncTcpServer(std::atoi(address.c_str()));
+  if (transport == "async")
+    return new AsyncTcpServer(std::atoi(address.c_str()), nbThreads);
+  if (transport == "shm")
+    return new ShmServer(address, nbThreads);
+  return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * RLLibOpenAiGymTransport.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#ifndef OPENAI_GYM_RLLIBOPENAIGYMTRANSPORT_H_
+#define OPENAI_GYM_RLLIBOPENAIGYMTRANSPORT_H_
+
+#include <string>
+
+/**
+ * A server that carries the frames of openai_gym.py to the agents. Every
+ * transport creates its agents with RLLibOpenAiGymAgentRegistry through an
+ * RLLibOpenAiGymProxy per session.
+ */
+class RLLibOpenAiGymTransport
+{
+  public:
+    virtual ~RLLibOpenAiGymTransport()
+    {
+    }
+
+    virtual void server() =0;
+
+    /**
+     * transport: "async" (default), "sync" or "shm"
+     * address: the TCP port, or the name of the shared memory segments
+     * nbThreads: the event loops of "async", or the sessions of "shm"
+     */
+    static RLLibOpenAiGymTransport* make(const std::string& transport,
+        const std::string& address, const size_t& nbThreads);
+};
+
+#endif /* OPENAI_GYM_RLLIBOPENAIGYMTRANSPORT_H_ */
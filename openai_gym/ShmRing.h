@@ -0,0 +1,211 @@
+/*
+ * ShmRing.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#ifndef OPENAI_GYM_SHMRING_H_
+#define OPENAI_GYM_SHMRING_H_
+
+#include <stdint.h>
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Single-producer single-consumer ring of frames in shared memory. The
+ * producer and the consumer may live in different processes (openai_gym.py
+ * mirrors this layout), so the control words are plain uint32_t accessed
+ * with atomic builtins, and the futexes are process shared.
+ *
+ * head and tail count bytes and wrap at 2^32; capacity is a power of two. A
+ * record is a uint32_t length followed by the frame, padded to 8 bytes. A
+ * frame never wraps: the producer writes WRAP and restarts at offset 0. The
+ * consumer reads the frames in place.
+ *
+ * The waits spin for a while, then set their waiting flag and sleep on the
+ * futex of the word they wait for; the other side wakes them only when the
+ * flag is set, after a full fence. The sleeps time out, as a safety net for
+ * a lost wake-up.
+ *
+ * The ring does not trust its peer: the capacity is kept on this side, and
+ * front() returns 0 on a record that reserve(..) would not have written, at
+ * which point the session is torn down.
+ */
+struct ShmRingControl
+{
+    uint32_t capacity;
+    uint32_t reserved0[15];
+    uint32_t head; // written by the producer
+    uint32_t producerWaiting;
+    uint32_t reserved1[14];
+    uint32_t tail; // written by the consumer
+    uint32_t consumerWaiting;
+    uint32_t reserved2[14];
+};
+
+class ShmRing
+{
+  public:
+    enum
+    {
+      WRAP = 0xFFFFFFFF, ALIGNMENT = 8
+    };
+
+  protected:
+    ShmRingControl* control;
+    char* data;
+    uint32_t capacity;
+    uint32_t mask;
+    int spins;
+
+  public:
+    ShmRing() :
+        control(0), data(0), capacity(0), mask(0), spins(sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 4000 : 0)
+    {
+      // Spinning on a single core only delays the peer
+    }
+
+    // Maps a ring at address; initialize clears it
+    void attach(void* address, const bool& initialize, const uint32_t& capacity = 0)
+    {
+      control = static_cast<ShmRingControl*>(address);
+      data = static_cast<char*>(address) + sizeof(ShmRingControl);
+      if (initialize)
+      {
+        control->capacity = capacity;
+        control->head = control->tail = 0;
+        control->producerWaiting = control->consumerWaiting = 0;
+      }
+      this->capacity = control->capacity;
+      mask = this->capacity - 1;
+    }
+
+    static size_t size(const uint32_t& capacity)
+    {
+      return sizeof(ShmRingControl) + capacity;
+    }
+
+    static uint32_t recordSize(const uint32_t& length)
+    {
+      return (sizeof(uint32_t) + length + ALIGNMENT - 1) & ~uint32_t(ALIGNMENT - 1);
+    }
+
+    // Whether a frame of length bytes fits in a record of at most half the ring, so that a record
+    // after a wrap always fits
+    bool accepts(const uint32_t& length) const
+    {
+      return length <= capacity / 2 - sizeof(uint32_t);
+    }
+
+    // Producer: a contiguous region for a frame of length bytes; waits while the ring is full,
+    // 0 if the frame does not fit in a record
+    char* reserve(const uint32_t& length)
+    {
+      if (!accepts(length))
+        return 0;
+      const uint32_t record = recordSize(length);
+      const uint32_t head = control->head;
+      const uint32_t offset = head & mask;
+      const uint32_t skip = offset + record > capacity ? capacity - offset : 0;
+      uint32_t tail = load(&control->tail);
+      while (head + skip + record - tail > capacity)
+      {
+        wait(&control->tail, tail, &control->producerWaiting);
+        tail = load(&control->tail);
+      }
+      if (skip)
+      {
+        *reinterpret_cast<uint32_t*>(data + offset) = WRAP;
+        store(&control->head, head + skip);
+        wake(&control->head, &control->consumerWaiting);
+      }
+      char* frame = data + ((head + skip) & mask);
+      *reinterpret_cast<uint32_t*>(frame) = length;
+      return frame + sizeof(uint32_t);
+    }
+
+    // Producer: makes the frame written in the reserved region visible
+    void publish(const uint32_t& length)
+    {
+      store(&control->head, control->head + recordSize(length));
+      wake(&control->head, &control->consumerWaiting);
+    }
+
+    // Consumer: the next frame, read in place; waits while the ring is empty, 0 if the record is
+    // corrupt
+    const char* front(uint32_t& length)
+    {
+      for (;;)
+      {
+        const uint32_t tail = control->tail;
+        while (load(&control->head) == tail)
+          wait(&control->head, tail, &control->consumerWaiting);
+        const uint32_t offset = tail & mask;
+        length = *reinterpret_cast<const uint32_t*>(data + offset);
+        if (length != uint32_t(WRAP))
+          return accepts(length) && offset + recordSize(length) <= capacity ?
+              data + offset + sizeof(uint32_t) : 0;
+        store(&control->tail, tail + capacity - offset);
+        wake(&control->tail, &control->producerWaiting);
+      }
+    }
+
+    // Consumer: releases the frame returned by front()
+    void pop(const uint32_t& length)
+    {
+      store(&control->tail, control->tail + recordSize(length));
+      wake(&control->tail, &control->producerWaiting);
+    }
+
+  protected:
+    static uint32_t load(const uint32_t* word)
+    {
+      return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    }
+
+    static void store(uint32_t* word, const uint32_t& value)
+    {
+      __atomic_store_n(word, value, __ATOMIC_RELEASE);
+    }
+
+    void wait(uint32_t* word, const uint32_t& value, uint32_t* waiting)
+    {
+      for (int i = 0; i < spins; ++i)
+      {
+        if (load(word) != value)
+          return;
+        relax();
+      }
+      __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n(word, __ATOMIC_SEQ_CST) == value)
+      {
+        const struct timespec timeout = { 0, 10000000 }; // 10ms
+        syscall(SYS_futex, word, FUTEX_WAIT, value, &timeout, 0, 0);
+      }
+      __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    // Eases the spin of wait(..) on the processor
+    static void relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#else
+      sched_yield();
+#endif
+    }
+
+    static void wake(uint32_t* word, uint32_t* waiting)
+    {
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if (__atomic_load_n(waiting, __ATOMIC_RELAXED))
+        syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+    }
+};
+
+#endif /* OPENAI_GYM_SHMRING_H_ */
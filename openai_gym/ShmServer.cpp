@@ -0,0 +1,105 @@
+/*
+ * ShmServer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+//
+#include "ShmServer.h"
+
+ShmServer::ShmServer(const std::string& name, const size_t& nbSessions,
+    const uint32_t& capacity) :
+    name(name), nbSessions(std::max(nbSessions, size_t(1))), capacity(capacity)
+{
+}
+
+ShmServer::~ShmServer()
+{
+}
+
+void ShmServer::server()
+{
+  std::cout << "ShmServer::server name=" << name << " sessions=" << nbSessions << std::endl;
+  boost::thread_group threads;
+  for (size_t k = 0; k < nbSessions; ++k)
+  {
+    std::ostringstream segment;
+    segment << "/" << name << "." << k;
+    threads.create_thread(boost::bind(session, segment.str(), capacity));
+  }
+  threads.join_all();
+}
+
+void ShmServer::session(const std::string& segment, const uint32_t& capacity)
+{
+  std::cout << "ShmServer::session " << segment << std::endl;
+  const size_t size = sizeof(ShmSegmentHeader) + 2 * ShmRing::size(capacity);
+  const int fd = shm_open(segment.c_str(), O_CREAT | O_RDWR, 0666);
+  if (fd < 0 || ftruncate(fd, size) != 0)
+  {
+    std::cerr << "ERROR! (shm_open) segment=" << segment << std::endl;
+    return;
+  }
+  void* address = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED)
+  {
+    std::cerr << "ERROR! (mmap) segment=" << segment << std::endl;
+    return;
+  }
+
+  char* base = static_cast<char*>(address);
+  ShmSegmentHeader* header = reinterpret_cast<ShmSegmentHeader*>(base);
+  std::memset(header, 0, sizeof(ShmSegmentHeader));
+  ShmRing requests, replies;
+  requests.attach(base + sizeof(ShmSegmentHeader), true, capacity);
+  replies.attach(base + sizeof(ShmSegmentHeader) + ShmRing::size(capacity), true, capacity);
+  header->version = ShmSegmentHeader::VERSION;
+  header->capacity = capacity;
+  // The clients wait for the magic before they use the rings
+  __atomic_store_n(&header->magic, uint32_t(ShmSegmentHeader::MAGIC), __ATOMIC_RELEASE);
+
+  RLLibOpenAiGymProxy proxy;
+  std::vector<char> reply;
+  for (;;)
+  {
+    // The request is decoded in place; only the reply frame is copied into the ring
+    uint32_t length;
+    const char* frame = requests.front(length);
+    if (!frame)
+    {
+      std::cerr << "ERROR! (request) segment=" << segment << std::endl;
+      break;
+    }
+    // A malformed frame closes the session, like on the sockets
+    RLLibOpenAiGymProtocol::FrameHeader request;
+    if (length >= sizeof(request))
+      std::memcpy(&request, frame, sizeof(request));
+    if (length < sizeof(request) || !RLLibOpenAiGymProtocol::isValid(request)
+        || length - sizeof(request) != request.payloadSize
+        || !proxy.toRLLib(request, frame + sizeof(request), reply))
+    {
+      std::cerr << "ERROR! (frame) segment=" << segment << std::endl;
+      break;
+    }
+    requests.pop(length);
+
+    char* out = replies.reserve(reply.size());
+    if (!out)
+    {
+      std::cerr << "ERROR! (reply) segment=" << segment << std::endl;
+      break;
+    }
+    std::memcpy(out, &reply[0], reply.size());
+    replies.publish(reply.size());
+  }
+  munmap(address, size);
+  shm_unlink(segment.c_str());
+}
@@ -0,0 +1,58 @@
+/*
+ * ShmServer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#ifndef OPENAI_GYM_SHMSERVER_H_
+#define OPENAI_GYM_SHMSERVER_H_
+
+#include <string>
+#include <vector>
+#include <iostream>
+//
+#include "RLLibOpenAiGymProxy.h"
+#include "RLLibOpenAiGymTransport.h"
+#include "ShmRing.h"
+
+/**
+ * Header of a shared memory segment "/<name>.<k>". The ring of the requests
+ * (openai_gym.py to the agent) follows the header, then the ring of the
+ * replies. The frames are those of RLLibOpenAiGymProtocol.h.
+ */
+struct ShmSegmentHeader
+{
+    enum
+    {
+      MAGIC = 0x53474C52, // "RLGS"
+      VERSION = 1
+    };
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved[13];
+};
+
+/**
+ * Local transport for co-located Gym workers: each of the nbSessions segments
+ * is served by its own thread and proxy, so one worker attaches per segment.
+ */
+class ShmServer: public RLLibOpenAiGymTransport
+{
+  protected:
+    std::string name;
+    size_t nbSessions;
+    uint32_t capacity;
+
+  public:
+    ShmServer(const std::string& name, const size_t& nbSessions,
+        const uint32_t& capacity = 1 << 20);
+    virtual ~ShmServer();
+
+    void server();
+    static void session(const std::string& segment, const uint32_t& capacity);
+};
+
+#endif /* OPENAI_GYM_SHMSERVER_H_ */
@@ -5,6 +5,9 @@
  *      Author: sabeyruw
  */
 
+#include <cstring>
+#include <stdexcept>
+//
 #include "SyncTcpServer.h"
 
 SyncTcpServer::SyncTcpServer(const unsigned short& port) :
@@ -36,23 +39,76 @@ void SyncTcpServer::session(socket_ptr socket, proxy_ptr proxy)
   try
   {
     std::cout << "SyncTcpServer::session" << std::endl;
-    char buffer[1024];
-    for (;;)
-    {
-      boost::system::error_code error;
-      size_t length = socket->read_some(boost::asio::buffer(buffer), error);
-      if (error == boost::asio::error::eof)
-        break; // Connection closed cleanly by peer.
-      else if (error)
-        throw boost::system::system_error(error); // Some other error.
-
-      std::string data = proxy->toRLLib(std::string(buffer, length));
-
-      boost::asio::write(*socket, boost::asio::buffer(data));
-    }
+    // The first four bytes select the protocol
+    char magic[sizeof(uint32_t)];
+    boost::system::error_code error;
+    boost::asio::read(*socket, boost::asio::buffer(magic), error);
+    if (error == boost::asio::error::eof)
+      return;
+    else if (error)
+      throw boost::system::system_error(error);
+
+    uint32_t value;
+    std::memcpy(&value, magic, sizeof(value));
+    if (value == RLLibOpenAiGymProtocol::MAGIC)
+      binarySession(socket, proxy);
+    else
+      textSession(socket, proxy, std::string(magic, sizeof(magic)));
   } catch (std::exception& e)
   {
     std::cerr << "Exception in thread: " << e.what() << "\n";
   }
 }
 
+void SyncTcpServer::binarySession(socket_ptr socket, proxy_ptr proxy)
+{
+  // The buffers only grow, so the steps do not allocate
+  RLLibOpenAiGymProtocol::FrameHeader header;
+  std::vector<char> payload(1), reply;
+  header.magic = RLLibOpenAiGymProtocol::MAGIC;
+  size_t offset = sizeof(header.magic); // The magic of the first frame was read by session
+  for (;;)
+  {
+    boost::system::error_code error;
+    boost::asio::read(*socket,
+        boost::asio::buffer(reinterpret_cast<char*>(&header) + offset, sizeof(header) - offset),
+        error);
+    if (error == boost::asio::error::eof)
+      break; // Connection closed cleanly by peer.
+    else if (error)
+      throw boost::system::system_error(error); // Some other error.
+    offset = 0;
+    if (!RLLibOpenAiGymProtocol::isValid(header))
+      throw std::runtime_error("invalid frame"); // Closes the connection
+
+    // In size_t, so that the trailing byte cannot wrap
+    const size_t payloadSize = header.payloadSize;
+    if (payload.size() < payloadSize + 1)
+      payload.resize(payloadSize + 1);
+    boost::asio::read(*socket, boost::asio::buffer(&payload[0], payloadSize));
+
+    if (!proxy->toRLLib(header, &payload[0], reply))
+      throw std::runtime_error("malformed frame"); // Closes the connection
+    boost::asio::write(*socket, boost::asio::buffer(reply));
+  }
+}
+
+void SyncTcpServer::textSession(socket_ptr socket, proxy_ptr proxy, const std::string& prefix)
+{
+  std::string pending(prefix);
+  char buffer[1024];
+  for (;;)
+  {
+    boost::system::error_code error;
+    size_t length = socket->read_some(boost::asio::buffer(buffer), error);
+    if (error == boost::asio::error::eof)
+      break; // Connection closed cleanly by peer.
+    else if (error)
+      throw boost::system::system_error(error); // Some other error.
+
+    std::string data = proxy->toRLLib(pending + std::string(buffer, length));
+    pending.clear();
+
+    boost::asio::write(*socket, boost::asio::buffer(data));
+  }
+}
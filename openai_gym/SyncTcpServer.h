@@ -15,8 +15,9 @@
 #include <boost/thread/thread.hpp>
 //
 #include "RLLibOpenAiGymProxy.h"
+#include "RLLibOpenAiGymTransport.h"
 
-class SyncTcpServer
+class SyncTcpServer: public RLLibOpenAiGymTransport
 {
   private:
     typedef boost::shared_ptr<boost::asio::ip::tcp::socket> socket_ptr;
@@ -32,6 +33,10 @@ class SyncTcpServer
 
     void server();
     static void session(socket_ptr socket, proxy_ptr proxy);
+
+  protected:
+    static void binarySession(socket_ptr socket, proxy_ptr proxy);
+    static void textSession(socket_ptr socket, proxy_ptr proxy, const std::string& prefix);
 };
 
 #endif /* OPENAI_GYM_SYNCTCPSERVER_H_ */
@@ -0,0 +1,203 @@
+/*
+ * GymLoadTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sabeyruw
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+//
+#include "RLLibOpenAiGymProtocol.h"
+
+/**
+ * Load test of the agent server: nbEnvs simulated environments send binary
+ * STEP frames over loopback, each waits for its action before the next step.
+ * All the environments are multiplexed by one thread of the client.
+ */
+namespace
+{
+  typedef boost::chrono::steady_clock Clock;
+
+  class LoadTestEnv: public boost::enable_shared_from_this<LoadTestEnv>
+  {
+    protected:
+      boost::asio::ip::tcp::socket socket;
+      const std::string env;
+      std::vector<double> observations;
+      std::vector<char> request;
+      RLLibOpenAiGymProtocol::FrameHeader header;
+      char payload[sizeof(double)];
+      Clock::time_point sent;
+      int step;
+
+    public:
+      std::vector<double>* latencies; // in microseconds
+      bool measuring;
+
+      LoadTestEnv(boost::asio::io_service& io_service, const std::string& env,
+          const size_t& nbObservations) :
+          socket(io_service), env(env), observations(nbObservations), step(0), latencies(0),
+          measuring(false)
+      {
+      }
+
+      void start(const boost::asio::ip::tcp::endpoint& endpoint)
+      {
+        socket.connect(endpoint);
+        socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        init();
+      }
+
+      void close()
+      {
+        boost::system::error_code ignored;
+        socket.close(ignored);
+      }
+
+    protected:
+      void init()
+      {
+        step = 0;
+        RLLibOpenAiGymProtocol::encode(request, RLLibOpenAiGymProtocol::INIT, env.data(),
+            env.size());
+        send();
+      }
+
+      void sendStep()
+      {
+        using namespace RLLibOpenAiGymProtocol;
+        StepHeader stepHeader;
+        stepHeader.episodeState = step == 0 ? 1 : 2;
+        stepHeader.nbObservations = observations.size();
+        stepHeader.reward = -1.0;
+        for (size_t i = 0; i < observations.size(); ++i)
+          observations[i] = double(std::rand()) / RAND_MAX - 0.5;
+        const size_t size = sizeof(stepHeader) + observations.size() * sizeof(double);
+        request.resize(sizeof(FrameHeader) + size);
+        FrameHeader frame;
+        frame.magic = MAGIC;
+        frame.version = VERSION;
+        frame.type = STEP;
+        frame.scalarType = FLOAT64;
+        frame.reserved = 0;
+        frame.payloadSize = size;
+        std::memcpy(&request[0], &frame, sizeof(frame));
+        std::memcpy(&request[sizeof(frame)], &stepHeader, sizeof(stepHeader));
+        std::memcpy(&request[sizeof(frame) + sizeof(stepHeader)], &observations[0],
+            observations.size() * sizeof(double));
+        ++step;
+        send();
+      }
+
+      void send()
+      {
+        sent = Clock::now();
+        boost::asio::async_write(socket, boost::asio::buffer(request),
+            boost::bind(&LoadTestEnv::onSent, shared_from_this(),
+                boost::asio::placeholders::error));
+      }
+
+      void onSent(const boost::system::error_code& error)
+      {
+        if (error)
+          return;
+        boost::asio::async_read(socket, boost::asio::buffer(&header, sizeof(header)),
+            boost::bind(&LoadTestEnv::onHeader, shared_from_this(),
+                boost::asio::placeholders::error));
+      }
+
+      void onHeader(const boost::system::error_code& error)
+      {
+        if (error || header.payloadSize > sizeof(payload))
+          return;
+        boost::asio::async_read(socket, boost::asio::buffer(payload, header.payloadSize),
+            boost::bind(&LoadTestEnv::onReply, shared_from_this(),
+                boost::asio::placeholders::error));
+      }
+
+      void onReply(const boost::system::error_code& error)
+      {
+        if (error)
+          return;
+        using namespace RLLibOpenAiGymProtocol;
+        if (header.type == ACTION && measuring)
+          latencies->push_back(
+              boost::chrono::duration<double, boost::micro>(Clock::now() - sent).count());
+        if (header.type == READY || header.type == ACTION)
+          sendStep();
+        else if (header.type == END)
+          init(); // The agent exhausted its time-steps
+        else
+          std::cerr << "ERROR! unknown environment " << env << std::endl;
+      }
+  };
+
+  typedef boost::shared_ptr<LoadTestEnv> env_ptr;
+
+  double percentile(std::vector<double>& values, const double& p)
+  {
+    if (values.empty())
+      return 0;
+    std::vector<double>::iterator nth = values.begin() + size_t(p * (values.size() - 1));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+  }
+
+  void run(const boost::asio::ip::tcp::endpoint& endpoint, const std::string& env,
+      const size_t& nbObservations, const int& nbEnvs, const double& seconds)
+  {
+    boost::asio::io_service io_service;
+    std::vector<double> latencies;
+    latencies.reserve(1 << 20);
+    std::vector<env_ptr> envs;
+    for (int i = 0; i < nbEnvs; ++i)
+    {
+      envs.push_back(env_ptr(new LoadTestEnv(io_service, env, nbObservations)));
+      envs.back()->latencies = &latencies;
+      envs.back()->start(endpoint);
+    }
+
+    // Warm up: the agents are created by the INIT frames
+    io_service.run_for(boost::asio::chrono::milliseconds(500));
+    for (int i = 0; i < nbEnvs; ++i)
+      envs[i]->measuring = true;
+    const Clock::time_point start = Clock::now();
+    io_service.run_for(boost::asio::chrono::microseconds(long(seconds * 1e6)));
+    const double elapsed = boost::chrono::duration<double>(Clock::now() - start).count();
+    for (int i = 0; i < nbEnvs; ++i)
+      envs[i]->close();
+    io_service.run();
+
+    const size_t nbSteps = latencies.size();
+    std::printf("%8d %12.0f %12.1f %12.1f %12zu\n", nbEnvs, nbSteps / elapsed,
+        percentile(latencies, 0.5), percentile(latencies, 0.99), nbSteps);
+  }
+}
+
+// usage: openai_gym_loadtest [host] [port] [seconds] [env] [nbObservations]
+int main(int argc, char** argv)
+{
+  const std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+  const unsigned short port = argc > 2 ? std::atoi(argv[2]) : 2345;
+  const double seconds = argc > 3 ? std::atof(argv[3]) : 5.0;
+  const std::string env = argc > 4 ? argv[4] : "MountainCar-v0";
+  const size_t nbObservations = argc > 5 ? std::atoi(argv[5]) : 2;
+
+  const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(host),
+      port);
+  std::printf("%8s %12s %12s %12s %12s\n", "envs", "steps/s", "p50(us)", "p99(us)", "steps");
+  const int nbEnvs[] = { 1, 64, 512 };
+  for (size_t i = 0; i < sizeof(nbEnvs) / sizeof(nbEnvs[0]); ++i)
+    run(endpoint, env, nbObservations, nbEnvs[i], seconds);
+  return 0;
+}
@@ -5,13 +5,41 @@
  *      Author: sabeyruw
  */
 
-#include "SyncTcpServer.h"
+#include <cstdlib>
+#include <iostream>
+#include <boost/thread/thread.hpp>
+//
+#include "RLLibOpenAiGymTransport.h"
+#include "RLLibOpenAiGymAgentRegistry.h"
 
-int main()
+// usage: openai_gym [async|sync|shm] [port|name] [nbThreads|nbSessions]
+//                   [env=nbAgents[:checkpoint]]...
+int main(int argc, char** argv)
 {
-  SyncTcpServer syncServer(2345);
-  syncServer.server();
+  const std::string transport = argc > 1 ? argv[1] : "async";
+  const std::string address = argc > 2 ? argv[2] : (transport == "shm" ? "rllib_gym" : "2345");
+  const size_t nbThreads = argc > 3 ? std::atoi(argv[3]) : boost::thread::hardware_concurrency();
+
+  // Pools of ready agents, optionally warm-started from a checkpoint
+  for (int i = 4; i < argc; ++i)
+  {
+    const std::string pool(argv[i]);
+    const size_t equal = pool.find('='), colon = pool.find(':', equal);
+    if (equal == std::string::npos)
+      continue;
+    const std::string checkpoint = colon == std::string::npos ? "" : pool.substr(colon + 1);
+    RLLibOpenAiGymAgentRegistry::getInstance().reserve(pool.substr(0, equal),
+        std::atoi(pool.substr(equal + 1, colon - equal - 1).c_str()), checkpoint);
+  }
+
+  RLLibOpenAiGymTransport* server = RLLibOpenAiGymTransport::make(transport, address, nbThreads);
+  if (!server)
+  {
+    std::cerr << "ERROR! unknown transport " << transport << std::endl;
+    return 1;
+  }
+  server->server();
+  delete server;
 
   return 0;
 }
-
@@ -1,10 +1,14 @@
 import gym
 import time
+import mmap
+import ctypes
 import socket
+import threading
+import struct
 import numpy as np
 from sys import argv
 
-# These interfaces provide access to RLLib C++ interfaces via TCP communication. 
+# These interfaces provide access to RLLib C++ interfaces via TCP or shared memory communication. 
 class TcpClient(object):
     
     def __init__(self, host, port):
@@ -19,18 +23,285 @@ class TcpClient(object):
         return self.client_socket.recv(self.buffer_size).decode()
 
 
+class BinaryTcpClient(object):
+    """ Length-prefixed binary frames, see RLLibOpenAiGymProtocol.h
+        header: magic version type scalar_type reserved payload_size
+        step payload: episode_state nb_observations reward observations
+    """
+    MAGIC = 0x42474C52
+    VERSION = 1
+    INIT, READY, UNKNOWN, STEP, ACTION, END, BATCH_STEP, BATCH_ACTION = range(1, 9)
+    FLOAT32, FLOAT64 = 1, 2
+    HEADER = struct.Struct('<IBBBBI')
+    STEP_HEADER = struct.Struct('<iId')
+    ACTION_PAYLOAD = struct.Struct('<d')
+    BATCH_HEADER = struct.Struct('<II')
+    ACTION_RECORD = struct.Struct('<IId')
+    MAX_BATCH_SIZE = 1024
+
+    def __init__(self, host, port, float32=False):
+        self.client_socket = socket.socket()
+        self.client_socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.client_socket.connect((host, port))
+        self.scalar_type = self.FLOAT32 if float32 else self.FLOAT64
+        self.dtype = '<f4' if float32 else '<f8'
+        self.buffer = bytearray(self.HEADER.size + self.ACTION_PAYLOAD.size)
+
+    def send_frame(self, msg_type, scalar_type, payload):
+        self.client_socket.sendall(self.HEADER.pack(self.MAGIC, self.VERSION, msg_type,
+                                                    scalar_type, 0, len(payload)) + payload)
+
+    def recv_frame(self):
+        received = 0
+        size = self.HEADER.size
+        while received < size:
+            n = self.client_socket.recv_into(memoryview(self.buffer)[received:size])
+            if n == 0:
+                raise IOError("connection closed")
+            received += n
+            if received == self.HEADER.size:
+                magic, _, msg_type, _, _, payload_size = self.HEADER.unpack_from(self.buffer)
+                if magic != self.MAGIC:
+                    raise IOError("invalid frame")
+                size += payload_size
+                if len(self.buffer) < size:
+                    self.buffer.extend(bytearray(size - len(self.buffer)))
+        return msg_type, memoryview(self.buffer)[self.HEADER.size:size]
+
+    def init(self, env_name):
+        self.send_frame(self.INIT, self.FLOAT64, env_name.encode())
+        return self.recv_frame()[0] == self.READY
+
+    def step(self, observations, reward, episode_state):
+        """ Returns the action, or None when the agent exhausted all the time-steps """
+        obs = np.asarray(observations, dtype=self.dtype).ravel()
+        self.send_frame(self.STEP, self.scalar_type,
+                        self.STEP_HEADER.pack(episode_state, obs.size, reward) + obs.tobytes())
+        msg_type, payload = self.recv_frame()
+        if msg_type == self.ACTION:
+            return self.ACTION_PAYLOAD.unpack(payload)[0]
+        if msg_type == self.END:
+            return None
+        raise IOError("unexpected reply: {}".format(msg_type))
+
+    def step_batch(self, observations, rewards, episode_states):
+        """ One message for all the environment copies; returns one action per copy,
+            None for the copies whose agent exhausted all the time-steps
+        """
+        if not 0 < len(observations) <= self.MAX_BATCH_SIZE:
+            raise ValueError("batch of {} environments".format(len(observations)))
+        payload = [self.BATCH_HEADER.pack(len(observations), 0)]
+        for obs, reward, episode_state in zip(observations, rewards, episode_states):
+            obs = np.asarray(obs, dtype=self.dtype).ravel()
+            payload.append(self.STEP_HEADER.pack(episode_state, obs.size, reward))
+            payload.append(obs.tobytes())
+        self.send_frame(self.BATCH_STEP, self.scalar_type, b''.join(payload))
+        msg_type, payload = self.recv_frame()
+        if msg_type != self.BATCH_ACTION:
+            raise IOError("unexpected reply: {}".format(msg_type))
+        nb_instances = self.BATCH_HEADER.unpack_from(payload)[0]
+        actions = []
+        for k in range(nb_instances):
+            record_type, _, action = self.ACTION_RECORD.unpack_from(
+                payload, self.BATCH_HEADER.size + k * self.ACTION_RECORD.size)
+            actions.append(action if record_type == self.ACTION else None)
+        return actions
+
+    def close(self):
+        self.client_socket.close()
+
+
+class ShmRing(object):
+    """ Single-producer single-consumer ring in shared memory, see ShmRing.h """
+    CONTROL_SIZE = 192
+    HEAD, PRODUCER_WAITING, TAIL, CONSUMER_WAITING = 64, 68, 128, 132
+    WRAP = 0xFFFFFFFF
+    SPINS = 200
+    U32 = struct.Struct('<I')
+    FUTEX_WAIT, FUTEX_WAKE, SYS_FUTEX = 0, 1, 202 # x86_64
+
+    class Timespec(ctypes.Structure):
+        _fields_ = [('tv_sec', ctypes.c_long), ('tv_nsec', ctypes.c_long)]
+
+    libc = ctypes.CDLL(None, use_errno=True)
+    # The sleeps time out, as a safety net for a lost wake-up
+    timeout = Timespec(0, 1000000)
+    # Taking a lock is an atomic read-modify-write, i.e., a full memory fence
+    fence_lock = threading.Lock()
+
+    def __init__(self, mm, address, offset):
+        self.mm = mm
+        self.address = address + offset
+        self.offset = offset
+        self.capacity = self.load(0)
+        self.mask = self.capacity - 1
+        self.data = offset + self.CONTROL_SIZE
+
+    def load(self, field):
+        return self.U32.unpack_from(self.mm, self.offset + field)[0]
+
+    def store(self, field, value):
+        self.U32.pack_into(self.mm, self.offset + field, value & 0xFFFFFFFF)
+
+    def fence(self):
+        with self.fence_lock:
+            pass
+
+    def accepts(self, length):
+        """ Whether a frame fits in a record of at most half the ring, see ShmRing.h """
+        return length <= self.capacity // 2 - 4
+
+    def wait(self, field, value, waiting):
+        for _ in range(self.SPINS):
+            if self.load(field) != value:
+                return
+        self.store(waiting, 1)
+        self.fence()
+        if self.load(field) == value:
+            self.libc.syscall(self.SYS_FUTEX, ctypes.c_void_p(self.address + field),
+                              self.FUTEX_WAIT, ctypes.c_uint32(value), ctypes.byref(self.timeout),
+                              None, 0)
+        self.store(waiting, 0)
+
+    def wake(self, field, waiting):
+        self.fence()
+        if self.load(waiting):
+            self.libc.syscall(self.SYS_FUTEX, ctypes.c_void_p(self.address + field),
+                              self.FUTEX_WAKE, 0x7FFFFFFF, None, None, 0)
+
+    def record_size(self, length):
+        return (4 + length + 7) & ~7
+
+    def reserve(self, length):
+        """ Producer: the offset of a contiguous region of length bytes in mm """
+        if not self.accepts(length):
+            raise ValueError("frame of {} bytes in a ring of {}".format(length, self.capacity))
+        record = self.record_size(length)
+        head = self.load(self.HEAD)
+        offset = head & self.mask
+        skip = self.capacity - offset if offset + record > self.capacity else 0
+        tail = self.load(self.TAIL)
+        while ((head + skip + record - tail) & 0xFFFFFFFF) > self.capacity:
+            self.wait(self.TAIL, tail, self.PRODUCER_WAITING)
+            tail = self.load(self.TAIL)
+        if skip:
+            self.U32.pack_into(self.mm, self.data + offset, self.WRAP)
+            self.fence()
+            self.store(self.HEAD, head + skip)
+            self.wake(self.HEAD, self.CONSUMER_WAITING)
+        frame = self.data + ((head + skip) & self.mask)
+        self.U32.pack_into(self.mm, frame, length)
+        return frame + 4
+
+    def publish(self, length):
+        # The frame is written before the head moves
+        self.fence()
+        self.store(self.HEAD, self.load(self.HEAD) + self.record_size(length))
+        self.wake(self.HEAD, self.CONSUMER_WAITING)
+
+    def front(self):
+        """ Consumer: (offset, length) of the next frame in mm """
+        while True:
+            tail = self.load(self.TAIL)
+            while self.load(self.HEAD) == tail:
+                self.wait(self.HEAD, tail, self.CONSUMER_WAITING)
+            # The frame is read after the head moved
+            self.fence()
+            offset = tail & self.mask
+            length = self.U32.unpack_from(self.mm, self.data + offset)[0]
+            if length != self.WRAP:
+                if not self.accepts(length) or offset + self.record_size(length) > self.capacity:
+                    raise IOError("corrupt record of {} bytes".format(length))
+                return self.data + offset + 4, length
+            self.store(self.TAIL, tail + self.capacity - offset)
+            self.wake(self.TAIL, self.PRODUCER_WAITING)
+
+    def pop(self, length):
+        # The frame is read before the tail moves
+        self.fence()
+        self.store(self.TAIL, self.load(self.TAIL) + self.record_size(length))
+        self.wake(self.TAIL, self.PRODUCER_WAITING)
+
+
+class ShmClient(BinaryTcpClient):
+    """ The frames of BinaryTcpClient over the shared memory segment /<name>.<session>
+        of 'openai_gym shm <name> <nb_sessions>', see ShmServer.h
+    """
+    SEGMENT_MAGIC = 0x53474C52
+    SEGMENT_HEADER_SIZE = 64
+
+    def __init__(self, name='rllib_gym', session=0, float32=False):
+        path = '/dev/shm/{}.{}'.format(name, session)
+        with open(path, 'r+b') as f:
+            self.mm = mmap.mmap(f.fileno(), 0)
+        while self.U32.unpack_from(self.mm, 0)[0] != self.SEGMENT_MAGIC:
+            time.sleep(0.01)
+        capacity = self.U32.unpack_from(self.mm, 8)[0]
+        address = ctypes.addressof(ctypes.c_char.from_buffer(self.mm))
+        self.requests = ShmRing(self.mm, address, self.SEGMENT_HEADER_SIZE)
+        self.replies = ShmRing(self.mm, address,
+                               self.SEGMENT_HEADER_SIZE + ShmRing.CONTROL_SIZE + capacity)
+        self.scalar_type = self.FLOAT32 if float32 else self.FLOAT64
+        self.dtype = '<f4' if float32 else '<f8'
+
+    U32 = ShmRing.U32
+
+    def send_frame(self, msg_type, scalar_type, payload):
+        length = self.HEADER.size + len(payload)
+        frame = self.requests.reserve(length)
+        self.HEADER.pack_into(self.mm, frame, self.MAGIC, self.VERSION, msg_type, scalar_type, 0,
+                              len(payload))
+        self.mm[frame + self.HEADER.size:frame + length] = payload
+        self.requests.publish(length)
+
+    def recv_frame(self):
+        frame, length = self.replies.front()
+        magic, _, msg_type, _, _, payload_size = self.HEADER.unpack_from(self.mm, frame)
+        payload = self.mm[frame + self.HEADER.size:frame + self.HEADER.size + payload_size]
+        self.replies.pop(length)
+        if magic != self.MAGIC:
+            raise IOError("invalid frame")
+        return msg_type, payload
+
+    def step(self, observations, reward, episode_state):
+        """ Writes the observations straight into the ring """
+        obs = np.asarray(observations).ravel()
+        payload_size = self.STEP_HEADER.size + obs.size * np.dtype(self.dtype).itemsize
+        length = self.HEADER.size + payload_size
+        frame = self.requests.reserve(length)
+        self.HEADER.pack_into(self.mm, frame, self.MAGIC, self.VERSION, self.STEP,
+                              self.scalar_type, 0, payload_size)
+        self.STEP_HEADER.pack_into(self.mm, frame + self.HEADER.size, episode_state, obs.size,
+                                   reward)
+        np.frombuffer(self.mm, dtype=self.dtype, count=obs.size,
+                      offset=frame + self.HEADER.size + self.STEP_HEADER.size)[:] = obs
+        self.requests.publish(length)
+        msg_type, payload = self.recv_frame()
+        if msg_type == self.ACTION:
+            return self.ACTION_PAYLOAD.unpack(payload)[0]
+        if msg_type == self.END:
+            return None
+        raise IOError("unexpected reply: {}".format(msg_type))
+
+    def close(self):
+        pass
+
+
 class LearnerAgent(object):
     """ Base class that connects to RLLib functionality via
         interprocessor communication
     """
     
-    def __init__(self, env_name, discrete_actions, render, host, port):
+    def __init__(self, env_name, discrete_actions, render, host, port, binary=True,
+                 shm_session=None):
         self.env_name = env_name
         self.discrete_actions = discrete_actions
         self.render = render 
         self.env = gym.make(env_name)
         self.host = host
         self.port = port
+        self.binary = binary
+        self.shm_session = shm_session
         self.client_socket = None
         #self.client_socket = TcpClient(host, port)
         
@@ -47,9 +318,29 @@ class LearnerAgent(object):
         msg += str(episode_state)
         return msg
     
-    def run(self):
-        # craete the connection
+    def init(self):
+        if (self.shm_session is not None):
+            # Local transport of 'openai_gym shm'
+            self.client_socket = ShmClient(session=self.shm_session)
+            return self.client_socket.init(self.env_name)
+        if (self.binary == True):
+            self.client_socket = BinaryTcpClient(self.host, self.port)
+            return self.client_socket.init(self.env_name)
         self.client_socket = TcpClient(self.host, self.port)
+        msg = "__I__ " + self.env_name
+        print("msg_init: " + msg)
+        msg = self.client_socket.send_recv(msg)
+        print("msg: " + msg)
+        return msg == "__A__"
+
+    def sendStep(self, observations, reward, episode_state):
+        """ Returns the action, or "__E__" when the agent exhausted all the time-steps """
+        if (self.binary == True):
+            action_tp1 = self.client_socket.step(observations, reward, episode_state)
+            return "__E__" if action_tp1 is None else action_tp1
+        return self.client_socket.send_recv(self.newMsg(observations, reward, episode_state))
+
+    def run(self):
         
         observations = self.env.reset()
         reward = 0
@@ -59,14 +350,8 @@ class LearnerAgent(object):
         # 0 => new epoch starts, 1 episode starts, 2 episode continue, 3 episode ends
         episode_state = 0 
     
-        msg = "__I__ " + self.env_name
-        # send init command
-        print("msg_init: " + msg)
-        # return msg
-        msg = self.client_socket.send_recv(msg)
-        print("msg: " + msg)
-        
-        if (msg != "__A__"):
+        # craete the connection and send init command
+        if (self.init() == False):
             print("Agent is not ready")
             return
         
@@ -82,10 +367,7 @@ class LearnerAgent(object):
                 self.env.render()
             
             if (send_msg_to_server == True):
-                msg = self.newMsg(observations, reward, episode_state)
-            
-                #print("msg: " + msg)
-                action_tp1 = self.client_socket.send_recv(msg)
+                action_tp1 = self.sendStep(observations, reward, episode_state)
                 #print("action_tp1: " + action_tp1)
             
             if (episode_state == 3):
@@ -122,6 +404,65 @@ class LearnerAgent(object):
         self.client_socket.close()
         
 
+class VectorLearnerAgent(LearnerAgent):
+    """ Drives nb_envs copies of the environment with one message per step;
+        the server keeps one agent per copy
+    """
+    def __init__(self, env_name, discrete_actions, render, nb_envs, host='127.0.0.1', port=2345,
+                 shm_session=None):
+        super(VectorLearnerAgent, self).__init__(env_name, discrete_actions, render, host, port,
+                                                 shm_session=shm_session)
+        self.envs = [self.env] + [gym.make(env_name) for _ in range(nb_envs - 1)]
+
+    def run(self):
+        if (self.init() == False):
+            print("Agent is not ready")
+            return
+
+        nb_envs = len(self.envs)
+        observations = [env.reset() for env in self.envs]
+        rewards = [0.0] * nb_envs
+        # 1 episode starts, 2 episode continue, 3 episode ends
+        episode_states = [1] * nb_envs
+        active = [True] * nb_envs
+        t = [0] * nb_envs
+        episodes_done = 0
+
+        while any(active):
+            if (self.render == True):
+                self.envs[0].render()
+
+            actions_tp1 = self.client_socket.step_batch(observations, rewards, episode_states)
+
+            for k, env in enumerate(self.envs):
+                if (active[k] == False):
+                    continue
+                if (episode_states[k] == 3):
+                    observations[k] = env.reset()
+                    rewards[k] = 0.0
+                    episode_states[k] = 1
+                    continue
+                if (actions_tp1[k] is None):
+                    # The RLLib agent of this copy has exhaused all the time steps
+                    active[k] = False
+                    print("{}: agent exhaused all time-steps".format(k))
+                    continue
+                if (self.discrete_actions == True):
+                    observations[k], rewards[k], done, info = env.step(int(actions_tp1[k]))
+                else:
+                    observations[k], rewards[k], done, info = env.step(np.array([actions_tp1[k]]))
+                t[k] = t[k] + 1
+                if (done == False):
+                    episode_states[k] = 2
+                else:
+                    episode_states[k] = 3
+                    episodes_done = episodes_done + 1
+                    print("{}: episode finished after {} timesteps".format(episodes_done, t[k]))
+                    t[k] = 0
+
+        self.client_socket.close()
+
+
 class OnPolicyLearnerAgent(LearnerAgent):
     """ On policy controller
     """
@@ -130,9 +471,17 @@ class OnPolicyLearnerAgent(LearnerAgent):
 
 if __name__ == '__main__':
     input_v0 = 0
+    nb_envs = 1
+    shm_session = None
     
     if (len(argv) > 1):
         input_v0 = int(argv[1])
+
+    if (len(argv) > 2):
+        nb_envs = int(argv[2])
+
+    if (len(argv) > 3):
+        shm_session = int(argv[3])
         
     if (input_v0 < 0 or input_v0 > 4):
         input_v0 = 0    
@@ -146,6 +495,11 @@ if __name__ == '__main__':
                   4 : OnPolicyLearnerAgent('LunarLander-v2', True, True)
                  }
     
-    control_v0[input_v0].run()
+    if (nb_envs > 1 or shm_session is not None):
+        agent = control_v0[input_v0]
+        VectorLearnerAgent(agent.env_name, agent.discrete_actions, agent.render, nb_envs,
+                           shm_session=shm_session).run()
+    else:
+        control_v0[input_v0].run()
     
     
@@ -25,7 +25,7 @@
 #include <cmath>
 #include "util/RK4.h"
 
-class TorquedPendulum: public RK4
+class TorquedPendulum: public RK4<double>
 {
   protected:
     double m, l, mu, g;
@@ -33,7 +33,7 @@ class TorquedPendulum: public RK4
   public:
 
     TorquedPendulum(const double& m, const double& l, const double& mu, const double& dt) :
-        RK4(2, dt), m(m), l(l), mu(mu), g(9.8)
+        RK4<double>(2, dt), m(m), l(l), mu(mu), g(9.8)
     {
     }
 
@@ -25,12 +25,12 @@ using namespace RLLib;
 class UnderwaterVehicle: public RLProblem<double>
 {
   protected:
-    class Dynammic: public RK4
+    class Dynammic: public RK4<double>
     {
 
       public:
         Dynammic(const double& dt) :
-            RK4(1, dt)
+            RK4<double>(1, dt)
         {
         }
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * AllocationPolicyTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "AllocationPolicyTest.h"
+
+RLLIB_TEST_MAKE(AllocationPolicyTest)
+
+void AllocationPolicyTest::testAlignment()
+{
+  AllocationPolicy policy;
+  AllocationPolicy pages(4096, AllocationPolicy::NO_HUGE_PAGES, AllocationPolicy::NUMA_LOCAL, 0,
+      0);
+  Vector<double>* large = 0;
+  Vector<double>* small = 0;
+  Vector<double>* aligned = 0;
+  {
+    AllocationPolicyScope scope(&policy);
+    large = new PVector<double>(100000);
+    small = new PVector<double>(10);
+    {
+      AllocationPolicyScope nested(&pages);
+      aligned = new PVector<double>(10);
+    }
+  }
+  Assert::assertObjectEquals(size_t(0), reinterpret_cast<size_t>(large->getValues()) % 64);
+  Assert::assertObjectEquals(size_t(0), reinterpret_cast<size_t>(aligned->getValues()) % 4096);
+  // Below the minimum size, the arrays stay on the heap
+  Assert::assertPasses(!AllocationPolicy::release(small->getValues()));
+  Assert::assertPasses(AllocationPolicy::current() == 0);
+  large->set(1.0);
+  Assert::assertObjectEquals(100000.0, large->sum());
+  delete large;
+  delete small;
+  delete aligned;
+}
+
+void AllocationPolicyTest::testHugePages()
+{
+  AllocationPolicy transparent(AllocationPolicy::CACHE_LINE_SIZE,
+      AllocationPolicy::TRANSPARENT_HUGE_PAGES);
+  AllocationPolicy explicitPages(AllocationPolicy::CACHE_LINE_SIZE,
+      AllocationPolicy::EXPLICIT_HUGE_PAGES);
+  const int size = 3 * AllocationPolicy::HUGE_PAGE_SIZE / sizeof(double);
+  Vector<double>* x = 0;
+  Vector<double>* y = 0;
+  {
+    AllocationPolicyScope scope(&transparent);
+    x = new PVector<double>(size);
+  }
+  {
+    AllocationPolicyScope scope(&explicitPages);
+    y = new PVector<double>(size);
+  }
+  std::cout << "explicit huge page fallbacks=" << explicitPages.getNbHugePageFallbacks()
+      << std::endl;
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+  // Both start on a huge page
+  Assert::assertObjectEquals(size_t(0),
+      reinterpret_cast<size_t>(x->getValues()) % AllocationPolicy::HUGE_PAGE_SIZE);
+  Assert::assertObjectEquals(size_t(0),
+      reinterpret_cast<size_t>(y->getValues()) % AllocationPolicy::HUGE_PAGE_SIZE);
+#endif
+  Assert::assertObjectEquals(0, transparent.getNbHugePageFallbacks());
+  x->set(1.0);
+  y->set(2.0);
+  Assert::assertObjectEquals(3.0 * size, x->sum() + y->sum());
+  delete x;
+  delete y;
+}
+
+void AllocationPolicyTest::testNuma()
+{
+  const std::vector<int> nodes = AllocationPolicy::onlineNodes();
+  Assert::assertPasses(!nodes.empty());
+  Assert::assertPasses(nodes[0] >= 0);
+  AllocationPolicy bind(AllocationPolicy::CACHE_LINE_SIZE, AllocationPolicy::NO_HUGE_PAGES,
+      AllocationPolicy::NUMA_BIND, nodes[0]);
+  AllocationPolicy interleave(AllocationPolicy::CACHE_LINE_SIZE,
+      AllocationPolicy::TRANSPARENT_HUGE_PAGES, AllocationPolicy::NUMA_INTERLEAVE);
+  AllocationPolicy unknown(AllocationPolicy::CACHE_LINE_SIZE, AllocationPolicy::NO_HUGE_PAGES,
+      AllocationPolicy::NUMA_BIND, 1 << 20);
+  Vector<double>* x = 0;
+  Vector<double>* y = 0;
+  Vector<double>* z = 0;
+  {
+    AllocationPolicyScope scope(&bind);
+    x = new PVector<double>(100000);
+  }
+  {
+    AllocationPolicyScope scope(&interleave);
+    y = new PVector<double>(100000);
+  }
+  {
+    AllocationPolicyScope scope(&unknown);
+    z = new PVector<double>(100000);
+  }
+  std::cout << "nodes=" << nodes.size() << " bind fallbacks=" << bind.getNbNumaFallbacks()
+      << " interleave fallbacks=" << interleave.getNbNumaFallbacks() << std::endl;
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+  // A node that does not exist stays local
+  Assert::assertObjectEquals(1, unknown.getNbNumaFallbacks());
+#endif
+  x->set(1.0);
+  y->set(1.0);
+  z->set(1.0);
+  Assert::assertObjectEquals(300000.0, x->sum() + y->sum() + z->sum());
+  delete x;
+  delete y;
+  delete z;
+}
+
+void AllocationPolicyTest::testVectors()
+{
+  // The vectors compute the same with and without a policy; the copies in the scope follow it
+  AllocationPolicy policy(AllocationPolicy::CACHE_LINE_SIZE,
+      AllocationPolicy::TRANSPARENT_HUGE_PAGES);
+  Random<double> random;
+  PVector<double>* heap = new PVector<double>(50000);
+  for (int i = 0; i < heap->dimension(); i++)
+    heap->setEntry(i, random.nextReal());
+  PVector<double>* x = 0;
+  PVector<double>* y = 0;
+  {
+    AllocationPolicyScope scope(&policy);
+    x = new PVector<double>(*heap);
+    y = new PVector<double>(1);
+    *y = *heap;
+  }
+#if !defined(EMBEDDED_MODE) && defined(__linux__)
+  Assert::assertObjectEquals(size_t(0),
+      reinterpret_cast<size_t>(y->getValues()) % AllocationPolicy::HUGE_PAGE_SIZE);
+#endif
+  Assert::assertObjectEquals(heap->dot(heap), x->dot(y));
+  x->addToSelf(1.0, heap);
+  Assert::assertObjectEquals(2.0 * heap->l1Norm(), x->l1Norm());
+
+  // An arena takes precedence over the policy
+  Arena arena(1 << 20);
+  Vector<double>* z = 0;
+  {
+    AllocationPolicyScope policyScope(&policy);
+    ArenaScope arenaScope(&arena);
+    z = new PVector<double>(50000);
+  }
+  Assert::assertPasses(arena.owns(z->getValues()));
+  delete heap;
+  delete x;
+  delete y;
+  delete z;
+}
+
+void AllocationPolicyTest::testBlockSlots()
+{
+  AllocationPolicy policy(64, AllocationPolicy::NO_HUGE_PAGES, AllocationPolicy::NUMA_LOCAL, 0, 0);
+  const int nbBlocks = AllocationPolicy::getNbBlocks();
+  std::vector<Vector<double>*> vectors;
+  {
+    AllocationPolicyScope scope(&policy);
+    for (int i = 0; i < int(AllocationPolicy::MAX_BLOCKS) + 1 - nbBlocks; i++)
+      vectors.push_back(new PVector<double>(10));
+  }
+  // The array past the last slot goes to the heap
+  Assert::assertObjectEquals(int(AllocationPolicy::MAX_BLOCKS), AllocationPolicy::getNbBlocks());
+  Assert::assertPasses(!AllocationPolicy::release(vectors.back()->getValues()));
+  for (size_t i = 0; i < vectors.size(); i++)
+  {
+    vectors[i]->set(1.0);
+    Assert::assertObjectEquals(10.0, vectors[i]->sum());
+    delete vectors[i];
+  }
+  Assert::assertObjectEquals(nbBlocks, AllocationPolicy::getNbBlocks());
+  // The released slots are reused
+  Vector<double>* vector = 0;
+  {
+    AllocationPolicyScope scope(&policy);
+    vector = new PVector<double>(10);
+  }
+  Assert::assertObjectEquals(nbBlocks + 1, AllocationPolicy::getNbBlocks());
+  delete vector;
+}
+
+void AllocationPolicyTest::run()
+{
+  testAlignment();
+  testHugePages();
+  testNuma();
+  testVectors();
+  testBlockSlots();
+}
@@ -0,0 +1,539 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * AllocationTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "AllocationTest.h"
+
+#include <new>
+
+volatile bool AllocationTracker::tracking = false;
+volatile unsigned long AllocationTracker::nbAllocations = 0;
+volatile unsigned long AllocationTracker::nbBytes = 0;
+
+#if defined(__GLIBC__)
+extern "C"
+{
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t nmemb, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+
+  void* malloc(size_t size)
+  {
+    AllocationTracker::count(size);
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t nmemb, size_t size)
+  {
+    AllocationTracker::count(nmemb * size);
+    return __libc_calloc(nmemb, size);
+  }
+
+  void* realloc(void* ptr, size_t size)
+  {
+    AllocationTracker::count(size);
+    return __libc_realloc(ptr, size);
+  }
+}
+#else
+void* operator new(size_t size)
+{
+  AllocationTracker::count(size);
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+#endif
+
+void AllocationTest::testTracker()
+{
+  AllocationTracker::start();
+  int* volatile a = new int[100]; // volatile: the compiler cannot elide the allocation
+  Vector<double>* volatile v = new PVector<double>(10);
+  AllocationTracker::stop();
+  delete[] a;
+  delete v;
+  Assert::assertObjectEquals(3ul, (unsigned long) AllocationTracker::nbAllocations);
+  Assert::assertPasses(AllocationTracker::nbBytes >= 100 * sizeof(int) + 10 * sizeof(double));
+}
+
+void AllocationTest::testPreSizing()
+{
+  // A sparse vector with reserved entries does not grow
+  SVector<double> sparse(1000);
+  sparse.reserve(100);
+  AllocationTracker::start();
+  for (int i = 0; i < 100; i++)
+    sparse.setEntry(i * 10, 1.0);
+  AllocationTracker::stop();
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+  Assert::assertObjectEquals(100, sparse.nonZeroElements());
+
+  // Nor does a trace with a maximum size
+  RTrace<double> e(1000);
+  e.reserve(100);
+  SVector<double> phi(1000);
+  AllocationTracker::start();
+  for (int i = 0; i < 100; i++)
+  {
+    phi.clear();
+    phi.setEntry(i * 10, 1.0);
+    e.update(1.0, &phi);
+  }
+  AllocationTracker::stop();
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+  Assert::assertObjectEquals(100, RTTI<double>::sparseVector(e.vect())->nonZeroElements());
+
+  // A buffered copy allocated in advance
+  Vector<double>* buffer = 0;
+  Vectors<double>::bufferedCopy(&sparse, buffer);
+  AllocationTracker::start();
+  Vectors<double>::bufferedCopy(&sparse, buffer);
+  AllocationTracker::stop();
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+  delete buffer;
+
+  // A pool with reserved vectors
+  VectorPool<double> pool(1000);
+  pool.reserve(4, &sparse);
+  AllocationTracker::start();
+  for (int i = 0; i < 4; i++)
+    pool.newVector(&sparse);
+  pool.releaseAll();
+  AllocationTracker::stop();
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+}
+
+namespace
+{
+  // The number of steps after which a feature decays below threshold, times the active features
+  int maximumTraceSize(const int& nbActive, const double& gammaLambda, const double& threshold)
+  {
+    return nbActive
+        * (int(std::ceil(std::log(threshold * (1.0 - gammaLambda)) / std::log(gammaLambda))) + 1);
+  }
+
+  // A control learner on the tile coder of the actions of problem. Each learner builds its traces,
+  // with their maximum size reserved, its policy and its control.
+  class ControlLearner
+  {
+    public:
+      Hashing<double>* hashing;
+      Projector<double>* projector;
+      StateToStateAction<double>* toStateAction;
+      Trace<double>* e;
+      Policy<double>* acting;
+      Control<double>* control;
+
+      ControlLearner(Random<double>* random, RLProblem<double>* problem, Actions<double>* actions) :
+          hashing(new MurmurHashing<double>(random, 10000)), //
+          projector(new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true)), //
+          toStateAction(new StateActionTilings<double>(projector, actions)), e(0), acting(0), //
+          control(0)
+      {
+      }
+
+      virtual ~ControlLearner()
+      {
+        delete hashing;
+        delete projector;
+        delete toStateAction;
+        delete e;
+        delete acting;
+        delete control;
+      }
+  };
+
+  class SarsaLearner: public ControlLearner
+  {
+    protected:
+      Sarsa<double>* sarsa;
+
+    public:
+      SarsaLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new RTrace<double>(projector->dimension());
+        e->reserve(maximumTraceSize(projector->vectorNorm(), 0.99 * 0.3, 1e-8));
+        sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+        control = new SarsaControl<double>(acting, toStateAction, sarsa);
+      }
+
+      ~SarsaLearner()
+      {
+        delete sarsa;
+      }
+  };
+
+  class ExpectedSarsaLearner: public ControlLearner
+  {
+    protected:
+      Sarsa<double>* sarsa;
+
+    public:
+      ExpectedSarsaLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new ATrace<double>(projector->dimension());
+        e->reserve(maximumTraceSize(projector->vectorNorm(), 0.99 * 0.3, 1e-8));
+        sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+        control = new ExpectedSarsaControl<double>(acting, toStateAction, sarsa,
+            problem->getDiscreteActions());
+      }
+
+      ~ExpectedSarsaLearner()
+      {
+        delete sarsa;
+      }
+  };
+
+  class QLearner: public ControlLearner
+  {
+    protected:
+      Q<double>* q;
+
+    public:
+      QLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new RTrace<double>(projector->dimension());
+        e->reserve(maximumTraceSize(projector->vectorNorm(), 0.99 * 0.3, 1e-8));
+        q = new Q<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e,
+            problem->getDiscreteActions(), toStateAction);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), q, 0.1);
+        control = new QControl<double>(acting, toStateAction, q);
+      }
+
+      ~QLearner()
+      {
+        delete q;
+      }
+  };
+
+  class GreedyGQLearner: public ControlLearner
+  {
+    protected:
+      GQ<double>* gq;
+      Policy<double>* target;
+
+    public:
+      GreedyGQLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new AMaxTrace<double>(projector->dimension());
+        e->reserve(maximumTraceSize(projector->vectorNorm(), 0.99 * 0.1, 1e-8));
+        gq = new GQ<double>(0.1 / projector->vectorNorm(), 0.0001 / projector->vectorNorm(), 0.99,
+            0.1, e);
+        acting = new RandomPolicy<double>(random, problem->getDiscreteActions());
+        target = new Greedy<double>(problem->getDiscreteActions(), gq);
+        control = new GreedyGQ<double>(target, acting, problem->getDiscreteActions(),
+            toStateAction, gq);
+      }
+
+      ~GreedyGQLearner()
+      {
+        delete gq;
+        delete target;
+      }
+  };
+
+  class GQOnPolicyLearner: public ControlLearner
+  {
+    protected:
+      GQ<double>* gq;
+
+    public:
+      GQOnPolicyLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new ATrace<double>(projector->dimension());
+        e->reserve(maximumTraceSize(projector->vectorNorm(), 0.9 * 0.1, 1e-8));
+        gq = new GQ<double>(0.05 / projector->vectorNorm(), 0.0, 0.9, 0.1, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), gq, 0.01);
+        control = new GQOnPolicyControl<double>(acting, problem->getDiscreteActions(),
+            toStateAction, gq);
+      }
+
+      ~GQOnPolicyLearner()
+      {
+        delete gq;
+      }
+  };
+
+  class OffPACLearner: public ControlLearner
+  {
+    protected:
+      GTDLambda<double>* critic;
+      PolicyDistribution<double>* target;
+      Trace<double>* actore;
+      Traces<double>* actoreTraces;
+      ActorOffPolicy<double>* actor;
+
+    public:
+      OffPACLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem, problem->getDiscreteActions())
+      {
+        e = new ATrace<double>(projector->dimension());
+        const int maximumSize = maximumTraceSize(projector->vectorNorm(), 0.99 * 0.4, 1e-8);
+        e->reserve(maximumSize);
+        critic = new GTDLambda<double>(0.1 / projector->vectorNorm(),
+            0.0001 / projector->vectorNorm(), 0.99, 0.4, e);
+        target = new BoltzmannDistribution<double>(random, problem->getDiscreteActions(),
+            projector->dimension());
+        actore = new ATrace<double>(projector->dimension());
+        actoreTraces = new Traces<double>();
+        actoreTraces->push_back(actore);
+        // The gradient of the Boltzmann distribution spans the features of all the actions
+        actoreTraces->reserve(maximumSize * problem->getDiscreteActions()->dimension());
+        actor = new ActorLambdaOffPolicy<double>(0.001 / projector->vectorNorm(), 0.99, 0.4,
+            target, actoreTraces);
+        acting = new RandomPolicy<double>(random, problem->getDiscreteActions());
+        control = new OffPAC<double>(acting, critic, actor, toStateAction, projector);
+      }
+
+      ~OffPACLearner()
+      {
+        delete critic;
+        delete target;
+        delete actore;
+        delete actoreTraces;
+        delete actor;
+      }
+  };
+
+  // The actor-critics on the actions of problem: discrete with a Boltzmann distribution, or
+  // continuous with a normal distribution over [-2, 2]
+  template<bool continuous, bool averageReward>
+  class ActorCriticLearner: public ControlLearner
+  {
+    protected:
+      TDLambda<double>* critic;
+      PolicyDistribution<double>* distribution;
+      Range<double> range;
+      Trace<double>* actore;
+      Trace<double>* actore2; // of the standard deviation
+      Traces<double>* actoreTraces;
+      ActorOnPolicy<double>* actor;
+
+    public:
+      ActorCriticLearner(Random<double>* random, RLProblem<double>* problem) :
+          ControlLearner(random, problem,
+              continuous ? problem->getContinuousActions() : problem->getDiscreteActions()), //
+          distribution(0), range(-2.0, 2.0), actore2(0)
+      {
+        Actions<double>* actions =
+            continuous ? problem->getContinuousActions() : problem->getDiscreteActions();
+        const int maximumSize = maximumTraceSize(projector->vectorNorm(), 0.5, 1e-8);
+        e = new ATrace<double>(projector->dimension());
+        e->reserve(maximumSize);
+        critic = new TDLambda<double>(0.1 / projector->vectorNorm(), 1.0, 0.5, e);
+        PolicyDistribution<double>* policy;
+        if (continuous)
+        {
+          distribution = new NormalDistributionScaled<double>(random, actions, 0, 1.0,
+              projector->dimension());
+          policy = new ScaledPolicyDistribution<double>(actions, distribution, &range, &range);
+        }
+        else
+          policy = new BoltzmannDistribution<double>(random, actions, toStateAction->dimension());
+        acting = policy;
+        actore = new ATrace<double>(toStateAction->dimension());
+        actoreTraces = new Traces<double>();
+        actoreTraces->push_back(actore);
+        if (continuous)
+        {
+          actore2 = new ATrace<double>(toStateAction->dimension());
+          actoreTraces->push_back(actore2);
+        }
+        actoreTraces->reserve(maximumSize * (continuous ? 1 : actions->dimension()));
+        actor = new ActorLambda<double>(0.001 / projector->vectorNorm(), 1.0, 0.5, policy,
+            actoreTraces);
+        if (averageReward)
+          control = new AverageRewardActorCritic<double>(critic, actor, projector, toStateAction,
+              0.0001);
+        else
+          control = new ActorCritic<double>(critic, actor, projector, toStateAction);
+      }
+
+      ~ActorCriticLearner()
+      {
+        delete critic;
+        delete distribution;
+        delete actore;
+        delete actore2;
+        delete actoreTraces;
+        delete actor;
+      }
+  };
+
+  template<class L>
+  ControlLearner* newLearner(Random<double>* random, RLProblem<double>* problem)
+  {
+    return new L(random, problem);
+  }
+
+  template<class P>
+  RLProblem<double>* newProblem(Random<double>* random)
+  {
+    return new P(random);
+  }
+
+  struct Learner
+  {
+      const char* name;
+      ControlLearner* (*make)(Random<double>* random, RLProblem<double>* problem);
+      bool continuous;
+  };
+
+  struct Problem
+  {
+      const char* name;
+      RLProblem<double>* (*make)(Random<double>* random);
+      bool continuous; // the continuous actions of [-2, 2]
+  };
+}
+
+void AllocationTest::assertSteadyState(const char* name, RLAgent<double>* agent,
+    RLProblem<double>* problem, const int& nbWarmUpEpisodes, const int& nbEpisodes)
+{
+  RLRunner<double>* runner = new RLRunner<double>(agent, problem, 1000, nbWarmUpEpisodes, 1);
+  runner->setVerbose(false);
+  runner->runEpisodes();
+  runner->setEpisodes(nbWarmUpEpisodes + nbEpisodes);
+  AllocationTracker::start();
+  runner->runEpisodes();
+  agent->flush();
+  AllocationTracker::stop();
+  std::cout << name << ": " << AllocationTracker::nbAllocations << " allocations, "
+      << AllocationTracker::nbBytes << " bytes after warm-up" << std::endl;
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+  delete runner;
+}
+
+void AllocationTest::testControlCombinations()
+{
+  // The control learners and the problems of the tests; each learner runs on the problems of
+  // its actions, with each agent
+  const Learner learners[] = { //
+      { "Sarsa", newLearner<SarsaLearner>, false }, //
+      { "ExpectedSarsa", newLearner<ExpectedSarsaLearner>, false }, //
+      { "Q", newLearner<QLearner>, false }, //
+      { "GreedyGQ", newLearner<GreedyGQLearner>, false }, //
+      { "GQOnPolicy", newLearner<GQOnPolicyLearner>, false }, //
+      { "OffPAC", newLearner<OffPACLearner>, false }, //
+      { "BoltzmannActorCritic", newLearner<ActorCriticLearner<false, false> >, false }, //
+      { "NormalActorCritic", newLearner<ActorCriticLearner<true, false> >, true }, //
+      { "NormalAverageRewardActorCritic", newLearner<ActorCriticLearner<true, true> >, true } };
+  const Problem problems[] = { //
+      { "MountainCar", newProblem<MountainCar<double> >, false }, //
+      { "ContinuousGridworld", newProblem<ContinuousGridworld<double> >, false }, //
+      { "Acrobot", newProblem<Acrobot>, false }, //
+      { "CartPole", newProblem<CartPole>, false }, //
+      { "SwingPendulum", newProblem<SwingPendulum<double> >, true } };
+  const char* agents[] = { "", "Pipelined", "PipelinedThreaded" };
+  for (size_t l = 0; l < sizeof(learners) / sizeof(learners[0]); l++)
+    for (size_t p = 0; p < sizeof(problems) / sizeof(problems[0]); p++)
+    {
+      if (learners[l].continuous && !problems[p].continuous)
+        continue;
+      for (size_t a = 0; a < sizeof(agents) / sizeof(agents[0]); a++)
+      {
+        Random<double> random;
+        RLProblem<double>* problem = problems[p].make(&random);
+        ControlLearner* learner = learners[l].make(&random, problem);
+        RLAgent<double>* agent;
+        if (a)
+          agent = new PipelinedLearnerAgent<double>(learner->control, a == 2);
+        else
+          agent = new LearnerAgent<double>(learner->control);
+        const std::string name = std::string(agents[a]) + learners[l].name + "/"
+            + problems[p].name;
+        assertSteadyState(name.c_str(), agent, problem);
+        delete agent;
+        delete learner;
+        delete problem;
+      }
+    }
+}
+
+void AllocationTest::testSupervisedLearners()
+{
+  NoisyInputSum noisyInputSum(5, 20);
+  Adaline<double> adaline(20, 0.01);
+  IDBD<double> idbd(20, 0.001);
+  SemiLinearIDBD<double> semiLinearIdbd(20, 0.001);
+  K1<double> k1(20, 0.001);
+  Autostep<double> autostep(20);
+  LearningAlgorithm<double>* learners[] = { &adaline, &idbd, &semiLinearIdbd, &k1, &autostep };
+  const int nbLearners = sizeof(learners) / sizeof(learners[0]);
+  for (int i = 0; i < 100; i++)
+  {
+    noisyInputSum.update();
+    for (int j = 0; j < nbLearners; j++)
+      learners[j]->learn(noisyInputSum.getInputs(), noisyInputSum.getTarget());
+  }
+  AllocationTracker::start();
+  for (int i = 0; i < 1000; i++)
+  {
+    noisyInputSum.update();
+    for (int j = 0; j < nbLearners; j++)
+      learners[j]->learn(noisyInputSum.getInputs(), noisyInputSum.getTarget());
+  }
+  AllocationTracker::stop();
+  Assert::assertObjectEquals(0ul, (unsigned long) AllocationTracker::nbAllocations);
+}
+
+void AllocationTest::run()
+{
+  testTracker();
+  testPreSizing();
+  testControlCombinations();
+  testSupervisedLearners();
+}
+
+// Runs on its own: the allocator of the process is interposed
+int main()
+{
+  AllocationTest test;
+  std::cout << "*** starts " << test.getName() << std::endl;
+  test.run();
+  std::cout << "*** ends   " << test.getName() << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * AllocationTest.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef ALLOCATIONTEST_H_
+#define ALLOCATIONTEST_H_
+
+#include "Test.h"
+#include "Acrobot.h"
+#include "CartPole.h"
+
+/**
+ * Counts the heap allocations of all the threads between start() and
+ * stop(). On glibc, malloc(..), calloc(..) and realloc(..) are interposed,
+ * which also covers operator new; elsewhere, operator new and new[] are
+ * replaced. The aligned allocations are not counted.
+ *
+ * The replacements apply to the whole process, so that the test is built as
+ * its own executable, RLLibAllocation, and not as a part of the RLLib suite.
+ */
+class AllocationTracker
+{
+  public:
+    static volatile bool tracking;
+    static volatile unsigned long nbAllocations;
+    static volatile unsigned long nbBytes;
+
+    static void start()
+    {
+      nbAllocations = nbBytes = 0;
+      tracking = true;
+    }
+
+    static void stop()
+    {
+      tracking = false;
+    }
+
+    static void count(const size_t& size)
+    {
+      if (!tracking)
+        return;
+      __sync_fetch_and_add(&nbAllocations, 1ul);
+      __sync_fetch_and_add(&nbBytes, (unsigned long) size);
+    }
+};
+
+RLLIB_TEST(AllocationTest)
+
+class AllocationTest: public AllocationTestBase
+{
+  public:
+    AllocationTest()
+    {
+    }
+
+    virtual ~AllocationTest()
+    {
+    }
+    void run();
+
+  private:
+    void testTracker();
+    void testPreSizing();
+    void assertSteadyState(const char* name, RLAgent<double>* agent, RLProblem<double>* problem,
+        const int& nbWarmUpEpisodes = 5, const int& nbEpisodes = 20);
+    void testControlCombinations();
+    void testSupervisedLearners();
+};
+
+#endif /* ALLOCATIONTEST_H_ */
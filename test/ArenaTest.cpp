@@ -0,0 +1,316 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * ArenaTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "ArenaTest.h"
+
+RLLIB_TEST_MAKE(ArenaTest)
+
+namespace
+{
+  // A Sarsa agent on the mountain car, with all its components
+  class SarsaAgent
+  {
+    public:
+      Hashing<double>* hashing;
+      Projector<double>* projector;
+      StateToStateAction<double>* toStateAction;
+      Trace<double>* e;
+      Sarsa<double>* sarsa;
+      Policy<double>* acting;
+      OnPolicyControlLearner<double>* control;
+      RLAgent<double>* agent;
+
+      SarsaAgent(Random<double>* random, RLProblem<double>* problem)
+      {
+        hashing = new MurmurHashing<double>(random, 10000);
+        projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true);
+        toStateAction = new StateActionTilings<double>(projector, problem->getDiscreteActions());
+        e = new RTrace<double>(projector->dimension());
+        e->reserve(1000);
+        sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+        control = new SarsaControl<double>(acting, toStateAction, sarsa);
+        agent = new LearnerAgent<double>(control);
+      }
+
+      ~SarsaAgent()
+      {
+        delete hashing;
+        delete projector;
+        delete toStateAction;
+        delete e;
+        delete sarsa;
+        delete acting;
+        delete control;
+        delete agent;
+      }
+  };
+}
+
+void ArenaTest::testAllocation()
+{
+  Arena arena(1 << 20);
+  Vector<double>* dense = 0;
+  Vector<double>* sparse = 0;
+  Vector<double>* heap = 0;
+  {
+    ArenaScope scope(&arena);
+    dense = new PVector<double>(100);
+    sparse = new SVector<double>(1000);
+    {
+      ArenaScope heapScope(0);
+      heap = new PVector<double>(100);
+    }
+  }
+  Assert::assertPasses(arena.owns(dense));
+  Assert::assertPasses(arena.owns(dense->getValues()));
+  Assert::assertPasses(arena.owns(sparse));
+  Assert::assertPasses(arena.owns(sparse->getValues()));
+  Assert::assertPasses(!arena.owns(heap));
+  Assert::assertPasses(!arena.owns(heap->getValues()));
+  Assert::assertObjectEquals(&arena, Arena::owner(dense));
+  Assert::assertPasses(Arena::owner(heap) == 0);
+  // The entries above a cache line are aligned to one
+  Assert::assertObjectEquals(size_t(0), reinterpret_cast<size_t>(dense->getValues()) % 64);
+  // Contiguous, in the order of the allocations
+  Assert::assertPasses((char*) dense < (char*) dense->getValues());
+  Assert::assertPasses((char*) dense->getValues() < (char*) sparse);
+  Assert::assertPasses(arena.getUsed() >= 100 * sizeof(double) + 1000 * sizeof(int));
+  Assert::assertPasses(arena.getUsed() < 100 * sizeof(double) + 1000 * sizeof(int) + 1024);
+
+  // The vectors work as usual, and grow in the arena of the thread
+  dense->set(1.0);
+  Assert::assertObjectEquals(100.0, dense->sum());
+  {
+    ArenaScope scope(&arena);
+    for (int i = 0; i < 100; i++)
+      sparse->setEntry(i * 3, 1.0);
+  }
+  Assert::assertObjectEquals(100.0, sparse->sum());
+  Assert::assertPasses(arena.owns(sparse->getValues()));
+
+  // Deleting an object of the arena releases nothing
+  const size_t used = arena.getUsed();
+  delete dense;
+  delete sparse;
+  delete heap;
+  Assert::assertObjectEquals(used, arena.getUsed());
+}
+
+void ArenaTest::testPlacement()
+{
+  Arena arena(1 << 20);
+  Vector<double>* nothrow = 0;
+  {
+    ArenaScope scope(&arena);
+    nothrow = new (std::nothrow) PVector<double>(100);
+  }
+  Assert::assertPasses(arena.owns(nothrow));
+  Assert::assertObjectEquals(100, nothrow->dimension());
+  delete nothrow;
+
+  // Constructed in a buffer of the caller, the arena is left alone
+  const size_t used = arena.getUsed();
+  char buffer[sizeof(PVector<double> )];
+  Vector<double>* placed = 0;
+  {
+    ArenaScope scope(&arena);
+    placed = new (buffer) PVector<double>(10);
+  }
+  Assert::assertPasses((char*) placed == buffer);
+  placed->set(1.0);
+  Assert::assertObjectEquals(10.0, placed->sum());
+  placed->~Vector<double>();
+  Assert::assertPasses(arena.getUsed() - used >= 10 * sizeof(double));
+  Assert::assertPasses(arena.getUsed() - used < 10 * sizeof(double) + 128);
+}
+
+void ArenaTest::testOverflow()
+{
+  Arena arena(256);
+  Vector<double>* vector = 0;
+  {
+    ArenaScope scope(&arena);
+    vector = new PVector<double>(1000);
+  }
+  Assert::assertPasses(arena.owns(vector));
+  Assert::assertPasses(!arena.owns(vector->getValues()));
+  Assert::assertObjectEquals(1, arena.getNbOverflows());
+  vector->set(1.0);
+  Assert::assertObjectEquals(1000.0, vector->sum());
+  delete vector;
+}
+
+void ArenaTest::testRegistry()
+{
+  // Each live arena owns its objects; the arenas beyond the slots fall back to the heap
+  std::vector<Arena*> arenas;
+  std::vector<Vector<double>*> vectors;
+  for (int i = 0; i <= Arena::MAX_ARENAS; i++)
+  {
+    arenas.push_back(new Arena(4096));
+    ArenaScope scope(arenas.back());
+    vectors.push_back(new PVector<double>(10));
+  }
+  for (int i = 0; i < Arena::MAX_ARENAS; i++)
+    Assert::assertObjectEquals(arenas[i], Arena::owner(vectors[i]));
+  Assert::assertPasses(Arena::owner(vectors.back()) == 0);
+  Assert::assertObjectEquals(2, arenas.back()->getNbOverflows()); // the vector, and its entries
+
+  // The slot of a deleted arena is reused
+  delete vectors[3];
+  delete arenas[3];
+  arenas[3] = new Arena(4096);
+  {
+    ArenaScope scope(arenas[3]);
+    vectors[3] = new PVector<double>(10);
+  }
+  Assert::assertObjectEquals(arenas[3], Arena::owner(vectors[3]));
+  for (size_t i = 0; i < arenas.size(); i++)
+  {
+    delete vectors[i];
+    delete arenas[i];
+  }
+  Assert::assertPasses(Arena::owner(vectors[3]) == 0);
+}
+
+void ArenaTest::testHugePages()
+{
+  Arena arena(4 * Arena::HUGE_PAGE_SIZE, true);
+  std::cout << "hugePageBacked=" << arena.isHugePageBacked() << " capacity="
+      << arena.getCapacity() << std::endl;
+  Assert::assertPasses(arena.getCapacity() >= size_t(4 * Arena::HUGE_PAGE_SIZE));
+  Vector<double>* vector = 0;
+  {
+    ArenaScope scope(&arena);
+    vector = new PVector<double>(Arena::HUGE_PAGE_SIZE / sizeof(double));
+  }
+  Assert::assertPasses(arena.owns(vector->getValues()));
+  vector->set(2.0);
+  Assert::assertObjectEquals(2.0 * vector->dimension(), vector->sum());
+  delete vector;
+}
+
+void ArenaTest::testAgent()
+{
+  // The same agent, in an arena and on the heap, learns the same weights
+  Random<double>* arenaRandom = new Random<double>;
+  Random<double>* heapRandom = new Random<double>;
+  RLProblem<double>* arenaProblem = new MountainCar<double>(arenaRandom);
+  RLProblem<double>* heapProblem = new MountainCar<double>(heapRandom);
+  Arena* arena = new Arena(1 << 20);
+  SarsaAgent* arenaAgent = 0;
+  {
+    ArenaScope scope(arena);
+    arenaAgent = new SarsaAgent(arenaRandom, arenaProblem);
+  }
+  SarsaAgent* heapAgent = new SarsaAgent(heapRandom, heapProblem);
+  std::cout << "arena: " << arena->getUsed() << " bytes used" << std::endl;
+
+  Assert::assertPasses(!arena->owns(arenaAgent));
+  Assert::assertPasses(arena->owns(arenaAgent->agent));
+  Assert::assertPasses(arena->owns(arenaAgent->control));
+  Assert::assertPasses(arena->owns(arenaAgent->sarsa));
+  Assert::assertPasses(arena->owns(arenaAgent->sarsa->weights()));
+  Assert::assertPasses(arena->owns(arenaAgent->sarsa->weights()->getValues()));
+  Assert::assertPasses(arena->owns(arenaAgent->e->vect()->getValues()));
+  Assert::assertPasses(arena->owns(arenaAgent->projector));
+  Assert::assertPasses(arena->owns(arenaAgent->acting));
+  Assert::assertPasses(!arena->owns(heapAgent->sarsa->weights()->getValues()));
+
+  RLRunner<double>* arenaRunner = new RLRunner<double>(arenaAgent->agent, arenaProblem, 5000, 5,
+      1);
+  RLRunner<double>* heapRunner = new RLRunner<double>(heapAgent->agent, heapProblem, 5000, 5, 1);
+  arenaRunner->setVerbose(false);
+  heapRunner->setVerbose(false);
+  {
+    // The buffers created on the first step go to the arena too
+    ArenaScope scope(arena);
+    arenaRunner->runEpisodes();
+  }
+  heapRunner->runEpisodes();
+  Assert::assertObjectEquals(heapRunner->timeStep, arenaRunner->timeStep);
+  Assert::assertObjectEquals(heapAgent->sarsa->weights()->l1Norm(),
+      arenaAgent->sarsa->weights()->l1Norm());
+  Assert::assertObjectEquals(0, arena->getNbOverflows());
+
+  delete arenaRunner;
+  delete heapRunner;
+  delete arenaAgent; // the std containers of the objects in the arena
+  delete heapAgent;
+  delete arena; // frees the agent at once
+  delete arenaRandom;
+  delete heapRandom;
+  delete arenaProblem;
+  delete heapProblem;
+}
+
+void ArenaTest::testSaveRestore()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Arena arena(1 << 20);
+  SarsaAgent* sarsaAgent = 0;
+  {
+    ArenaScope scope(&arena);
+    sarsaAgent = new SarsaAgent(random, problem);
+  }
+  RLRunner<double>* runner = new RLRunner<double>(sarsaAgent->agent, problem, 5000, 2, 1);
+  runner->setVerbose(false);
+  PVector<double> weights(sarsaAgent->sarsa->weights()->dimension());
+  ArenaScope scope(&arena);
+  runner->runEpisodes();
+
+  // After the warm-up, the steps do not allocate: the agent rolls back in bulk
+  std::vector<char> saved;
+  arena.save(saved);
+  weights.set(sarsaAgent->sarsa->weights());
+  runner->setEpisodes(4);
+  runner->runEpisodes();
+  Assert::assertPasses(weights.l1Norm() != sarsaAgent->sarsa->weights()->l1Norm());
+  Assert::assertPasses(arena.restore(saved));
+  Assert::assertObjectEquals(weights.l1Norm(), sarsaAgent->sarsa->weights()->l1Norm());
+  weights.subtractToSelf(sarsaAgent->sarsa->weights());
+  Assert::assertObjectEquals(0.0, weights.maxNorm());
+
+  // Not after an allocation in the arena
+  Vector<double>* vector = new PVector<double>(10);
+  Assert::assertPasses(!arena.restore(saved));
+  delete vector;
+
+  delete runner;
+  delete sarsaAgent;
+  delete random;
+  delete problem;
+}
+
+void ArenaTest::run()
+{
+  testAllocation();
+  testPlacement();
+  testOverflow();
+  testRegistry();
+  testHugePages();
+  testAgent();
+  testSaveRestore();
+}
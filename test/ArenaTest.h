@@ -0,0 +1,53 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * ArenaTest.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef ARENATEST_H_
+#define ARENATEST_H_
+
+#include "Test.h"
+
+RLLIB_TEST(ArenaTest)
+
+class ArenaTest: public ArenaTestBase
+{
+  public:
+    ArenaTest()
+    {
+    }
+
+    virtual ~ArenaTest()
+    {
+    }
+    void run();
+
+  private:
+    void testAllocation();
+    void testPlacement();
+    void testOverflow();
+    void testRegistry();
+    void testHugePages();
+    void testAgent();
+    void testSaveRestore();
+};
+
+#endif /* ARENATEST_H_ */
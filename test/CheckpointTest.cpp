@@ -0,0 +1,401 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * CheckpointTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "CheckpointTest.h"
+
+RLLIB_TEST_MAKE(CheckpointTest)
+
+static long fileSize(const char* f)
+{
+  std::ifstream ifs(f, std::ifstream::in | std::ifstream::binary);
+  ifs.seekg(0, std::ifstream::end);
+  return long(ifs.tellg());
+}
+
+void CheckpointTest::testCodec()
+{
+  Random<double>* random = new Random<double>;
+  std::vector<unsigned char> in(5000);
+  for (size_t i = 0; i < in.size(); i++)
+    in[i] = i < 1000 ? 0 : (i < 3000 ? (unsigned char) random->nextInt(256) : (i / 100) % 3);
+  std::vector<unsigned char> encoded;
+  CheckpointCodec::encode(&in[0], in.size(), encoded);
+  Assert::assertPasses(encoded.size() < in.size());
+  std::vector<unsigned char> out(in.size());
+  Assert::assertPasses(CheckpointCodec::decode(&encoded[0], encoded.size(), &out[0], out.size()));
+  Assert::assertPasses(in == out);
+  // The decoder must not overflow the output
+  Assert::assertFails(CheckpointCodec::decode(&encoded[0], encoded.size(), &out[0], 100));
+
+  std::vector<unsigned char> shuffled(in.size()), unshuffled(in.size());
+  CheckpointCodec::shuffle(&in[0], in.size() / 8, 8, &shuffled[0]);
+  CheckpointCodec::unshuffle(&shuffled[0], in.size() / 8, 8, &unshuffled[0]);
+  Assert::assertPasses(in == unshuffled);
+  delete random;
+}
+
+void CheckpointTest::testDenseAndSparseBlocks()
+{
+  Random<double>* random = new Random<double>;
+  // Hashed table: zero runs, a few touched blocks, and a dense region
+  PVector<double> table(1000000);
+  for (int i = 0; i < 200; i++)
+    table.setEntry(random->nextInt(table.dimension()), random->nextGaussian(0.0, 1.0));
+  for (int i = 500000; i < 510000; i++)
+    table.setEntry(i, random->nextGaussian(0.0, 1.0));
+  // Slowly varying entries: the shuffled exponent bytes compress
+  PVector<float> bias(50000);
+  for (int i = 0; i < bias.dimension(); i++)
+    bias.setEntry(i, 1.0f + (i % 7) * 0.25f);
+  SVector<double> trace(100000);
+  for (int i = 0; i < 50; i++)
+    trace.setEntry(random->nextInt(trace.dimension()), random->nextGaussian(0.0, 1.0));
+  Vectors<double> parameters;
+  PVector<double> u_mean(3000), u_stddev(3000);
+  u_mean.setEntry(7, 1.0);
+  u_stddev.setEntry(2999, -1.0);
+  parameters.push_back(&u_mean);
+  parameters.push_back(&u_stddev);
+
+  Checkpoint<double> checkpoint;
+  checkpoint.add("table", &table);
+  checkpoint.add("trace", &trace);
+  checkpoint.add("actor", &parameters);
+  Assert::assertObjectEquals(checkpoint.dimension(), 4);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint.data"));
+  table.persist("visualization/checkpoint_table.data");
+  const long compressed = fileSize("visualization/checkpoint.data");
+  const long dense = fileSize("visualization/checkpoint_table.data");
+  cout << "checkpoint=" << compressed << " bytes PVector::persist=" << dense << " bytes ratio="
+      << double(dense) / compressed << endl;
+  Assert::assertPasses(compressed < dense / 5);
+
+  PVector<double> table2(table.dimension());
+  for (int i = 0; i < table2.dimension(); i++)
+    table2.setEntry(i, 1.0);
+  SVector<double> trace2(trace.dimension());
+  trace2.setEntry(1, 5.0);
+  PVector<double> u_mean2(u_mean.dimension()), u_stddev2(u_stddev.dimension());
+  Vectors<double> parameters2;
+  parameters2.push_back(&u_mean2);
+  parameters2.push_back(&u_stddev2);
+  Checkpoint<double> restored;
+  restored.add("actor", &parameters2);
+  restored.add("table", &table2);
+  restored.add("trace", &trace2);
+  Assert::assertPasses(restored.resurrect("visualization/checkpoint.data"));
+  Assert::assertEquals(&table, &table2);
+  Assert::assertEquals(&trace, &trace2);
+  Assert::assertEquals(&u_mean, &u_mean2);
+  Assert::assertEquals(&u_stddev, &u_stddev2);
+
+  Checkpoint<float> floatCheckpoint;
+  floatCheckpoint.add("bias", &bias);
+  Assert::assertPasses(floatCheckpoint.persist("visualization/checkpoint_float.data"));
+  Assert::assertPasses(
+      fileSize("visualization/checkpoint_float.data") < long(bias.dimension() * sizeof(float) / 2));
+  PVector<float> bias2(bias.dimension());
+  Checkpoint<float> floatRestored;
+  floatRestored.add("bias", &bias2);
+  Assert::assertPasses(floatRestored.resurrect("visualization/checkpoint_float.data"));
+  Assert::assertEquals(&bias, &bias2);
+  // A checkpoint of doubles is not a checkpoint of floats
+  Assert::assertFails(floatRestored.resurrect("visualization/checkpoint.data"));
+  delete random;
+}
+
+void CheckpointTest::testCorruptedFile()
+{
+  PVector<double> v(5000);
+  for (int i = 0; i < v.dimension(); i += 3)
+    v.setEntry(i, i * 0.5);
+  Checkpoint<double> checkpoint;
+  checkpoint.add("v", &v);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_corrupted.data"));
+  std::fstream fs("visualization/checkpoint_corrupted.data",
+      std::fstream::in | std::fstream::out | std::fstream::binary);
+  fs.seekp(40);
+  fs.put(char(0x55));
+  fs.close();
+  Assert::assertFails(checkpoint.resurrect("visualization/checkpoint_corrupted.data"));
+
+  // A forged run of zero blocks past the end of the vector, with a valid checksum
+  PVector<double> zeros(5000);
+  Checkpoint<double> zeroCheckpoint;
+  zeroCheckpoint.add("v", &zeros);
+  Assert::assertPasses(zeroCheckpoint.persist("visualization/checkpoint_corrupted.data"));
+  std::ifstream ifs("visualization/checkpoint_corrupted.data", std::ifstream::binary);
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  ifs.close();
+  const size_t count = 8 + 3 * sizeof(uint32_t) + sizeof(uint32_t) + 1 + sizeof(int32_t) + 1;
+  Assert::assertObjectEquals(bytes.size(), count + sizeof(uint32_t) + sizeof(uint64_t));
+  const uint32_t nbBlocks = 1u << 22; // overflows an int once multiplied by the block size
+  std::memcpy(&bytes[count], &nbBlocks, sizeof(nbBlocks));
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < count + sizeof(uint32_t); i++)
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  std::memcpy(&bytes[count + sizeof(uint32_t)], &hash, sizeof(hash));
+  std::ofstream ofs("visualization/checkpoint_corrupted.data", std::ofstream::binary);
+  ofs.write((const char*) &bytes[0], bytes.size());
+  ofs.close();
+  Assert::assertFails(zeroCheckpoint.resurrect("visualization/checkpoint_corrupted.data"));
+
+  PVector<double> other(10);
+  Checkpoint<double> mismatch;
+  mismatch.add("v", &other);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_corrupted.data"));
+  Assert::assertFails(mismatch.resurrect("visualization/checkpoint_corrupted.data"));
+}
+
+void CheckpointTest::testOffPACCheckpoint()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 1000000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10,
+      true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+
+  double alpha_v = 0.05 / projector->vectorNorm();
+  double alpha_w = 0.0001 / projector->vectorNorm();
+  double gamma = 0.99;
+  double lambda = 0.4;
+  Trace<double>* critice = new ATrace<double>(projector->dimension());
+  GTDLambda<double>* critic = new GTDLambda<double>(alpha_v, alpha_w, gamma, lambda, critice);
+  double alpha_u = 0.5 / projector->vectorNorm();
+  PolicyDistribution<double>* target = new BoltzmannDistribution<double>(random,
+      problem->getDiscreteActions(), projector->dimension());
+
+  Trace<double>* actore = new ATrace<double>(projector->dimension());
+  Traces<double>* actoreTraces = new Traces<double>();
+  actoreTraces->push_back(actore);
+  ActorOffPolicy<double>* actor = new ActorLambdaOffPolicy<double>(alpha_u, gamma, lambda, target,
+      actoreTraces);
+
+  Policy<double>* behavior = new RandomPolicy<double>(random, problem->getDiscreteActions());
+  OffPolicyControlLearner<double>* control = new OffPAC<double>(behavior, critic, actor,
+      toStateAction, projector);
+
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* sim = new RLRunner<double>(agent, problem, 1000, 5, 1);
+  sim->setVerbose(false);
+  sim->run();
+
+  // The actor and the critic share one file
+  Checkpoint<double> checkpoint;
+  checkpoint.add("critic.v", critic->weights());
+  checkpoint.add("critic.w", critic->secondaryWeights());
+  checkpoint.add("actor", target->parameters());
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_offpac.data"));
+  cout << "offpac checkpoint=" << fileSize("visualization/checkpoint_offpac.data") << " bytes raw="
+      << 3 * projector->dimension() * sizeof(double) << " bytes" << endl;
+
+  PVector<double> v(critic->weights()->dimension()), w(v.dimension());
+  v.set(critic->weights());
+  w.set(critic->secondaryWeights());
+  PVector<double> u(v.dimension());
+  u.set(target->parameters()->getEntry(0));
+  control->reset();
+  Assert::assertPasses(checkpoint.resurrect("visualization/checkpoint_offpac.data"));
+  Assert::assertEquals(&v, critic->weights());
+  Assert::assertEquals(&w, critic->secondaryWeights());
+  Assert::assertEquals(&u, target->parameters()->getEntry(0));
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete critice;
+  delete critic;
+  delete actore;
+  delete actoreTraces;
+  delete actor;
+  delete behavior;
+  delete target;
+  delete control;
+  delete agent;
+  delete sim;
+}
+
+void CheckpointTest::testDirtyBlocks()
+{
+  PVector<double> v(10000);
+  Assert::assertPasses(v.dirtyBlocks() == 0);
+  v.trackDirtyBlocks(10);
+  Assert::assertObjectEquals(v.dirtyBlocks()->getNbBlocks(), 10);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 10);
+  v.dirtyBlocks()->clear();
+  v.setEntry(5, 1.0);
+  v.setEntry(1023, 1.0);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 1);
+  SVector<double> x(v.dimension());
+  x.setEntry(2048, 1.0);
+  x.setEntry(9999, 1.0);
+  v.addToSelf(0.5, &x);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 3);
+  Assert::assertPasses(v.dirtyBlocks()->isDirty(9));
+  Assert::assertFails(v.dirtyBlocks()->isDirty(1));
+  v.subtractToSelf(&x);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 3);
+  PVector<double> y(v.dimension());
+  v.addToSelf(1.0, &y);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 10);
+
+  // The entries handed out for writing are dirty, the reads are not
+  v.dirtyBlocks()->clear();
+  const PVector<double>& constV = v;
+  Assert::assertObjectEquals(constV.getValues()[5], v.getEntry(5));
+  Assert::assertObjectEquals(constV[1023], v.getEntry(1023));
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 0);
+  v[3000] = 2.0;
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 1);
+  Vectors<double>::multiplySelfByExponential(&v, 0.5, &x, 0.0);
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 2);
+  v.getValues()[0] = 3.0;
+  Assert::assertObjectEquals(v.dirtyBlocks()->nbDirtyBlocks(), 10);
+  v.untrackDirtyBlocks();
+  Assert::assertPasses(v.dirtyBlocks() == 0);
+}
+
+void CheckpointTest::testRawWriteCheckpoint()
+{
+  Random<double>* random = new Random<double>;
+  PVector<double> alphas(1 << 16);
+  for (int i = 0; i < alphas.dimension(); i++)
+    alphas.setEntry(i, i % 2 ? 0.1 : -0.1);
+  IncrementalCheckpoint<double> checkpoint;
+  checkpoint.add("alphas", &alphas);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_raw.data"));
+
+  // IDBD-like step sizes, and entries edited in place through the raw buffer
+  SVector<double> x(alphas.dimension());
+  for (int i = 0; i < 8; i++)
+    x.setEntry(random->nextInt(alphas.dimension()), random->nextGaussian(0.0, 1.0));
+  Vectors<double>::multiplySelfByExponential(&alphas, 0.5, &x, 0.01);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_raw.data"));
+  Vectors<double>::absToSelf(&alphas);
+  alphas[7] = 0.7;
+  double* values = alphas.getValues();
+  for (int i = 0; i < alphas.dimension(); i += 1000)
+    values[i] += 1.0;
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_raw.data"));
+
+  PVector<double> restored(alphas.dimension());
+  IncrementalCheckpoint<double> other;
+  other.add("alphas", &restored);
+  Assert::assertPasses(other.resurrect("visualization/checkpoint_raw.data"));
+  Assert::assertObjectEquals(other.getNbSegments(), 2);
+  Assert::assertEquals(&alphas, &restored);
+  Assert::assertObjectEquals(restored.getEntry(7), 0.7);
+  delete random;
+}
+
+void CheckpointTest::testIncrementalCheckpoint()
+{
+  Random<double>* random = new Random<double>;
+  PVector<double> table(1 << 22);
+  for (int i = 0; i < table.dimension(); i++)
+    table.setEntry(i, random->nextGaussian(0.0, 1.0));
+  SVector<double> trace(table.dimension());
+  IncrementalCheckpoint<double> checkpoint(3);
+  checkpoint.add("table", &table);
+  checkpoint.add("trace", &trace);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_incremental.data"));
+  const long full = fileSize("visualization/checkpoint_incremental.data");
+  Assert::assertPasses(table.dirtyBlocks() != 0);
+  Assert::assertObjectEquals(table.dirtyBlocks()->nbDirtyBlocks(), 0);
+
+  // Sparse TD-like updates between the checkpoints
+  for (int segment = 1; segment <= 2; segment++)
+  {
+    for (int t = 0; t < 20; t++)
+    {
+      trace.clear();
+      const int index = random->nextInt(table.dimension() - 8);
+      for (int i = 0; i < 8; i++)
+        trace.setEntry(index + i, 1.0);
+      table.addToSelf(0.1, &trace);
+    }
+    Assert::assertPasses(checkpoint.persist("visualization/checkpoint_incremental.data"));
+    Assert::assertObjectEquals(checkpoint.getNbSegments(), segment);
+    const long delta = fileSize(
+        (std::string("visualization/checkpoint_incremental.data.delta.") + char('0' + segment))
+            .c_str());
+    cout << "full=" << full << " bytes delta=" << delta << " bytes" << endl;
+    Assert::assertPasses(delta < full / 100);
+  }
+
+  PVector<double> restored(table.dimension());
+  SVector<double> restoredTrace(table.dimension());
+  IncrementalCheckpoint<double> other;
+  other.add("table", &restored);
+  other.add("trace", &restoredTrace);
+  Assert::assertPasses(other.resurrect("visualization/checkpoint_incremental.data"));
+  Assert::assertObjectEquals(other.getNbSegments(), 2);
+  Assert::assertEquals(&table, &restored);
+  Assert::assertEquals(&trace, &restoredTrace);
+
+  // A sparse vector only writes its modified blocks, and the blocks that became zero
+  SVector<double> sparse(table.dimension());
+  for (int i = 0; i < 1000; i++)
+    sparse.setEntry(random->nextInt(sparse.dimension()), random->nextGaussian(0.0, 1.0));
+  IncrementalCheckpoint<double> sparseCheckpoint;
+  sparseCheckpoint.add("sparse", &sparse);
+  Assert::assertPasses(sparseCheckpoint.persist("visualization/checkpoint_sparse.data"));
+  const long sparseFull = fileSize("visualization/checkpoint_sparse.data");
+  const int modified = sparse.nonZeroIndexes()[0];
+  const int removed = sparse.nonZeroIndexes()[1];
+  sparse.setEntry(modified, 7.0);
+  sparse.removeEntry(removed);
+  Assert::assertPasses(sparseCheckpoint.persist("visualization/checkpoint_sparse.data"));
+  const long sparseDelta = fileSize("visualization/checkpoint_sparse.data.delta.1");
+  cout << "sparse full=" << sparseFull << " bytes delta=" << sparseDelta << " bytes" << endl;
+  Assert::assertPasses(sparseDelta < sparseFull / 50);
+  SVector<double> restoredSparse(sparse.dimension());
+  restoredSparse.setEntry(3, 1.0);
+  IncrementalCheckpoint<double> otherSparse;
+  otherSparse.add("sparse", &restoredSparse);
+  Assert::assertPasses(otherSparse.resurrect("visualization/checkpoint_sparse.data"));
+  Assert::assertEquals(&sparse, &restoredSparse);
+
+  // The third segment triggers the compaction
+  table.setEntry(12345, 42.0);
+  Assert::assertPasses(checkpoint.persist("visualization/checkpoint_incremental.data"));
+  Assert::assertObjectEquals(checkpoint.getNbSegments(), 0);
+  Assert::assertFails(std::ifstream("visualization/checkpoint_incremental.data.delta.1").good());
+  Assert::assertPasses(other.resurrect("visualization/checkpoint_incremental.data"));
+  Assert::assertEquals(&table, &restored);
+  delete random;
+}
+
+void CheckpointTest::run()
+{
+  testCodec();
+  testDenseAndSparseBlocks();
+  testCorruptedFile();
+  testOffPACCheckpoint();
+  testDirtyBlocks();
+  testIncrementalCheckpoint();
+  testRawWriteCheckpoint();
+}
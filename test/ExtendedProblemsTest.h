@@ -74,11 +74,11 @@ class ExtendedProblemsTest: public ExtendedProblemsTestBase
     void testFunction2RK4();
 
     // RK tests
-    class Function1: public RK4
+    class Function1: public RK4<double>
     {
       public:
         Function1(const int& m, const double& dt) :
-            RK4(m, dt)
+            RK4<double>(m, dt)
         {
         }
 
@@ -90,11 +90,11 @@ class ExtendedProblemsTest: public ExtendedProblemsTestBase
 
     };
 
-    class Function2: public RK4
+    class Function2: public RK4<double>
     {
       public:
         Function2(const int& m, const double& dt) :
-            RK4(m, dt)
+            RK4<double>(m, dt)
         {
         }
 
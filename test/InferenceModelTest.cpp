@@ -0,0 +1,154 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * InferenceModelTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "InferenceModelTest.h"
+#include <iterator>
+
+RLLIB_TEST_MAKE(InferenceModelTest)
+
+void InferenceModelTest::testInferenceModel(Hashing<double>* hashing, Random<double>* random)
+{
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  TileCoderHashing<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(),
+      10, 10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+  Trace<double>* e = new RTrace<double>(projector->dimension());
+  Sarsa<double>* sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa,
+      0.01);
+  OnPolicyControlLearner<double>* control = new SarsaControl<double>(acting, toStateAction, sarsa);
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* sim = new RLRunner<double>(agent, problem, 5000, 20, 1);
+  sim->setVerbose(false);
+  sim->run();
+
+  const char* f = "visualization/mcar_inference.bin";
+  Assert::assertPasses(
+      InferenceControl<double>::persist(f, projector, problem->getDiscreteActions(),
+          sarsa->weights()));
+
+  testCorruptedModel(f);
+
+  InferenceControl<double>* inference = new InferenceControl<double>(f);
+  Policy<double>* greedy = new Greedy<double>(problem->getDiscreteActions(), sarsa);
+  Assert::assertObjectEquals(inference->dimension(), sarsa->weights()->dimension());
+  Assert::assertObjectEquals(inference->getActions()->dimension(),
+      problem->getDiscreteActions()->dimension());
+
+  PVector<double> x(problem->dimension());
+  for (int k = 0; k < 1000; k++)
+  {
+    for (int i = 0; i < x.dimension(); i++)
+      x.setEntry(i, random->nextReal());
+    const Representations<double>* phis = toStateAction->stateActions(&x);
+    greedy->update(phis);
+    const Action<double>* expected = greedy->sampleBestAction();
+    const Action<double>* actual = inference->proposeAction(&x);
+    Assert::assertObjectEquals(expected->id(), actual->id());
+    for (Actions<double>::const_iterator a = problem->getDiscreteActions()->begin();
+        a != problem->getDiscreteActions()->end(); ++a)
+      Assert::assertPasses(
+          std::fabs(sarsa->predict(phis->at(*a)) - inference->computeQ(&x, *a)) < 1e-12);
+  }
+
+  delete problem;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete sim;
+  delete inference;
+  delete greedy;
+}
+
+void InferenceModelTest::testCorruptedModel(const char* f)
+{
+  std::ifstream ifs(f, std::ifstream::in | std::ifstream::binary);
+  std::vector<char> model((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  InferenceModelHeader* h = reinterpret_cast<InferenceModelHeader*>(&model[0]);
+  Assert::assertPasses(InferenceControl<double>::isValid(h, model.size()));
+
+  // A truncated model, even with a consistent file size
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size() - 8));
+  h->fileSize -= 8;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size() - 8));
+  h->fileSize += 8;
+
+  // Sections past the end of the model
+  const InferenceModelHeader header = *h;
+  h->weightsOffset = model.size();
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  h->actionsOffset = uint64_t(-64);
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  h->gridResolutionsOffset += 1;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  h->nbWeights += 1;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  h->actionDimension = 1 << 30;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+
+  // Negative counts
+  *h = header;
+  h->nbInputs = -1;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  h->nbActions = -1;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+
+  // More inputs than the tile coder can hold
+  *h = header;
+  h->nbInputs = Hashing<double>::MAX_NUM_VARS + 1;
+  Assert::assertPasses(!InferenceControl<double>::isValid(h, model.size()));
+  *h = header;
+  Assert::assertPasses(InferenceControl<double>::isValid(h, model.size()));
+}
+
+void InferenceModelTest::testUNHInferenceModel()
+{
+  Random<double>* random = new Random<double>;
+  Hashing<double>* hashing = new UNH<double>(random, 10000);
+  testInferenceModel(hashing, random);
+  delete hashing;
+  delete random;
+}
+
+void InferenceModelTest::testMurmurInferenceModel()
+{
+  Random<double>* random = new Random<double>;
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 10000);
+  testInferenceModel(hashing, random);
+  delete hashing;
+  delete random;
+}
+
+void InferenceModelTest::run()
+{
+  testUNHInferenceModel();
+  testMurmurInferenceModel();
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ * InstrumentationTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <thread>
+#include "InstrumentationTest.h"
+
+RLLIB_TEST_MAKE(InstrumentationTest)
+
+namespace
+{
+  void busy(const uint64_t& nanos)
+  {
+    const uint64_t start = Instrumentation::now();
+    while (Instrumentation::now() - start < nanos)
+      ;
+  }
+
+  // The phases of the episodes of a runner
+  class EpisodePhases: public RLRunner<double>::Event
+  {
+    public:
+      std::vector<Instrumentation::Breakdown>* episodes;
+      std::vector<int>* lengths;
+
+      EpisodePhases(std::vector<Instrumentation::Breakdown>* episodes, std::vector<int>* lengths) :
+          episodes(episodes), lengths(lengths)
+      {
+      }
+
+      void update() const
+      {
+        episodes->push_back(phases);
+        lengths->push_back(nbTotalTimeSteps);
+      }
+  };
+}
+
+void InstrumentationTest::testExclusiveTime()
+{
+  Instrumentation::Breakdown before, after;
+  Instrumentation::snapshot(before);
+  {
+    ScopedProbe learner(Instrumentation::LEARNER);
+    busy(2000000);
+    {
+      ScopedProbe trace(Instrumentation::TRACE);
+      busy(3000000);
+    }
+  }
+  Instrumentation::snapshot(after);
+  const Instrumentation::Breakdown episode = after - before;
+  Assert::assertObjectEquals(uint64_t(1), episode.counts[Instrumentation::LEARNER]);
+  Assert::assertObjectEquals(uint64_t(1), episode.counts[Instrumentation::TRACE]);
+  // The nested trace update does not count as learner time
+  Assert::assertPasses(episode.nanos[Instrumentation::TRACE] >= 3000000);
+  Assert::assertPasses(episode.nanos[Instrumentation::LEARNER] >= 2000000);
+  // With the nested time, the learner would take longer than the trace update
+  Assert::assertPasses(episode.nanos[Instrumentation::LEARNER]
+      < episode.nanos[Instrumentation::TRACE]);
+  episode.print(std::cout, 1);
+}
+
+void InstrumentationTest::testThreadAggregation()
+{
+  Instrumentation::Breakdown before, after, threadBefore, threadAfter;
+  Instrumentation::snapshotAll(before);
+  Instrumentation::snapshot(threadBefore);
+  std::thread worker([]()
+  {
+    ScopedProbe policy(Instrumentation::POLICY);
+    busy(1000000);
+  });
+  worker.join();
+  {
+    ScopedProbe policy(Instrumentation::POLICY);
+    busy(1000000);
+  }
+  // The counters of the worker outlive it
+  Instrumentation::snapshotAll(after);
+  Instrumentation::snapshot(threadAfter);
+  const Instrumentation::Breakdown difference = after - before;
+  Assert::assertObjectEquals(uint64_t(2), difference.counts[Instrumentation::POLICY]);
+  Assert::assertPasses(difference.nanos[Instrumentation::POLICY] >= 2000000);
+  // The calling thread only sees its own probes
+  const Instrumentation::Breakdown own = threadAfter - threadBefore;
+  Assert::assertObjectEquals(uint64_t(1), own.counts[Instrumentation::POLICY]);
+  Assert::assertPasses(
+      own.nanos[Instrumentation::POLICY] < difference.nanos[Instrumentation::POLICY]);
+}
+
+void InstrumentationTest::testProbeOverhead()
+{
+  const int nbProbes = 1000000;
+  const uint64_t start = Instrumentation::now();
+  for (int i = 0; i < nbProbes; i++)
+  {
+    ScopedProbe probe(Instrumentation::AGENT);
+  }
+  const double nanosPerProbe = double(Instrumentation::now() - start) / nbProbes;
+  std::cout << "ScopedProbe: " << nanosPerProbe << " ns" << std::endl;
+  Assert::assertPasses(nanosPerProbe < 1000);
+}
+
+void InstrumentationTest::testPerfCounters()
+{
+  // The counters are optional: without them the probes still time, and count no events
+  const bool available = Instrumentation::enablePerfCounters(true);
+  std::cout << "PerfCounters: " << (available ? "available" : "not permitted") << std::endl;
+  Instrumentation::Breakdown before, after;
+  Instrumentation::snapshot(before);
+  {
+    ScopedProbe learner(Instrumentation::LEARNER);
+    busy(1000000);
+    {
+      ScopedProbe trace(Instrumentation::TRACE);
+      busy(1000000);
+    }
+  }
+  Instrumentation::snapshot(after);
+  Instrumentation::enablePerfCounters(false);
+  const Instrumentation::Breakdown difference = after - before;
+  Assert::assertObjectEquals(uint64_t(1), difference.counts[Instrumentation::LEARNER]);
+  Assert::assertObjectEquals(uint64_t(1), difference.counts[Instrumentation::TRACE]);
+  Assert::assertPasses(difference.nanos[Instrumentation::TRACE] >= 1000000);
+  if (available)
+  {
+    Assert::assertObjectEquals(uint64_t(1), difference.eventCounts[Instrumentation::LEARNER]);
+    Assert::assertPasses(difference.events[Instrumentation::LEARNER][PerfCounters::CYCLES] > 0
+        || difference.events[Instrumentation::LEARNER][PerfCounters::INSTRUCTIONS] > 0);
+    Assert::assertPasses(difference.events[Instrumentation::TRACE][PerfCounters::CYCLES] > 0
+        || difference.events[Instrumentation::TRACE][PerfCounters::INSTRUCTIONS] > 0);
+  }
+  else
+    Assert::assertPasses(!difference.hasEvents());
+  difference.print(std::cout, 1);
+
+  // Disabled, the probes do not read the counters
+  Instrumentation::snapshot(before);
+  {
+    ScopedProbe policy(Instrumentation::POLICY);
+    busy(100000);
+  }
+  Instrumentation::snapshot(after);
+  Assert::assertPasses(!(after - before).hasEvents());
+}
+
+void InstrumentationTest::testEpisodeBreakdown()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 10000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10,
+      10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+  Trace<double>* e = new RTrace<double>(projector->dimension());
+  Sarsa<double>* sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa,
+      0.01);
+  OnPolicyControlLearner<double>* control = new SarsaControl<double>(acting, toStateAction,
+      sarsa);
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* sim = new RLRunner<double>(agent, problem, 5000, 10, 1);
+  sim->setVerbose(false);
+  std::vector<Instrumentation::Breakdown> episodes;
+  std::vector<int> lengths;
+  EpisodePhases event(&episodes, &lengths);
+  sim->onEpisodeEnd.push_back(&event);
+  sim->run();
+
+  Assert::assertObjectEquals(size_t(10), episodes.size());
+  for (size_t i = 0; i < episodes.size(); i++)
+  {
+    const Instrumentation::Breakdown& phases = episodes[i];
+#if defined(RLLIB_INSTRUMENTATION)
+    // One agent probe per decision, and the phases below it
+    Assert::assertObjectEquals(uint64_t(lengths[i] + 1), phases.counts[Instrumentation::AGENT]);
+    Assert::assertPasses(phases.counts[Instrumentation::PROJECTION] > 0);
+    Assert::assertPasses(phases.counts[Instrumentation::STATE_ACTIONS] > 0);
+    Assert::assertPasses(phases.counts[Instrumentation::POLICY] > 0);
+    Assert::assertObjectEquals(uint64_t(lengths[i]), phases.counts[Instrumentation::TRACE]);
+    Assert::assertObjectEquals(uint64_t(lengths[i]), phases.counts[Instrumentation::LEARNER]);
+#else
+    // The probes compile to nothing
+    Assert::assertObjectEquals(uint64_t(0), phases.totalNanos());
+#endif
+  }
+  episodes.back().print(std::cout, lengths.back());
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete sim;
+}
+
+void InstrumentationTest::run()
+{
+  testExclusiveTime();
+  testThreadAggregation();
+  testProbeOverhead();
+  testPerfCounters();
+  testEpisodeBreakdown();
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * LatencyHistogramTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "LatencyHistogramTest.h"
+
+RLLIB_TEST_MAKE(LatencyHistogramTest)
+
+namespace
+{
+  // The step counts and the latency counts of the episodes of a runner
+  class EpisodeLatencies: public RLRunner<double>::Event
+  {
+    public:
+      std::vector<int>* lengths;
+      std::vector<uint64_t>* counts;
+
+      EpisodeLatencies(std::vector<int>* lengths, std::vector<uint64_t>* counts) :
+          lengths(lengths), counts(counts)
+      {
+      }
+
+      void update() const
+      {
+        lengths->push_back(nbTotalTimeSteps);
+        counts->push_back(latencies ? latencies->count() : 0);
+      }
+  };
+}
+
+void LatencyHistogramTest::testSmallValues()
+{
+  // The values below SUB_COUNT are exact
+  LatencyHistogram histogram;
+  for (uint64_t v = 0; v < uint64_t(LatencyHistogram::SUB_COUNT); v++)
+  {
+    Assert::assertObjectEquals(int(v), LatencyHistogram::bucketIndex(v));
+    Assert::assertObjectEquals(v, LatencyHistogram::bucketLower(int(v)));
+    Assert::assertObjectEquals(v, LatencyHistogram::bucketUpper(int(v)));
+    histogram.record(v);
+  }
+  Assert::assertObjectEquals(uint64_t(LatencyHistogram::SUB_COUNT), histogram.count());
+  Assert::assertObjectEquals(uint64_t(0), histogram.min());
+  Assert::assertObjectEquals(uint64_t(LatencyHistogram::SUB_COUNT - 1), histogram.max());
+  Assert::assertObjectEquals(uint64_t(31), histogram.percentile(50));
+}
+
+void LatencyHistogramTest::testRelativePrecision()
+{
+  // Each value lies in its bucket, and the buckets are within 1/HALF_COUNT of their values
+  const double precision = 1.0 / LatencyHistogram::HALF_COUNT;
+  int previous = -1;
+  for (uint64_t v = 1; v < (uint64_t(1) << 41); v += v / 7 + 1)
+  {
+    const int index = LatencyHistogram::bucketIndex(v);
+    Assert::assertPasses(index >= previous);
+    Assert::assertPasses(index < LatencyHistogram::NB_BUCKETS);
+    Assert::assertPasses(LatencyHistogram::bucketLower(index) <= v);
+    Assert::assertPasses(v <= LatencyHistogram::bucketUpper(index));
+    Assert::assertPasses(
+        double(LatencyHistogram::bucketUpper(index) - LatencyHistogram::bucketLower(index))
+            <= precision * v);
+    previous = index;
+  }
+  // The buckets are contiguous
+  for (int i = 1; i < LatencyHistogram::NB_BUCKETS - 1; i++)
+    Assert::assertObjectEquals(LatencyHistogram::bucketUpper(i - 1) + 1,
+        LatencyHistogram::bucketLower(i));
+  // The values out of range saturate
+  Assert::assertObjectEquals(int(LatencyHistogram::NB_BUCKETS - 1),
+      LatencyHistogram::bucketIndex(UINT64_MAX));
+}
+
+void LatencyHistogramTest::testPercentiles()
+{
+  // 1us..1000us: a uniform distribution
+  LatencyHistogram histogram;
+  for (uint64_t v = 1; v <= 1000; v++)
+    histogram.record(v * 1000);
+  const double percentiles[] = { 0.1, 50, 90, 99, 99.9, 100 };
+  for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++)
+  {
+    const double expected = percentiles[i] * 10000;
+    const double actual = double(histogram.percentile(percentiles[i]));
+    Assert::assertPasses(actual >= expected);
+    Assert::assertPasses(actual <= expected * (1.0 + 1.0 / LatencyHistogram::HALF_COUNT));
+  }
+  Assert::assertObjectEquals(uint64_t(1000000), histogram.percentile(100));
+  Assert::assertObjectEquals(500500.0, histogram.mean());
+  // A tail: 1% of the steps take 100 times longer
+  LatencyHistogram tail;
+  for (int i = 0; i < 990; i++)
+    tail.record(10000);
+  for (int i = 0; i < 10; i++)
+    tail.record(1000000);
+  Assert::assertPasses(tail.percentile(99) < 11000);
+  Assert::assertObjectEquals(uint64_t(1000000), tail.percentile(99.9));
+  tail.print(std::cout, "tail(us)");
+  tail.reset();
+  Assert::assertObjectEquals(uint64_t(0), tail.count());
+  Assert::assertObjectEquals(uint64_t(0), tail.percentile(99));
+}
+
+void LatencyHistogramTest::testMerge()
+{
+  // Merging the histograms of the threads equals recording all the values in one
+  Random<double> random;
+  LatencyHistogram a, b, all;
+  for (int i = 0; i < 10000; i++)
+  {
+    const uint64_t v = uint64_t(std::exp(random.nextReal() * 20.0));
+    ((i % 3) ? a : b).record(v);
+    all.record(v);
+  }
+  a.merge(b);
+  Assert::assertObjectEquals(all.count(), a.count());
+  Assert::assertObjectEquals(all.min(), a.min());
+  Assert::assertObjectEquals(all.max(), a.max());
+  for (int i = 0; i < LatencyHistogram::NB_BUCKETS; i++)
+    Assert::assertObjectEquals(all.countAt(i), a.countAt(i));
+  Assert::assertObjectEquals(all.percentile(99.9), a.percentile(99.9));
+}
+
+void LatencyHistogramTest::testRunnerLatencies()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 10000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10,
+      10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+  Trace<double>* e = new RTrace<double>(projector->dimension());
+  Sarsa<double>* sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa,
+      0.01);
+  OnPolicyControlLearner<double>* control = new SarsaControl<double>(acting, toStateAction,
+      sarsa);
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* sim = new RLRunner<double>(agent, problem, 5000, 10, 1);
+  sim->setVerbose(false);
+  std::vector<int> lengths;
+  std::vector<uint64_t> counts;
+  EpisodeLatencies event(&lengths, &counts);
+  sim->onEpisodeEnd.push_back(&event);
+
+  // Disabled by default
+  sim->run();
+  Assert::assertPasses(!sim->getRunLatencies());
+  Assert::assertObjectEquals(uint64_t(0), counts.back());
+
+  // One latency per step, in the episode and in the run
+  lengths.clear();
+  counts.clear();
+  sim->enableLatencyHistograms(true);
+  sim->run();
+  uint64_t nbSteps = 0;
+  for (size_t i = 0; i < lengths.size(); i++)
+  {
+    Assert::assertObjectEquals(uint64_t(lengths[i]), counts[i]);
+    nbSteps += lengths[i];
+  }
+  Assert::assertObjectEquals(nbSteps, sim->getRunLatencies()->count());
+  Assert::assertPasses(sim->getRunLatencies()->max() > 0);
+  sim->getRunLatencies()->print(std::cout, "step(us)");
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete sim;
+}
+
+void LatencyHistogramTest::run()
+{
+  testSmallValues();
+  testRelativePrecision();
+  testPercentiles();
+  testMerge();
+  testRunnerLatencies();
+}
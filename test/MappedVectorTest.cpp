@@ -0,0 +1,156 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * MappedVectorTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "MappedVectorTest.h"
+#include <iterator>
+
+RLLIB_TEST_MAKE(MappedVectorTest)
+
+void MappedVectorTest::testReadOnlyMapping()
+{
+  Random<double>* random = new Random<double>;
+  PVector<double> v(10000);
+  for (int i = 0; i < v.dimension(); i++)
+    v.setEntry(i, random->nextGaussian(0.0, 1.0));
+  Assert::assertPasses(MappedPVector<double>::persist("visualization/mapped_vector.dat", &v));
+
+  MappedPVector<double>* mapped = new MappedPVector<double>("visualization/mapped_vector.dat");
+  Assert::assertPasses(mapped->verify());
+  Assert::assertEquals<double>(&v, mapped);
+
+  SVector<double> x(v.dimension());
+  for (int i = 0; i < 100; i++)
+    x.setEntry(random->nextInt(v.dimension()), 1.0);
+  Assert::assertObjectEquals(v.dot(&x), mapped->dot(&x));
+
+  // Copy-on-write: the updates are private to the process
+  mapped->addToSelf(1.0, &x);
+  delete mapped;
+  mapped = new MappedPVector<double>("visualization/mapped_vector.dat");
+  Assert::assertEquals<double>(&v, mapped);
+
+  // resurrect remaps the file with the same mode
+  mapped->resurrect("visualization/mapped_vector.dat");
+  Assert::assertObjectEquals(mapped->dimension(), v.dimension());
+  Assert::assertPasses(mapped->verify());
+  delete mapped;
+  delete random;
+}
+
+void MappedVectorTest::testSharedMapping()
+{
+  PVector<float> v(1000);
+  for (int i = 0; i < v.dimension(); i++)
+    v.setEntry(i, 0.5f);
+  Assert::assertPasses(MappedPVector<float>::persist("visualization/mapped_shared.dat", &v));
+
+  MappedPVector<float>* learner = new MappedPVector<float>("visualization/mapped_shared.dat",
+      MappedPVector<float>::SHARED);
+  MappedPVector<float>* reader = new MappedPVector<float>("visualization/mapped_shared.dat");
+  SVector<float> x(v.dimension());
+  x.setEntry(3, 2.0f);
+  x.setEntry(999, 1.0f);
+  learner->addToSelf(0.5f, &x);
+  // A shared mapping is visible to the other mappings of the same file
+  Assert::assertObjectEquals(reader->getEntry(3), 1.5f);
+  Assert::assertObjectEquals(reader->getEntry(999), 1.0f);
+  Assert::assertFails(learner->verify());
+  learner->sync();
+  Assert::assertPasses(learner->verify());
+  delete learner;
+  delete reader;
+
+  MappedPVector<float> mapped("visualization/mapped_shared.dat");
+  Assert::assertPasses(mapped.verify());
+  Assert::assertObjectEquals(mapped.getEntry(3), 1.5f);
+  Assert::assertObjectEquals(mapped.getEntry(0), 0.5f);
+}
+
+void MappedVectorTest::testCreate()
+{
+  const int dimension = 1 << 22;
+  Assert::assertPasses(MappedPVector<double>::create("visualization/mapped_create.dat", dimension));
+  Timer timer;
+  timer.start();
+  MappedPVector<double> mapped("visualization/mapped_create.dat", MappedPVector<double>::SHARED);
+  timer.stop();
+  cout << "mapped " << dimension << " entries in " << timer.getElapsedTimeInMilliSec() << "ms"
+      << endl;
+  Assert::assertObjectEquals(mapped.dimension(), dimension);
+  mapped.setEntry(dimension - 1, 3.0);
+  Assert::assertObjectEquals(mapped.getEntry(dimension - 1), 3.0);
+  Assert::assertObjectEquals(mapped.getEntry(dimension / 2), 0.0);
+  mapped.sync();
+  Assert::assertPasses(mapped.verify());
+}
+
+void MappedVectorTest::testResurrectBulk()
+{
+  PVector<double> v(1000);
+  for (int i = 0; i < v.dimension(); i++)
+    v.setEntry(i, i * 0.5);
+  v.persist("visualization/mapped_pvector.dat");
+  PVector<double> w(10);
+  w.resurrect("visualization/mapped_pvector.dat");
+  Assert::assertEquals(&v, &w);
+  w.resurrect("visualization/mapped_pvector.dat");
+  Assert::assertEquals(&v, &w);
+}
+
+void MappedVectorTest::testCorruptedHeader()
+{
+  PVector<double> v(1000);
+  Assert::assertPasses(MappedPVector<double>::persist("visualization/mapped_vector.dat", &v));
+  std::ifstream ifs("visualization/mapped_vector.dat", std::ifstream::in | std::ifstream::binary);
+  std::vector<char> file((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  MappedVectorHeader* h = reinterpret_cast<MappedVectorHeader*>(&file[0]);
+  Assert::assertPasses(MappedPVector<double>::isValid(h, file.size()));
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size() - 8));
+
+  const MappedVectorHeader header = *h;
+  h->dimension = -1;
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size()));
+  // Would wrap around to a small size in bytes
+  *h = header;
+  h->dimension = (int64_t(1) << 61) + 1;
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size()));
+  *h = header;
+  h->dataOffset = uint64_t(-8);
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size()));
+  *h = header;
+  h->dataOffset = sizeof(MappedVectorHeader) - 8;
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size()));
+  *h = header;
+  h->dataOffset += 4;
+  h->dimension -= 1;
+  Assert::assertPasses(!MappedPVector<double>::isValid(h, file.size()));
+  *h = header;
+  Assert::assertPasses(MappedPVector<double>::isValid(h, file.size()));
+}
+
+void MappedVectorTest::run()
+{
+  testReadOnlyMapping();
+  testSharedMapping();
+  testCreate();
+  testResurrectBulk();
+  testCorruptedHeader();
+}
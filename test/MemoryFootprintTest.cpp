@@ -0,0 +1,164 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * MemoryFootprintTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "MemoryFootprintTest.h"
+
+RLLIB_TEST_MAKE(MemoryFootprintTest)
+
+void MemoryFootprintTest::testVectors()
+{
+  PVector<double> dense(100);
+  MemoryFootprint footprint;
+  dense.memoryFootprint(&footprint, "dense");
+  Assert::assertObjectEquals(size_t(100 * sizeof(double)), footprint.allocatedBytes());
+  Assert::assertObjectEquals(size_t(100 * sizeof(double)), footprint.liveBytes());
+
+  // The active entries of a sparse vector are live, the rest of its capacity is not
+  SVector<double> sparse(1000);
+  for (int i = 0; i < 10; i++)
+    sparse.setEntry(i * 7, 1.0);
+  footprint.clear();
+  sparse.memoryFootprint(&footprint, "sparse");
+  const MemoryFootprint* node = footprint.find("sparse");
+  Assert::assertPasses(node != 0);
+  Assert::assertObjectEquals(1, node->nbChildren());
+  const MemoryFootprint* indexesPosition = footprint.find("sparse/indexesPosition");
+  Assert::assertPasses(indexesPosition != 0);
+  Assert::assertObjectEquals(size_t(1000 * sizeof(int)), indexesPosition->allocatedBytes());
+  const size_t live = node->liveBytes() - indexesPosition->liveBytes();
+  Assert::assertObjectEquals(size_t(10 * (sizeof(int) + sizeof(double))), live);
+  Assert::assertPasses(node->allocatedBytes() >= node->liveBytes());
+  Assert::assertPasses(footprint.find("sparse/missing") == 0);
+  Assert::assertPasses(footprint.find("missing") == 0);
+
+  // The vectors handed out since releaseAll() are live
+  VectorPool<double> pool(100);
+  pool.newVector(&dense);
+  pool.newVector(&dense);
+  pool.releaseAll();
+  pool.newVector(&dense);
+  footprint.clear();
+  pool.memoryFootprint(&footprint, "pool");
+  Assert::assertPasses(footprint.allocatedBytes() >= 2 * 100 * sizeof(double));
+  Assert::assertPasses(footprint.liveBytes() < 2 * 100 * sizeof(double));
+  Assert::assertPasses(footprint.liveBytes() >= 100 * sizeof(double));
+}
+
+void MemoryFootprintTest::testSharedComponents()
+{
+  // The projector is shared by the StateToStateAction<T> and by the learner: counted once
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 10000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(),
+      10, 10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+
+  MemoryFootprint footprint;
+  projector->memoryFootprint(&footprint, "projector");
+  const size_t projectorBytes = footprint.allocatedBytes();
+  Assert::assertPasses(projectorBytes > 0);
+  toStateAction->memoryFootprint(&footprint, "toStateAction");
+  Assert::assertPasses(footprint.find("toStateAction/projector") == 0);
+  Assert::assertObjectEquals(2, footprint.nbChildren());
+
+  footprint.clear();
+  toStateAction->memoryFootprint(&footprint, "toStateAction");
+  Assert::assertPasses(footprint.find("toStateAction/projector") != 0);
+  Assert::assertObjectEquals(projectorBytes,
+      footprint.find("toStateAction/projector")->allocatedBytes());
+  projector->memoryFootprint(&footprint, "projector");
+  Assert::assertObjectEquals(1, footprint.nbChildren());
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+}
+
+void MemoryFootprintTest::testAgentFootprint()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  Hashing<double>* hashing = new MurmurHashing<double>(random, 10000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10,
+      10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+  Trace<double>* e = new RTrace<double>(projector->dimension());
+  Sarsa<double>* sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa,
+      0.01);
+  OnPolicyControlLearner<double>* control = new SarsaControl<double>(acting, toStateAction,
+      sarsa);
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* runner = new RLRunner<double>(agent, problem, 5000, 5, 1);
+  runner->setVerbose(false);
+
+  MemoryFootprint start;
+  agent->memoryFootprint(&start, "agent");
+  std::cout << std::endl;
+  start.print(std::cout);
+  Assert::assertPasses(start.find("agent/control/sarsa/q") != 0);
+  Assert::assertPasses(start.find("agent/control/sarsa/e") != 0);
+  Assert::assertPasses(start.find("agent/control/acting") != 0);
+  Assert::assertPasses(start.find("agent/control/toStateAction/projector") != 0);
+  // The weights are dense: all live
+  const MemoryFootprint* q = start.find("agent/control/sarsa/q");
+  Assert::assertObjectEquals(size_t(projector->dimension() * sizeof(double)),
+      q->allocatedBytes());
+  Assert::assertObjectEquals(q->allocatedBytes(), q->liveBytes());
+
+  runner->runEpisodes();
+
+  MemoryFootprint end;
+  agent->memoryFootprint(&end, "agent");
+  end.print(std::cout, 3);
+  // The trace grows during the episodes
+  Assert::assertPasses(
+      end.find("agent/control/sarsa/e")->liveBytes()
+          > start.find("agent/control/sarsa/e")->liveBytes());
+  Assert::assertPasses(end.allocatedBytes() > start.allocatedBytes());
+  Assert::assertPasses(end.allocatedBytes() >= end.liveBytes());
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete runner;
+}
+
+void MemoryFootprintTest::run()
+{
+  testVectors();
+  testSharedComponents();
+  testAgentFootprint();
+}
@@ -9,6 +9,7 @@
 
 #define NAO_TRAIN "train"
 #define NAO_TEST  "test"
+#define NAO_REALTIME "realtime"
 
 RLLIB_TEST_MAKE(NAOTest)
 NAOTest::NAOTest()
@@ -29,6 +30,10 @@ void NAOTest::run()
   {
     testEvaluate();
   }
+  else if (argv[1] == NAO_REALTIME)
+  {
+    testRealTime();
+  }
   else
   {
     std::cout << "Nothing ..." << std::endl;
@@ -257,3 +262,61 @@ void NAOTest::testEvaluate()
     delete sim;
   }
 }
+
+void NAOTest::testRealTime()
+{
+  // The offline learner on the 10ms cycle of the NAO
+  Random<float>* random = new Random<float>;
+  RLProblem<float>* problem = new MountainCar<float>(random);
+  Hashing<float>* hashing = new MurmurHashing<float>(random, 1000000);
+  Projector<float>* projector = new TileCoderHashing<float>(hashing, problem->dimension(), 10, 10);
+  StateToStateAction<float>* toStateAction = new StateActionTilings<float>(projector,
+      problem->getDiscreteActions());
+
+  double alpha_v = 0.05 / projector->vectorNorm();
+  double alpha_w = 0.0001 / projector->vectorNorm();
+  double lambda = 0.0;
+  double gamma = 0.99;
+  Trace<float>* critice = new ATrace<float>(projector->dimension());
+  OffPolicyTD<float>* critic = new GTDLambda<float>(alpha_v, alpha_w, gamma, lambda, critice);
+  double alpha_u = 1.0 / projector->vectorNorm();
+  PolicyDistribution<float>* target = new BoltzmannDistribution<float>(random,
+      problem->getDiscreteActions(), projector->dimension());
+
+  Trace<float>* actore = new ATrace<float>(projector->dimension());
+  Traces<float>* actoreTraces = new Traces<float>();
+  actoreTraces->push_back(actore);
+  ActorOffPolicy<float>* actor = new ActorLambdaOffPolicy<float>(alpha_u, gamma, lambda, target,
+      actoreTraces);
+
+  Policy<float>* behavior = new RandomPolicy<float>(random, problem->getDiscreteActions());
+
+  OffPolicyControlLearner<float>* control = new OffPAC<float>(behavior, critic, actor,
+      toStateAction, projector);
+
+  RLAgent<float>* agent = new LearnerAgent<float>(control);
+  RealTimeRunner<float>* sim = new RealTimeRunner<float>(agent, problem, 1000, 10000, 2);
+  sim->setVerbose(false);
+  sim->setCpu(0);
+  sim->setPriority(80);
+  sim->initializeRealTime();
+  sim->runRealTime();
+  sim->printReport(std::cout);
+  sim->releaseRealTime();
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete critice;
+  delete critic;
+  delete actore;
+  delete actoreTraces;
+  delete actor;
+  delete behavior;
+  delete target;
+  delete control;
+  delete agent;
+  delete sim;
+}
@@ -9,6 +9,7 @@
 #define NAOTEST_H_
 
 #include "Test.h"
+#include "RealTimeRunner.h"
 
 RLLIB_TEST(NAOTest)
 class NAOTest: public NAOTestBase
@@ -21,6 +22,7 @@ class NAOTest: public NAOTestBase
   protected:
     void testTrain();
     void testEvaluate();
+    void testRealTime();
 };
 
 #endif /* NAOTEST_H_ */
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * PipelinedLearnerAgentTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <thread>
+#include <chrono>
+#include "PipelinedLearnerAgentTest.h"
+
+RLLIB_TEST_MAKE(PipelinedLearnerAgentTest)
+
+// A control on MountainCar; the learners with the same seed are identical
+class PipelinedLearner
+{
+  public:
+    Random<double>* random;
+    RLProblem<double>* problem;
+    Hashing<double>* hashing;
+    Projector<double>* projector;
+    StateToStateAction<double>* toStateAction;
+    Trace<double>* e;
+    Sarsa<double>* sarsa;
+    GQ<double>* gq;
+    Policy<double>* acting;
+    Policy<double>* target;
+    Control<double>* control;
+
+    PipelinedLearner(const uint32_t& seed, const bool& offPolicy, const double& lambda = 0.3) :
+        random(new Random<double>), sarsa(0), gq(0), target(0)
+    {
+      random->reseed(seed);
+      problem = new MountainCar<double>(random);
+      hashing = new MurmurHashing<double>(random, 10000);
+      projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true);
+      toStateAction = new StateActionTilings<double>(projector, problem->getDiscreteActions());
+      e = new RTrace<double>(projector->dimension());
+      if (offPolicy)
+      {
+        gq = new GQ<double>(0.1 / projector->vectorNorm(), 0.0001 / projector->vectorNorm(), 0.99,
+            lambda, e);
+        acting = new RandomPolicy<double>(random, problem->getDiscreteActions());
+        target = new Greedy<double>(problem->getDiscreteActions(), gq);
+        control = new GreedyGQ<double>(target, acting, problem->getDiscreteActions(),
+            toStateAction, gq);
+      }
+      else
+      {
+        sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, lambda, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+        control = new SarsaControl<double>(acting, toStateAction, sarsa);
+      }
+    }
+
+    ~PipelinedLearner()
+    {
+      delete random;
+      delete problem;
+      delete hashing;
+      delete projector;
+      delete toStateAction;
+      delete e;
+      delete sarsa;
+      delete gq;
+      delete acting;
+      delete target;
+      delete control;
+    }
+
+    const Vector<double>* weights() const
+    {
+      return sarsa ? sarsa->weights() : gq->weights();
+    }
+
+    // Steps agent through nbSteps time steps; wait runs while the problem computes
+    void run(RLAgent<double>* agent, const int& nbSteps, void (*wait)(RLAgent<double>*),
+        std::vector<double>* latencies = 0)
+    {
+      Timer timer;
+      problem->initialize();
+      problem->updateTuple();
+      const Action<double>* a = agent->initialize(problem->getTRStep());
+      for (int t = 0; t < nbSteps; t++)
+      {
+        problem->step(a);
+        wait(agent);
+        problem->updateTuple();
+        timer.start();
+        a = agent->getAtp1(problem->getTRStep());
+        timer.stop();
+        if (latencies)
+          latencies->push_back(timer.getElapsedTimeInMicroSec());
+        if (problem->getTRStep()->endOfEpisode)
+        {
+          problem->initialize();
+          problem->updateTuple();
+          a = agent->initialize(problem->getTRStep());
+        }
+      }
+      agent->flush();
+    }
+};
+
+static void flushNow(RLAgent<double>* agent)
+{
+  agent->flush();
+}
+
+// An external problem that answers after 200us
+static void waitExternal(RLAgent<double>* agent)
+{
+  (void) agent;
+  std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+static void flushAndWaitExternal(RLAgent<double>* agent)
+{
+  agent->flush();
+  waitExternal(agent);
+}
+
+static double percentile(std::vector<double> values, const double& p)
+{
+  std::vector<double>::iterator nth = values.begin() + size_t(p * (values.size() - 1));
+  std::nth_element(values.begin(), nth, values.end());
+  return *nth;
+}
+
+void PipelinedLearnerAgentTest::testFlushedEquivalence()
+{
+  // Flushed while the problem computes, the pipelined agent learns exactly as a LearnerAgent:
+  // Sarsa samples before it learns, and the random behavior of GreedyGQ ignores the weights
+  for (int offPolicy = 0; offPolicy < 2; offPolicy++)
+  {
+    PipelinedLearner learner(1, offPolicy), pipelined(1, offPolicy);
+    RLAgent<double>* learnerAgent = new LearnerAgent<double>(learner.control);
+    RLAgent<double>* pipelinedAgent = new PipelinedLearnerAgent<double>(pipelined.control);
+    learner.run(learnerAgent, 3000, flushNow);
+    pipelined.run(pipelinedAgent, 3000, flushNow);
+    Assert::assertPasses(learner.weights()->sum() != 0);
+    Assert::assertObjectEquals(learner.weights()->sum(), pipelined.weights()->sum());
+    delete learnerAgent;
+    delete pipelinedAgent;
+  }
+}
+
+void PipelinedLearnerAgentTest::testThreadedLearning()
+{
+  // Sarsa samples before it learns: on the learner thread, it learns exactly as a LearnerAgent
+  PipelinedLearner learner(1, false), pipelined(1, false);
+  RLAgent<double>* learnerAgent = new LearnerAgent<double>(learner.control);
+  RLAgent<double>* pipelinedAgent = new PipelinedLearnerAgent<double>(pipelined.control, true);
+  RLRunner<double>* learnerRunner = new RLRunner<double>(learnerAgent, learner.problem, 5000, 100,
+      1);
+  RLRunner<double>* pipelinedRunner = new RLRunner<double>(pipelinedAgent, pipelined.problem,
+      5000, 100, 1);
+  learnerRunner->setVerbose(false);
+  pipelinedRunner->setVerbose(false);
+  learnerRunner->runEpisodes();
+  pipelinedRunner->runEpisodes();
+  pipelinedAgent->flush();
+  Assert::assertObjectEquals(learner.weights()->sum(), pipelined.weights()->sum());
+  Assert::assertPasses(learnerRunner->timeStep == pipelinedRunner->timeStep);
+  delete learnerRunner;
+  delete pipelinedRunner;
+  delete learnerAgent;
+  delete pipelinedAgent;
+}
+
+void PipelinedLearnerAgentTest::testActionLatency()
+{
+  // With long traces the update dominates the step; the pipelined agents only pay for the
+  // action, the update runs while the problem computes
+  const int nbSteps = 3000;
+  std::vector<double> learnerLatencies, deferredLatencies, threadedLatencies;
+  PipelinedLearner learner(1, false, 0.99), deferred(1, false, 0.99), threaded(1, false, 0.99);
+  RLAgent<double>* learnerAgent = new LearnerAgent<double>(learner.control);
+  RLAgent<double>* deferredAgent = new PipelinedLearnerAgent<double>(deferred.control);
+  RLAgent<double>* threadedAgent = new PipelinedLearnerAgent<double>(threaded.control, true);
+  learner.run(learnerAgent, nbSteps, waitExternal, &learnerLatencies);
+  deferred.run(deferredAgent, nbSteps, flushAndWaitExternal, &deferredLatencies);
+  threaded.run(threadedAgent, nbSteps, waitExternal, &threadedLatencies);
+
+  const double learnerP99 = percentile(learnerLatencies, 0.99);
+  const double deferredP99 = percentile(deferredLatencies, 0.99);
+  const double threadedP99 = percentile(threadedLatencies, 0.99);
+  std::cout << "p50/p99(us) learner=" << percentile(learnerLatencies, 0.5) << "/" << learnerP99
+      << " deferred=" << percentile(deferredLatencies, 0.5) << "/" << deferredP99
+      << " threaded=" << percentile(threadedLatencies, 0.5) << "/" << threadedP99 << std::endl;
+  Assert::assertPasses(deferredP99 < learnerP99);
+  // On one core, waking up the learner thread preempts the agent
+  if (std::thread::hardware_concurrency() > 1)
+    Assert::assertPasses(threadedP99 < learnerP99);
+  delete learnerAgent;
+  delete deferredAgent;
+  delete threadedAgent;
+}
+
+void PipelinedLearnerAgentTest::run()
+{
+  testFlushedEquivalence();
+  testThreadedLearning();
+  testActionLatency();
+}
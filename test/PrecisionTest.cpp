@@ -0,0 +1,208 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * PrecisionTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "PrecisionTest.h"
+
+// Every member of the library compiles with single precision
+namespace RLLib
+{
+  template class DenseVector<float> ;
+  template class SparseVector<float> ;
+  template class PVector<float> ;
+  template class SVector<float> ;
+  template class Vectors<float> ;
+  template class VectorPool<float> ;
+  template class ATrace<float> ;
+  template class RTrace<float> ;
+  template class AMaxTrace<float> ;
+  template class MaxLengthTrace<float> ;
+  template class Traces<float> ;
+  template class Random<float> ;
+  template class Ranges<float> ;
+  template class TileCoderHashing<float> ;
+  template class Tiles<float> ;
+  template class UNH<float> ;
+  template class MurmurHashing<float> ;
+  template class Representations<float> ;
+  template class StateActionTilings<float> ;
+  template class TabularAction<float> ;
+  template class ActionArray<float> ;
+  template class NormalDistribution<float> ;
+  template class NormalDistributionScaled<float> ;
+  template class NormalDistributionSkewed<float> ;
+  template class ScaledPolicyDistribution<float> ;
+  template class BoltzmannDistribution<float> ;
+  template class SoftMax<float> ;
+  template class RandomPolicy<float> ;
+  template class RandomBiasPolicy<float> ;
+  template class Greedy<float> ;
+  template class EpsilonGreedy<float> ;
+  template class BoltzmannDistributionPerturbed<float> ;
+  template class SingleActionPolicy<float> ;
+  template class ConstantPolicy<float> ;
+  template class TD<float> ;
+  template class TDLambda<float> ;
+  template class TDLambdaTrue<float> ;
+  template class TDLambdaAlphaBound<float> ;
+  template class Sarsa<float> ;
+  template class SarsaTrue<float> ;
+  template class SarsaAlphaBound<float> ;
+  template class GQ<float> ;
+  template class GTDLambda<float> ;
+  template class GTDLambdaTrue<float> ;
+  template class SarsaControl<float> ;
+  template class ExpectedSarsaControl<float> ;
+  template class Q<float> ;
+  template class QControl<float> ;
+  template class GreedyGQ<float> ;
+  template class GQOnPolicyControl<float> ;
+  template class ActorLambdaOffPolicy<float> ;
+  template class OffPAC<float> ;
+  template class Actor<float> ;
+  template class ActorLambda<float> ;
+  template class ActorNatural<float> ;
+  template class ActorCritic<float> ;
+  template class AverageRewardActorCritic<float> ;
+  template class Adaline<float> ;
+  template class IDBD<float> ;
+  template class SemiLinearIDBD<float> ;
+  template class K1<float> ;
+  template class Autostep<float> ;
+  template class FourierBasis<float> ;
+  template class LearnerAgent<float> ;
+  template class ControlAgent<float> ;
+  template class RLRunner<float> ;
+}
+
+template class RK4<float> ;
+
+RLLIB_TEST_MAKE(PrecisionTest)
+
+void PrecisionTest::testDotProductAccumulation()
+{
+  Random<double>* random = new Random<double>;
+  const int dimension = 100000;
+  PVector<float> wf(dimension);
+  PVector<double> wd(dimension);
+  SVector<float> xf(dimension);
+  SVector<double> xd(dimension);
+  PVector<float> xdf(dimension); // the same features, in a dense vector
+  for (int i = 0; i < dimension; i++)
+  {
+    const float w = float(random->nextGaussian(0.0, 1.0));
+    wf.setEntry(i, w);
+    wd.setEntry(i, w);
+    if (i % 3 == 0)
+    {
+      const float x = float(random->nextReal());
+      xf.setEntry(i, x);
+      xd.setEntry(i, x);
+      xdf.setEntry(i, x);
+    }
+  }
+  const double expected = wd.dot(&xd);
+  const double sparseError = std::fabs(wf.dot(&xf) - expected);
+  const double denseError = std::fabs(wf.dot(&xdf) - expected);
+  cout << "mixedPrecision=" << (sizeof(Accumulator<float>::type) == sizeof(double))
+      << " |float-double| sparse=" << sparseError << " dense=" << denseError << endl;
+  // sqrt(n) * eps * sum|w_i x_i| is a loose bound on the float accumulation error
+  const double bound = std::sqrt(double(xf.nonZeroElements()))
+      * std::numeric_limits<float>::epsilon() * wd.l1Norm();
+  Assert::assertPasses(sparseError < bound);
+  Assert::assertPasses(denseError < bound);
+  delete random;
+}
+
+void PrecisionTest::testTDError()
+{
+  Assert::assertObjectEquals(TDError<float>::compute(1.0f, 0.5f, 4.0f, 2.0f), 1.0f);
+  Assert::assertObjectEquals(TDError<double>::compute(1.0, 0.5, 4.0, 2.0, 2.0), 2.0);
+}
+
+template<class T>
+double PrecisionTest::runSarsaMountainCar(std::vector<int>* lengths)
+{
+  Random<T>* random = new Random<T>;
+  RLProblem<T>* problem = new MountainCar<T>(random);
+  Hashing<T>* hashing = new MurmurHashing<T>(random, 10000);
+  Projector<T>* projector = new TileCoderHashing<T>(hashing, problem->dimension(), 10, 10, true);
+  StateToStateAction<T>* toStateAction = new StateActionTilings<T>(projector,
+      problem->getDiscreteActions());
+  Trace<T>* e = new RTrace<T>(projector->dimension());
+  Sarsa<T>* sarsa = new Sarsa<T>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<T>* acting = new EpsilonGreedy<T>(random, problem->getDiscreteActions(), sarsa, 0.01);
+  OnPolicyControlLearner<T>* control = new SarsaControl<T>(acting, toStateAction, sarsa);
+  RLAgent<T>* agent = new LearnerAgent<T>(control);
+  RLRunner<T>* sim = new RLRunner<T>(agent, problem, 5000, 100, 1);
+  EpisodeLengths<T> event(lengths);
+  sim->onEpisodeEnd.push_back(&event);
+  sim->setVerbose(false);
+
+  Timer timer;
+  timer.start();
+  sim->run();
+  timer.stop();
+  const double stepsPerSecond = std::accumulate(lengths->begin(), lengths->end(), 0)
+      / timer.getElapsedTimeInSec();
+
+  delete random;
+  delete problem;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete sim;
+  return stepsPerSecond;
+}
+
+void PrecisionTest::testSingleVsDoublePrecisionMountainCar()
+{
+  std::vector<int> floatLengths, doubleLengths;
+  const double floatThroughput = runSarsaMountainCar<float>(&floatLengths);
+  const double doubleThroughput = runSarsaMountainCar<double>(&doubleLengths);
+  cout << "steps/s float=" << floatThroughput << " double=" << doubleThroughput << endl;
+
+  // Learning curves: average episode length over blocks of 10 episodes
+  const int block = 10;
+  double floatLast = 0, doubleLast = 0;
+  for (size_t i = 0; i + block <= floatLengths.size(); i += block)
+  {
+    floatLast = std::accumulate(floatLengths.begin() + i, floatLengths.begin() + i + block, 0)
+        / double(block);
+    doubleLast = std::accumulate(doubleLengths.begin() + i, doubleLengths.begin() + i + block, 0)
+        / double(block);
+    cout << "episodes[" << i << "," << (i + block) << ") float=" << floatLast << " double="
+        << doubleLast << endl;
+  }
+  Assert::assertPasses(floatLast < 500);
+  Assert::assertPasses(doubleLast < 500);
+}
+
+void PrecisionTest::run()
+{
+  testDotProductAccumulation();
+  testTDError();
+  testSingleVsDoublePrecisionMountainCar();
+}
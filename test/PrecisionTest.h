@@ -0,0 +1,68 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * PrecisionTest.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef PRECISIONTEST_H_
+#define PRECISIONTEST_H_
+
+#include "Test.h"
+#include "util/RK4.h"
+
+RLLIB_TEST(PrecisionTest)
+
+class PrecisionTest: public PrecisionTestBase
+{
+  public:
+    PrecisionTest()
+    {
+    }
+
+    virtual ~PrecisionTest()
+    {
+    }
+    void run();
+
+  private:
+    template<class T>
+    class EpisodeLengths: public RLRunner<T>::Event
+    {
+      public:
+        std::vector<int>* lengths;
+
+        EpisodeLengths(std::vector<int>* lengths) :
+            lengths(lengths)
+        {
+        }
+
+        void update() const
+        {
+          lengths->push_back(RLRunner<T>::Event::nbTotalTimeSteps);
+        }
+    };
+
+    template<class T>
+    double runSarsaMountainCar(std::vector<int>* lengths);
+
+    void testDotProductAccumulation();
+    void testTDError();
+    void testSingleVsDoublePrecisionMountainCar();
+};
+
+#endif /* PRECISIONTEST_H_ */
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QuantizedVectorTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "QuantizedVectorTest.h"
+
+RLLIB_TEST_MAKE(QuantizedVectorTest)
+
+void QuantizedVectorTest::testHalfPrecision()
+{
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(1.0f), 0x3c00);
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(-2.0f), 0xc000);
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(65504.0f), 0x7bff);
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(1e6f), 0x7c00);
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(5.9604645e-8f), 0x0001);
+  Assert::assertObjectEquals(HalfPrecision::floatToHalf(1e-10f), 0x0000);
+  Assert::assertObjectEquals(HalfPrecision::halfToFloat(0x3555), 0.333251953125f);
+  Assert::assertObjectEquals(HalfPrecision::floatToBFloat16(1.0f), 0x3f80);
+  Assert::assertObjectEquals(HalfPrecision::bfloat16ToFloat(0xc040), -3.0f);
+  // Every finite half survives a round trip through float
+  for (int h = 0; h < 0x10000; h++)
+  {
+    if ((h & 0x7c00) == 0x7c00)
+      continue;
+    Assert::assertObjectEquals(HalfPrecision::floatToHalf(HalfPrecision::halfToFloat(h)), h);
+  }
+}
+
+void QuantizedVectorTest::testQuantizedVector()
+{
+  Random<double>* random = new Random<double>;
+  PVector<double> v(1000);
+  for (int i = 0; i < v.dimension(); i++)
+    v.setEntry(i, random->nextGaussian(0.0, 1.0));
+  v.persist("visualization/quantized_pvector.dat");
+
+  SVector<double> s(v.dimension());
+  for (int i = 0; i < 50; i++)
+    s.setEntry(random->nextInt(v.dimension()), random->nextReal());
+
+  const double tolerances[] = { 1.0 / 127.0, 1.0 / 1024.0, 1.0 / 128.0 };
+  for (int type = QuantizedVector<double>::INT8_QUANTIZED;
+      type <= QuantizedVector<double>::BFLOAT16_QUANTIZED; type++)
+  {
+    QuantizedVector<double>::QuantizedType quantizedType = QuantizedVector<double>::QuantizedType(
+        type);
+    QuantizedVector<double>* q = Quantizer<double>::quantize(quantizedType, &v);
+    Quantizer<double>::convert("visualization/quantized_pvector.dat",
+        "visualization/quantized_vector.dat", quantizedType);
+    QuantizedVector<double>* r = Quantizer<double>::resurrect("visualization/quantized_vector.dat");
+    Assert::assertObjectEquals(r->getQuantizedType(), quantizedType);
+    Assert::assertObjectEquals(r->dimension(), v.dimension());
+    Assert::assertObjectEquals(r->sizeInBytes(), q->sizeInBytes());
+    for (int i = 0; i < v.dimension(); i++)
+    {
+      Assert::assertObjectEquals(r->getEntry(i), q->getEntry(i));
+      Assert::assertPasses(
+          std::fabs(q->getEntry(i) - v.getEntry(i))
+              <= tolerances[type] * std::max(v.maxNorm(), 1.0));
+    }
+    double sparseDot = 0;
+    for (int i = 0; i < v.dimension(); i++)
+      sparseDot += s.getEntry(i) * q->getEntry(i);
+    Assert::assertPasses(std::fabs(q->dot(&s) - sparseDot) < 1e-10);
+    // The predictor decodes the same weights
+    QuantizedPredictor<double> predictor(q);
+    const Vector<double>* decoded = predictor.weights();
+    Assert::assertObjectEquals(decoded->dimension(), v.dimension());
+    for (int i = 0; i < v.dimension(); i++)
+      Assert::assertObjectEquals(decoded->getEntry(i), q->getEntry(i));
+    Assert::assertPasses(predictor.weights() == decoded);
+    delete q;
+    delete r;
+  }
+  delete random;
+}
+
+void QuantizedVectorTest::testQuantizedAgent(const char* name, RLProblem<double>* problem,
+    Random<double>* random)
+{
+  Hashing<double>* hashing = new UNH<double>(random, 100000);
+  Projector<double>* projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10,
+      10, true);
+  StateToStateAction<double>* toStateAction = new StateActionTilings<double>(projector,
+      problem->getDiscreteActions());
+  Trace<double>* e = new RTrace<double>(projector->dimension());
+  Sarsa<double>* sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+  Policy<double>* acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa,
+      0.01);
+  OnPolicyControlLearner<double>* control = new SarsaControl<double>(acting, toStateAction, sarsa);
+  RLAgent<double>* agent = new LearnerAgent<double>(control);
+  RLRunner<double>* sim = new RLRunner<double>(agent, problem, 1000, 50, 1);
+  sim->setVerbose(false);
+  sim->run();
+  sarsa->weights()->persist("visualization/quantized_weights.dat");
+
+  // States visited by the full precision greedy policy
+  Policy<double>* greedy = new Greedy<double>(problem->getDiscreteActions(), sarsa);
+  std::vector<Vector<double>*> phis;
+  const int nbActions = problem->getDiscreteActions()->dimension();
+  problem->initialize();
+  problem->updateTuple();
+  for (int t = 0; t < 2000; t++)
+  {
+    const Representations<double>* phi = toStateAction->stateActions(problem->getTRStep()->o_tp1);
+    for (Actions<double>::const_iterator a = problem->getDiscreteActions()->begin();
+        a != problem->getDiscreteActions()->end(); ++a)
+      phis.push_back(phi->at(*a)->copy());
+    greedy->update(phi);
+    problem->step(greedy->sampleBestAction());
+    problem->updateTuple();
+    if (problem->getTRStep()->endOfEpisode)
+    {
+      problem->initialize();
+      problem->updateTuple();
+    }
+  }
+
+  const int nbRepeats = 50;
+  Timer timer;
+  double checksum = 0;
+  timer.start();
+  for (int k = 0; k < nbRepeats; k++)
+    for (std::vector<Vector<double>*>::const_iterator phi = phis.begin(); phi != phis.end(); ++phi)
+      checksum += sarsa->predict(*phi);
+  timer.stop();
+  const double fullTime = timer.getElapsedTimeInMicroSec() * 1000.0 / (nbRepeats * phis.size());
+  cout << name << " double size=" << sarsa->weights()->dimension() * sizeof(double)
+      << "B ns/lookup=" << fullTime << " (checksum=" << checksum << ")" << endl;
+
+  const char* names[] = { "int8", "fp16", "bf16" };
+  // The action picked must be within the tolerance of the type of the best one. bf16 only keeps 8
+  // significant bits, i.e., a step of 0.5 above |Q|=64, more than the gap between the MountainCar
+  // actions in most states, so that their exact order often swaps: its exact agreement is only
+  // reported, int8 and fp16 also have to pick the same action in most states.
+  const double tolerances[] = { 1.0 / 127.0, 1.0 / 1024.0, 1.0 / 128.0 };
+  for (int type = QuantizedVector<double>::INT8_QUANTIZED;
+      type <= QuantizedVector<double>::BFLOAT16_QUANTIZED; type++)
+  {
+    Quantizer<double>::convert("visualization/quantized_weights.dat",
+        "visualization/quantized_weights.q", QuantizedVector<double>::QuantizedType(type));
+    QuantizedVector<double>* q = Quantizer<double>::resurrect("visualization/quantized_weights.q");
+    QuantizedPredictor<double> predictor(q);
+
+    double maxError = 0, sumError = 0, maxQ = 0;
+    int agreements = 0, nearAgreements = 0;
+    for (size_t s = 0; s < phis.size(); s += nbActions)
+    {
+      int expected = 0, actual = 0;
+      for (int a = 0; a < nbActions; a++)
+      {
+        const double expectedQ = sarsa->predict(phis[s + a]);
+        const double actualQ = predictor.predict(phis[s + a]);
+        const double error = std::fabs(expectedQ - actualQ);
+        maxError = std::max(maxError, error);
+        maxQ = std::max(maxQ, std::fabs(expectedQ));
+        sumError += error;
+        if (expectedQ > sarsa->predict(phis[s + expected]))
+          expected = a;
+        if (actualQ > predictor.predict(phis[s + actual]))
+          actual = a;
+      }
+      if (expected == actual)
+        ++agreements;
+      if (sarsa->predict(phis[s + expected]) - sarsa->predict(phis[s + actual])
+          <= 2.0 * tolerances[type] * std::max(maxQ, 1.0))
+        ++nearAgreements;
+    }
+
+    checksum = 0;
+    timer.start();
+    for (int k = 0; k < nbRepeats; k++)
+      for (std::vector<Vector<double>*>::const_iterator phi = phis.begin(); phi != phis.end();
+          ++phi)
+        checksum += predictor.predict(*phi);
+    timer.stop();
+    const double quantizedTime = timer.getElapsedTimeInMicroSec() * 1000.0
+        / (nbRepeats * phis.size());
+
+    const double agreement = double(agreements) / (phis.size() / nbActions);
+    const double nearAgreement = double(nearAgreements) / (phis.size() / nbActions);
+    cout << name << " " << names[type] << " size=" << q->sizeInBytes() << "B maxErr=" << maxError
+        << " meanErr=" << sumError / phis.size() << " max|Q|=" << maxQ << " agreement="
+        << agreement << " nearAgreement=" << nearAgreement << " ns/lookup=" << quantizedTime
+        << " (checksum=" << checksum << ")" << endl;
+    Assert::assertPasses(maxError <= tolerances[type] * std::max(maxQ, 1.0));
+    Assert::assertPasses(nearAgreement >= 0.99);
+    if (type != QuantizedVector<double>::BFLOAT16_QUANTIZED)
+      Assert::assertPasses(agreement >= 0.95);
+    delete q;
+  }
+
+  for (std::vector<Vector<double>*>::iterator phi = phis.begin(); phi != phis.end(); ++phi)
+    delete *phi;
+  delete hashing;
+  delete projector;
+  delete toStateAction;
+  delete e;
+  delete sarsa;
+  delete acting;
+  delete control;
+  delete agent;
+  delete sim;
+  delete greedy;
+}
+
+void QuantizedVectorTest::testQuantizedMountainCar()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new MountainCar<double>(random);
+  testQuantizedAgent("MountainCar", problem, random);
+  delete problem;
+  delete random;
+}
+
+void QuantizedVectorTest::testQuantizedAcrobot()
+{
+  Random<double>* random = new Random<double>;
+  RLProblem<double>* problem = new Acrobot(random);
+  testQuantizedAgent("Acrobot", problem, random);
+  delete problem;
+  delete random;
+}
+
+void QuantizedVectorTest::run()
+{
+  testHalfPrecision();
+  testQuantizedVector();
+  testQuantizedMountainCar();
+  testQuantizedAcrobot();
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * QuantizedVectorTest.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#ifndef QUANTIZEDVECTORTEST_H_
+#define QUANTIZEDVECTORTEST_H_
+
+#include "Test.h"
+#include "Acrobot.h"
+#include "QuantizedVector.h"
+
+RLLIB_TEST(QuantizedVectorTest)
+
+class QuantizedVectorTest: public QuantizedVectorTestBase
+{
+  public:
+    QuantizedVectorTest()
+    {
+    }
+
+    virtual ~QuantizedVectorTest()
+    {
+    }
+    void run();
+
+  private:
+    void testHalfPrecision();
+    void testQuantizedVector();
+    void testQuantizedAgent(const char* name, RLProblem<double>* problem, Random<double>* random);
+    void testQuantizedMountainCar();
+    void testQuantizedAcrobot();
+};
+
+#endif /* QUANTIZEDVECTORTEST_H_ */
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * RLRunnerSchedulerTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "RLRunnerSchedulerTest.h"
+
+RLLIB_TEST_MAKE(RLRunnerSchedulerTest)
+
+/**
+ * MountainCar behind an external environment: the observation that follows
+ * initialize() or step(..) arrives after a random number of polls, or after
+ * a latency in microseconds.
+ */
+class ExternalMountainCar: public MountainCar<double>
+{
+  protected:
+    Random<double>* delays;
+    int maxDelay;
+    int polls;
+    double latency;
+    Timer timer;
+
+  public:
+    ExternalMountainCar(Random<double>* random, const int& maxDelay, const double& latency = 0) :
+        MountainCar<double>(random), delays(new Random<double>), maxDelay(maxDelay), polls(0), //
+        latency(latency)
+    {
+    }
+
+    virtual ~ExternalMountainCar()
+    {
+      delete delays;
+    }
+
+    void initialize()
+    {
+      MountainCar<double>::initialize();
+      request();
+    }
+
+    void step(const Action<double>* a)
+    {
+      MountainCar<double>::step(a);
+      request();
+    }
+
+    bool ready()
+    {
+      if (latency > 0)
+      {
+        timer.stop();
+        return timer.getElapsedTimeInMicroSec() >= latency;
+      }
+      return polls-- <= 0;
+    }
+
+  private:
+    void request()
+    {
+      polls = maxDelay ? delays->nextInt(maxDelay + 1) : 0;
+      timer.start();
+    }
+};
+
+// Sarsa on an ExternalMountainCar; the pairs with the same seed are identical
+class SarsaPair
+{
+  public:
+    Random<double>* random;
+    RLProblem<double>* problem;
+    Hashing<double>* hashing;
+    Projector<double>* projector;
+    StateToStateAction<double>* toStateAction;
+    Trace<double>* e;
+    Sarsa<double>* sarsa;
+    Policy<double>* acting;
+    OnPolicyControlLearner<double>* control;
+    RLAgent<double>* agent;
+    RLRunner<double>* runner;
+
+    SarsaPair(const uint32_t& seed, const int& maxDelay, const double& latency,
+        const int& maxEpisodeTimeSteps, const int& nbEpisodes) :
+        random(new Random<double>)
+    {
+      random->reseed(seed);
+      problem = new ExternalMountainCar(random, maxDelay, latency);
+      hashing = new MurmurHashing<double>(random, 10000);
+      projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true);
+      toStateAction = new StateActionTilings<double>(projector, problem->getDiscreteActions());
+      e = new RTrace<double>(projector->dimension());
+      sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+      acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+      control = new SarsaControl<double>(acting, toStateAction, sarsa);
+      agent = new LearnerAgent<double>(control);
+      runner = new RLRunner<double>(agent, problem, maxEpisodeTimeSteps, nbEpisodes, 1);
+      runner->setVerbose(false);
+    }
+
+    ~SarsaPair()
+    {
+      delete random;
+      delete problem;
+      delete hashing;
+      delete projector;
+      delete toStateAction;
+      delete e;
+      delete sarsa;
+      delete acting;
+      delete control;
+      delete agent;
+      delete runner;
+    }
+};
+
+void RLRunnerSchedulerTest::testInterleavedEquivalence()
+{
+  // The scheduled pairs learn exactly as the same pairs run one after the other
+  const int nbPairs = 16;
+  std::vector<SarsaPair*> sequential, scheduled;
+  RLRunnerScheduler<double> scheduler;
+  for (int i = 0; i < nbPairs; i++)
+  {
+    sequential.push_back(new SarsaPair(i + 1, 0, 0, 300, 3));
+    scheduled.push_back(new SarsaPair(i + 1, 5, 0, 300, 3));
+    scheduler.add(scheduled.back()->runner);
+  }
+  for (int i = 0; i < nbPairs; i++)
+    sequential[i]->runner->runEpisodes();
+  scheduler.run();
+
+  for (int i = 0; i < nbPairs; i++)
+  {
+    Assert::assertPasses(!scheduled[i]->runner->isRunning());
+    Assert::assertObjectEquals(sequential[i]->sarsa->weights()->sum(),
+        scheduled[i]->sarsa->weights()->sum());
+    Assert::assertPasses(sequential[i]->runner->timeStep == scheduled[i]->runner->timeStep);
+    delete sequential[i];
+    delete scheduled[i];
+  }
+}
+
+void RLRunnerSchedulerTest::testExternalLatency()
+{
+  // The pairs wait 1ms for each observation: one thread overlaps the waits
+  const int nbPairs = 32, nbSteps = 20;
+  const double latency = 1000;
+  std::vector<SarsaPair*> blocking, scheduled;
+  RLRunnerScheduler<double> scheduler;
+  for (int i = 0; i < nbPairs; i++)
+  {
+    blocking.push_back(new SarsaPair(i + 1, 0, latency, nbSteps, 1));
+    scheduled.push_back(new SarsaPair(i + 1, 0, latency, nbSteps, 1));
+    scheduler.add(scheduled.back()->runner);
+  }
+
+  Timer timer;
+  timer.start();
+  for (int i = 0; i < nbPairs; i++)
+    while (blocking[i]->runner->isRunning())
+      while (!blocking[i]->runner->resume())
+        ;
+  timer.stop();
+  const double blockingTime = timer.getElapsedTimeInMilliSec();
+
+  timer.start();
+  scheduler.run();
+  timer.stop();
+  const double scheduledTime = timer.getElapsedTimeInMilliSec();
+  std::cout << "blocking=" << blockingTime << "ms scheduled=" << scheduledTime << "ms"
+      << std::endl;
+  Assert::assertPasses(scheduledTime * 5 < blockingTime);
+
+  for (int i = 0; i < nbPairs; i++)
+  {
+    Assert::assertObjectEquals(blocking[i]->sarsa->weights()->sum(),
+        scheduled[i]->sarsa->weights()->sum());
+    delete blocking[i];
+    delete scheduled[i];
+  }
+}
+
+void RLRunnerSchedulerTest::run()
+{
+  testInterleavedEquivalence();
+  testExternalLatency();
+}
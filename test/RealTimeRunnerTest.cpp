@@ -0,0 +1,175 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * RealTimeRunnerTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "RealTimeRunnerTest.h"
+
+RLLIB_TEST_MAKE(RealTimeRunnerTest)
+
+// MountainCar whose every k-th step computes for busyInMicroSec
+class SlowMountainCar: public MountainCar<double>
+{
+  protected:
+    int k;
+    double busyInMicroSec;
+
+  public:
+    long nbCalls; // one per step of the runner
+
+    SlowMountainCar(Random<double>* random, const int& k, const double& busyInMicroSec) :
+        MountainCar<double>(random), k(k), busyInMicroSec(busyInMicroSec), nbCalls(0)
+    {
+    }
+
+    void initialize()
+    {
+      MountainCar<double>::initialize();
+      ++nbCalls;
+    }
+
+    void step(const Action<double>* a)
+    {
+      MountainCar<double>::step(a);
+      ++nbCalls;
+      if (k && nbCalls % k == 0)
+      {
+        Timer timer;
+        timer.start();
+        do
+          timer.stop();
+        while (timer.getElapsedTimeInMicroSec() < busyInMicroSec);
+      }
+    }
+};
+
+// Sarsa on a SlowMountainCar, stepped by a RealTimeRunner
+class RealTimeSarsa
+{
+  public:
+    Random<double>* random;
+    SlowMountainCar* problem;
+    Hashing<double>* hashing;
+    Projector<double>* projector;
+    StateToStateAction<double>* toStateAction;
+    Trace<double>* e;
+    Sarsa<double>* sarsa;
+    Policy<double>* acting;
+    OnPolicyControlLearner<double>* control;
+    RLAgent<double>* agent;
+    RealTimeRunner<double>* runner;
+
+    RealTimeSarsa(const double& periodInMicroSec, const int& k, const double& busyInMicroSec,
+        const int& maxEpisodeTimeSteps, const int& nbEpisodes) :
+        random(new Random<double>)
+    {
+      problem = new SlowMountainCar(random, k, busyInMicroSec);
+      hashing = new MurmurHashing<double>(random, 10000);
+      projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true);
+      toStateAction = new StateActionTilings<double>(projector, problem->getDiscreteActions());
+      e = new RTrace<double>(projector->dimension());
+      sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+      acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+      control = new SarsaControl<double>(acting, toStateAction, sarsa);
+      agent = new LearnerAgent<double>(control);
+      runner = new RealTimeRunner<double>(agent, problem, maxEpisodeTimeSteps, periodInMicroSec,
+          nbEpisodes);
+      runner->setVerbose(false);
+    }
+
+    ~RealTimeSarsa()
+    {
+      delete random;
+      delete problem;
+      delete hashing;
+      delete projector;
+      delete toStateAction;
+      delete e;
+      delete sarsa;
+      delete acting;
+      delete control;
+      delete agent;
+      delete runner;
+    }
+};
+
+// Undoes initializeRealTime() for the tests that follow
+class RealTimeScope
+{
+  protected:
+    RealTimeRunner<double>* runner;
+
+  public:
+    RealTimeScope(RealTimeRunner<double>* runner) :
+        runner(runner)
+    {
+      runner->initializeRealTime();
+    }
+
+    ~RealTimeScope()
+    {
+      runner->releaseRealTime();
+    }
+};
+
+void RealTimeRunnerTest::testPeriodicSteps()
+{
+  // 4 episodes on a 1ms period: the steps do not allocate after the warm-up
+  const int nbWarmUpSteps = 100;
+  RealTimeSarsa sarsa(1000, 0, 0, 250, 4);
+  sarsa.runner->setWarmUpSteps(nbWarmUpSteps);
+  RealTimeScope scope(sarsa.runner);
+  Timer timer;
+  timer.start();
+  sarsa.runner->runRealTime();
+  timer.stop();
+  sarsa.runner->printReport(std::cout);
+
+  const long nbSteps = sarsa.problem->nbCalls;
+  Assert::assertPasses(sarsa.runner->getNbSteps() == nbSteps - nbWarmUpSteps);
+  Assert::assertPasses(
+      long(sarsa.runner->getStepTimeHistogram().count()) == nbSteps - nbWarmUpSteps);
+  Assert::assertPasses(
+      long(sarsa.runner->getLatencyHistogram().count()) == nbSteps - nbWarmUpSteps);
+  Assert::assertPasses(timer.getElapsedTimeInMilliSec() >= nbSteps - 1);
+  Assert::assertPasses(sarsa.runner->getHeapGrowth() == 0);
+  Assert::assertPasses(sarsa.runner->getNbDeadlineMisses() < nbSteps / 4);
+}
+
+void RealTimeRunnerTest::testDeadlineMisses()
+{
+  // Every 20th step computes for 2.5ms on a 1ms period: it misses its deadline and two periods
+  RealTimeSarsa sarsa(1000, 20, 2500, 250, 2);
+  sarsa.runner->setWarmUpSteps(0);
+  sarsa.runner->setLockMemory(false);
+  sarsa.runner->runRealTime();
+  sarsa.runner->printReport(std::cout);
+
+  const long nbSlowSteps = sarsa.problem->nbCalls / 20;
+  Assert::assertPasses(nbSlowSteps > 0);
+  Assert::assertPasses(sarsa.runner->getNbDeadlineMisses() >= nbSlowSteps);
+  Assert::assertPasses(sarsa.runner->getNbMissedPeriods() >= 2 * nbSlowSteps);
+  Assert::assertPasses(sarsa.runner->getMaxStepTimeInMicroSec() >= 2500);
+}
+
+void RealTimeRunnerTest::run()
+{
+  testPeriodicSteps();
+  testDeadlineMisses();
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SnapshotTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include "SnapshotTest.h"
+
+RLLIB_TEST_MAKE(SnapshotTest)
+
+/**
+ * OffPAC on a synthetic problem whose observations and rewards are drawn
+ * from the same random number generator as the behavior policy.
+ */
+class SyntheticOffPAC
+{
+  public:
+    Random<double>* random;
+    Actions<double>* actions;
+    Hashing<double>* hashing;
+    Projector<double>* projector;
+    StateToStateAction<double>* toStateAction;
+    Trace<double>* critice;
+    GTDLambda<double>* critic;
+    PolicyDistribution<double>* target;
+    Trace<double>* actore;
+    Traces<double>* actoreTraces;
+    ActorOffPolicy<double>* actor;
+    Policy<double>* behavior;
+    OffPolicyControlLearner<double>* control;
+    PVector<double>* x_t;
+    PVector<double>* x_tp1;
+    double a_t;
+
+    SyntheticOffPAC(const int& memorySize, const uint32_t& seed, const bool& start = true) :
+        random(new Random<double>), actions(new ActionArray<double>(3)), //
+        hashing(new MurmurHashing<double>(random, memorySize)), //
+        projector(new TileCoderHashing<double>(hashing, 2, 10, 10, true)), //
+        toStateAction(new StateActionTilings<double>(projector, actions)), //
+        critice(new ATrace<double>(projector->dimension())), //
+        critic(new GTDLambda<double>(0.1 / projector->vectorNorm(), 0.001 / projector->vectorNorm(),
+            0.9, 0.4, critice)), //
+        target(new BoltzmannDistribution<double>(random, actions, projector->dimension())), //
+        actore(new ATrace<double>(projector->dimension())), actoreTraces(new Traces<double>), //
+        actor(0), behavior(new RandomPolicy<double>(random, actions)), control(0), //
+        x_t(new PVector<double>(2)), x_tp1(new PVector<double>(2)), a_t(0)
+    {
+      random->reseed(seed);
+      actoreTraces->push_back(actore);
+      actor = new ActorLambdaOffPolicy<double>(0.01 / projector->vectorNorm(), 0.9, 0.4, target,
+          actoreTraces);
+      control = new OffPAC<double>(behavior, critic, actor, toStateAction, projector);
+      if (start)
+        initialize();
+    }
+
+    void initialize()
+    {
+      observe(x_t);
+      a_t = control->initialize(x_t)->id();
+    }
+
+    ~SyntheticOffPAC()
+    {
+      delete control;
+      delete behavior;
+      delete actor;
+      delete actoreTraces;
+      delete actore;
+      delete target;
+      delete critic;
+      delete critice;
+      delete toStateAction;
+      delete projector;
+      delete hashing;
+      delete actions;
+      delete random;
+      delete x_t;
+      delete x_tp1;
+    }
+
+    void observe(PVector<double>* x)
+    {
+      for (int i = 0; i < x->dimension(); i++)
+        x->setEntry(i, random->nextReal());
+    }
+
+    void steps(const int& nbSteps)
+    {
+      for (int t = 0; t < nbSteps; t++)
+      {
+        observe(x_tp1);
+        const double r_tp1 = x_tp1->getEntry(0) * (a_t - 1.0);
+        a_t = control->step(x_t, actions->getEntry(int(a_t)), x_tp1, r_tp1, 0.0)->id();
+        x_t->set(x_tp1);
+      }
+    }
+
+    // The learner, the random number generator, and the state of the loop
+    void archive(Snapshot<double>* snapshot)
+    {
+      snapshot->add("control", control);
+      snapshot->add("random", random);
+      snapshot->add("x_t", x_t);
+      snapshot->add("a_t", a_t);
+    }
+};
+
+/**
+ * Sarsa on the same synthetic problem, with an epsilon greedy behavior.
+ */
+class SyntheticSarsa
+{
+  public:
+    Random<double>* random;
+    Actions<double>* actions;
+    Hashing<double>* hashing;
+    Projector<double>* projector;
+    StateToStateAction<double>* toStateAction;
+    Trace<double>* e;
+    Sarsa<double>* sarsa;
+    Policy<double>* acting;
+    OnPolicyControlLearner<double>* control;
+    PVector<double>* x_t;
+    PVector<double>* x_tp1;
+    double a_t;
+
+    SyntheticSarsa(const int& memorySize, const uint32_t& seed) :
+        random(new Random<double>), actions(new ActionArray<double>(3)), //
+        hashing(new MurmurHashing<double>(random, memorySize)), //
+        projector(new TileCoderHashing<double>(hashing, 2, 10, 10, true)), //
+        toStateAction(new StateActionTilings<double>(projector, actions)), //
+        e(new ATrace<double>(toStateAction->dimension())), //
+        sarsa(new Sarsa<double>(0.1 / projector->vectorNorm(), 0.9, 0.4, e)), //
+        acting(new EpsilonGreedy<double>(random, actions, sarsa, 0.1)), //
+        control(new SarsaControl<double>(acting, toStateAction, sarsa)), //
+        x_t(new PVector<double>(2)), x_tp1(new PVector<double>(2)), a_t(0)
+    {
+      random->reseed(seed);
+    }
+
+    ~SyntheticSarsa()
+    {
+      delete control;
+      delete acting;
+      delete sarsa;
+      delete e;
+      delete toStateAction;
+      delete projector;
+      delete hashing;
+      delete actions;
+      delete random;
+      delete x_t;
+      delete x_tp1;
+    }
+
+    void initialize()
+    {
+      for (int i = 0; i < x_t->dimension(); i++)
+        x_t->setEntry(i, random->nextReal());
+      a_t = control->initialize(x_t)->id();
+    }
+
+    void steps(const int& nbSteps)
+    {
+      for (int t = 0; t < nbSteps; t++)
+      {
+        for (int i = 0; i < x_tp1->dimension(); i++)
+          x_tp1->setEntry(i, random->nextReal());
+        const double r_tp1 = x_tp1->getEntry(0) * (a_t - 1.0);
+        a_t = control->step(x_t, actions->getEntry(int(a_t)), x_tp1, r_tp1, 0.0)->id();
+        x_t->set(x_tp1);
+      }
+    }
+
+    void archive(Snapshot<double>* snapshot)
+    {
+      snapshot->add("control", control);
+      snapshot->add("random", random);
+      snapshot->add("x_t", x_t);
+      snapshot->add("a_t", a_t);
+    }
+};
+
+void SnapshotTest::testRandomState()
+{
+  Random<double> random;
+  random.reseed(7);
+  random.nextGaussian(0.0, 1.0);
+  uint32_t state[4];
+  double cachedGaussian;
+  bool isCached;
+  random.getState(state, cachedGaussian, isCached);
+  Assert::assertPasses(isCached);
+  const double expected1 = random.nextGaussian(0.0, 1.0);
+  const double expected2 = random.nextGaussian(0.0, 1.0);
+  // Each generator has its own cached deviate
+  Random<double> other;
+  other.nextGaussian(0.0, 1.0);
+  other.setState(state, cachedGaussian, isCached);
+  Assert::assertObjectEquals(other.nextGaussian(0.0, 1.0), expected1);
+  Assert::assertObjectEquals(other.nextGaussian(0.0, 1.0), expected2);
+}
+
+void SnapshotTest::testResumeEquivalence()
+{
+  SyntheticOffPAC original(100000, 1);
+  original.steps(500);
+  Snapshot<double> snapshot;
+  original.archive(&snapshot);
+  // v, w, e, phi_t, u, e_u, x_t; gamma_t, lambda_t, a_t; random
+  Assert::assertObjectEquals(snapshot.dimension(), 11);
+  snapshot.persistAsync("visualization/snapshot_offpac.data");
+  Assert::assertPasses(snapshot.wait());
+  original.steps(500);
+
+  SyntheticOffPAC resumed(100000, 2);
+  Snapshot<double> restored;
+  resumed.archive(&restored);
+  Assert::assertPasses(restored.resurrect("visualization/snapshot_offpac.data"));
+  // Restoring the weights only is not equivalent
+  SyntheticOffPAC weightsOnly(100000, 2);
+  weightsOnly.critic->weights()->set(resumed.critic->weights());
+  weightsOnly.target->parameters()->getEntry(0)->set(resumed.target->parameters()->getEntry(0));
+
+  resumed.steps(500);
+  Assert::assertEquals(original.critic->weights(), resumed.critic->weights());
+  Assert::assertEquals(original.critic->secondaryWeights(), resumed.critic->secondaryWeights());
+  Assert::assertEquals(original.target->parameters()->getEntry(0),
+      resumed.target->parameters()->getEntry(0));
+  weightsOnly.steps(500);
+  Assert::assertFails(
+      VectorsTestsUtils::checkVectorEquals(original.critic->weights(),
+          weightsOnly.critic->weights()));
+}
+
+void SnapshotTest::testArchiveBeforeFirstStep()
+{
+  // The snapshot registers the state of a learner that has not stepped yet
+  SyntheticOffPAC original(100000, 1, false);
+  Snapshot<double> snapshot;
+  original.archive(&snapshot);
+  Assert::assertObjectEquals(snapshot.dimension(), 11);
+  original.initialize();
+  original.steps(500);
+  Assert::assertPasses(snapshot.persist("visualization/snapshot_first_step.data"));
+  original.steps(500);
+
+  SyntheticOffPAC resumed(100000, 2);
+  Snapshot<double> restored;
+  resumed.archive(&restored);
+  Assert::assertPasses(restored.resurrect("visualization/snapshot_first_step.data"));
+  resumed.steps(500);
+  Assert::assertEquals(original.critic->weights(), resumed.critic->weights());
+  Assert::assertEquals(original.target->parameters()->getEntry(0),
+      resumed.target->parameters()->getEntry(0));
+}
+
+void SnapshotTest::testSarsaResume()
+{
+  // The state-action vector of the current step is registered before the first step
+  SyntheticSarsa original(100000, 1);
+  Snapshot<double> snapshot;
+  original.archive(&snapshot);
+  // q, e, xa_t, x_t; alpha, a_t; random
+  Assert::assertObjectEquals(snapshot.dimension(), 7);
+  original.initialize();
+  original.steps(500);
+  Assert::assertPasses(snapshot.persist("visualization/snapshot_sarsa.data"));
+  original.steps(500);
+
+  // Resumed in the middle of the episode
+  SyntheticSarsa resumed(100000, 2);
+  resumed.initialize();
+  Snapshot<double> restored;
+  resumed.archive(&restored);
+  Assert::assertPasses(restored.resurrect("visualization/snapshot_sarsa.data"));
+  resumed.steps(500);
+  Assert::assertEquals(original.sarsa->weights(), resumed.sarsa->weights());
+}
+
+void SnapshotTest::testStepTimeImpact()
+{
+  const int nbSteps = 40000, period = 10000;
+  const char* modes[] = { "none", "async", "sync" };
+  double captureTime = 0, writeTime = 0;
+  for (int mode = 0; mode < 3; mode++)
+  {
+    SyntheticOffPAC agent(1 << 20, 1);
+    Snapshot<double> snapshot;
+    agent.archive(&snapshot);
+    Timer timer;
+    double maxStepTime = 0;
+    timer.start();
+    for (int t = 0; t < nbSteps; t += period)
+    {
+      agent.steps(period);
+      Timer stepTimer;
+      stepTimer.start();
+      if (mode == 1)
+        snapshot.persistAsync("visualization/snapshot_impact.data");
+      else if (mode == 2)
+        Assert::assertPasses(snapshot.persist("visualization/snapshot_impact.data"));
+      stepTimer.stop();
+      maxStepTime = std::max(maxStepTime, stepTimer.getElapsedTimeInMilliSec());
+    }
+    Assert::assertPasses(snapshot.wait());
+    timer.stop();
+    cout << "snapshot=" << modes[mode] << " timePerStep="
+        << timer.getElapsedTimeInMicroSec() / nbSteps << "us maxStall=" << maxStepTime
+        << "ms capture=" << snapshot.getCaptureTimeInMilliSec() << "ms write="
+        << snapshot.getWriteTimeInMilliSec() << "ms" << endl;
+    if (mode == 1)
+      captureTime = snapshot.getCaptureTimeInMilliSec();
+    if (mode == 2)
+      writeTime = snapshot.getWriteTimeInMilliSec();
+  }
+  Assert::assertPasses(captureTime < writeTime);
+}
+
+void SnapshotTest::run()
+{
+  testRandomState();
+  testResumeEquivalence();
+  testArchiveBeforeFirstStep();
+  testSarsaResume();
+  testStepTimeImpact();
+}
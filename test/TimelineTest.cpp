@@ -0,0 +1,258 @@
+/*
+ * Copyright 2015 Saminda Abeyruwan (saminda@cs.miami.edu)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *
+ *
+ * TimelineTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: sam
+ */
+
+#include <thread>
+#include <chrono>
+#include "TimelineTest.h"
+
+RLLIB_TEST_MAKE(TimelineTest)
+
+namespace
+{
+  const char* timelineFile = "TimelineTest.json";
+
+  std::string readAll(const char* f)
+  {
+    std::ifstream in(f);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+  int count(const std::string& text, const std::string& pattern)
+  {
+    int n = 0;
+    for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1))
+      ++n;
+    return n;
+  }
+
+  // The CPU time of the calling thread, in us
+  double threadTime()
+  {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec * 1e6 + time.tv_nsec * 1e-3;
+  }
+
+  // A MountainCar agent with Sarsa, pipelined (and learning on a background thread) or not
+  class MountainCarSarsa
+  {
+    public:
+      Random<double>* random;
+      RLProblem<double>* problem;
+      Hashing<double>* hashing;
+      Projector<double>* projector;
+      StateToStateAction<double>* toStateAction;
+      Trace<double>* e;
+      Sarsa<double>* sarsa;
+      Policy<double>* acting;
+      OnPolicyControlLearner<double>* control;
+      RLAgent<double>* agent;
+      RLRunner<double>* runner;
+
+      MountainCarSarsa(const int& nbEpisodes, const bool& pipelined, const bool& threaded = false)
+      {
+        random = new Random<double>;
+        problem = new MountainCar<double>(random);
+        hashing = new MurmurHashing<double>(random, 10000);
+        projector = new TileCoderHashing<double>(hashing, problem->dimension(), 10, 10, true);
+        toStateAction = new StateActionTilings<double>(projector, problem->getDiscreteActions());
+        e = new RTrace<double>(projector->dimension());
+        sarsa = new Sarsa<double>(0.15 / projector->vectorNorm(), 0.99, 0.3, e);
+        acting = new EpsilonGreedy<double>(random, problem->getDiscreteActions(), sarsa, 0.01);
+        control = new SarsaControl<double>(acting, toStateAction, sarsa);
+        if (pipelined)
+          agent = new PipelinedLearnerAgent<double>(control, threaded);
+        else
+          agent = new LearnerAgent<double>(control);
+        runner = new RLRunner<double>(agent, problem, 5000, nbEpisodes, 1);
+        runner->setVerbose(false);
+      }
+
+      ~MountainCarSarsa()
+      {
+        delete runner;
+        delete agent;
+        delete hashing;
+        delete projector;
+        delete toStateAction;
+        delete e;
+        delete sarsa;
+        delete acting;
+        delete control;
+        delete random;
+        delete problem;
+      }
+  };
+}
+
+void TimelineTest::testAgentTimeline()
+{
+  MountainCarSarsa agent(3, true, true);
+  Checkpoint<double> checkpoint;
+  checkpoint.add("q", agent.sarsa->weights());
+  Assert::assertPasses(Timeline::start(timelineFile));
+  agent.runner->run();
+  checkpoint.persist("TimelineTest.bin");
+  Timeline::stop();
+
+  const std::string timeline = readAll(timelineFile);
+  std::cout << "timeline: " << timeline.size() << " bytes" << std::endl;
+  Assert::assertPasses(timeline.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+  Assert::assertPasses(timeline.rfind("]}") == timeline.size() - 3);
+  Assert::assertObjectEquals(3, count(timeline, "\"name\":\"episode\""));
+  Assert::assertObjectEquals(3, count(timeline, "\"name\":\"initialize\""));
+  Assert::assertObjectEquals(1, count(timeline, "\"name\":\"checkpoint\""));
+  Assert::assertObjectEquals(1, count(timeline, "\"args\":{\"value\":2}"));
+  const int nbSteps = count(timeline, "\"name\":\"step\"");
+  Assert::assertPasses(nbSteps > 0);
+  // The updates run on the learner thread, at most one per step
+  const int nbUpdates = count(timeline, "\"name\":\"learn\"");
+  Assert::assertPasses(nbUpdates > 0 && nbUpdates <= nbSteps);
+  Assert::assertPasses(count(timeline, "\"tid\":1,") > 0);
+  Assert::assertPasses(count(timeline, "\"ph\":\"X\"") == count(timeline, "\"dur\":"));
+  std::remove(timelineFile);
+  std::remove("TimelineTest.bin");
+
+  // Stopped, the spans are not recorded
+  agent.runner->setEpisodes(1);
+  agent.runner->run();
+  Assert::assertPasses(!Timeline::enabled());
+}
+
+void TimelineTest::testDroppedSpans()
+{
+  // A burst larger than the ring: the spans are written or counted as dropped
+  const uint64_t nbDropped = Timeline::getNbDropped();
+  const int nbSpans = 4 * Timeline::RING_SIZE;
+  Assert::assertPasses(Timeline::start(timelineFile));
+  std::thread burst([nbSpans]()
+  {
+    for (int i = 0; i < nbSpans; i++)
+    {
+      RLLIB_TIMELINE("burst");
+    }
+  });
+  burst.join();
+  Timeline::stop();
+  const std::string timeline = readAll(timelineFile);
+  const int nbWritten = count(timeline, "\"name\":\"burst\"");
+  std::cout << "burst: written=" << nbWritten << " dropped="
+      << (Timeline::getNbDropped() - nbDropped) << std::endl;
+  Assert::assertObjectEquals(uint64_t(nbSpans), nbWritten + Timeline::getNbDropped() - nbDropped);
+  std::remove(timelineFile);
+}
+
+void TimelineTest::testLearnerSpans()
+{
+  // The agents that learn on the thread of the runner record their updates too
+  for (int pipelined = 0; pipelined < 2; pipelined++)
+  {
+    // One episode: its spans fit in the ring, none are dropped
+    MountainCarSarsa agent(1, pipelined);
+    Assert::assertPasses(Timeline::start(timelineFile));
+    agent.runner->run();
+    Timeline::stop();
+    const std::string timeline = readAll(timelineFile);
+    const int nbSteps = count(timeline, "\"name\":\"step\"");
+    const int nbUpdates = count(timeline, "\"name\":\"learn\"");
+    Assert::assertPasses(nbSteps > 0);
+    if (pipelined)
+      Assert::assertPasses(nbUpdates > 0 && nbUpdates <= nbSteps);
+    else
+      Assert::assertObjectEquals(nbSteps, nbUpdates);
+  }
+  std::remove(timelineFile);
+}
+
+void TimelineTest::testLongName()
+{
+  // The names are written as they are, whatever their length
+  const std::string name(4000, 'n');
+  Assert::assertPasses(Timeline::start(timelineFile));
+  {
+    RLLIB_TIMELINE(name.c_str());
+  }
+  Timeline::stop();
+  const std::string timeline = readAll(timelineFile);
+  Assert::assertObjectEquals(1, count(timeline, "{\"name\":\"" + name + "\",\"ph\":\"X\""));
+  std::remove(timelineFile);
+}
+
+void TimelineTest::testOverhead()
+{
+  // The costs on the recording thread, each the fastest of a few bursts, so the writer does
+  // not run in between and the ring never fills: a scope, and a record of known times
+  const int nbSpans = Timeline::RING_SIZE / 8;
+  double spanTime = 0, recordTime = 0;
+  Assert::assertPasses(Timeline::start(timelineFile));
+  for (int i = 0; i < 5; i++)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * int(Timeline::FLUSH_PERIOD)));
+    double time = threadTime();
+    for (int j = 0; j < nbSpans; j++)
+    {
+      RLLIB_TIMELINE("overhead");
+    }
+    spanTime = std::min(i ? spanTime : 1e300, (threadTime() - time) / nbSpans);
+    time = threadTime();
+    for (int j = 0; j < nbSpans; j++)
+      Timeline::record("overhead", j, j + 1);
+    recordTime = std::min(i ? recordTime : 1e300, (threadTime() - time) / nbSpans);
+  }
+  Timeline::stop();
+
+  // The runner records the step with the times of its timer, the agent a scope per update
+  MountainCarSarsa agent(50, true);
+  Assert::assertPasses(Timeline::start(timelineFile));
+  agent.runner->run();
+  Timeline::stop();
+  const std::string timeline = readAll(timelineFile);
+  const int nbSteps = count(timeline, "\"name\":\"step\"");
+  const double stepOverhead = recordTime
+      + spanTime * count(timeline, "\"name\":\"learn\"") / nbSteps;
+  double stepTime = 0;
+  for (int i = 0; i < 5; i++)
+  {
+    MountainCarSarsa reference(50, true);
+    const double time = threadTime();
+    reference.runner->run();
+    stepTime = std::min(i ? stepTime : 1e300, (threadTime() - time) / nbSteps);
+  }
+  std::cout << "step: " << stepTime * 1e3 << "ns timeline: " << stepOverhead * 1e3 << "ns ("
+      << 100 * stepOverhead / stepTime << "%)" << std::endl;
+  // A few percent: about two clock reads of a step of 2us. Both sides are wall-clock timings,
+  // so only an order of magnitude is checked, which a loaded machine cannot break
+  Assert::assertPasses(stepOverhead < stepTime);
+  std::remove(timelineFile);
+}
+
+void TimelineTest::run()
+{
+  testAgentTimeline();
+  testDroppedSpans();
+  testLearnerSpans();
+  testLongName();
+  testOverhead();
+}
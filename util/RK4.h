@@ -27,20 +27,21 @@
 #include "Action.h"
 
 // Runge-Kutta 4th Order ODE Solver for RL problems
+template<typename T>
 class RK4
 {
   private:
-    Vector<double>* state;
-    VectorPool<double>* pool;
+    Vector<T>* state;
+    VectorPool<T>* pool;
 
-    double timeIncrement;
-    double time;
+    T timeIncrement;
+    T time;
     int timeSteps;
 
   public:
-    RK4(const int& stateVariables, const double& timeIncrement) :
-        state(new PVector<double>(stateVariables)), pool(
-            new VectorPool<double>(state->dimension())), timeIncrement(timeIncrement)
+    RK4(const int& stateVariables, const T& timeIncrement) :
+        state(new PVector<T>(stateVariables)), pool(
+            new VectorPool<T>(state->dimension())), timeIncrement(timeIncrement)
     {
       initialize();
     }
@@ -57,12 +58,12 @@ class RK4
       timeSteps = 0;
     }
 
-    Vector<double>* vec()
+    Vector<T>* vec()
     {
       return state;
     }
 
-    double getTime() const
+    T getTime() const
     {
       return time;
     }
@@ -80,37 +81,37 @@ class RK4
      * x(t_0) = x_0;
      *
      */
-    void step(const Action<double>* action = 0)
+    void step(const Action<T>* action = 0)
     {
       //
       //  Get four sample values of the derivative.
       //
-      Vector<double>* f0 = pool->newVector(state);
+      Vector<T>* f0 = pool->newVector(state);
       f(time, action, state, f0);
 
-      Vector<double>* u1 = pool->newVector(state);
-      u1->addToSelf(timeIncrement / 2.0f, f0);
+      Vector<T>* u1 = pool->newVector(state);
+      u1->addToSelf(timeIncrement / T(2), f0);
 
-      Vector<double>* f1 = pool->newVector(u1);
-      f(time + timeIncrement / 2.0f, action, u1, f1);
+      Vector<T>* f1 = pool->newVector(u1);
+      f(time + timeIncrement / T(2), action, u1, f1);
 
-      Vector<double>* u2 = pool->newVector(state);
-      u2->addToSelf(timeIncrement / 2.0f, f1);
+      Vector<T>* u2 = pool->newVector(state);
+      u2->addToSelf(timeIncrement / T(2), f1);
 
-      Vector<double>* f2 = pool->newVector(u2);
-      f(time + timeIncrement / 2.0f, action, u2, f2);
+      Vector<T>* f2 = pool->newVector(u2);
+      f(time + timeIncrement / T(2), action, u2, f2);
 
-      Vector<double>* u3 = pool->newVector(state);
+      Vector<T>* u3 = pool->newVector(state);
       u3->addToSelf(timeIncrement, f2);
 
-      Vector<double>* f3 = pool->newVector(u3);
+      Vector<T>* f3 = pool->newVector(u3);
       f(time + timeIncrement, action, u3, f3);
 
       //
       //  Combine them to estimate the solution.
       //
-      state->addToSelf(timeIncrement / 6.0f, f0)->addToSelf(timeIncrement / 3.0f, f1)->addToSelf(
-          timeIncrement / 3.0f, f2)->addToSelf(timeIncrement / 6.0f, f3);
+      state->addToSelf(timeIncrement / T(6), f0)->addToSelf(timeIncrement / T(3), f1)->addToSelf(
+          timeIncrement / T(3), f2)->addToSelf(timeIncrement / T(6), f3);
 
       // Release pool
       pool->releaseAll();
@@ -125,8 +126,8 @@ class RK4
      *
      * Output is the fourth-order Runge-Kutta solution estimate at time TIME + DT.
      */
-    virtual void f(const double& time, const Action<double>* action, const Vector<double>* x,
-        Vector<double>* x_dot) =0;
+    virtual void f(const T& time, const Action<T>* action, const Vector<T>* x,
+        Vector<T>* x_dot) =0;
 };
 
 #endif /* RK4_H_ */